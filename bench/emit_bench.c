@@ -0,0 +1,130 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LCA_DA_IMPLEMENTATION
+#define LCA_MEM_IMPLEMENTATION
+#define LCA_STR_IMPLEMENTATION
+#define LCA_PLAT_IMPLEMENTATION
+#include "laye.h"
+#include "layec.h"
+
+#define NOB_NO_CMD_RENDER
+#define NOB_IMPLEMENTATION
+#include "nob.h"
+
+// Measures the throughput of the textual backends (LYIR, LLVM IR and C) on a synthetic
+// module with a large number of small functions, using only instructions every backend
+// supports. Each emitter is run a few times over the same module and the best run is
+// reported, in megabytes of output per second.
+
+#define DEFAULT_FUNCTION_COUNT (20000)
+#define EMIT_ROUNDS            (5)
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static string generate_source(int64_t function_count) {
+    string source = string_create(default_allocator);
+
+    lca_string_append_format(&source, "foreign \"puts\" callconv(cdecl) int puts(i8[*] s);\n");
+    for (int64_t i = 0; i < function_count; i++) {
+        lca_string_append_format(
+            &source,
+            "int fn_%lld(int x, int y) {\n"
+            "    int mut a = x + %lld + y;\n"
+            "    int mut b = a - %lld;\n"
+            "    if (a < b) { b = b + a; } else { a = a - 2; }\n"
+            "    f64 f = %lld;\n"
+            "    puts(\"function %lld\");\n"
+            "    return a + b;\n"
+            "}\n",
+            (long long)i, (long long)i, (long long)i, (long long)i, (long long)i
+        );
+    }
+
+    return source;
+}
+
+typedef string (*emit_function)(layec_module* module);
+
+static string emit_lyir(layec_module* module) {
+    return layec_module_print(module, false);
+}
+
+static void run_emitter(const char* name, emit_function emit, layec_module* module) {
+    double best_seconds = 0;
+    int64_t output_size = 0;
+
+    for (int64_t round = 0; round < EMIT_ROUNDS; round++) {
+        double start = now_seconds();
+        string output = emit(module);
+        double end = now_seconds();
+
+        output_size = output.count;
+        string_destroy(&output);
+
+        if (round == 0 || end - start < best_seconds) {
+            best_seconds = end - start;
+        }
+    }
+
+    double megabytes = (double)output_size / (1024.0 * 1024.0);
+    printf("  %-6s %10.3f ms  %8.2f MB  %8.2f MB/s\n", name, best_seconds * 1000.0, megabytes, megabytes / best_seconds);
+}
+
+int main(int argc, char** argv) {
+    int64_t function_count = DEFAULT_FUNCTION_COUNT;
+    if (argc > 1) {
+        function_count = atoll(argv[1]);
+        assert(function_count > 0);
+    }
+
+    lca_temp_allocator_init(default_allocator, 1024 * 1024);
+    layec_init_targets(default_allocator);
+
+    layec_context* context = layec_context_create(default_allocator);
+    context->use_color = false;
+
+    string source = generate_source(function_count);
+    printf("emit_bench: %lld functions, %lld bytes of source\n", (long long)function_count, (long long)source.count);
+
+    layec_sourceid sourceid = layec_context_get_or_add_source_from_string(
+        context,
+        string_view_to_string(default_allocator, SV_CONSTANT("<emit-bench>")),
+        source
+    );
+
+    laye_module* module = laye_parse(context, sourceid);
+    assert(module != NULL);
+    if (context->has_reported_errors) {
+        fprintf(stderr, "emit_bench: the synthetic module failed to parse\n");
+        return 1;
+    }
+
+    laye_analyse(context);
+    if (context->has_reported_errors) {
+        fprintf(stderr, "emit_bench: the synthetic module failed semantic analysis\n");
+        return 1;
+    }
+
+    laye_generate_ir(context);
+    assert(arr_count(context->ir_modules) == 1);
+
+    layec_module* ir_module = context->ir_modules[0];
+    layec_irpass_validate(ir_module);
+    layec_irpass_fix_abi(ir_module);
+
+    run_emitter("lyir", emit_lyir, ir_module);
+    run_emitter("llvm", layec_codegen_llvm, ir_module);
+    run_emitter("c", layec_codegen_c, ir_module);
+
+    layec_context_destroy(context);
+    lca_temp_allocator_clear();
+
+    return 0;
+}
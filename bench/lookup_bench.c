@@ -0,0 +1,118 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LCA_DA_IMPLEMENTATION
+#define LCA_MEM_IMPLEMENTATION
+#define LCA_STR_IMPLEMENTATION
+#define LCA_PLAT_IMPLEMENTATION
+#include "laye.h"
+#include "layec.h"
+
+#define NOB_NO_CMD_RENDER
+#define NOB_IMPLEMENTATION
+#include "nob.h"
+
+// Measures name resolution on a synthetic module with a very large number of
+// top-level declarations. Every function is declared at module scope, and a final
+// function references each of them once, so sema performs one lookup per declaration
+// through a nested scope chain.
+
+#define DEFAULT_DECLARATION_COUNT (50000)
+#define LOOKUP_ROUNDS             (20)
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static string generate_source(int64_t declaration_count) {
+    string source = string_create(default_allocator);
+
+    for (int64_t i = 0; i < declaration_count; i++) {
+        lca_string_append_format(&source, "int decl_%lld(int x) { return x + %lld; }\n", (long long)i, (long long)i);
+    }
+
+    lca_string_append_format(&source, "int reference_all() {\n    int mut s = 0;\n");
+    for (int64_t i = 0; i < declaration_count; i++) {
+        lca_string_append_format(&source, "    s = decl_%lld(s);\n", (long long)i);
+    }
+
+    lca_string_append_format(&source, "    return s;\n}\n");
+    return source;
+}
+
+int main(int argc, char** argv) {
+    int64_t declaration_count = DEFAULT_DECLARATION_COUNT;
+    if (argc > 1) {
+        declaration_count = atoll(argv[1]);
+        assert(declaration_count > 0);
+    }
+
+    lca_temp_allocator_init(default_allocator, 1024 * 1024);
+    layec_init_targets(default_allocator);
+
+    layec_context* context = layec_context_create(default_allocator);
+    context->use_color = false;
+
+    string source = generate_source(declaration_count);
+    printf("lookup_bench: %lld top-level declarations, %lld bytes of source\n", (long long)declaration_count, (long long)source.count);
+
+    layec_sourceid sourceid = layec_context_get_or_add_source_from_string(
+        context,
+        string_view_to_string(default_allocator, SV_CONSTANT("<lookup-bench>")),
+        source
+    );
+
+    double parse_start = now_seconds();
+    laye_module* module = laye_parse(context, sourceid);
+    assert(module != NULL);
+    double parse_end = now_seconds();
+
+    if (context->has_reported_errors) {
+        fprintf(stderr, "lookup_bench: the synthetic module failed to parse\n");
+        return 1;
+    }
+
+    double sema_start = now_seconds();
+    laye_analyse(context);
+    double sema_end = now_seconds();
+
+    if (context->has_reported_errors) {
+        fprintf(stderr, "lookup_bench: the synthetic module failed semantic analysis\n");
+        return 1;
+    }
+
+    printf("  parse:                 %10.3f ms\n", (parse_end - parse_start) * 1000.0);
+    printf("  sema:                  %10.3f ms\n", (sema_end - sema_start) * 1000.0);
+
+    // look up every declared name directly in the module scope.
+    dynarr(layec_symbol) names = NULL;
+    for (int64_t i = 0, count = arr_count(module->top_level_nodes); i < count; i++) {
+        laye_node* node = module->top_level_nodes[i];
+        if (laye_node_is_decl(node)) {
+            arr_push(names, node->declared_name);
+        }
+    }
+
+    int64_t found_count = 0;
+    double lookup_start = now_seconds();
+    for (int64_t round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int64_t i = 0, count = arr_count(names); i < count; i++) {
+            found_count += laye_scope_lookup_value(module->scope, names[i]) != NULL;
+        }
+    }
+    double lookup_end = now_seconds();
+
+    assert(found_count == LOOKUP_ROUNDS * arr_count(names));
+    double lookup_total_ns = (lookup_end - lookup_start) * 1e9;
+    printf("  scope lookup:          %10.3f ns/lookup (%lld lookups)\n", lookup_total_ns / (double)found_count, (long long)found_count);
+
+    arr_free(names);
+    layec_context_destroy(context);
+    lca_temp_allocator_clear();
+
+    return 0;
+}
@@ -43,12 +43,24 @@ static const char* stage1_laye_headers_dir = "./stage1/include/";
 static const char* stage1_laye_sources[] = {
     "./stage1/src/layec_shared.c",
     "./stage1/src/layec_context.c",
+    "./stage1/src/layec_trace.c",
     "./stage1/src/layec_depgraph.c",
     "./stage1/src/layec_ir.c",
+    "./stage1/src/layec_pass_manager.c",
+    "./stage1/src/layec_analysis.c",
     "./stage1/src/irpass/validate.c",
     "./stage1/src/irpass/abi.c",
+    "./stage1/src/irpass/mem2reg.c",
+    "./stage1/src/irpass/simplify.c",
+    "./stage1/src/irpass/simplifycfg.c",
+    "./stage1/src/irpass/inline.c",
+    "./stage1/src/irpass/gvn.c",
+    "./stage1/src/irpass/licm.c",
+    "./stage1/src/irpass/lsr.c",
+    "./stage1/src/irpass/dce.c",
     "./stage1/src/layec_cback.c",
     "./stage1/src/layec_llvm.c",
+    "./stage1/src/layec_interp.c",
     "./stage1/src/c/c_data.c",
     "./stage1/src/c/c_debug.c",
     "./stage1/src/c/c_parser.c",
@@ -61,6 +73,13 @@ static const char* stage1_laye_sources[] = {
     "./stage1/src/compiler.c"
 };
 
+static const char* benchmark_sources[] = {
+    "./bench/lookup_bench.c",
+    "./bench/emit_bench.c",
+};
+
+static int64_t benchmark_sources_count = sizeof(benchmark_sources) / sizeof(benchmark_sources[0]);
+
 static int64_t stage1_laye_sources_count = sizeof(stage1_laye_sources) / sizeof(stage1_laye_sources[0]);
 static int64_t stage1_laye_sources_count_without_main = (sizeof(stage1_laye_sources) / sizeof(stage1_laye_sources[0])) - 1;
 
@@ -101,6 +120,17 @@ static void cflags(Nob_Cmd* cmd) {
     nob_cmd_append(cmd, "-D_XOPEN_SOURCE=600");
 }
 
+// libraries the compiler links against: libm, and libdl for the interpreter's foreign calls on
+// systems where dlopen isn't part of libc yet.
+static void ldflags(Nob_Cmd* cmd) {
+#ifndef _WIN32
+    nob_cmd_append(cmd, "-lm");
+#    if !defined(__APPLE__)
+    nob_cmd_append(cmd, "-ldl");
+#    endif
+#endif
+}
+
 static void layeflags(Nob_Cmd* cmd) {
     nob_cmd_append(cmd, "-I", "./lib/laye/liblaye");
 }
@@ -217,6 +247,7 @@ static void build_stage1_laye_executable() {
         nob_cmd_append(&cmd, output_path);
     }
 
+    ldflags(&cmd);
     nob_cmd_run_sync(cmd);
 }
 
@@ -281,10 +312,39 @@ static void build_parse_fuzzer() {
     }
 
     nob_cmd_append(&cmd_link, object_path);
+    ldflags(&cmd_link);
 
     nob_cmd_run_sync(cmd_link);
 }
 
+// benchmarks are always rebuilt from source with optimizations and without sanitizers,
+// so they don't share object files with the stage1 driver.
+static const char* build_benchmark(const char* benchmark_path) {
+    const char* benchmark_name = basename(benchmark_path);
+    const char* executable_path = nob_temp_sprintf(BUILD_DIR "/%.*s", (int)(strlen(benchmark_name) - 2), benchmark_name);
+
+    Nob_File_Paths inputs = {0};
+    nob_da_append(&inputs, benchmark_path);
+    for (int i = 0; i < stage1_laye_sources_count_without_main; i++) {
+        nob_da_append(&inputs, stage1_laye_sources[i]);
+    }
+
+    Nob_Cmd cmd = {0};
+    nob_cmd_append(&cmd, CC);
+    nob_cmd_append(&cmd, "-o", executable_path);
+    cflags(&cmd);
+    nob_cmd_append(&cmd, "-O2");
+    nob_da_append_many(&cmd, inputs.items, inputs.count);
+    ldflags(&cmd);
+
+    Nob_Proc_Result result = nob_cmd_run_sync_result(cmd);
+    bool success = result.exited && result.exit_code == 0;
+    nob_cmd_free(cmd);
+    nob_da_free(inputs);
+
+    return success ? executable_path : NULL;
+}
+
 static void build_stage1_laye_driver() {
     build_stage1_laye_executable();
 }
@@ -344,6 +404,9 @@ static void run_fchk(bool rebuild) {
 #define NOB_HELP_TEXT_FUZZ \
     "    --stage2             Build the fuzzer for the stage2 compiler (not currently supported)\n"
 
+#define NOB_HELP_TEXT_BENCH \
+    "    <name>               Only build and run the benchmark with this name\n"
+
 #define NOB_HELP_TEXT                                                                                       \
     "\nCommands:\n\n"                                                                                       \
     "build                    Used to build the Laye tools in this project.\n"                              \
@@ -361,6 +424,9 @@ static void run_fchk(bool rebuild) {
     "\n"                                                                                                    \
     "fuzz                     Runs the fuzzer. The fuzzer currently only runs through parsing.\n"           \
     "                         By default, fuzzing is run against the stage1 compiler.\n" NOB_HELP_TEXT_FUZZ \
+    "\n"                                                                                                    \
+    "bench                    Builds and runs the stage1 compiler benchmarks in `bench/`.\n"                \
+    "                         Benchmarks are built with optimizations and without sanitizers.\n" NOB_HELP_TEXT_BENCH \
     ""
 
 static int nob_help(const char* command) {
@@ -377,6 +443,8 @@ static int nob_help(const char* command) {
         fprintf(stderr, "%s\n", NOB_HELP_TEXT_TEST);
     } else if (0 == strcmp("fuzz", command)) {
         fprintf(stderr, "%s\n", NOB_HELP_TEXT_FUZZ);
+    } else if (0 == strcmp("bench", command)) {
+        fprintf(stderr, "%s\n", NOB_HELP_TEXT_BENCH);
     } else {
         fprintf(stderr, "unknown command\n");
         return 1;
@@ -694,6 +762,47 @@ static int nob_fuzz(int argc, char** argv) {
     return 0;
 }
 
+static int nob_bench(int argc, char** argv) {
+    const char* only_benchmark = NULL;
+
+    while (argc > 0) {
+        int shared = nob_shared_args("bench", &argc, &argv);
+        if (shared >= 0) {
+            return shared;
+        } else if (shared == NOB_SHARED_ARG_HANDLED) {
+            continue;
+        }
+
+        only_benchmark = nob_shift_args(&argc, &argv);
+    }
+
+    no_asan = true;
+
+    int result = 0;
+    for (int64_t i = 0; i < benchmark_sources_count; i++) {
+        const char* benchmark_name = basename(benchmark_sources[i]);
+        if (only_benchmark != NULL && 0 != strncmp(only_benchmark, benchmark_name, strlen(benchmark_name) - 2)) {
+            continue;
+        }
+
+        const char* executable_path = build_benchmark(benchmark_sources[i]);
+        if (executable_path == NULL) {
+            return 1;
+        }
+
+        Nob_Cmd cmd = {0};
+        nob_cmd_append(&cmd, executable_path);
+        Nob_Proc_Result benchmark_result = nob_cmd_run_sync_result(cmd);
+        if (!benchmark_result.exited || benchmark_result.exit_code != 0) {
+            result = 1;
+        }
+
+        nob_cmd_free(cmd);
+    }
+
+    return result;
+}
+
 int main(int argc, char** argv) {
     NOB_GO_REBUILD_URSELF(argc, argv);
 
@@ -718,6 +827,9 @@ int main(int argc, char** argv) {
         } else if (0 == strcmp("fuzz", maybe_command)) {
             nob_shift_args(&argc, &argv);
             return nob_fuzz(argc, argv);
+        } else if (0 == strcmp("bench", maybe_command)) {
+            nob_shift_args(&argc, &argv);
+            return nob_bench(argc, argv);
         }
     }
 
@@ -100,7 +100,7 @@ typedef struct laye_module_import {
 } laye_module_import;
 
 typedef struct laye_aliased_node {
-    string_view name;
+    layec_symbol name;
     laye_node* node;
 } laye_aliased_node;
 
@@ -110,11 +110,18 @@ typedef enum laye_symbol_kind {
 } laye_symbol_kind;
 
 typedef struct laye_symbol {
+    struct laye_module* module;
     laye_symbol_kind kind;
-    string_view name;
+    layec_symbol name;
     union {
         dynarr(laye_node*) nodes;
-        dynarr(struct laye_symbol*) symbols;
+        struct {
+            // children of a namespace symbol should be added with `laye_symbol_namespace_add`
+            // so they are also tracked by `symbol_index`.
+            dynarr(struct laye_symbol*) symbols;
+            // maps the data pointer of each interned child name to its first position in `symbols`.
+            lca_ptrmap symbol_index;
+        };
     };
 } laye_symbol;
 
@@ -160,6 +167,11 @@ struct laye_scope {
     dynarr(laye_aliased_node) value_declarations;
     // types declared in this scope.
     dynarr(laye_aliased_node) type_declarations;
+    // lookup indices for the two declaration lists above, mapping the data pointer of each
+    // interned name to its first position in the list. the lists keep declaration order, so
+    // iteration remains deterministic, while lookups no longer have to scan them.
+    lca_ptrmap value_index;
+    lca_ptrmap type_index;
 };
 
 typedef enum laye_mut_compare {
@@ -332,7 +344,8 @@ struct laye_token {
     union {
         int64_t int_value;
         double float_value;
-        string_view string_value;
+        // identifier and string literal values are always interned.
+        layec_symbol string_value;
     };
 };
 
@@ -489,7 +502,7 @@ typedef struct laye_nameref {
 
 typedef struct laye_struct_type_field {
     laye_type type;
-    string_view name;
+    layec_symbol name;
     layec_evaluated_constant initial_value;
 } laye_struct_type_field;
 
@@ -544,7 +557,7 @@ struct laye_node {
     // if either `import.is_wildcard` is set to true *or* `import.imported_names`
     // contains values, then this is assumed to be empty except for to report a syntax
     // error when used imporperly.
-    string_view declared_name;
+    layec_symbol declared_name;
     // attributes for this declaration that aren't covered by other standard cases.
     laye_attributes attributes;
     // template parameters for this declaration, if there are any.
@@ -560,10 +573,6 @@ struct laye_node {
     // but for syntactic preservation these nodes are stored with every declaration anyway.
     dynarr(laye_node*) attribute_nodes;
 
-    // populated during IRgen, makes it easier to keep track of
-    // since we don't have usable hash tables woot.
-    //layec_value* ir_value;
-
     union {
         // node describing an import declaration.
         // note that `export import` reuses the `linkage` field shared by all declarations.
@@ -1219,9 +1228,10 @@ void laye_module_destroy(laye_module* module);
 
 //
 
-laye_symbol* laye_symbol_create(laye_module* module, laye_symbol_kind kind, string_view name);
+laye_symbol* laye_symbol_create(laye_module* module, laye_symbol_kind kind, layec_symbol name);
 void laye_symbol_destroy(laye_symbol* symbol);
-laye_symbol* laye_symbol_lookup(laye_symbol* symbol_namespace, string_view name);
+laye_symbol* laye_symbol_lookup(laye_symbol* symbol_namespace, layec_symbol name);
+void laye_symbol_namespace_add(laye_symbol* symbol_namespace, laye_symbol* symbol);
 
 //
 
@@ -1246,9 +1256,9 @@ layec_source laye_module_get_source(laye_module* module);
 laye_scope* laye_scope_create(laye_module* module, laye_scope* parent);
 void laye_scope_destroy(laye_scope* scope);
 void laye_scope_declare(laye_scope* scope, laye_node* declaration);
-void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, string_view alias);
-laye_node* laye_scope_lookup_value(laye_scope* scope, string_view value_name);
-laye_node* laye_scope_lookup_type(laye_scope* scope, string_view type_name);
+void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, layec_symbol alias);
+laye_node* laye_scope_lookup_value(laye_scope* scope, layec_symbol value_name);
+laye_node* laye_scope_lookup_type(laye_scope* scope, layec_symbol type_name);
 
 laye_node* laye_node_create(laye_module* module, laye_node_kind kind, layec_location location, laye_type type);
 laye_node* laye_node_create_in_context(layec_context* context, laye_node_kind kind, laye_type type);
@@ -57,9 +57,19 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 typedef int64_t layec_sourceid;
 
+// a string interned by `layec_context_intern_string_view`.
+// every symbol interned into the same context with the same contents shares the same
+// storage, so two symbols compare equal exactly when their data pointers do.
+// symbols are stored as plain string views so they can be used anywhere one is expected,
+// which also means a view that was never interned type checks as one; APIs keyed on symbols
+// assert `layec_symbol_is_interned` to catch that.
+typedef string_view layec_symbol;
+
 typedef struct layec_source {
     string name;
     string text;
+    // byte offsets of the start of each line, built on first use by location queries.
+    dynarr(int64_t) line_starts;
 } layec_source;
 
 typedef struct layec_target_info {
@@ -108,6 +118,7 @@ typedef struct layec_dependency_graph layec_dependency_graph;
 
 typedef struct layec_type layec_type;
 typedef struct layec_value layec_value;
+typedef struct layec_use layec_use;
 typedef struct layec_module layec_module;
 typedef struct layec_builder layec_builder;
 
@@ -118,6 +129,21 @@ typedef struct layec_struct_member {
 
 typedef void (*layec_ir_pass_function)(layec_module* module);
 
+typedef struct layec_pass_manager layec_pass_manager;
+
+// returns true if the function was changed.
+typedef bool (*layec_ir_function_pass_function)(layec_pass_manager* pass_manager, layec_value* function);
+
+// an analysis is computed for a function on first request, then cached by the pass manager
+// until that function changes; a result stays valid until the analysis is next requested.
+typedef struct layec_analysis_info {
+    const char* name;
+    void* (*compute)(layec_pass_manager* pass_manager, layec_value* function);
+    void (*destroy)(void* result);
+    // only looks at the blocks and the edges between them, so changes to anything else keep it.
+    bool depends_only_on_cfg;
+} layec_analysis_info;
+
 typedef struct layec_context {
     lca_allocator allocator;
     layec_target_info* target;
@@ -125,6 +151,10 @@ typedef struct layec_context {
     bool use_color;
     bool has_reported_errors;
     bool use_byte_positions_in_diagnostics;
+    // the -O level; at 1 and above, builders simplify instructions as they're created.
+    int optimization_level;
+    // the largest callee, in instructions, the inliner will inline; -1 picks one from the -O level.
+    int inline_threshold;
 
     dynarr(layec_source) sources;
     dynarr(string_view) include_directories;
@@ -133,7 +163,8 @@ typedef struct layec_context {
 
     int64_t max_interned_string_size;
     lca_arena* string_arena;
-    dynarr(string) _interned_strings;
+    // every interned string, keyed by contents.
+    lca_hashset _interned_strings;
     dynarr(string) allocated_strings;
 
     dynarr(struct laye_module*) laye_modules;
@@ -167,12 +198,14 @@ typedef struct layec_context {
     lca_arena* type_arena;
     dynarr(layec_type*) _all_types;
     dynarr(struct cached_struct_type { laye_node* node; layec_type* type; }) _all_struct_types;
+    // every structurally uniqued type (integer, array and function types), so two
+    // such types are equal exactly when their pointers are.
+    lca_hashset _unique_types;
 
     struct {
         layec_type* poison;
         layec_type* ptr;
         layec_type* _void;
-        dynarr(layec_type*) int_types;
         layec_type* f32;
         layec_type* f64;
     } types;
@@ -182,6 +215,9 @@ typedef struct layec_context {
     } values;
 
     dynarr(layec_value*) _all_values;
+
+    // the open --trace-out file, or NULL when not tracing.
+    struct layec_trace* trace;
 } layec_context;
 
 typedef struct layec_location {
@@ -277,12 +313,17 @@ typedef void layec_dependency_entity;
 typedef struct layec_dependency_entry {
     laye_node* node;
     dynarr(layec_dependency_entity*) dependencies;
+    // set of `dependencies`, only built once the list is long enough
+    // that scanning it for duplicates would be slower.
+    ptrmap dependency_set;
 } layec_dependency_entry;
 
 struct layec_dependency_graph {
     layec_context* context;
     lca_arena* arena;
     dynarr(layec_dependency_entry*) entries;
+    // maps each tracked entity to its entry.
+    ptrmap entry_lookup;
 };
 
 typedef struct layec_dependency_order_result {
@@ -452,7 +493,20 @@ void layec_write_warn(layec_context* context, layec_location location, const cha
 void layec_write_error(layec_context* context, layec_location location, const char* format, ...);
 void layec_write_ice(layec_context* context, layec_location location, const char* format, ...);
 
-string_view layec_context_intern_string_view(layec_context* context, string_view s);
+layec_symbol layec_context_intern_string_view(layec_context* context, string_view s);
+bool layec_symbol_equals(layec_symbol a, layec_symbol b);
+// true if `s` is the symbol interned into `context` for its contents, not just an equal view.
+// this costs a lookup in the intern table, so it's meant for assertions.
+bool layec_symbol_is_interned(layec_context* context, string_view s);
+
+// writes Chrome trace events (viewable in Perfetto or chrome://tracing) to `file_path` until closed.
+// spans nest; every `layec_trace_begin` must be matched by a `layec_trace_end`, except that
+// closing the trace ends any spans still open. without an open trace these do nothing.
+bool layec_trace_open(layec_context* context, const char* file_path);
+void layec_trace_close(layec_context* context);
+// `detail` is shown with the span when it isn't empty.
+void layec_trace_begin(layec_context* context, const char* category, string_view name, string_view detail);
+void layec_trace_end(layec_context* context);
 
 #define LAYEC_ICE(C, L, F) do { layec_write_ice(C, L, F); exit(1); } while (0)
 #define LAYEC_ICEV(C, L, F, ...) do { layec_write_ice(C, L, F, __VA_ARGS__); exit(1); } while (0)
@@ -476,9 +530,122 @@ int layec_get_significant_bits(int64_t value);
 
 void layec_irpass_validate(layec_module* module);
 void layec_irpass_fix_abi(layec_module* module);
+void layec_irpass_mem2reg(layec_module* module);
+void layec_irpass_inline(layec_module* module);
+bool layec_irpass_mem2reg_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_simplify_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_simplifycfg_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_gvn_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_licm_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_lsr_function(layec_pass_manager* pass_manager, layec_value* function);
+bool layec_irpass_dce_function(layec_pass_manager* pass_manager, layec_value* function);
+
+// return an existing or constant value equivalent to the operation, or NULL if there's none.
+// when optimizing, the builder calls these before creating unary and binary instructions.
+layec_value* layec_simplify_unary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* operand, layec_type* type);
+layec_value* layec_simplify_binary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* lhs, layec_value* rhs, layec_type* type);
+
+layec_pass_manager* layec_pass_manager_create(layec_context* context);
+void layec_pass_manager_destroy(layec_pass_manager* pass_manager);
+void layec_pass_manager_add_module_pass(layec_pass_manager* pass_manager, const char* name, layec_ir_pass_function pass);
+void layec_pass_manager_add_function_pass(layec_pass_manager* pass_manager, const char* name, layec_ir_function_pass_function pass);
+// registers the standard pipeline for an -O level, starting with validation and the ABI fixups.
+void layec_pass_manager_add_default_passes(layec_pass_manager* pass_manager, int optimization_level);
+void layec_pass_manager_set_time_passes(layec_pass_manager* pass_manager, bool time_passes);
+// prints, per module, every pass which changed the number of instructions or blocks in it.
+void layec_pass_manager_set_print_pass_stats(layec_pass_manager* pass_manager, bool print_pass_stats);
+// prints a line to stderr for every remark a pass makes about what it changed.
+void layec_pass_manager_set_print_remarks(layec_pass_manager* pass_manager, bool print_remarks);
+// passes can skip putting together remarks nobody will see.
+bool layec_pass_manager_wants_remarks(layec_pass_manager* pass_manager);
+// `block` may be NULL for a remark about the whole function.
+void layec_pass_manager_remark(layec_pass_manager* pass_manager, layec_value* function, layec_value* block, const char* format, ...);
+void layec_pass_manager_run(layec_pass_manager* pass_manager, layec_module* module);
+void* layec_pass_manager_get_analysis(layec_pass_manager* pass_manager, const layec_analysis_info* analysis, layec_value* function);
+// drops the cached analyses of `function`, or of every function if it is NULL.
+void layec_pass_manager_invalidate_analyses(layec_pass_manager* pass_manager, layec_value* function);
+// prints the time and IR size change of every pass, accumulated over all runs, to stderr.
+void layec_pass_manager_print_time_passes(layec_pass_manager* pass_manager);
+
+// - Analyses
+
+typedef struct layec_cfg layec_cfg;
+typedef struct layec_dominator_tree layec_dominator_tree;
+typedef struct layec_dominance_frontier layec_dominance_frontier;
+typedef struct layec_loop_info layec_loop_info;
+typedef struct layec_loop layec_loop;
+
+// each computes the type of the same name; the ones built on others request them from the pass manager.
+extern const layec_analysis_info layec_cfg_analysis;
+extern const layec_analysis_info layec_dominator_tree_analysis;
+extern const layec_analysis_info layec_dominance_frontier_analysis;
+extern const layec_analysis_info layec_loop_info_analysis;
+
+layec_cfg* layec_cfg_get(layec_pass_manager* pass_manager, layec_value* function);
+layec_dominator_tree* layec_dominator_tree_get(layec_pass_manager* pass_manager, layec_value* function);
+layec_dominance_frontier* layec_dominance_frontier_get(layec_pass_manager* pass_manager, layec_value* function);
+layec_loop_info* layec_loop_info_get(layec_pass_manager* pass_manager, layec_value* function);
+
+// predecessors and successors are listed once each, however many edges there are between two blocks.
+int64_t layec_cfg_predecessor_count(layec_cfg* cfg, layec_value* block);
+layec_value* layec_cfg_get_predecessor_at_index(layec_cfg* cfg, layec_value* block, int64_t predecessor_index);
+int64_t layec_cfg_successor_count(layec_cfg* cfg, layec_value* block);
+layec_value* layec_cfg_get_successor_at_index(layec_cfg* cfg, layec_value* block, int64_t successor_index);
+bool layec_cfg_is_reachable(layec_cfg* cfg, layec_value* block);
+// the blocks reachable from the entry block, in reverse post-order.
+int64_t layec_cfg_reachable_block_count(layec_cfg* cfg);
+layec_value* layec_cfg_get_block_in_reverse_postorder(layec_cfg* cfg, int64_t rpo_index);
+
+bool layec_dominator_tree_is_reachable(layec_dominator_tree* tree, layec_value* block);
+// NULL for the entry block and for unreachable blocks.
+layec_value* layec_dominator_tree_immediate_dominator(layec_dominator_tree* tree, layec_value* block);
+int64_t layec_dominator_tree_child_count(layec_dominator_tree* tree, layec_value* block);
+layec_value* layec_dominator_tree_get_child_at_index(layec_dominator_tree* tree, layec_value* block, int64_t child_index);
+// every block dominates itself; unreachable blocks neither dominate nor are dominated.
+bool layec_dominator_tree_dominates(layec_dominator_tree* tree, layec_value* dominator, layec_value* block);
+
+int64_t layec_dominance_frontier_count(layec_dominance_frontier* frontier, layec_value* block);
+layec_value* layec_dominance_frontier_get_block_at_index(layec_dominance_frontier* frontier, layec_value* block, int64_t frontier_index);
+
+// natural loops; loops sharing a header are one loop with several latches.
+// a loop always comes before the loops nested in it.
+int64_t layec_loop_info_loop_count(layec_loop_info* loop_info);
+layec_loop* layec_loop_info_get_loop_at_index(layec_loop_info* loop_info, int64_t loop_index);
+// the innermost loop containing `block`, or NULL if it isn't in one.
+layec_loop* layec_loop_info_get_loop_for_block(layec_loop_info* loop_info, layec_value* block);
+layec_value* layec_loop_header(layec_loop* loop);
+// NULL for an outermost loop.
+layec_loop* layec_loop_parent(layec_loop* loop);
+// 1 for an outermost loop.
+int64_t layec_loop_depth(layec_loop* loop);
+int64_t layec_loop_block_count(layec_loop* loop);
+layec_value* layec_loop_get_block_at_index(layec_loop* loop, int64_t block_index);
+int64_t layec_loop_latch_count(layec_loop* loop);
+layec_value* layec_loop_get_latch_at_index(layec_loop* loop, int64_t latch_index);
+bool layec_loop_contains(layec_loop* loop, layec_value* block);
+// the one block outside the loop branching to its header, if the header is all it branches to.
+layec_value* layec_loop_get_preheader(layec_loop* loop, layec_cfg* cfg);
 
 string layec_codegen_c(layec_module* module);
+void layec_codegen_c_to_writer(layec_module* module, lca_writer* output);
 string layec_codegen_llvm(layec_module* module);
+void layec_codegen_llvm_to_writer(layec_module* module, lca_writer* output);
+
+// Interpreter API
+
+// runs LYIR directly from the context's modules, which must outlive it. declarations resolve to a
+// definition of the same name in any module, then to a symbol of the compiler's own process,
+// so calls into libc work where the platform supports them. errors, including runtime ones like
+// division by zero, are reported as diagnostics at the offending instruction.
+typedef struct layec_interp layec_interp;
+
+layec_interp* layec_interp_create(layec_context* context);
+void layec_interp_destroy(layec_interp* interp);
+// the function named `name` with a body in any of the context's modules, or NULL.
+layec_value* layec_interp_find_function(layec_interp* interp, string_view name);
+// arguments and the result are integers zero-extended from their width, floats as their IEEE bits
+// (a float in the low 32) and pointers as addresses. returns false if the call could not complete.
+bool layec_interp_call(layec_interp* interp, layec_value* function, int64_t argument_count, const uint64_t* arguments, uint64_t* out_result);
 
 // Context API
 
@@ -498,8 +665,12 @@ layec_value* layec_module_get_global_at_index(layec_module* module, int64_t glob
 int64_t layec_module_function_count(layec_module* module);
 layec_value* layec_module_get_function_at_index(layec_module* module, int64_t function_index);
 layec_value* layec_module_create_global_string_ptr(layec_module* module, layec_location location, string_view string_value);
+// every value created in the module, including ones which have since been removed from it.
+int64_t layec_module_value_count(layec_module* module);
+lca_arena_stats layec_module_arena_stats(layec_module* module);
 
 string layec_module_print(layec_module* module, bool use_color);
+void layec_module_print_to_writer(layec_module* module, lca_writer* output, bool use_color);
 
 // Type API
 
@@ -543,27 +714,39 @@ int64_t layec_type_struct_member_count(layec_type* type);
 layec_struct_member layec_type_struct_get_member_at_index(layec_type* type, int64_t index);
 layec_type* layec_type_struct_get_member_type_at_index(layec_type* type, int64_t index);
 
-void layec_type_print_to_string(layec_type* type, string* s, bool use_color);
+void layec_type_print_to_writer(layec_type* type, lca_writer* w, bool use_color);
 
 // - Function Type API
 
 int64_t layec_function_type_parameter_count(layec_type* function_type);
 layec_type* layec_function_type_get_parameter_type_at_index(layec_type* function_type, int64_t parameter_index);
 bool layec_function_type_is_variadic(layec_type* function_type);
-void layec_function_type_set_parameter_type_at_index(layec_type* function_type, int64_t parameter_index, layec_type* param_type);
 
 // Value API
 
 const char* layec_value_kind_to_cstring(layec_value_kind kind);
 
-int64_t layec_value_get_user_count(layec_value* value);
-layec_value* layec_value_get_user_at_index(layec_value* value, int64_t user_index);
+// every operand slot referring to a value is linked into that value's list of uses, in no particular order.
+// the uses from an instruction go away when it is removed from its function (but not when it is only
+// taken out of its block to be inserted elsewhere).
+layec_use* layec_value_first_use(layec_value* value);
+bool layec_value_has_uses(layec_value* value);
+int64_t layec_value_use_count(layec_value* value);
+// points every use of `value` at `replacement` instead, in time proportional to the number of uses.
+void layec_value_replace_all_uses_with(layec_value* value, layec_value* replacement);
+
+layec_use* layec_use_next(layec_use* use);
+layec_value* layec_use_get_value(layec_use* use);
+layec_value* layec_use_get_user(layec_use* use);
+int64_t layec_use_operand_index(layec_use* use);
 
 int64_t layec_value_integer_constant(layec_value* value);
 double layec_value_float_constant(layec_value* value);
 
 layec_value_kind layec_value_get_kind(layec_value* value);
 layec_context* layec_value_context(layec_value* value);
+// the module a function, global or instruction belongs to; NULL for constants.
+layec_module* layec_value_module(layec_value* value);
 layec_location layec_value_location(layec_value* value);
 layec_linkage layec_value_linkage(layec_value* value);
 layec_type* layec_value_get_type(layec_value* value);
@@ -577,6 +760,7 @@ bool layec_value_is_function(layec_value* value);
 bool layec_value_is_instruction(layec_value* value);
 
 layec_value* layec_void_constant(layec_context* context);
+layec_value* layec_poison_constant(layec_context* context, layec_location location, layec_type* type);
 layec_value* layec_int_constant(layec_context* context, layec_location location, layec_type* type, int64_t value);
 layec_value* layec_float_constant(layec_context* context, layec_location location, layec_type* type, double value);
 layec_value* layec_array_constant(layec_context* context, layec_location location, layec_type* type, void* data, int64_t length, bool is_string_literal);
@@ -585,7 +769,7 @@ bool layec_array_constant_is_string(layec_value* array_constant);
 int64_t layec_array_constant_length(layec_value* array_constant);
 const char* layec_array_constant_data(layec_value* array_constant);
 
-void layec_value_print_to_string(layec_value* value, string* s, bool print_type, bool use_color);
+void layec_value_print_to_writer(layec_value* value, lca_writer* w, bool print_type, bool use_color);
 
 // - Function Value API
 
@@ -596,9 +780,22 @@ layec_value* layec_function_get_block_at_index(layec_value* function, int64_t bl
 int64_t layec_function_parameter_count(layec_value* function);
 layec_value* layec_function_get_parameter_at_index(layec_value* function, int64_t parameter_index);
 bool layec_function_is_variadic(layec_value* function);
+bool layec_function_is_inline(layec_value* function);
+void layec_function_set_inline(layec_value* function, bool is_inline);
+// incremented by every change to the function, and for `cfg_version` by every change to its blocks
+// or their successors.
+int64_t layec_function_version(layec_value* function);
+int64_t layec_function_cfg_version(layec_value* function);
 void layec_function_set_parameter_type_at_index(layec_value* function, int64_t parameter_index, layec_type* param_type);
 
 layec_value* layec_function_append_block(layec_value* function, string_view name);
+// removes every instruction marked with `layec_instruction_mark_for_removal` from its block.
+void layec_function_remove_marked_instructions(layec_value* function);
+// removes every block marked with `layec_block_mark_for_removal`, then renumbers the rest.
+// phis referring to a removed block must already have been updated.
+void layec_function_remove_marked_blocks(layec_value* function);
+// removes every block which can't be reached from the entry block, along with the phi entries for edges out of them.
+bool layec_function_remove_unreachable_blocks(layec_value* function);
 
 // - Block API
 
@@ -608,6 +805,16 @@ int64_t layec_block_index(layec_value* block);
 int64_t layec_block_instruction_count(layec_value* block);
 layec_value* layec_block_get_instruction_at_index(layec_value* block, int64_t instruction_index);
 bool layec_block_is_terminated(layec_value* block);
+int64_t layec_block_successor_count(layec_value* block);
+layec_value* layec_block_get_successor_at_index(layec_value* block, int64_t successor_index);
+void layec_block_set_successor_at_index(layec_value* block, int64_t successor_index, layec_value* successor);
+// moves `instruction` and everything after it into a new block at the end of the function, and
+// returns that block. the original block is left without a terminator.
+layec_value* layec_block_split_before(layec_value* instruction);
+// moves every instruction of `block` to the end of `destination`, which must not have a terminator.
+void layec_block_move_instructions_to_end(layec_value* block, layec_value* destination);
+void layec_block_mark_for_removal(layec_value* block);
+bool layec_block_is_marked_for_removal(layec_value* block);
 
 // - Instruction API
 
@@ -619,6 +826,7 @@ bool layec_instruction_return_has_value(layec_value* _return);
 layec_value* layec_instruction_return_value(layec_value* _return);
 
 layec_type* layec_instruction_get_alloca_type(layec_value* alloca);
+int64_t layec_instruction_get_alloca_element_count(layec_value* alloca);
 
 layec_value* layec_instruction_get_address(layec_value* instruction);
 layec_value* layec_instruction_get_operand(layec_value* instruction);
@@ -631,7 +839,6 @@ layec_value* layec_instruction_branch_get_fail(layec_value* instruction);
 layec_value* layec_instruction_callee(layec_value* call);
 int64_t layec_instruction_call_argument_count(layec_value* call);
 layec_value* layec_instruction_call_get_argument_at_index(layec_value* call, int64_t argument_index);
-void layec_instruction_call_set_arguments(layec_value* call, dynarr(layec_value*) arguments);
 int64_t layec_instruction_builtin_argument_count(layec_value* builtin);
 layec_value* layec_instruction_builtin_get_argument_at_index(layec_value* builtin, int64_t argument_index);
 
@@ -639,6 +846,24 @@ void layec_instruction_phi_add_incoming_value(layec_value* phi, layec_value* val
 int64_t layec_instruction_phi_incoming_value_count(layec_value* phi);
 layec_value* layec_instruction_phi_incoming_value_at_index(layec_value* phi, int64_t index);
 layec_value* layec_instruction_phi_incoming_block_at_index(layec_value* phi, int64_t index);
+void layec_instruction_phi_set_incoming_block_at_index(layec_value* phi, int64_t index, layec_value* block);
+void layec_instruction_phi_remove_incoming_value_at_index(layec_value* phi, int64_t index);
+
+// every value operand of an instruction, in a fixed order per instruction kind.
+// block operands (branch targets, phi incoming blocks) are not included.
+int64_t layec_instruction_operand_count(layec_value* instruction);
+layec_value* layec_instruction_get_operand_at_index(layec_value* instruction, int64_t operand_index);
+void layec_instruction_set_operand_at_index(layec_value* instruction, int64_t operand_index, layec_value* operand);
+
+layec_value* layec_instruction_get_parent_block(layec_value* instruction);
+// copies `instruction` into `module` without inserting it anywhere; operands, branch targets and
+// phi blocks still refer to the originals until they are replaced.
+layec_value* layec_instruction_clone(layec_value* instruction, layec_module* module);
+void layec_instruction_remove_from_parent(layec_value* instruction);
+// removes an instruction which nothing uses anymore from its block for good, along with its uses of its operands.
+void layec_instruction_erase(layec_value* instruction);
+void layec_instruction_mark_for_removal(layec_value* instruction);
+bool layec_instruction_is_marked_for_removal(layec_value* instruction);
 
 layec_value* layec_instruction_ptradd_get_address(layec_value* ptradd);
 layec_value* layec_instruction_ptradd_get_offset(layec_value* ptradd);
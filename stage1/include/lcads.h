@@ -41,6 +41,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef LCA_DA_H
 #define LCA_DA_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -114,6 +115,61 @@ void lca_da_maybe_expand(void** da_ref, int64_t element_size, int64_t required_c
 #define lca_da_foreach(T, N, V)     for (T N, *N##_ptr = V, *N##_endptr = V + lca_da_count(V); (N##_ptr < N##_endptr) && (N = *N##_ptr, true); N##_ptr += 1)
 #define lca_da_foreach_ptr(T, N, V) for (T N, **N##_ptr = (T*)V, **N##_endptr = (T*)V + lca_da_count(V); (N##_ptr < N##_endptr) && (N = *N##_ptr, true); N##_ptr += 1)
 
+/// An open-addressed hash map from non-NULL pointer keys to pointer values.
+/// Entries are stored inline and move when the map grows, so pointers to them must never be
+/// stored; always go through `lca_ptrmap_get` and `lca_ptrmap_set` instead.
+/// A zero-initialized map is empty and ready to use.
+typedef struct lca_ptrmap_entry {
+    const void* key;
+    void* value;
+} lca_ptrmap_entry;
+
+typedef struct lca_ptrmap {
+    lca_ptrmap_entry* entries;
+    int64_t capacity;
+    int64_t count;
+} lca_ptrmap;
+
+/// Returns the value stored for `key`, or NULL if there is none.
+void* lca_ptrmap_get(lca_ptrmap* map, const void* key);
+bool lca_ptrmap_contains(lca_ptrmap* map, const void* key);
+void lca_ptrmap_set(lca_ptrmap* map, const void* key, void* value);
+/// Returns true if `key` was present.
+bool lca_ptrmap_remove(lca_ptrmap* map, const void* key);
+void lca_ptrmap_clear(lca_ptrmap* map);
+void lca_ptrmap_free(lca_ptrmap* map);
+
+/// An open-addressed hash set of non-NULL pointers to values the caller hashes and compares,
+/// for keeping one copy of each structurally distinct value. Each entry keeps its value's hash,
+/// so nothing is rehashed when the set grows. A zero-initialized set is empty and ready to use.
+typedef struct lca_hashset_entry {
+    uint64_t hash;
+    void* value;
+} lca_hashset_entry;
+
+typedef struct lca_hashset {
+    lca_hashset_entry* entries;
+    int64_t capacity;
+    int64_t count;
+} lca_hashset;
+
+/// Returns true if the stored `value` is equal to the lookup `key`.
+typedef bool (*lca_hashset_equals_function)(const void* value, const void* key);
+
+/// Returns the value hashed to `hash` which `equals` finds equal to `key`, or NULL if there is none.
+void* lca_hashset_find(lca_hashset* set, uint64_t hash, lca_hashset_equals_function equals, const void* key);
+/// Adds `value`, which must not be equal to any value already in the set.
+void lca_hashset_insert(lca_hashset* set, uint64_t hash, void* value);
+void lca_hashset_free(lca_hashset* set);
+
+/// The initial value for `lca_hash_bytes` and `lca_hash_combine`.
+#define LCA_HASH_SEED 14695981039346656037ull
+
+/// FNV-1a, continuing from `hash`.
+uint64_t lca_hash_bytes(uint64_t hash, const void* data, size_t count);
+/// FNV-1a over a whole 64-bit word at once, for keys made of integers and pointers.
+uint64_t lca_hash_combine(uint64_t hash, uint64_t value);
+
 #ifndef LCA_DA_NO_SHORT_NAMES
 #    define dynarr(T)                T*
 #    define arr_count(V)             lca_da_count(V)
@@ -128,6 +184,19 @@ void lca_da_maybe_expand(void** da_ref, int64_t element_size, int64_t required_c
 #    define arr_free_all(V, F)       lca_da_free_all(V, F)
 #    define arr_foreach(T, N, V)     lca_da_foreach (T, N, V)
 #    define arr_foreach_ptr(T, N, V) lca_da_foreach_ptr (T, N, V)
+
+#    define ptrmap                   lca_ptrmap
+#    define ptrmap_get(M, K)         lca_ptrmap_get(M, K)
+#    define ptrmap_contains(M, K)    lca_ptrmap_contains(M, K)
+#    define ptrmap_set(M, K, V)      lca_ptrmap_set(M, K, V)
+#    define ptrmap_remove(M, K)      lca_ptrmap_remove(M, K)
+#    define ptrmap_clear(M)          lca_ptrmap_clear(M)
+#    define ptrmap_free(M)           lca_ptrmap_free(M)
+
+#    define hashset                  lca_hashset
+#    define hashset_find(S, H, E, K) lca_hashset_find(S, H, E, K)
+#    define hashset_insert(S, H, V)  lca_hashset_insert(S, H, V)
+#    define hashset_free(S)          lca_hashset_free(S)
 #endif // !LCA_DA_NO_SHORT_NAMES
 
 #ifdef LCA_DA_IMPLEMENTATION
@@ -140,6 +209,8 @@ void lca_da_maybe_expand(void** da_ref, int64_t element_size, int64_t required_c
     struct lca_da_header* header = lca_da_get_header(*da_ref);
     if (!*da_ref) {
         int64_t initial_capacity = 32;
+        while (required_count > initial_capacity)
+            initial_capacity *= 2;
         void* new_data = LCA_DA_MALLOC((sizeof *header) + (size_t)(initial_capacity * element_size));
         header = new_data;
 
@@ -154,6 +225,177 @@ void lca_da_maybe_expand(void** da_ref, int64_t element_size, int64_t required_c
     *da_ref = (void*)(header + 1);
 }
 
+static bool lca_hash_table_is_full(int64_t count, int64_t capacity) {
+    // keep the load factor at or below 1/2 so probe sequences stay short.
+    return 2 * (count + 1) > capacity;
+}
+
+static uint64_t lca_ptrmap_hash(const void* key) {
+    uint64_t hash = (uint64_t)(uintptr_t)key;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static int64_t lca_ptrmap_find_slot(lca_ptrmap* map, const void* key) {
+    int64_t mask = map->capacity - 1;
+    int64_t slot = (int64_t)(lca_ptrmap_hash(key) & (uint64_t)mask);
+    while (map->entries[slot].key != NULL && map->entries[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void* lca_ptrmap_get(lca_ptrmap* map, const void* key) {
+    if (map->count == 0 || key == NULL) return NULL;
+    return map->entries[lca_ptrmap_find_slot(map, key)].value;
+}
+
+bool lca_ptrmap_contains(lca_ptrmap* map, const void* key) {
+    if (map->count == 0 || key == NULL) return false;
+    return map->entries[lca_ptrmap_find_slot(map, key)].key != NULL;
+}
+
+void lca_ptrmap_set(lca_ptrmap* map, const void* key, void* value) {
+    if (key == NULL) return;
+
+    if (lca_hash_table_is_full(map->count, map->capacity)) {
+        lca_ptrmap old_map = *map;
+
+        map->capacity = old_map.capacity == 0 ? 32 : old_map.capacity * 2;
+        map->count = 0;
+        map->entries = LCA_DA_MALLOC((size_t)map->capacity * sizeof *map->entries);
+        memset(map->entries, 0, (size_t)map->capacity * sizeof *map->entries);
+
+        for (int64_t i = 0; i < old_map.capacity; i++) {
+            if (old_map.entries[i].key != NULL) {
+                map->entries[lca_ptrmap_find_slot(map, old_map.entries[i].key)] = old_map.entries[i];
+                map->count++;
+            }
+        }
+
+        if (old_map.entries) LCA_DA_FREE(old_map.entries);
+    }
+
+    int64_t slot = lca_ptrmap_find_slot(map, key);
+    if (map->entries[slot].key == NULL) {
+        map->entries[slot].key = key;
+        map->count++;
+    }
+
+    map->entries[slot].value = value;
+}
+
+bool lca_ptrmap_remove(lca_ptrmap* map, const void* key) {
+    if (map->count == 0 || key == NULL) return false;
+
+    int64_t mask = map->capacity - 1;
+    int64_t slot = lca_ptrmap_find_slot(map, key);
+    if (map->entries[slot].key == NULL) return false;
+
+    // backward-shift deletion, so no tombstones are needed.
+    int64_t next = slot;
+    for (;;) {
+        map->entries[slot] = (lca_ptrmap_entry){0};
+
+        for (;;) {
+            next = (next + 1) & mask;
+            if (map->entries[next].key == NULL) {
+                map->count--;
+                return true;
+            }
+
+            int64_t ideal = (int64_t)(lca_ptrmap_hash(map->entries[next].key) & (uint64_t)mask);
+            // the entry at `next` may only move back to `slot` if its ideal slot is not within (slot, next].
+            bool stays = slot <= next ? (slot < ideal && ideal <= next) : (slot < ideal || ideal <= next);
+            if (!stays) break;
+        }
+
+        map->entries[slot] = map->entries[next];
+        slot = next;
+    }
+}
+
+void lca_ptrmap_clear(lca_ptrmap* map) {
+    if (map->entries) memset(map->entries, 0, (size_t)map->capacity * sizeof *map->entries);
+    map->count = 0;
+}
+
+void lca_ptrmap_free(lca_ptrmap* map) {
+    if (map->entries) LCA_DA_FREE(map->entries);
+    *map = (lca_ptrmap){0};
+}
+
+void* lca_hashset_find(lca_hashset* set, uint64_t hash, lca_hashset_equals_function equals, const void* key) {
+    if (set->count == 0) return NULL;
+
+    int64_t mask = set->capacity - 1;
+    for (int64_t slot = (int64_t)(hash & (uint64_t)mask); set->entries[slot].value != NULL; slot = (slot + 1) & mask) {
+        if (set->entries[slot].hash == hash && equals(set->entries[slot].value, key)) {
+            return set->entries[slot].value;
+        }
+    }
+
+    return NULL;
+}
+
+static void lca_hashset_insert_unchecked(lca_hashset* set, lca_hashset_entry entry) {
+    int64_t mask = set->capacity - 1;
+    int64_t slot = (int64_t)(entry.hash & (uint64_t)mask);
+    while (set->entries[slot].value != NULL) {
+        slot = (slot + 1) & mask;
+    }
+
+    set->entries[slot] = entry;
+    set->count++;
+}
+
+void lca_hashset_insert(lca_hashset* set, uint64_t hash, void* value) {
+    if (value == NULL) return;
+
+    if (lca_hash_table_is_full(set->count, set->capacity)) {
+        lca_hashset old_set = *set;
+
+        set->capacity = old_set.capacity == 0 ? 32 : old_set.capacity * 2;
+        set->count = 0;
+        set->entries = LCA_DA_MALLOC((size_t)set->capacity * sizeof *set->entries);
+        memset(set->entries, 0, (size_t)set->capacity * sizeof *set->entries);
+
+        for (int64_t i = 0; i < old_set.capacity; i++) {
+            if (old_set.entries[i].value != NULL) {
+                lca_hashset_insert_unchecked(set, old_set.entries[i]);
+            }
+        }
+
+        if (old_set.entries) LCA_DA_FREE(old_set.entries);
+    }
+
+    lca_hashset_insert_unchecked(set, (lca_hashset_entry){.hash = hash, .value = value});
+}
+
+void lca_hashset_free(lca_hashset* set) {
+    if (set->entries) LCA_DA_FREE(set->entries);
+    *set = (lca_hashset){0};
+}
+
+uint64_t lca_hash_bytes(uint64_t hash, const void* data, size_t count) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+uint64_t lca_hash_combine(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
 #endif // LCA_DA_IMPLEMENTATION
 
 #endif // !LCA_DA_H
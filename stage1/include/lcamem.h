@@ -54,6 +54,14 @@ typedef struct lca_allocator {
 
 typedef struct lca_arena lca_arena;
 
+// totals over every block of an arena; `allocated_bytes` is what was handed out of the blocks,
+// `capacity_bytes` what the blocks themselves take up.
+typedef struct lca_arena_stats {
+    int64_t block_count;
+    int64_t allocated_bytes;
+    int64_t capacity_bytes;
+} lca_arena_stats;
+
 extern lca_allocator default_allocator;
 extern lca_allocator temp_allocator;
 
@@ -73,6 +81,7 @@ void lca_arena_destroy(lca_arena* arena);
 void* lca_arena_push(lca_arena* arena, size_t size);
 void lca_arena_clear(lca_arena* arena);
 void lca_arena_dump(lca_arena* arena);
+lca_arena_stats lca_arena_get_stats(lca_arena* arena);
 
 #ifdef LCA_MEM_IMPLEMENTATION
 
@@ -254,6 +263,9 @@ void lca_arena_dump(lca_arena* arena) {
     fprintf(stderr, "  Allocator:\n");
     fprintf(stderr, "    User Data: %p\n", (void*)arena->allocator.user_data);
     //fprintf(stderr, "    Function: %p\n", arena->allocator.allocator_function);
+    lca_arena_stats stats = lca_arena_get_stats(arena);
+    fprintf(stderr, "  Total Allocated: %ld\n", stats.allocated_bytes);
+    fprintf(stderr, "  Total Capacity: %ld\n", stats.capacity_bytes);
     fprintf(stderr, "  Blocks:\n");
 
     for (int64_t i = 0, count = lca_da_count(arena->blocks); i < count; i++) {
@@ -266,6 +278,21 @@ void lca_arena_dump(lca_arena* arena) {
     }
 }
 
+lca_arena_stats lca_arena_get_stats(lca_arena* arena) {
+    lca_arena_stats stats = {0};
+    if (arena == NULL) {
+        return stats;
+    }
+
+    stats.block_count = lca_da_count(arena->blocks);
+    for (int64_t i = 0, count = lca_da_count(arena->blocks); i < count; i++) {
+        stats.allocated_bytes += arena->blocks[i].allocated;
+        stats.capacity_bytes += arena->blocks[i].capacity;
+    }
+
+    return stats;
+}
+
 #endif // LCA_MEM_IMPLEMENTATION
 
 #endif // !LCAMEM_H
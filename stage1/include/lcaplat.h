@@ -42,6 +42,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define LCAPLAT_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 bool lca_plat_stdout_isatty(void);
 bool lca_plat_stderr_isatty(void);
@@ -50,6 +51,17 @@ bool lca_plat_file_exists(const char* file_path);
 
 const char* lca_plat_self_exe(void);
 
+// seconds from an arbitrary fixed point, for measuring elapsed wall time.
+double lca_plat_time_seconds(void);
+// seconds of CPU time, user and system, this process has used so far.
+double lca_plat_cpu_time_seconds(void);
+// seconds of CPU time used by the child processes which have been waited for so far.
+double lca_plat_child_cpu_time_seconds(void);
+// the largest resident set size of this process so far in bytes, or -1 if it can't be determined.
+int64_t lca_plat_peak_rss_bytes(void);
+// the number of processors available to run on, at least 1.
+int lca_plat_processor_count(void);
+
 #ifdef LCA_PLAT_IMPLEMENTATION
 
 #include <stdio.h>
@@ -67,6 +79,13 @@ const char* lca_plat_self_exe(void);
 #    include <sys/stat.h>
 #endif
 
+#ifndef _WIN32
+#    include <sys/resource.h>
+#    include <unistd.h>
+#endif
+
+#include <time.h>
+
 #include <errno.h>
 
 #include "lcamem.h"
@@ -127,6 +146,92 @@ const char* lca_plat_self_exe(void) {
 #endif
 }
 
+double lca_plat_time_seconds(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#ifdef _WIN32
+static double lca_plat_filetime_seconds(FILETIME filetime) {
+    ULARGE_INTEGER ticks = { .LowPart = filetime.dwLowDateTime, .HighPart = filetime.dwHighDateTime };
+    return (double)ticks.QuadPart / 1e7;
+}
+#else
+static double lca_plat_rusage_seconds(struct rusage* usage) {
+    return (double)usage->ru_utime.tv_sec + (double)usage->ru_utime.tv_usec / 1e6
+         + (double)usage->ru_stime.tv_sec + (double)usage->ru_stime.tv_usec / 1e6;
+}
+#endif
+
+double lca_plat_cpu_time_seconds(void) {
+#if defined(_WIN32)
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        return 0;
+    }
+    return lca_plat_filetime_seconds(kernel_time) + lca_plat_filetime_seconds(user_time);
+#else
+    struct rusage usage = {0};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return lca_plat_rusage_seconds(&usage);
+#endif
+}
+
+double lca_plat_child_cpu_time_seconds(void) {
+#if defined(_WIN32)
+    // NOTE(local): windows only reports times for a process handle, which nob closes once it has waited.
+    return 0;
+#else
+    struct rusage usage = {0};
+    if (getrusage(RUSAGE_CHILDREN, &usage) != 0) {
+        return 0;
+    }
+    return lca_plat_rusage_seconds(&usage);
+#endif
+}
+
+int64_t lca_plat_peak_rss_bytes(void) {
+#if defined(_WIN32)
+    return -1;
+#else
+    struct rusage usage = {0};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#    if defined(__APPLE__)
+    return (int64_t)usage.ru_maxrss;
+#    else
+    // linux and the BSDs report it in kilobytes.
+    return (int64_t)usage.ru_maxrss * 1024;
+#    endif
+#endif
+}
+
+int lca_plat_processor_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#else
+    return 1;
+#endif
+}
+
 #endif // LCA_PLAT_IMPLEMENTATION
 
 #endif // !LCAPLAT_H
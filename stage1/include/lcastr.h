@@ -41,6 +41,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef LCASTR_H
 #define LCASTR_H
 
+#include "lcads.h"
 #include "lcamem.h"
 
 #include <stdarg.h>
@@ -96,6 +97,49 @@ lca_string lca_string_view_change_extension(lca_allocator allocator, lca_string_
 
 lca_string_view lca_string_view_path_file_name(lca_string_view s);
 
+// append-only byte buffer for bulk text output, like generated code.
+// unlike `lca_string_append_format`, the typed appenders never go through printf.
+typedef struct lca_writer {
+    lca_allocator allocator;
+    char* data;
+    int64_t count;
+    int64_t capacity;
+    // when set, the buffer is bounded: rather than growing, it is written out to
+    // `sink` whenever it fills up. the writer never closes its sink.
+    FILE* sink;
+    bool sink_failed;
+    // when `hash_sink` is set, every byte written to the sink is folded into `sink_hash` with
+    // FNV-1a, so the output can be identified without reading it back. `sink_hash` is the seed.
+    bool hash_sink;
+    uint64_t sink_hash;
+    int64_t sink_count;
+} lca_writer;
+
+#define LCA_WRITER_APPEND_LITERAL(W, L) lca_writer_append_data(W, "" L, (int64_t)(sizeof L) - 1)
+
+lca_writer lca_writer_create(lca_allocator allocator);
+lca_writer lca_writer_create_to_file(lca_allocator allocator, FILE* sink, int64_t buffer_size);
+// writes everything buffered so far to the sink, if there is one.
+// returns false if any write to the sink has failed.
+bool lca_writer_flush(lca_writer* w);
+// does not flush; bytes not yet written to the sink are discarded.
+void lca_writer_destroy(lca_writer* w);
+lca_string_view lca_writer_as_view(lca_writer* w);
+// moves the written bytes into a nul terminated string, leaving `w` empty.
+lca_string lca_writer_to_string(lca_writer* w);
+void lca_writer_append_data(lca_writer* w, const char* data, int64_t count);
+void lca_writer_append_view(lca_writer* w, lca_string_view s);
+void lca_writer_append_cstring(lca_writer* w, const char* s);
+void lca_writer_append_char(lca_writer* w, char c);
+void lca_writer_append_int(lca_writer* w, int64_t value);
+void lca_writer_append_uint(lca_writer* w, uint64_t value);
+// upper case, zero padded to at least `min_digits`.
+void lca_writer_append_hex(lca_writer* w, uint64_t value, int min_digits);
+// same output as printf's "%f".
+void lca_writer_append_float(lca_writer* w, double value);
+void lca_writer_append_format(lca_writer* w, const char* format, ...);
+void lca_writer_append_vformat(lca_writer* w, const char* format, va_list v);
+
 #ifndef LCA_STR_NO_SHORT_NAMES
 #    define SV_EMPTY       LCA_SV_EMPTY
 #    define SV_CONSTANT(C) LCA_SV_CONSTANT(C)
@@ -133,6 +177,27 @@ typedef struct lca_string_view string_view;
 #    define string_view_change_extension(A, S, E) lca_string_view_change_extension(A, S, E)
 
 #    define string_view_path_file_name(S) lca_string_view_path_file_name(S)
+
+typedef struct lca_writer writer;
+
+#    define WRITER_APPEND_LITERAL(W, L) LCA_WRITER_APPEND_LITERAL(W, L)
+
+#    define writer_create(A)                lca_writer_create(A)
+#    define writer_create_to_file(A, F, N)  lca_writer_create_to_file(A, F, N)
+#    define writer_flush(W)                 lca_writer_flush(W)
+#    define writer_destroy(W)               lca_writer_destroy(W)
+#    define writer_as_view(W)               lca_writer_as_view(W)
+#    define writer_to_string(W)             lca_writer_to_string(W)
+#    define writer_append_data(W, D, C)     lca_writer_append_data(W, D, C)
+#    define writer_append_view(W, S)        lca_writer_append_view(W, S)
+#    define writer_append_cstring(W, S)     lca_writer_append_cstring(W, S)
+#    define writer_append_char(W, C)        lca_writer_append_char(W, C)
+#    define writer_append_int(W, V)         lca_writer_append_int(W, V)
+#    define writer_append_uint(W, V)        lca_writer_append_uint(W, V)
+#    define writer_append_hex(W, V, D)      lca_writer_append_hex(W, V, D)
+#    define writer_append_float(W, V)       lca_writer_append_float(W, V)
+#    define writer_append_format(W, F, ...) lca_writer_append_format(W, F, __VA_ARGS__)
+#    define writer_append_vformat(W, F, V)  lca_writer_append_vformat(W, F, V)
 #endif // !LCA_STR_NO_SHORT_NAMES
 
 #ifdef LCA_STR_IMPLEMENTATION
@@ -425,6 +490,239 @@ lca_string_view lca_string_view_path_file_name(lca_string_view s) {
     return s;
 }
 
+lca_writer lca_writer_create(lca_allocator allocator) {
+    int64_t capacity = 4096;
+    char* data = lca_allocate(allocator, (size_t)capacity * sizeof *data);
+    assert(data);
+    return (lca_writer){
+        .allocator = allocator,
+        .data = data,
+        .capacity = capacity,
+        .count = 0,
+    };
+}
+
+lca_writer lca_writer_create_to_file(lca_allocator allocator, FILE* sink, int64_t buffer_size) {
+    assert(sink != NULL);
+    assert(buffer_size > 0);
+    char* data = lca_allocate(allocator, (size_t)buffer_size * sizeof *data);
+    assert(data);
+    return (lca_writer){
+        .allocator = allocator,
+        .data = data,
+        .capacity = buffer_size,
+        .count = 0,
+        .sink = sink,
+    };
+}
+
+bool lca_writer_flush(lca_writer* w) {
+    assert(w != NULL);
+    if (w->sink == NULL) return true;
+
+    if (w->count > 0 && !w->sink_failed) {
+        if (w->hash_sink) {
+            w->sink_hash = lca_hash_bytes(w->sink_hash, w->data, (size_t)w->count);
+        }
+
+        if (fwrite(w->data, 1, (size_t)w->count, w->sink) != (size_t)w->count) {
+            w->sink_failed = true;
+        }
+
+        w->sink_count += w->count;
+    }
+
+    w->count = 0;
+    if (!w->sink_failed && fflush(w->sink) != 0) {
+        w->sink_failed = true;
+    }
+
+    return !w->sink_failed;
+}
+
+void lca_writer_destroy(lca_writer* w) {
+    if (w == NULL || w->data == NULL) return;
+    lca_deallocate(w->allocator, w->data);
+    *w = (lca_writer){0};
+}
+
+lca_string_view lca_writer_as_view(lca_writer* w) {
+    assert(w != NULL);
+    assert(w->sink == NULL && "the contents of a writer with a sink are not all in memory");
+    return (lca_string_view){
+        .data = w->data,
+        .count = w->count,
+    };
+}
+
+static void lca_writer_grow(lca_writer* w, int64_t min_capacity) {
+    if (w->sink != NULL) {
+        // NOTE(local): only grow a bounded writer when a single contiguous piece is larger than the whole buffer.
+        int64_t needed = min_capacity - w->count;
+        lca_writer_flush(w);
+        min_capacity = needed;
+        if (min_capacity <= w->capacity) return;
+    }
+
+    int64_t new_capacity = w->capacity == 0 ? 4096 : w->capacity;
+    while (new_capacity < min_capacity) {
+        new_capacity <<= 1;
+    }
+
+    w->data = lca_reallocate(w->allocator, w->data, (size_t)new_capacity);
+    assert(w->data != NULL);
+    w->capacity = new_capacity;
+}
+
+#define LCA_WRITER_RESERVE(W, N)                       \
+    do {                                               \
+        if ((W)->count + (N) > (W)->capacity)          \
+            lca_writer_grow((W), (W)->count + (N));    \
+    } while (0)
+
+lca_string lca_writer_to_string(lca_writer* w) {
+    assert(w != NULL);
+    assert(w->sink == NULL && "the contents of a writer with a sink are not all in memory");
+    LCA_WRITER_RESERVE(w, 1);
+    w->data[w->count] = 0;
+
+    lca_string result = {
+        .allocator = w->allocator,
+        .data = w->data,
+        .count = w->count,
+        .capacity = w->capacity,
+    };
+
+    *w = (lca_writer){0};
+    return result;
+}
+
+void lca_writer_append_data(lca_writer* w, const char* data, int64_t count) {
+    assert(w != NULL);
+    assert(count >= 0);
+    if (count == 0) return;
+
+    if (w->sink != NULL && count > w->capacity) {
+        // too big to ever be buffered, so skip the copy.
+        lca_writer_flush(w);
+        if (!w->sink_failed && fwrite(data, 1, (size_t)count, w->sink) != (size_t)count) {
+            w->sink_failed = true;
+        }
+
+        return;
+    }
+
+    LCA_WRITER_RESERVE(w, count);
+    memcpy(w->data + w->count, data, (size_t)count);
+    w->count += count;
+}
+
+void lca_writer_append_view(lca_writer* w, lca_string_view s) {
+    lca_writer_append_data(w, s.data, s.count);
+}
+
+void lca_writer_append_cstring(lca_writer* w, const char* s) {
+    lca_writer_append_data(w, s, (int64_t)strlen(s));
+}
+
+void lca_writer_append_char(lca_writer* w, char c) {
+    assert(w != NULL);
+    LCA_WRITER_RESERVE(w, 1);
+    w->data[w->count] = c;
+    w->count++;
+}
+
+void lca_writer_append_uint(lca_writer* w, uint64_t value) {
+    char digits[20];
+    int start = (int)sizeof digits;
+
+    do {
+        digits[--start] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    lca_writer_append_data(w, digits + start, (int64_t)sizeof digits - start);
+}
+
+void lca_writer_append_int(lca_writer* w, int64_t value) {
+    if (value < 0) {
+        lca_writer_append_char(w, '-');
+        lca_writer_append_uint(w, (uint64_t)0 - (uint64_t)value);
+    } else {
+        lca_writer_append_uint(w, (uint64_t)value);
+    }
+}
+
+void lca_writer_append_hex(lca_writer* w, uint64_t value, int min_digits) {
+    assert(min_digits >= 0 && min_digits <= 16);
+
+    char digits[16];
+    int start = (int)sizeof digits;
+
+    do {
+        digits[--start] = "0123456789ABCDEF"[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+
+    while ((int)sizeof digits - start < min_digits) {
+        digits[--start] = '0';
+    }
+
+    lca_writer_append_data(w, digits + start, (int64_t)sizeof digits - start);
+}
+
+void lca_writer_append_float(lca_writer* w, double value) {
+    // integral values are by far the most common constants, and print exactly.
+    if (value >= -9007199254740992.0 && value <= 9007199254740992.0 && (double)(int64_t)value == value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof bits);
+        if (bits >> 63) {
+            lca_writer_append_char(w, '-');
+            lca_writer_append_uint(w, (uint64_t)(int64_t)-value);
+        } else {
+            lca_writer_append_uint(w, (uint64_t)(int64_t)value);
+        }
+
+        LCA_WRITER_APPEND_LITERAL(w, ".000000");
+        return;
+    }
+
+    // large enough for any double printed with "%f".
+    char buffer[512];
+    int n = snprintf(buffer, sizeof buffer, "%f", value);
+    assert(n > 0 && n < (int)sizeof buffer);
+    lca_writer_append_data(w, buffer, n);
+}
+
+void lca_writer_append_format(lca_writer* w, const char* format, ...) {
+    assert(w != NULL);
+    va_list v;
+    va_start(v, format);
+    lca_writer_append_vformat(w, format, v);
+    va_end(v);
+}
+
+void lca_writer_append_vformat(lca_writer* w, const char* format, va_list v) {
+    assert(w != NULL);
+
+    // format straight into the spare capacity, and only format again if it didn't fit.
+    va_list v1;
+    va_copy(v1, v);
+    int64_t available = w->capacity - w->count;
+    int n = vsnprintf(w->data + w->count, (size_t)available, format, v1);
+    va_end(v1);
+    assert(n >= 0);
+
+    if (n >= available) {
+        LCA_WRITER_RESERVE(w, n + 1);
+        vsnprintf(w->data + w->count, (size_t)n + 1, format, v);
+    }
+
+    w->count += n;
+}
+
+#undef LCA_WRITER_RESERVE
+
 #endif // LCA_STR_IMPLEMENTATION
 
 #endif // !LCASTR_H
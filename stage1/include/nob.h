@@ -176,6 +176,28 @@ typedef struct {
     size_t capacity;
 } Nob_Procs;
 
+// File descriptor handle
+#ifdef _WIN32
+typedef HANDLE Nob_Fd;
+#define NOB_INVALID_FD INVALID_HANDLE_VALUE
+#else
+typedef int Nob_Fd;
+#define NOB_INVALID_FD (-1)
+#endif // _WIN32
+
+void nob_fd_close(Nob_Fd fd);
+
+// Create an anonymous pipe. Only the read end is inherited by child processes, so a child
+// reading from it sees the end of the stream once the parent closes the write end.
+bool nob_pipe_create(Nob_Fd *read_end, Nob_Fd *write_end);
+
+// Standard streams for a child process. NULL means the child inherits the parent's stream.
+typedef struct {
+    Nob_Fd *fdin;
+    Nob_Fd *fdout;
+    Nob_Fd *fderr;
+} Nob_Cmd_Redirect;
+
 typedef struct {
     bool exited;
     int exit_code;
@@ -210,6 +232,9 @@ void nob_cmd_render(Nob_Cmd cmd, Nob_String_Builder *render);
 // Run command asynchronously
 Nob_Proc nob_cmd_run_async(Nob_Cmd cmd);
 
+// Run command asynchronously with its standard streams redirected
+Nob_Proc nob_cmd_run_async_redirect(Nob_Cmd cmd, Nob_Cmd_Redirect redirect);
+
 // Run command synchronously
 bool nob_cmd_run_sync(Nob_Cmd cmd);
 
@@ -504,7 +529,60 @@ void nob_cmd_render(Nob_Cmd cmd, Nob_String_Builder *render)
     }
 }
 
+void nob_fd_close(Nob_Fd fd)
+{
+#ifdef _WIN32
+    CloseHandle(fd);
+#else
+    close(fd);
+#endif // _WIN32
+}
+
+bool nob_pipe_create(Nob_Fd *read_end, Nob_Fd *write_end)
+{
+#ifdef _WIN32
+    SECURITY_ATTRIBUTES saAttr = {0};
+    saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
+    saAttr.bInheritHandle = TRUE;
+
+    if (!CreatePipe(read_end, write_end, &saAttr, 0)) {
+        nob_log(NOB_ERROR, "Could not create pipe: %lu", GetLastError());
+        return false;
+    }
+
+    if (!SetHandleInformation(*write_end, HANDLE_FLAG_INHERIT, 0)) {
+        nob_log(NOB_ERROR, "Could not configure pipe: %lu", GetLastError());
+        CloseHandle(*read_end);
+        CloseHandle(*write_end);
+        return false;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) < 0) {
+        nob_log(NOB_ERROR, "Could not create pipe: %s", strerror(errno));
+        return false;
+    }
+
+    if (fcntl(fds[1], F_SETFD, FD_CLOEXEC) < 0) {
+        nob_log(NOB_ERROR, "Could not configure pipe: %s", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    *read_end = fds[0];
+    *write_end = fds[1];
+#endif // _WIN32
+
+    return true;
+}
+
 Nob_Proc nob_cmd_run_async(Nob_Cmd cmd)
+{
+    return nob_cmd_run_async_redirect(cmd, (Nob_Cmd_Redirect){0});
+}
+
+Nob_Proc nob_cmd_run_async_redirect(Nob_Cmd cmd, Nob_Cmd_Redirect redirect)
 {
     if (cmd.count < 1) {
         nob_log(NOB_ERROR, "Could not run empty command");
@@ -529,9 +607,9 @@ Nob_Proc nob_cmd_run_async(Nob_Cmd cmd)
     // NOTE: theoretically setting NULL to std handles should not be a problem
     // https://docs.microsoft.com/en-us/windows/console/getstdhandle?redirectedfrom=MSDN#attachdetach-behavior
     // TODO: check for errors in GetStdHandle
-    siStartInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
-    siStartInfo.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
-    siStartInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    siStartInfo.hStdError = redirect.fderr ? *redirect.fderr : GetStdHandle(STD_ERROR_HANDLE);
+    siStartInfo.hStdOutput = redirect.fdout ? *redirect.fdout : GetStdHandle(STD_OUTPUT_HANDLE);
+    siStartInfo.hStdInput = redirect.fdin ? *redirect.fdin : GetStdHandle(STD_INPUT_HANDLE);
     siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
 
     PROCESS_INFORMATION piProcInfo;
@@ -560,6 +638,27 @@ Nob_Proc nob_cmd_run_async(Nob_Cmd cmd)
     }
 
     if (cpid == 0) {
+        if (redirect.fdin) {
+            if (dup2(*redirect.fdin, STDIN_FILENO) < 0) {
+                nob_log(NOB_ERROR, "Could not setup stdin for child process: %s", strerror(errno));
+                exit(1);
+            }
+        }
+
+        if (redirect.fdout) {
+            if (dup2(*redirect.fdout, STDOUT_FILENO) < 0) {
+                nob_log(NOB_ERROR, "Could not setup stdout for child process: %s", strerror(errno));
+                exit(1);
+            }
+        }
+
+        if (redirect.fderr) {
+            if (dup2(*redirect.fderr, STDERR_FILENO) < 0) {
+                nob_log(NOB_ERROR, "Could not setup stderr for child process: %s", strerror(errno));
+                exit(1);
+            }
+        }
+
         // NOTE: This leaks a bit of memory in the child process.
         // But do we actually care? It's a one off leak anyway...
         Nob_Cmd cmd_null = {0};
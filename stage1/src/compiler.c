@@ -39,8 +39,14 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <assert.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdio.h>
 
+#if _WIN32
+#    include <io.h>
+#endif
+
 #define LCA_DA_IMPLEMENTATION
 #define LCA_MEM_IMPLEMENTATION
 #define LCA_STR_IMPLEMENTATION
@@ -71,6 +77,18 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
     "                              Default: 'default'.\n"                                                             \
     "    --backend <backend>       What code generation backend to use. One of 'c' or 'llvm'.\n"                      \
     "                              Default: 'c'.\n"                                                                   \
+    "    -O<level>                 Optimization level for the generated LYIR. One of 0, 1 or 2.\n"                    \
+    "                              -O1 runs the cleanup passes and inlining, -O2 also runs global value\n"            \
+    "                              numbering and the loop optimizations.\n"                                          \
+    "                              Default: 0.\n"                                                                     \
+    "    -finline-threshold=<n>    Inline calls to functions of up to <n> LYIR instructions when optimizing.\n"       \
+    "                              Functions declared 'inline' are always inlined.\n"                                 \
+    "                              Default: 20 at -O1, 60 at -O2.\n"                                                  \
+    "    -j <n>                    Run up to <n> clang jobs at once when compiling several modules.\n"                \
+    "                              Default: the number of processors.\n"                                              \
+    "    --cache-dir=<dir>         Reuse objects compiled by clang from, and add new ones to, <dir>.\n"               \
+    "                              Default: $LAYE_CACHE_DIR, or 'laye' in the user's cache directory.\n"              \
+    "    -fno-object-cache         Compile every module with clang, without the object cache.\n"                      \
     "\n"                                                                                                              \
     "  actions:\n"                                                                                                    \
     "    -E, --preprocess          Run the preprocessor step (for C files). Writes the result to stdout.\n"           \
@@ -81,11 +99,20 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
     "    -emit-lyir                Uses the LYIR representation for assembler and object files.\n"                    \
     "    -emit-llvm                Uses the LLVM representation for assembler and object files.\n"                    \
     "    -emit-c                   Rather than emiting typical IR, emits C source code instead.\n"                    \
+    "    --run                     Run the parse, semantic analysis and LYIR pass steps, then interpret the\n"        \
+    "                              program's 'main' rather than compiling it. Exits with what 'main' returns.\n"      \
     "\n"                                                                                                              \
     "  diagnostics and output:\n"                                                                                     \
     "    --nocolor            Explicitly disable output coloring. By default, colors are enabled only if \n"          \
     "                         writing to a terminal.\n"                                                               \
-    "    --byte-diagnostics   Report diagnostic information with a byte offset rather than line/column.\n"
+    "    --byte-diagnostics   Report diagnostic information with a byte offset rather than line/column.\n"            \
+    "    -v, --verbose        Report the compiler version and, when clang is run, object cache hits and misses.\n"  \
+    "    -ftime-passes        Report the time taken by each LYIR pass and how it changed the IR size.\n"              \
+    "    -fpass-stats         Report the instructions and blocks each LYIR pass added or removed, per module.\n"  \
+    "    -fpass-remarks       Report each change the loop optimizations make, per function and loop.\n"        \
+    "    -ftime-report        Report the wall and CPU time taken by each compilation phase, including clang.\n"   \
+    "    -fmem-report         Report arena usage, how many nodes, values and types were created, and peak RSS.\n"  \
+    "    --trace-out=<file>   Write a Chrome trace of the compilation to <file>, for viewing in Perfetto.\n"
 
 #define LAYE_HELP_TEXT_BUILD \
     "\n"
@@ -103,8 +130,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
     "                         other compilers 100%. The intent is to use it as a friendly and\n"        \
     "                         comfortable interface to reduce learning curves.\n"                       \
     "                         It also, of course, has additional options specific to this compiler.\n"  \
-    "\n" LAYE_HELP_TEXT_NOCMD                                                                           \
-    ""
+    "\n"
 
 typedef enum source_file_kind {
     SOURCE_DEFAULT,
@@ -123,6 +149,47 @@ typedef struct source_file_info {
     source_file_kind kind;
 } source_file_info;
 
+typedef enum compile_phase {
+    PHASE_PARSE,
+    PHASE_SEMA,
+    PHASE_IRGEN,
+    PHASE_PASSES,
+    PHASE_CODEGEN,
+    PHASE_CLANG,
+    PHASE_RUN,
+    PHASE_COUNT,
+} compile_phase;
+
+static const char* compile_phase_names[PHASE_COUNT] = {
+    [PHASE_PARSE] = "parse",
+    [PHASE_SEMA] = "sema",
+    [PHASE_IRGEN] = "irgen",
+    [PHASE_PASSES] = "LYIR passes",
+    [PHASE_CODEGEN] = "codegen",
+    [PHASE_CLANG] = "clang",
+    [PHASE_RUN] = "run",
+};
+
+typedef struct phase_time {
+    bool has_run;
+    double wall_seconds;
+    // for clang, the CPU time of the subprocess rather than our own.
+    double cpu_seconds;
+} phase_time;
+
+typedef struct phase_start {
+    double wall_seconds;
+    double cpu_seconds;
+    double child_cpu_seconds;
+} phase_start;
+
+typedef struct ir_memory_stats {
+    bool has_been_collected;
+    int64_t module_count;
+    int64_t value_count;
+    lca_arena_stats arenas;
+} ir_memory_stats;
+
 typedef struct compiler_state {
     string_view command;
     string_view program_name;
@@ -142,8 +209,32 @@ typedef struct compiler_state {
     bool parse_only;
     bool sema_only;
     bool assemble_only;
+    // interpret the program after the passes instead of handing it to a backend.
+    bool run;
 
     backend backend;
+    int optimization_level;
+    int inline_threshold;
+    // the most clang jobs to run at once; 0 means one per processor.
+    int jobs;
+    bool no_object_cache;
+    // NULL to use LAYE_CACHE_DIR or the platform's cache directory.
+    const char* object_cache_dir;
+    int64_t object_cache_hits;
+    int64_t object_cache_misses;
+    bool time_passes;
+    bool print_pass_stats;
+    bool print_pass_remarks;
+    bool time_report;
+    bool mem_report;
+    // NULL unless --trace-out was given.
+    const char* trace_out_file;
+
+    phase_start start_time;
+    phase_time phase_times[PHASE_COUNT];
+    // modules are released as soon as their output is written, so their numbers are taken
+    // once the passes are done with them.
+    ir_memory_stats ir_memory;
 
     bool emit_lyir;
     bool emit_llvm;
@@ -158,8 +249,6 @@ typedef struct compiler_state {
     dynarr(c_translation_unit*) translation_units;
 
     dynarr(string) total_intermediate_files;
-    dynarr(string) c_modules;
-    dynarr(string) llvm_modules;
 
     dynarr(string_view) include_directories;
     dynarr(string_view) library_directories;
@@ -190,6 +279,143 @@ static string_view create_intermediate_file_name(compiler_state* state, string_v
     return string_as_view(intermediate_file_name);
 }
 
+static phase_start phase_now(compiler_state* state) {
+    if (!state->time_report) {
+        return (phase_start){0};
+    }
+
+    return (phase_start){
+        .wall_seconds = lca_plat_time_seconds(),
+        .cpu_seconds = lca_plat_cpu_time_seconds(),
+        .child_cpu_seconds = lca_plat_child_cpu_time_seconds(),
+    };
+}
+
+static phase_start phase_begin(compiler_state* state, compile_phase phase) {
+    layec_trace_begin(state->context, "phase", string_view_from_cstring(compile_phase_names[phase]), SV_EMPTY);
+    return phase_now(state);
+}
+
+static void phase_end(compiler_state* state, compile_phase phase, phase_start start) {
+    layec_trace_end(state->context);
+    if (!state->time_report) {
+        return;
+    }
+
+    phase_time* time = &state->phase_times[phase];
+    time->has_run = true;
+    time->wall_seconds += lca_plat_time_seconds() - start.wall_seconds;
+    if (phase == PHASE_CLANG) {
+        time->cpu_seconds += lca_plat_child_cpu_time_seconds() - start.child_cpu_seconds;
+    } else {
+        time->cpu_seconds += lca_plat_cpu_time_seconds() - start.cpu_seconds;
+    }
+}
+
+static void print_time_report(compiler_state* state) {
+    phase_start total = phase_now(state);
+    double total_wall_seconds = total.wall_seconds - state->start_time.wall_seconds;
+    double total_cpu_seconds = (total.cpu_seconds - state->start_time.cpu_seconds) + (total.child_cpu_seconds - state->start_time.child_cpu_seconds);
+
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "                          Compilation phase timing\n");
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "  Total: %.3f ms wall, %.3f ms CPU\n\n", total_wall_seconds * 1000.0, total_cpu_seconds * 1000.0);
+    fprintf(stderr, "  %12s  %7s  %12s  %s\n", "wall (ms)", "%", "cpu (ms)", "phase");
+
+    for (int64_t p = 0; p < PHASE_COUNT; p++) {
+        phase_time* time = &state->phase_times[p];
+        if (!time->has_run) {
+            continue;
+        }
+
+        double percent = total_wall_seconds > 0 ? 100.0 * time->wall_seconds / total_wall_seconds : 0;
+        fprintf(stderr, "  %12.3f  %6.1f%%  %12.3f  %s\n", time->wall_seconds * 1000.0, percent, time->cpu_seconds * 1000.0, compile_phase_names[p]);
+    }
+
+    // clang reads a single module's output as it is generated, and otherwise compiles each
+    // module while the next ones are generated, so the two overlap either way.
+    if (state->phase_times[PHASE_CLANG].has_run) {
+        fprintf(stderr, "\n  codegen runs while clang is compiling, so their wall times overlap.\n");
+    }
+}
+
+static void collect_ir_memory_stats(compiler_state* state) {
+    ir_memory_stats* stats = &state->ir_memory;
+    if (stats->has_been_collected) {
+        return;
+    }
+
+    stats->has_been_collected = true;
+    for (int64_t i = 0, count = arr_count(state->context->ir_modules); i < count; i++) {
+        layec_module* ir_module = state->context->ir_modules[i];
+        if (ir_module == NULL) {
+            continue;
+        }
+
+        lca_arena_stats arena_stats = layec_module_arena_stats(ir_module);
+        stats->module_count++;
+        stats->value_count += layec_module_value_count(ir_module);
+        stats->arenas.block_count += arena_stats.block_count;
+        stats->arenas.allocated_bytes += arena_stats.allocated_bytes;
+        stats->arenas.capacity_bytes += arena_stats.capacity_bytes;
+    }
+}
+
+static void print_arena_stats(const char* name, int64_t arena_count, lca_arena_stats stats, lca_arena_stats* total) {
+    fprintf(stderr, "  %8lld  %8lld  %14lld  %14lld  %s\n", (long long)arena_count, (long long)stats.block_count, (long long)stats.allocated_bytes, (long long)stats.capacity_bytes, name);
+    total->block_count += stats.block_count;
+    total->allocated_bytes += stats.allocated_bytes;
+    total->capacity_bytes += stats.capacity_bytes;
+}
+
+static void print_mem_report(compiler_state* state) {
+    layec_context* context = state->context;
+    collect_ir_memory_stats(state);
+
+    int64_t laye_node_count = 0;
+    lca_arena_stats laye_arenas = {0};
+    for (int64_t i = 0, count = arr_count(context->laye_modules); i < count; i++) {
+        laye_module* module = context->laye_modules[i];
+        lca_arena_stats stats = lca_arena_get_stats(module->arena);
+        laye_arenas.block_count += stats.block_count;
+        laye_arenas.allocated_bytes += stats.allocated_bytes;
+        laye_arenas.capacity_bytes += stats.capacity_bytes;
+        laye_node_count += arr_count(module->_all_nodes);
+    }
+
+    lca_arena_stats c_arenas = {0};
+    for (int64_t i = 0, count = arr_count(state->translation_units); i < count; i++) {
+        lca_arena_stats stats = lca_arena_get_stats(state->translation_units[i]->arena);
+        c_arenas.block_count += stats.block_count;
+        c_arenas.allocated_bytes += stats.allocated_bytes;
+        c_arenas.capacity_bytes += stats.capacity_bytes;
+    }
+
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "                          Compiler memory usage\n");
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "  %8s  %8s  %14s  %14s  %s\n", "arenas", "blocks", "allocated (B)", "capacity (B)", "owner");
+
+    lca_arena_stats total = {0};
+    print_arena_stats("interned strings", 1, lca_arena_get_stats(context->string_arena), &total);
+    print_arena_stats("LYIR types", 1, lca_arena_get_stats(context->type_arena), &total);
+    print_arena_stats("laye modules", arr_count(context->laye_modules), laye_arenas, &total);
+    print_arena_stats("C translation units", arr_count(state->translation_units), c_arenas, &total);
+    print_arena_stats("LYIR modules", state->ir_memory.module_count, state->ir_memory.arenas, &total);
+    fprintf(stderr, "  %8s  %8lld  %14lld  %14lld  %s\n\n", "", (long long)total.block_count, (long long)total.allocated_bytes, (long long)total.capacity_bytes, "total");
+
+    fprintf(stderr, "  %12lld  laye nodes\n", (long long)laye_node_count);
+    fprintf(stderr, "  %12lld  LYIR values\n", (long long)state->ir_memory.value_count);
+    fprintf(stderr, "  %12lld  LYIR constants\n", (long long)arr_count(context->_all_values));
+    fprintf(stderr, "  %12lld  LYIR types\n", (long long)arr_count(context->_all_types));
+
+    int64_t peak_rss_bytes = lca_plat_peak_rss_bytes();
+    if (peak_rss_bytes >= 0) {
+        fprintf(stderr, "\n  Peak RSS: %.1f MiB\n", (double)peak_rss_bytes / (1024.0 * 1024.0));
+    }
+}
+
 static int preprocess_only(compiler_state* state) {
     fprintf(stderr, "Running just the preprocessor is not currently supported.\n");
     return 1;
@@ -224,104 +450,109 @@ static c_translation_unit* parse_translation_unit(compiler_state* state, layec_c
     return tu;
 }
 
-static int emit_lyir(compiler_state* state) {
-    for (int64_t i = 0, count = arr_count(state->context->ir_modules); i < count; i++) {
-        bool is_only_file = state->assemble_only && arr_count(state->input_files) == 1;
-        bool is_output_file_stdout = state->is_output_file_stdout;
-        bool use_color = is_output_file_stdout ? state->use_color : false;
+// backend output is streamed to its destination through a buffer of this size rather than
+// being built up in memory in its entirety first.
+#define BACKEND_OUTPUT_BUFFER_SIZE (64 * 1024)
+
+typedef enum module_output_format {
+    MODULE_OUTPUT_LYIR,
+    MODULE_OUTPUT_C,
+    MODULE_OUTPUT_LLVM,
+} module_output_format;
+
+// the FNV-1a hash and size of a module's output, computed as it is written.
+typedef struct module_digest {
+    uint64_t hash;
+    int64_t size;
+} module_digest;
+
+// when `digest` is not NULL, its hash seeds the hash of the module's output and both are
+// filled in once the module is written.
+static bool emit_module_to_stream(compiler_state* state, layec_module* ir_module, module_output_format format, FILE* stream, bool use_color, module_digest* digest) {
+    phase_start start = phase_begin(state, PHASE_CODEGEN);
+    layec_trace_begin(state->context, "codegen", layec_module_name(ir_module), SV_EMPTY);
+    lca_writer writer = lca_writer_create_to_file(state->context->allocator, stream, BACKEND_OUTPUT_BUFFER_SIZE);
+    if (digest != NULL) {
+        writer.hash_sink = true;
+        writer.sink_hash = digest->hash;
+    }
 
-        layec_module* ir_module = state->context->ir_modules[i];
-        assert(ir_module != NULL);
+    switch (format) {
+        case MODULE_OUTPUT_LYIR: layec_module_print_to_writer(ir_module, &writer, use_color); break;
+        case MODULE_OUTPUT_C: layec_codegen_c_to_writer(ir_module, &writer); break;
+        case MODULE_OUTPUT_LLVM: layec_codegen_llvm_to_writer(ir_module, &writer); break;
+    }
 
-        string ir_module_string = layec_module_print(ir_module, use_color);
-        string_view intermediate_file_name = {0};
-        assert(string_view_equals(layec_module_name(ir_module), state->input_files[0].path));
+    bool success = lca_writer_flush(&writer);
+    if (digest != NULL) {
+        digest->hash = writer.sink_hash;
+        digest->size = writer.sink_count;
+    }
 
-        if (is_only_file && state->output_file.count != 0) {
-            intermediate_file_name = state->output_file;
-        } else {
-            intermediate_file_name = create_intermediate_file_name(state, layec_module_name(ir_module), ".lyir");
-        }
+    lca_writer_destroy(&writer);
 
-        if (is_output_file_stdout) {
-            assert(is_only_file);
-            fprintf(stdout, "%.*s", STR_EXPAND(ir_module_string));
-        } else {
-            if (!nob_write_entire_file(string_view_to_cstring(temp_allocator, intermediate_file_name), ir_module_string.data, (size_t)ir_module_string.count)) {
-                string_destroy(&ir_module_string);
-                return 1;
-            }
-        }
+    layec_trace_end(state->context);
+    phase_end(state, PHASE_CODEGEN, start);
+    return success;
+}
 
-        // fprintf(stdout, "%.*s\n", STR_EXPAND(ir_module_string));
-        string_destroy(&ir_module_string);
+static bool emit_module_to_file(compiler_state* state, layec_module* ir_module, module_output_format format, const char* file_path, bool use_color, module_digest* digest) {
+    FILE* stream = fopen(file_path, "wb");
+    if (stream == NULL) {
+        fprintf(stderr, "Could not open file \"%s\" for writing: %s\n", file_path, strerror(errno));
+        return false;
+    }
 
-        if (is_only_file) {
-            break;
-        }
+    bool success = emit_module_to_stream(state, ir_module, format, stream, use_color, digest);
+    if (fclose(stream) != 0) {
+        success = false;
     }
 
-    return 0;
+    if (!success) {
+        fprintf(stderr, "Could not write to file \"%s\": %s\n", file_path, strerror(errno));
+    }
+
+    return success;
 }
 
-static int emit_c(compiler_state* state) {
-    for (int64_t i = 0, count = arr_count(state->c_modules); i < count; i++) {
+// once a module's output has been written, nothing else needs the module, so it is
+// released immediately. this keeps at most one module's output buffered at a time.
+static void release_module(layec_context* context, int64_t module_index) {
+    layec_module_destroy(context->ir_modules[module_index]);
+    context->ir_modules[module_index] = NULL;
+}
+
+static int emit_assembly(compiler_state* state, module_output_format format, const char* extension) {
+    layec_context* context = state->context;
+
+    for (int64_t i = 0, count = arr_count(context->ir_modules); i < count; i++) {
         bool is_only_file = state->assemble_only && arr_count(state->input_files) == 1;
         bool is_output_file_stdout = state->is_output_file_stdout;
+        bool use_color = format == MODULE_OUTPUT_LYIR && is_output_file_stdout ? state->use_color : false;
 
-        string c_module = state->c_modules[i];
+        layec_module* ir_module = context->ir_modules[i];
+        assert(ir_module != NULL);
+        assert(string_view_equals(layec_module_name(ir_module), state->input_files[0].path));
 
         string_view intermediate_file_name = {0};
         if (is_only_file && state->output_file.count != 0) {
             intermediate_file_name = state->output_file;
         } else {
-            layec_module* ir_module = state->context->ir_modules[i];
-            assert(ir_module != NULL);
-            assert(string_view_equals(layec_module_name(ir_module), state->input_files[0].path));
-            intermediate_file_name = create_intermediate_file_name(state, layec_module_name(ir_module), ".ir.c");
+            intermediate_file_name = create_intermediate_file_name(state, layec_module_name(ir_module), extension);
         }
 
+        bool success = false;
         if (is_output_file_stdout) {
             assert(is_only_file);
-            fprintf(stdout, "%.*s", STR_EXPAND(c_module));
+            success = emit_module_to_stream(state, ir_module, format, stdout, use_color, NULL);
         } else {
-            if (!nob_write_entire_file(string_view_to_cstring(temp_allocator, intermediate_file_name), c_module.data, (size_t)c_module.count)) {
-                return 1;
-            }
+            success = emit_module_to_file(state, ir_module, format, string_view_to_cstring(temp_allocator, intermediate_file_name), use_color, NULL);
         }
 
-        if (is_only_file) {
-            break;
-        }
-    }
-
-    return 0;
-}
-
-static int emit_llvm(compiler_state* state) {
-    for (int64_t i = 0, count = arr_count(state->llvm_modules); i < count; i++) {
-        bool is_only_file = state->assemble_only && arr_count(state->input_files) == 1;
-        bool is_output_file_stdout = state->is_output_file_stdout;
-
-        string llvm_module = state->llvm_modules[i];
-
-        string_view intermediate_file_name = {0};
-        if (is_only_file && state->output_file.count != 0) {
-            intermediate_file_name = state->output_file;
-        } else {
-            layec_module* ir_module = state->context->ir_modules[i];
-            assert(ir_module != NULL);
-            assert(string_view_equals(layec_module_name(ir_module), state->input_files[0].path));
-            intermediate_file_name = create_intermediate_file_name(state, layec_module_name(ir_module), ".ll");
-        }
+        release_module(context, i);
 
-        if (is_output_file_stdout) {
-            assert(is_only_file);
-            fprintf(stdout, "%.*s", STR_EXPAND(llvm_module));
-        } else {
-            if (!nob_write_entire_file(string_view_to_cstring(temp_allocator, intermediate_file_name), llvm_module.data, (size_t)llvm_module.count)) {
-                return 1;
-            }
+        if (!success) {
+            return 1;
         }
 
         if (is_only_file) {
@@ -341,8 +572,50 @@ static void add_stdlib_includes(layec_context* context, string_view stdlib_root)
     }
 }
 
-static int backend_c(compiler_state* state);
-static int backend_llvm(compiler_state* state);
+static int backend_compile(compiler_state* state, module_output_format format, const char* extension, const char* language);
+
+// interprets the program's `main`, passing it the first input file as argv[0] if it takes
+// arguments. the exit code is whatever it returns, as it would be for a compiled program.
+static int run_program(compiler_state* state) {
+    layec_context* context = state->context;
+    layec_interp* interp = layec_interp_create(context);
+
+    layec_value* main_function = layec_interp_find_function(interp, SV_CONSTANT("main"));
+    if (main_function == NULL) {
+        fprintf(stderr, "Cannot run the program, since it has no 'main' function.\n");
+        layec_interp_destroy(interp);
+        return 1;
+    }
+
+    int64_t parameter_count = layec_function_parameter_count(main_function);
+    if (parameter_count != 0 && parameter_count != 2) {
+        fprintf(stderr, "Cannot run the program, since its 'main' function must take either no arguments or argc and argv.\n");
+        layec_interp_destroy(interp);
+        return 1;
+    }
+
+    const char* program_name = lca_temp_sprintf("%.*s", STR_EXPAND(state->input_files[0].path));
+    const char* program_argv[] = {program_name, NULL};
+    uint64_t arguments[2] = {1, (uint64_t)(uintptr_t)program_argv};
+
+    uint64_t result = 0;
+    phase_start run_start = phase_begin(state, PHASE_RUN);
+    bool succeeded = layec_interp_call(interp, main_function, parameter_count, arguments, &result);
+    phase_end(state, PHASE_RUN, run_start);
+
+    layec_interp_destroy(interp);
+    fflush(stdout);
+
+    if (!succeeded) {
+        return 1;
+    }
+
+    if (!layec_type_is_integer(layec_function_return_type(main_function))) {
+        return 0;
+    }
+
+    return (int)(uint32_t)result;
+}
 
 int main(int argc, char** argv) {
     int exit_code = 0;
@@ -356,6 +629,7 @@ int main(int argc, char** argv) {
     compiler_state state = {
         .use_color = COLOR_AUTO,
         .backend = BACKEND_LLVM,
+        .inline_threshold = -1,
     };
     if (!parse_args(&state, &argc, &argv) || state.help) {
         string_view command = state.command;
@@ -363,10 +637,13 @@ int main(int argc, char** argv) {
             command = SV_CONSTANT("<command>");
         }
         fprintf(stderr, LAYE_HELP_TEXT_USAGE, STR_EXPAND(state.program_name), STR_EXPAND(command));
-        fprintf(stderr, "%s\n", LAYE_HELP_TEXT);
+        // printed separately; together they'd be longer than the 4095 characters C guarantees a string literal.
+        fprintf(stderr, "%s%s\n", LAYE_HELP_TEXT, LAYE_HELP_TEXT_NOCMD);
         return 1;
     }
 
+    state.start_time = phase_now(&state);
+
     if (state.verbose) {
         fprintf(stderr, "Laye Compiler " LAYEC_VERSION "\n");
     }
@@ -380,6 +657,18 @@ int main(int argc, char** argv) {
     assert(context != NULL);
     state.context = context;
 
+    if (state.trace_out_file != NULL && !layec_trace_open(context, state.trace_out_file)) {
+        fprintf(stderr, "Could not open trace output file \"%s\": %s\n", state.trace_out_file, strerror(errno));
+        exit_code = 1;
+        goto program_exit;
+    }
+
+    if (state.run && state.assemble_only) {
+        fprintf(stderr, "--run cannot be used with -S.\n");
+        exit_code = 1;
+        goto program_exit;
+    }
+
     if (state.emit_lyir) {
         if (!state.assemble_only) {
             fprintf(stderr, "-emit-lyir cannot be used when linking.\n");
@@ -417,6 +706,8 @@ int main(int argc, char** argv) {
     context->link_libraries = state.link_libraries;
 
     context->use_byte_positions_in_diagnostics = state.use_byte_positions_in_diagnostics;
+    context->optimization_level = state.optimization_level;
+    context->inline_threshold = state.inline_threshold;
 
     const char* self_exe = lca_plat_self_exe();
     if (self_exe != NULL) {
@@ -466,6 +757,7 @@ found_stdlib:;
         if (exit_code != 0) goto program_exit;
     }
 
+    phase_start parse_start = phase_begin(&state, PHASE_PARSE);
     for (int64_t i = 0; i < arr_count(state.input_files); i++) {
         source_file_info input_file_info = state.input_files[i];
         string_view input_file_path = input_file_info.path;
@@ -494,6 +786,8 @@ found_stdlib:;
         }
     }
 
+    phase_end(&state, PHASE_PARSE, parse_start);
+
     if (context->has_reported_errors) {
         if (!state.sema_only && !state.parse_only) exit_code = 1;
         goto program_exit;
@@ -520,7 +814,9 @@ found_stdlib:;
         goto program_exit;
     }
 
+    phase_start sema_start = phase_begin(&state, PHASE_SEMA);
     laye_analyse(context);
+    phase_end(&state, PHASE_SEMA, sema_start);
 
     if (context->has_reported_errors) {
         if (!state.sema_only) exit_code = 1;
@@ -548,7 +844,9 @@ found_stdlib:;
     }
 
     // no matter what, if we're instructed to get past sema then we want to generate LYIR modules
+    phase_start irgen_start = phase_begin(&state, PHASE_IRGEN);
     laye_generate_ir(context);
+    phase_end(&state, PHASE_IRGEN, irgen_start);
 
     if (context->has_reported_errors) {
         exit_code = 1;
@@ -558,14 +856,31 @@ found_stdlib:;
     // from this point forward, the concept of "Laye" is no more; we deal exclusively in LYIR and beyond.
     // everything after generating LYIR should be identical for other frontends ideally.
     // IF IT IS NOT, then we need to refactor to support that *somehow*, but that time is not now.
+    layec_pass_manager* pass_manager = layec_pass_manager_create(context);
+    layec_pass_manager_add_default_passes(pass_manager, context->optimization_level);
+    layec_pass_manager_set_time_passes(pass_manager, state.time_passes);
+    layec_pass_manager_set_print_pass_stats(pass_manager, state.print_pass_stats);
+    layec_pass_manager_set_print_remarks(pass_manager, state.print_pass_remarks);
+
+    phase_start passes_start = phase_begin(&state, PHASE_PASSES);
     for (int64_t i = 0; i < arr_count(context->ir_modules); i++) {
         layec_module* ir_module = context->ir_modules[i];
         assert(ir_module != NULL);
+        layec_pass_manager_run(pass_manager, ir_module);
+    }
+
+    phase_end(&state, PHASE_PASSES, passes_start);
 
-        layec_irpass_validate(ir_module);
-        layec_irpass_fix_abi(ir_module);
+    if (state.mem_report) {
+        collect_ir_memory_stats(&state);
     }
 
+    if (state.time_passes) {
+        layec_pass_manager_print_time_passes(pass_manager);
+    }
+
+    layec_pass_manager_destroy(pass_manager);
+
     if (context->has_reported_errors) {
         exit_code = 1;
         goto program_exit;
@@ -573,13 +888,18 @@ found_stdlib:;
 
     //
 
+    if (state.run) {
+        exit_code = run_program(&state);
+        goto program_exit;
+    }
+
     if (state.assemble_only) {
         if (state.emit_llvm) {
-            exit_code = backend_llvm(&state);
+            exit_code = emit_assembly(&state, MODULE_OUTPUT_LLVM, ".ll");
         } else if (state.emit_lyir) {
-            exit_code = emit_lyir(&state);
+            exit_code = emit_assembly(&state, MODULE_OUTPUT_LYIR, ".lyir");
         } else if (state.emit_c) {
-            exit_code = backend_c(&state);
+            exit_code = emit_assembly(&state, MODULE_OUTPUT_C, ".ir.c");
         } else {
             exit_code = 1;
             fprintf(stderr, "No explicit assembler format provided when -S option was given.\n");
@@ -589,9 +909,9 @@ found_stdlib:;
     }
 
     if (state.backend == BACKEND_LLVM) {
-        exit_code = backend_llvm(&state);
+        exit_code = backend_compile(&state, MODULE_OUTPUT_LLVM, ".ll", "ir");
     } else if (state.backend == BACKEND_C) {
-        exit_code = backend_c(&state);
+        exit_code = backend_compile(&state, MODULE_OUTPUT_C, ".ir.c", "c");
     } else {
         exit_code = 1;
         fprintf(stderr, "Unknown backend\n");
@@ -602,6 +922,16 @@ found_stdlib:;
     // down all of our allocations. these should always be run in debug/safe
     // builds so the static analysers (like address sanitizer) can do their magic.
 program_exit:;
+    layec_trace_close(context);
+
+    if (state.time_report) {
+        print_time_report(&state);
+    }
+
+    if (state.mem_report) {
+        print_mem_report(&state);
+    }
+
     if (!state.assemble_only) {
         for (int64_t i = 0; i < arr_count(state.total_intermediate_files); i++) {
             const char* path_cstr = string_as_cstring(state.total_intermediate_files[i]);
@@ -631,117 +961,175 @@ program_exit:;
     return exit_code;
 }
 
-static int backend_c(compiler_state* state) {
-    int exit_code = 0;
+static FILE* open_pipe_stream(Nob_Fd fd) {
+#if _WIN32
+    int crt_fd = _open_osfhandle((intptr_t)fd, 0);
+    if (crt_fd < 0) {
+        return NULL;
+    }
+
+    return _fdopen(crt_fd, "wb");
+#else
+    return fdopen(fd, "wb");
+#endif
+}
+
+// `nob_proc_wait` only reports whether the process exited, so clang failing would go unnoticed.
+static bool wait_for_clang(Nob_Proc proc) {
+    Nob_Proc_Result result = nob_proc_wait_result(proc);
+    return result.exited && result.exit_code == 0;
+}
 
+// with exactly one module and no object cache, its output is piped straight into clang's stdin
+// instead of going through an intermediate file. clang then compiles and links in one step, so
+// there is no object to cache.
+static int backend_compile_piped(compiler_state* state, Nob_Cmd* clang_cmd, module_output_format format, const char* language) {
     layec_context* context = state->context;
+    assert(arr_count(context->ir_modules) == 1);
 
-    for (int64_t i = 0; i < arr_count(context->ir_modules); i++) {
-        layec_module* ir_module = context->ir_modules[i];
-        assert(ir_module != NULL);
+    nob_cmd_append(clang_cmd, "-x", language, "-");
 
-        string c_module_string = layec_codegen_c(ir_module);
-        arr_push(state->c_modules, c_module_string);
+    Nob_Fd read_end, write_end;
+    if (!nob_pipe_create(&read_end, &write_end)) {
+        return 1;
     }
 
-    assert(arr_count(state->c_modules) == arr_count(context->ir_modules));
+    phase_start clang_start = phase_begin(state, PHASE_CLANG);
+    Nob_Proc clang_proc = nob_cmd_run_async_redirect(*clang_cmd, (Nob_Cmd_Redirect){.fdin = &read_end});
+    nob_fd_close(read_end);
 
-    if (state->emit_c) {
-        assert(state->assemble_only);
-        emit_c(state);
-        goto backend_exit;
+    if (clang_proc == NOB_INVALID_PROC) {
+        nob_fd_close(write_end);
+        return 1;
     }
 
-    for (int64_t i = 0; i < arr_count(state->c_modules); i++) {
-        string c_module_string = state->c_modules[i];
-        string_view source_input_file_path = string_view_path_file_name(layec_module_name(context->ir_modules[i]));
+#ifndef _WIN32
+    // if clang is missing or exits early, writing to the pipe raises SIGPIPE, which would kill
+    // the driver before it could clean up. ignored, the write fails with EPIPE instead.
+    void (*previous_sigpipe_handler)(int) = signal(SIGPIPE, SIG_IGN);
+#endif
 
-        string output_file_path_intermediate = string_view_change_extension(default_allocator, source_input_file_path, ".ir.c");
-        arr_push(state->total_intermediate_files, output_file_path_intermediate);
+    FILE* stream = open_pipe_stream(write_end);
+    bool success = stream != NULL;
+    if (success) {
+        // once a write fails, the writer stops writing and the rest of the module is discarded.
+        success = emit_module_to_stream(state, context->ir_modules[0], format, stream, false, NULL);
+        // closing the stream is what tells clang the module is complete.
+        if (fclose(stream) != 0) {
+            success = false;
+        }
 
-        bool c_file_result = nob_write_entire_file(lca_string_as_cstring(output_file_path_intermediate), c_module_string.data, c_module_string.count);
-        if (!c_file_result) {
-            exit_code = 1;
-            goto backend_exit;
+        if (!success) {
+            fprintf(stderr, "Could not write the module to clang: %s\n", strerror(errno));
         }
+    } else {
+        fprintf(stderr, "Could not open pipe to clang: %s\n", strerror(errno));
+        nob_fd_close(write_end);
     }
 
-    Nob_Cmd clang_cc_cmd = {0};
-    nob_cmd_append(
-        &clang_cc_cmd,
-        "clang",
-        "-Wno-override-module",
-        "-O3",
-        "-o",
-        lca_string_view_to_cstring(temp_allocator, state->output_file)
-    );
+#ifndef _WIN32
+    signal(SIGPIPE, previous_sigpipe_handler);
+#endif
 
-    for (int64_t i = 0; i < arr_count(state->link_libraries); i++) {
-        const char* s = lca_temp_sprintf("-l%.*s", STR_EXPAND(state->link_libraries[i]));
-        nob_cmd_append(&clang_cc_cmd, s);
-    }
+    release_module(context, 0);
 
-    for (int64_t i = 0; i < arr_count(state->total_intermediate_files); i++) {
-        const char* s = string_as_cstring(state->total_intermediate_files[i]);
-        nob_cmd_append(&clang_cc_cmd, s);
+    if (!wait_for_clang(clang_proc)) {
+        fprintf(stderr, "clang failed to compile the module.\n");
+        success = false;
     }
 
-    if (!nob_cmd_run_sync(clang_cc_cmd)) {
-        nob_cmd_free(clang_cc_cmd);
-        exit_code = 1;
-        goto backend_exit;
+    phase_end(state, PHASE_CLANG, clang_start);
+
+    return success ? 0 : 1;
+}
+
+// where compiled objects are cached, creating it if needed; NULL if caching is disabled or
+// there's nowhere to put the cache.
+static const char* object_cache_directory(compiler_state* state) {
+    if (state->no_object_cache) {
+        return NULL;
     }
 
-    nob_cmd_free(clang_cc_cmd);
+    const char* directory = state->object_cache_dir;
+    if (directory == NULL) {
+        directory = getenv("LAYE_CACHE_DIR");
+    }
 
-backend_exit:;
-    for (int64_t i = 0; i < arr_count(state->c_modules); i++) {
-        string_destroy(&state->c_modules[i]);
+    if (directory == NULL || *directory == 0) {
+#if _WIN32
+        const char* local_app_data = getenv("LOCALAPPDATA");
+        directory = local_app_data != NULL ? lca_temp_sprintf("%s\\laye", local_app_data) : NULL;
+#else
+        const char* xdg_cache_home = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        if (xdg_cache_home != NULL && *xdg_cache_home != 0) {
+            directory = lca_temp_sprintf("%s/laye", xdg_cache_home);
+        } else if (home != NULL && *home != 0) {
+            directory = lca_temp_sprintf("%s/.cache/laye", home);
+        } else {
+            directory = NULL;
+        }
+#endif
     }
 
-    arr_free(state->c_modules);
+    if (directory == NULL || !nob_mkdir_if_not_exists(directory)) {
+        return NULL;
+    }
 
-    return exit_code;
+    return directory;
 }
 
-static int backend_llvm(compiler_state* state) {
-    int exit_code = 0;
+// the hash every module's cache key starts from, covering the compiler version and the first
+// `flag_count` arguments of `compile_cmd`. the module's text is hashed on top of it as it is
+// written. the key doesn't cover the version of clang itself, so the cache must be cleared
+// when clang changes.
+static uint64_t object_cache_key_seed(Nob_Cmd compile_cmd, size_t flag_count) {
+    uint64_t hash = lca_hash_bytes(LCA_HASH_SEED, LAYEC_VERSION, sizeof LAYEC_VERSION);
+    for (size_t i = 0; i < flag_count; i++) {
+        hash = lca_hash_bytes(hash, compile_cmd.items[i], strlen(compile_cmd.items[i]) + 1);
+    }
 
-    layec_context* context = state->context;
+    return hash;
+}
 
-    for (int64_t i = 0; i < arr_count(context->ir_modules); i++) {
-        layec_module* ir_module = context->ir_modules[i];
-        assert(ir_module != NULL);
+// the cache entry for a module whose output was hashed on top of `object_cache_key_seed`.
+static const char* object_cache_path(const char* cache_directory, module_digest digest) {
+    return lca_temp_sprintf("%s/%016llx-%llx.o", cache_directory, (unsigned long long)digest.hash, (unsigned long long)digest.size);
+}
 
-        string llvm_module_string = layec_codegen_llvm(ir_module);
-        arr_push(state->llvm_modules, llvm_module_string);
+// copies the object into the cache under a temporary name first, so other compiles never see it
+// half written. failing to cache an object isn't an error; it's compiled again next time.
+static void object_cache_insert(const char* object_file_path, const char* cached_object_path) {
+    Nob_String_Builder object = {0};
+    if (!nob_read_entire_file(object_file_path, &object)) {
+        return;
     }
 
-    assert(arr_count(state->llvm_modules) == arr_count(context->ir_modules));
-
-    if (state->emit_llvm) {
-        assert(state->assemble_only);
-        emit_llvm(state);
-        goto backend_exit;
+    const char* temp_path = lca_temp_sprintf("%s.%llx.tmp", cached_object_path, (unsigned long long)(lca_plat_time_seconds() * 1e9));
+    if (nob_write_entire_file(temp_path, object.items, object.count) && rename(temp_path, cached_object_path) != 0) {
+        remove(temp_path);
     }
 
-    for (int64_t i = 0; i < arr_count(state->llvm_modules); i++) {
-        string llvm_module_string = state->llvm_modules[i];
-        string_view source_input_file_path = string_view_path_file_name(layec_module_name(context->ir_modules[i]));
+    nob_sb_free(object);
+}
 
-        string output_file_path_intermediate = string_view_change_extension(default_allocator, source_input_file_path, ".ll");
-        arr_push(state->total_intermediate_files, output_file_path_intermediate);
+// waits for the job which was started first, then removes it from `jobs`.
+static bool wait_for_oldest_job(Nob_Procs* jobs) {
+    assert(jobs->count > 0);
+    bool success = wait_for_clang(jobs->items[0]);
+    memmove(jobs->items, jobs->items + 1, (jobs->count - 1) * sizeof *jobs->items);
+    jobs->count--;
+    return success;
+}
 
-        bool ll_file_result = nob_write_entire_file(lca_string_as_cstring(output_file_path_intermediate), llvm_module_string.data, llvm_module_string.count);
-        if (!ll_file_result) {
-            exit_code = 1;
-            goto backend_exit;
-        }
-    }
+static int backend_compile(compiler_state* state, module_output_format format, const char* extension, const char* language) {
+    int exit_code = 0;
 
-    Nob_Cmd clang_ll_cmd = {0};
+    layec_context* context = state->context;
+
+    Nob_Cmd clang_cmd = {0};
     nob_cmd_append(
-        &clang_ll_cmd,
+        &clang_cmd,
         "clang",
         "-Wno-override-module",
         "-O3",
@@ -751,30 +1139,117 @@ static int backend_llvm(compiler_state* state) {
 
     for (int64_t i = 0; i < arr_count(state->link_libraries); i++) {
         const char* s = lca_temp_sprintf("-l%.*s", STR_EXPAND(state->link_libraries[i]));
-        nob_cmd_append(&clang_ll_cmd, s);
+        nob_cmd_append(&clang_cmd, s);
     }
 
-    for (int64_t i = 0; i < arr_count(state->total_intermediate_files); i++) {
-        const char* s = string_as_cstring(state->total_intermediate_files[i]);
-        nob_cmd_append(&clang_ll_cmd, s);
+    // a cached object can only be reused by compiling modules separately from linking, so piping is
+    // only worth it when the cache is off.
+    const char* cache_directory = object_cache_directory(state);
+    if (arr_count(context->ir_modules) == 1 && cache_directory == NULL) {
+        exit_code = backend_compile_piped(state, &clang_cmd, format, language);
+        nob_cmd_free(clang_cmd);
+        return exit_code;
     }
 
-    if (!nob_cmd_run_sync(clang_ll_cmd)) {
-        nob_cmd_free(clang_ll_cmd);
-        exit_code = 1;
-        goto backend_exit;
+    // every module is compiled to an object file by its own clang job, started as soon as the
+    // module's output is written, with at most `state->jobs` running at once. the objects are
+    // then linked by one last clang invocation.
+    int max_jobs = state->jobs > 0 ? state->jobs : lca_plat_processor_count();
+    Nob_Procs jobs = {0};
+    bool success = true;
+
+    Nob_Cmd compile_cmd = {0};
+    nob_cmd_append(&compile_cmd, "clang", "-Wno-override-module", "-O3", "-c", "-x", language);
+    size_t compile_flag_count = compile_cmd.count;
+
+    uint64_t cache_key_seed = object_cache_key_seed(compile_cmd, compile_flag_count);
+    // objects compiled this time which go into the cache once every job has succeeded.
+    dynarr(struct object_cache_entry { const char* object_file_path; const char* cached_object_path; }) cache_misses = NULL;
+
+    phase_start clang_start = phase_begin(state, PHASE_CLANG);
+    for (int64_t i = 0; i < arr_count(context->ir_modules) && success; i++) {
+        layec_module* ir_module = context->ir_modules[i];
+        assert(ir_module != NULL);
+
+        // the module index keeps modules with the same file name, like std/string.laye and
+        // libc/string.laye, from writing to the same files.
+        string_view source_input_file_path = string_view_path_file_name(layec_module_name(ir_module));
+
+        string output_file_path_intermediate = string_view_change_extension(default_allocator, source_input_file_path, lca_temp_sprintf(".%lld%s", (long long)i, extension));
+        arr_push(state->total_intermediate_files, output_file_path_intermediate);
+
+        string object_file_path = string_view_change_extension(default_allocator, source_input_file_path, lca_temp_sprintf(".%lld.o", (long long)i));
+        arr_push(state->total_intermediate_files, object_file_path);
+
+        module_digest digest = {.hash = cache_key_seed};
+        bool file_result = emit_module_to_file(state, ir_module, format, lca_string_as_cstring(output_file_path_intermediate), false, cache_directory != NULL ? &digest : NULL);
+        release_module(context, i);
+
+        if (!file_result) {
+            success = false;
+            break;
+        }
+
+        const char* cached_object_path = NULL;
+        if (cache_directory != NULL) {
+            cached_object_path = object_cache_path(cache_directory, digest);
+        }
+
+        if (cached_object_path != NULL) {
+            if (nob_file_exists(cached_object_path) == 1) {
+                state->object_cache_hits++;
+                nob_cmd_append(&clang_cmd, cached_object_path);
+                continue;
+            }
+
+            state->object_cache_misses++;
+            arr_push(cache_misses, ((struct object_cache_entry){lca_string_as_cstring(object_file_path), cached_object_path}));
+        }
+
+        if ((int)jobs.count >= max_jobs) {
+            success = wait_for_oldest_job(&jobs);
+            if (!success) {
+                break;
+            }
+        }
+
+        compile_cmd.count = compile_flag_count;
+        nob_cmd_append(&compile_cmd, lca_string_as_cstring(output_file_path_intermediate), "-o", lca_string_as_cstring(object_file_path));
+
+        Nob_Proc job = nob_cmd_run_async(compile_cmd);
+        if (job == NOB_INVALID_PROC) {
+            success = false;
+            break;
+        }
+
+        nob_da_append(&jobs, job);
+        nob_cmd_append(&clang_cmd, lca_string_as_cstring(object_file_path));
+    }
+
+    // jobs already running are waited for even after a failure, so none outlive the driver.
+    for (size_t i = 0; i < jobs.count; i++) {
+        success = wait_for_clang(jobs.items[i]) && success;
     }
 
-    nob_cmd_free(clang_ll_cmd);
+    if (success) {
+        for (int64_t i = 0; i < arr_count(cache_misses); i++) {
+            object_cache_insert(cache_misses[i].object_file_path, cache_misses[i].cached_object_path);
+        }
 
-backend_exit:;
-    for (int64_t i = 0; i < arr_count(state->llvm_modules); i++) {
-        string_destroy(&state->llvm_modules[i]);
+        success = wait_for_clang(nob_cmd_run_async(clang_cmd));
     }
 
-    arr_free(state->llvm_modules);
+    phase_end(state, PHASE_CLANG, clang_start);
 
-    return exit_code;
+    if (state->verbose && cache_directory != NULL) {
+        fprintf(stderr, "Object cache: %lld hits, %lld misses in %s\n", (long long)state->object_cache_hits, (long long)state->object_cache_misses, cache_directory);
+    }
+
+    arr_free(cache_misses);
+    nob_da_free(jobs);
+    nob_cmd_free(compile_cmd);
+    nob_cmd_free(clang_cmd);
+    return success ? 0 : 1;
 }
 
 static bool parse_args(compiler_state* args, int* argc, char*** argv) {
@@ -788,7 +1263,7 @@ static bool parse_args(compiler_state* args, int* argc, char*** argv) {
         string_view arg = string_view_from_cstring(nob_shift_args(argc, argv));
         if (string_view_equals(arg, SV_CONSTANT("--help"))) {
             args->help = true;
-        } else if (string_view_equals(arg, SV_CONSTANT("--verbose"))) {
+        } else if (string_view_equals(arg, SV_CONSTANT("-v")) || string_view_equals(arg, SV_CONSTANT("--verbose"))) {
             args->verbose = true;
         } else if (string_view_equals(arg, SV_CONSTANT("-E")) || string_view_equals(arg, SV_CONSTANT("--preprocess"))) {
             args->preprocess_only = true;
@@ -798,6 +1273,8 @@ static bool parse_args(compiler_state* args, int* argc, char*** argv) {
             args->sema_only = true;
         } else if (string_view_equals(arg, SV_CONSTANT("-S")) || string_view_equals(arg, SV_CONSTANT("--assemble"))) {
             args->assemble_only = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("--run"))) {
+            args->run = true;
         } else if (string_view_equals(arg, SV_CONSTANT("-emit-c"))) {
             args->emit_c = true;
         } else if (string_view_equals(arg, SV_CONSTANT("-emit-lyir"))) {
@@ -806,6 +1283,32 @@ static bool parse_args(compiler_state* args, int* argc, char*** argv) {
             args->emit_llvm = true;
         } else if (string_view_equals(arg, SV_CONSTANT("--nocolor"))) {
             args->use_color = COLOR_NEVER;
+        } else if (string_view_equals(arg, SV_CONSTANT("-ftime-passes"))) {
+            args->time_passes = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("-fpass-stats"))) {
+            args->print_pass_stats = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("-fpass-remarks"))) {
+            args->print_pass_remarks = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("-ftime-report"))) {
+            args->time_report = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("-fmem-report"))) {
+            args->mem_report = true;
+        } else if (string_view_equals(arg, SV_CONSTANT("-fno-object-cache"))) {
+            args->no_object_cache = true;
+        } else if (string_view_starts_with(arg, SV_CONSTANT("--cache-dir="))) {
+            if (arg.count == 12) {
+                fprintf(stderr, "'--cache-dir=' requires a directory\n");
+                return false;
+            }
+
+            args->object_cache_dir = string_view_slice(arg, 12, -1).data;
+        } else if (string_view_starts_with(arg, SV_CONSTANT("--trace-out="))) {
+            if (arg.count == 12) {
+                fprintf(stderr, "'--trace-out=' requires a file path\n");
+                return false;
+            }
+
+            args->trace_out_file = string_view_slice(arg, 12, -1).data;
         } else if (string_view_equals(arg, SV_CONSTANT("--byte-diagnostics"))) {
             args->use_byte_positions_in_diagnostics = true;
         } else if (string_view_equals(arg, SV_CONSTANT("--backend"))) {
@@ -825,6 +1328,41 @@ static bool parse_args(compiler_state* args, int* argc, char*** argv) {
                 fprintf(stderr, "Unknown value for option '--backend': %s\n", backend);
                 return false;
             }
+        } else if (string_view_equals(arg, SV_CONSTANT("-O0"))) {
+            args->optimization_level = 0;
+        } else if (string_view_equals(arg, SV_CONSTANT("-O1"))) {
+            args->optimization_level = 1;
+        } else if (string_view_equals(arg, SV_CONSTANT("-O2"))) {
+            args->optimization_level = 2;
+        } else if (string_view_starts_with(arg, SV_CONSTANT("-finline-threshold="))) {
+            string_view threshold = string_view_slice(arg, 19, -1);
+            char* threshold_end = NULL;
+            long threshold_value = strtol(threshold.data, &threshold_end, 10);
+            if (threshold.count == 0 || *threshold_end != 0 || threshold_value < 0 || threshold_value > INT_MAX) {
+                fprintf(stderr, "Invalid value for option '-finline-threshold': %.*s\n", STR_EXPAND(threshold));
+                return false;
+            }
+
+            args->inline_threshold = (int)threshold_value;
+        } else if (string_view_starts_with(arg, SV_CONSTANT("-j"))) {
+            string_view jobs = {0};
+            if (arg.count > 2) {
+                jobs = string_view_slice(arg, 2, -1);
+            } else if (*argc > 0) {
+                jobs = string_view_from_cstring(nob_shift_args(argc, argv));
+            } else {
+                fprintf(stderr, "'-j' requires a number of jobs\n");
+                return false;
+            }
+
+            char* jobs_end = NULL;
+            long jobs_value = strtol(jobs.data, &jobs_end, 10);
+            if (jobs.count == 0 || *jobs_end != 0 || jobs_value < 1 || jobs_value > INT_MAX) {
+                fprintf(stderr, "Invalid value for option '-j': %.*s\n", STR_EXPAND(jobs));
+                return false;
+            }
+
+            args->jobs = (int)jobs_value;
         } else if (string_view_equals(arg, SV_CONSTANT("-x"))) {
             if (argc == 0) {
                 fprintf(stderr, "'-x' requires an argument\n");
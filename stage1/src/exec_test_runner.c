@@ -67,6 +67,10 @@ typedef struct test_state {
     dynarr(test_info) failed_tests;
 } test_state;
 
+// tests are run in the compiler's interpreter unless --native is given, which compiles each
+// to an executable through clang instead.
+static bool use_native_executables;
+
 static bool cstring_ends_with(const char* s, const char* ending);
 static bool run_exec_test(const char* test_file_path);
 static void run_tests_in_directory(test_state* state, const char* test_directory, const char* extension);
@@ -74,6 +78,16 @@ static void run_tests_in_directory(test_state* state, const char* test_directory
 int main(int argc, char** argv) {
     const char* program = nob_shift_args(&argc, &argv);
 
+    while (argc > 0) {
+        const char* arg = nob_shift_args(&argc, &argv);
+        if (0 == strcmp(arg, "--native")) {
+            use_native_executables = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--native]\n", program);
+            return 1;
+        }
+    }
+
     test_state state = {0};
     run_tests_in_directory(&state, "./test/laye", ".laye");
 
@@ -169,9 +183,60 @@ static int read_expected_exit_code(const char* test_file_path) {
     return expected_exit_code;
 }
 
-static bool run_exec_test(const char* test_file_path) {
-    nob_log(NOB_INFO, "-- Running execution test for \"%s\"", test_file_path);
+// reads what the child writes to the pipe until it exits, forwarding it to our own stderr.
+// returns whether there was any.
+static bool drain_child_output(Nob_Fd read_end) {
+    bool has_output = false;
+    char buffer[4096];
+    for (;;) {
+#ifdef _WIN32
+        DWORD read_count = 0;
+        if (!ReadFile(read_end, buffer, sizeof buffer, &read_count, NULL) || read_count == 0) break;
+#else
+        ssize_t read_count = read(read_end, buffer, sizeof buffer);
+        if (read_count < 0 && errno == EINTR) continue;
+        if (read_count <= 0) break;
+#endif
+        has_output = true;
+        fwrite(buffer, 1, (size_t)read_count, stderr);
+    }
+
+    return has_output;
+}
+
+// the interpreter reports compile and runtime errors on stderr and exits with 1, which a test
+// may also expect, so anything written there fails the test. no test writes to stderr itself.
+static bool run_interpreted(const char* test_file_path, Nob_Proc_Result* out_result) {
+    Nob_Fd read_end, write_end;
+    if (!nob_pipe_create(&read_end, &write_end)) {
+        return false;
+    }
 
+#ifdef _WIN32
+    // nob's pipes are made for writing to a child, so the ends are inherited the other way round.
+    SetHandleInformation(write_end, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+    SetHandleInformation(read_end, HANDLE_FLAG_INHERIT, 0);
+#endif
+
+    Nob_Cmd cmd = {0};
+    nob_cmd_append(&cmd, LAYEC_PATH, "--run", test_file_path);
+    Nob_Proc proc = nob_cmd_run_async_redirect(cmd, (Nob_Cmd_Redirect){.fderr = &write_end});
+    nob_cmd_free(cmd);
+    nob_fd_close(write_end);
+
+    if (proc == NOB_INVALID_PROC) {
+        nob_fd_close(read_end);
+        return false;
+    }
+
+    bool has_output = drain_child_output(read_end);
+    nob_fd_close(read_end);
+
+    *out_result = nob_proc_wait_result(proc);
+    return !has_output;
+}
+
+static bool run_native(const char* test_file_path, Nob_Proc_Result* out_result) {
 #ifdef _WIN32
     const char* exec_file = nob_temp_sprintf("%s.out.exe", test_file_path);
 #else
@@ -196,10 +261,22 @@ static bool run_exec_test(const char* test_file_path) {
     cmd.count = 0;
     nob_cmd_append(&cmd, exec_file);
 
-    Nob_Proc_Result exec_result = nob_cmd_run_sync_result(cmd);
+    *out_result = nob_cmd_run_sync_result(cmd);
     nob_cmd_free(cmd);
     remove(exec_file);
 
+    return true;
+}
+
+static bool run_exec_test(const char* test_file_path) {
+    nob_log(NOB_INFO, "-- Running execution test for \"%s\"", test_file_path);
+
+    Nob_Proc_Result exec_result = {0};
+    bool run_success = use_native_executables ? run_native(test_file_path, &exec_result) : run_interpreted(test_file_path, &exec_result);
+    if (!run_success) {
+        return false;
+    }
+
     int expected_exit_code = read_expected_exit_code(test_file_path);
     if (expected_exit_code == INVALID_EXIT_CODE) {
         return false;
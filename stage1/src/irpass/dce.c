@@ -0,0 +1,131 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Dead code elimination: removes blocks which can't be reached from the entry block, then every
+// instruction whose result never reaches something with a side effect.
+// NOTE(local): rather than removing instructions without uses and then revisiting their operands,
+// this marks everything reachable from the side-effecting roots as live, which also catches dead
+// cycles like a phi only used by the add feeding back into it.
+
+#include "layec.h"
+
+#include <assert.h>
+
+// constants, parameters and globals aren't in any block, and are never removed.
+static bool dce_value_is_in_block(layec_value* value) {
+    return layec_instruction_get_parent_block(value) != NULL;
+}
+
+static bool dce_instruction_is_root(layec_value* instruction) {
+    switch (layec_value_get_kind(instruction)) {
+        default: return layec_value_is_terminating_instruction(instruction);
+
+        case LAYEC_IR_STORE:
+        case LAYEC_IR_CALL:
+        case LAYEC_IR_BUILTIN: return true;
+    }
+}
+
+static bool dce_remove_dead_instructions(layec_value* function) {
+    ptrmap live = {0};
+    dynarr(layec_value*) worklist = NULL;
+
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (dce_instruction_is_root(instruction)) {
+                ptrmap_set(&live, instruction, instruction);
+                arr_push(worklist, instruction);
+            }
+        }
+    }
+
+    while (arr_count(worklist) > 0) {
+        layec_value* instruction = *arr_back(worklist);
+        arr_pop(worklist);
+
+        for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+            layec_value* operand = layec_instruction_get_operand_at_index(instruction, o);
+            if (!dce_value_is_in_block(operand) || ptrmap_get(&live, operand) != NULL) {
+                continue;
+            }
+
+            ptrmap_set(&live, operand, operand);
+            arr_push(worklist, operand);
+        }
+    }
+
+    arr_free(worklist);
+
+    bool changed = false;
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (ptrmap_get(&live, instruction) == NULL) {
+                layec_instruction_mark_for_removal(instruction);
+                changed = true;
+            }
+        }
+    }
+
+    ptrmap_free(&live);
+
+    if (changed) {
+        layec_function_remove_marked_instructions(function);
+    }
+
+    return changed;
+}
+
+bool layec_irpass_dce_function(layec_pass_manager* pass_manager, layec_value* function) {
+    (void)pass_manager;
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    if (layec_function_block_count(function) == 0) {
+        return false;
+    }
+
+    bool changed = layec_function_remove_unreachable_blocks(function);
+    changed |= dce_remove_dead_instructions(function);
+    return changed;
+}
@@ -0,0 +1,561 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Global value numbering over the dominator tree.
+// Pure instructions are hashed by opcode, type and operands; one whose twin is available in a
+// dominating position is replaced by it. Loads are numbered by address: a load is replaced by the
+// value last stored to or loaded from the same address, as long as nothing in between may have
+// written to that memory.
+// NOTE(local): memory is only followed from a block into a child with no other predecessor;
+// anything joining paths starts over, since a store on the other path can't be seen from here.
+
+#include "layec.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct gvn_expression {
+    uint64_t hash;
+    layec_value* value;
+    // the previously available expression with the same hash, or -1.
+    int64_t previous;
+} gvn_expression;
+
+typedef struct gvn_memory {
+    layec_value* address;
+    // the value known to be in memory at `address`, its type being the type of the access.
+    layec_value* value;
+    // the previously available memory value at the same address, or -1.
+    int64_t previous;
+    int64_t generation;
+    bool is_clobbered;
+} gvn_memory;
+
+typedef struct gvn_scope {
+    int64_t expression_count;
+    int64_t memory_count;
+    int64_t clobber_count;
+    int64_t generation;
+} gvn_scope;
+
+typedef struct gvn_location {
+    layec_value* base;
+    int64_t offset;
+    bool has_offset;
+} gvn_location;
+
+typedef struct gvn_state {
+    layec_value* function;
+    layec_dominator_tree* dominator_tree;
+
+    // allocas whose address never leaves the loads, stores and memsets accessing them.
+    ptrmap private_allocas;
+    dynarr(gvn_expression) expressions;
+    // hash -> index + 1 of the newest expression with that hash
+    ptrmap expression_lookup;
+
+    dynarr(gvn_memory) memory;
+    // address -> index + 1 of the newest memory value at that address
+    ptrmap memory_lookup;
+    // indices of memory values clobbered in the current scopes, to restore on leaving them.
+    dynarr(int64_t) clobbers;
+
+    // memory values of an older generation are no longer available.
+    int64_t generation;
+    int64_t next_generation;
+} gvn_state;
+
+static bool gvn_is_pure(layec_value_kind kind) {
+    return kind == LAYEC_IR_PTRADD || (kind >= LAYEC_IR_ZEXT && kind <= LAYEC_IR_FPEXT) || (kind >= LAYEC_IR_ADD && kind <= LAYEC_IR_FCMP_TRUE);
+}
+
+static bool gvn_is_commutative(layec_value_kind kind) {
+    switch (kind) {
+        default: return false;
+
+        case LAYEC_IR_ADD:
+        case LAYEC_IR_MUL:
+        case LAYEC_IR_AND:
+        case LAYEC_IR_OR:
+        case LAYEC_IR_XOR:
+        case LAYEC_IR_ICMP_EQ:
+        case LAYEC_IR_ICMP_NE: return true;
+    }
+}
+
+static uint64_t gvn_hash_combine(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// constants aren't uniqued, so they are hashed and compared by value.
+static uint64_t gvn_operand_hash(layec_value* operand) {
+    switch (layec_value_get_kind(operand)) {
+        default: return (uint64_t)(uintptr_t)operand;
+
+        case LAYEC_IR_INTEGER_CONSTANT: {
+            return gvn_hash_combine((uint64_t)(uintptr_t)layec_value_get_type(operand), (uint64_t)layec_value_integer_constant(operand));
+        }
+
+        case LAYEC_IR_FLOAT_CONSTANT: {
+            double value = layec_value_float_constant(operand);
+            uint64_t bits = 0;
+            memcpy(&bits, &value, sizeof bits);
+            return gvn_hash_combine((uint64_t)(uintptr_t)layec_value_get_type(operand), bits);
+        }
+    }
+}
+
+static bool gvn_same_operand(layec_value* first, layec_value* second) {
+    if (first == second) {
+        return true;
+    }
+
+    layec_value_kind kind = layec_value_get_kind(first);
+    if (kind != layec_value_get_kind(second) || layec_value_get_type(first) != layec_value_get_type(second)) {
+        return false;
+    }
+
+    if (kind == LAYEC_IR_INTEGER_CONSTANT) {
+        return layec_value_integer_constant(first) == layec_value_integer_constant(second);
+    }
+
+    if (kind == LAYEC_IR_FLOAT_CONSTANT) {
+        double first_value = layec_value_float_constant(first);
+        double second_value = layec_value_float_constant(second);
+        return memcmp(&first_value, &second_value, sizeof first_value) == 0;
+    }
+
+    return false;
+}
+
+static uint64_t gvn_expression_hash(layec_value* instruction) {
+    layec_value_kind kind = layec_value_get_kind(instruction);
+    uint64_t hash = gvn_hash_combine((uint64_t)kind, (uint64_t)(uintptr_t)layec_value_get_type(instruction));
+
+    int64_t operand_count = layec_instruction_operand_count(instruction);
+    if (operand_count == 2 && gvn_is_commutative(kind)) {
+        uint64_t lhs_hash = gvn_operand_hash(layec_instruction_get_operand_at_index(instruction, 0));
+        uint64_t rhs_hash = gvn_operand_hash(layec_instruction_get_operand_at_index(instruction, 1));
+        hash = gvn_hash_combine(hash, lhs_hash < rhs_hash ? lhs_hash : rhs_hash);
+        hash = gvn_hash_combine(hash, lhs_hash < rhs_hash ? rhs_hash : lhs_hash);
+    } else {
+        for (int64_t o = 0; o < operand_count; o++) {
+            hash = gvn_hash_combine(hash, gvn_operand_hash(layec_instruction_get_operand_at_index(instruction, o)));
+        }
+    }
+
+    // the hash is used as a map key, which can't be NULL.
+    return hash == 0 ? 1 : hash;
+}
+
+static bool gvn_same_expression(layec_value* first, layec_value* second) {
+    layec_value_kind kind = layec_value_get_kind(first);
+    if (kind != layec_value_get_kind(second) || layec_value_get_type(first) != layec_value_get_type(second)) {
+        return false;
+    }
+
+    int64_t operand_count = layec_instruction_operand_count(first);
+    assert(operand_count == layec_instruction_operand_count(second));
+
+    bool same_operands = true;
+    for (int64_t o = 0; o < operand_count && same_operands; o++) {
+        same_operands = gvn_same_operand(layec_instruction_get_operand_at_index(first, o), layec_instruction_get_operand_at_index(second, o));
+    }
+
+    if (same_operands || operand_count != 2 || !gvn_is_commutative(kind)) {
+        return same_operands;
+    }
+
+    return gvn_same_operand(layec_instruction_get_operand_at_index(first, 0), layec_instruction_get_operand_at_index(second, 1)) &&
+           gvn_same_operand(layec_instruction_get_operand_at_index(first, 1), layec_instruction_get_operand_at_index(second, 0));
+}
+
+// the object an address points into, and the constant offset into it if there is one.
+static gvn_location gvn_decompose_address(layec_value* address) {
+    gvn_location location = {
+        .base = address,
+        .has_offset = true,
+    };
+
+    while (layec_value_get_kind(location.base) == LAYEC_IR_PTRADD) {
+        layec_value* offset = layec_instruction_ptradd_get_offset(location.base);
+        if (layec_value_get_kind(offset) == LAYEC_IR_INTEGER_CONSTANT) {
+            location.offset += layec_value_integer_constant(offset);
+        } else {
+            location.has_offset = false;
+        }
+
+        location.base = layec_instruction_ptradd_get_address(location.base);
+    }
+
+    return location;
+}
+
+static bool gvn_is_private_alloca(gvn_state* state, layec_value* base) {
+    return ptrmap_contains(&state->private_allocas, base);
+}
+
+// a negative size is unknown.
+static bool gvn_may_alias(gvn_state* state, layec_value* first, int64_t first_size, layec_value* second, int64_t second_size) {
+    gvn_location first_location = gvn_decompose_address(first);
+    gvn_location second_location = gvn_decompose_address(second);
+
+    if (first_location.base == second_location.base) {
+        if (!first_location.has_offset || !second_location.has_offset || first_size < 0 || second_size < 0) {
+            return true;
+        }
+
+        return first_location.offset < second_location.offset + second_size && second_location.offset < first_location.offset + first_size;
+    }
+
+    // distinct allocas and globals are distinct objects, and nothing else can point into a private alloca.
+    layec_value_kind first_kind = layec_value_get_kind(first_location.base);
+    layec_value_kind second_kind = layec_value_get_kind(second_location.base);
+    bool first_is_object = first_kind == LAYEC_IR_ALLOCA || first_kind == LAYEC_IR_GLOBAL_VARIABLE;
+    bool second_is_object = second_kind == LAYEC_IR_ALLOCA || second_kind == LAYEC_IR_GLOBAL_VARIABLE;
+    if (first_is_object && second_is_object) {
+        return false;
+    }
+
+    return !gvn_is_private_alloca(state, first_location.base) && !gvn_is_private_alloca(state, second_location.base);
+}
+
+static void gvn_find_private_allocas(gvn_state* state) {
+    ptrmap escaping = {0};
+
+    for (int64_t b = 0, bcount = layec_function_block_count(state->function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(state->function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            layec_value_kind kind = layec_value_get_kind(instruction);
+
+            if (kind == LAYEC_IR_ALLOCA) {
+                ptrmap_set(&state->private_allocas, instruction, instruction);
+                continue;
+            }
+
+            for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+                layec_value* base = gvn_decompose_address(layec_instruction_get_operand_at_index(instruction, o)).base;
+                if (layec_value_get_kind(base) != LAYEC_IR_ALLOCA) {
+                    continue;
+                }
+
+                bool is_accessed = kind == LAYEC_IR_LOAD || kind == LAYEC_IR_PTRADD || (kind == LAYEC_IR_STORE && o == 0) ||
+                                   (kind == LAYEC_IR_BUILTIN && layec_instruction_builtin_kind(instruction) == LAYEC_BUILTIN_MEMSET && o == 0);
+                if (!is_accessed) {
+                    ptrmap_set(&escaping, base, base);
+                }
+            }
+        }
+    }
+
+    for (int64_t b = 0, bcount = layec_function_block_count(state->function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(state->function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (ptrmap_contains(&escaping, instruction)) {
+                ptrmap_remove(&state->private_allocas, instruction);
+            }
+        }
+    }
+
+    ptrmap_free(&escaping);
+}
+
+static layec_value* gvn_find_expression(gvn_state* state, layec_value* instruction, uint64_t hash) {
+    int64_t index = (int64_t)(intptr_t)ptrmap_get(&state->expression_lookup, (void*)(uintptr_t)hash) - 1;
+    for (; index >= 0; index = state->expressions[index].previous) {
+        if (gvn_same_expression(state->expressions[index].value, instruction)) {
+            return state->expressions[index].value;
+        }
+    }
+
+    return NULL;
+}
+
+static void gvn_add_expression(gvn_state* state, layec_value* instruction, uint64_t hash) {
+    gvn_expression expression = {
+        .hash = hash,
+        .value = instruction,
+        .previous = (int64_t)(intptr_t)ptrmap_get(&state->expression_lookup, (void*)(uintptr_t)hash) - 1,
+    };
+
+    arr_push(state->expressions, expression);
+    ptrmap_set(&state->expression_lookup, (void*)(uintptr_t)hash, (void*)(intptr_t)arr_count(state->expressions));
+}
+
+static layec_value* gvn_find_memory(gvn_state* state, layec_value* address, layec_type* type) {
+    int64_t index = (int64_t)(intptr_t)ptrmap_get(&state->memory_lookup, address) - 1;
+    for (; index >= 0; index = state->memory[index].previous) {
+        gvn_memory* memory = &state->memory[index];
+        if (memory->generation != state->generation) {
+            break;
+        }
+
+        if (!memory->is_clobbered) {
+            return layec_value_get_type(memory->value) == type ? memory->value : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+static void gvn_add_memory(gvn_state* state, layec_value* address, layec_value* value) {
+    gvn_memory memory = {
+        .address = address,
+        .value = value,
+        .previous = (int64_t)(intptr_t)ptrmap_get(&state->memory_lookup, address) - 1,
+        .generation = state->generation,
+    };
+
+    arr_push(state->memory, memory);
+    ptrmap_set(&state->memory_lookup, address, (void*)(intptr_t)arr_count(state->memory));
+}
+
+// forgets the memory values a write of `size` bytes to `address` may change.
+// a NULL address is a write to anything that isn't a private alloca.
+static void gvn_clobber(gvn_state* state, layec_value* address, int64_t size) {
+    // the available memory values are the ones of the current generation, all at the end.
+    for (int64_t index = arr_count(state->memory) - 1; index >= 0; index--) {
+        gvn_memory* memory = &state->memory[index];
+        if (memory->generation != state->generation) {
+            break;
+        }
+
+        if (memory->is_clobbered) {
+            continue;
+        }
+
+        bool may_alias = false;
+        if (address == NULL) {
+            may_alias = !gvn_is_private_alloca(state, gvn_decompose_address(memory->address).base);
+        } else {
+            int64_t memory_size = layec_type_size_in_bytes(layec_value_get_type(memory->value));
+            may_alias = gvn_may_alias(state, address, size, memory->address, memory_size);
+        }
+
+        if (may_alias) {
+            memory->is_clobbered = true;
+            arr_push(state->clobbers, index);
+        }
+    }
+}
+
+// the value dominates the instruction, so it can stand in for it everywhere, including in phis
+// and in instructions which haven't been numbered yet.
+static void gvn_replace(layec_value* instruction, layec_value* value) {
+    layec_value_replace_all_uses_with(instruction, value);
+    layec_instruction_mark_for_removal(instruction);
+}
+
+// returns true if the instruction was replaced.
+static bool gvn_instruction(gvn_state* state, layec_value* instruction) {
+    layec_value_kind kind = layec_value_get_kind(instruction);
+
+    if (gvn_is_pure(kind)) {
+        uint64_t hash = gvn_expression_hash(instruction);
+        layec_value* available = gvn_find_expression(state, instruction, hash);
+        if (available != NULL) {
+            gvn_replace(instruction, available);
+            return true;
+        }
+
+        gvn_add_expression(state, instruction, hash);
+        return false;
+    }
+
+    switch (kind) {
+        default: return false;
+
+        case LAYEC_IR_LOAD: {
+            layec_value* address = layec_instruction_get_address(instruction);
+            layec_value* available = gvn_find_memory(state, address, layec_value_get_type(instruction));
+            if (available != NULL) {
+                gvn_replace(instruction, available);
+                return true;
+            }
+
+            gvn_add_memory(state, address, instruction);
+            return false;
+        }
+
+        case LAYEC_IR_STORE: {
+            layec_value* address = layec_instruction_get_address(instruction);
+            layec_value* value = layec_instruction_get_operand(instruction);
+            gvn_clobber(state, address, layec_type_size_in_bytes(layec_value_get_type(value)));
+            gvn_add_memory(state, address, value);
+            return false;
+        }
+
+        case LAYEC_IR_BUILTIN: {
+            if (layec_instruction_builtin_kind(instruction) == LAYEC_BUILTIN_MEMSET) {
+                assert(layec_instruction_builtin_argument_count(instruction) == 3);
+                layec_value* count = layec_instruction_builtin_get_argument_at_index(instruction, 2);
+                int64_t size = layec_value_get_kind(count) == LAYEC_IR_INTEGER_CONSTANT ? layec_value_integer_constant(count) : -1;
+                gvn_clobber(state, layec_instruction_builtin_get_argument_at_index(instruction, 0), size);
+                return false;
+            }
+
+            gvn_clobber(state, NULL, -1);
+            return false;
+        }
+
+        case LAYEC_IR_CALL: {
+            gvn_clobber(state, NULL, -1);
+            return false;
+        }
+    }
+}
+
+static void gvn_enter_scope(gvn_state* state, dynarr(gvn_scope)* scopes, int64_t predecessor_count) {
+    gvn_scope scope = {
+        .expression_count = arr_count(state->expressions),
+        .memory_count = arr_count(state->memory),
+        .clobber_count = arr_count(state->clobbers),
+        .generation = state->generation,
+    };
+
+    arr_push(*scopes, scope);
+
+    if (predecessor_count != 1) {
+        state->generation = state->next_generation++;
+    }
+}
+
+static void gvn_leave_scope(gvn_state* state, dynarr(gvn_scope)* scopes) {
+    gvn_scope scope = *arr_back(*scopes);
+    arr_pop(*scopes);
+
+    while (arr_count(state->expressions) > scope.expression_count) {
+        gvn_expression expression = *arr_back(state->expressions);
+        arr_pop(state->expressions);
+
+        void* key = (void*)(uintptr_t)expression.hash;
+        if (expression.previous >= 0) {
+            ptrmap_set(&state->expression_lookup, key, (void*)(intptr_t)(expression.previous + 1));
+        } else {
+            ptrmap_remove(&state->expression_lookup, key);
+        }
+    }
+
+    while (arr_count(state->memory) > scope.memory_count) {
+        gvn_memory memory = *arr_back(state->memory);
+        arr_pop(state->memory);
+
+        if (memory.previous >= 0) {
+            ptrmap_set(&state->memory_lookup, memory.address, (void*)(intptr_t)(memory.previous + 1));
+        } else {
+            ptrmap_remove(&state->memory_lookup, memory.address);
+        }
+    }
+
+    while (arr_count(state->clobbers) > scope.clobber_count) {
+        int64_t index = *arr_back(state->clobbers);
+        arr_pop(state->clobbers);
+
+        if (index < arr_count(state->memory)) {
+            state->memory[index].is_clobbered = false;
+        }
+    }
+
+    state->generation = scope.generation;
+}
+
+bool layec_irpass_gvn_function(layec_pass_manager* pass_manager, layec_value* function) {
+    assert(pass_manager != NULL);
+    assert(function != NULL);
+
+    gvn_state state = {
+        .function = function,
+        .dominator_tree = layec_dominator_tree_get(pass_manager, function),
+        .next_generation = 1,
+    };
+
+    gvn_find_private_allocas(&state);
+
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+
+    bool changed = false;
+
+    // walk the dominator tree; a negative entry means "leave block -(entry + 1)".
+    dynarr(gvn_scope) scopes = NULL;
+    dynarr(int64_t) stack = NULL;
+    arr_push(stack, 0);
+
+    while (arr_count(stack) > 0) {
+        int64_t entry = *arr_back(stack);
+        arr_pop(stack);
+
+        if (entry < 0) {
+            gvn_leave_scope(&state, &scopes);
+            continue;
+        }
+
+        // the entry block has no predecessors, but may be branched back to.
+        layec_value* block = layec_function_get_block_at_index(function, entry);
+        gvn_enter_scope(&state, &scopes, entry == 0 ? 0 : layec_cfg_predecessor_count(cfg, block));
+        arr_push(stack, -(entry + 1));
+
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            changed |= gvn_instruction(&state, layec_block_get_instruction_at_index(block, i));
+        }
+
+        for (int64_t c = layec_dominator_tree_child_count(state.dominator_tree, block) - 1; c >= 0; c--) {
+            arr_push(stack, layec_block_index(layec_dominator_tree_get_child_at_index(state.dominator_tree, block, c)));
+        }
+    }
+
+    if (changed) {
+        layec_function_remove_marked_instructions(function);
+    }
+
+    arr_free(scopes);
+    arr_free(stack);
+    arr_free(state.expressions);
+    arr_free(state.memory);
+    arr_free(state.clobbers);
+    ptrmap_free(&state.expression_lookup);
+    ptrmap_free(&state.memory_lookup);
+    ptrmap_free(&state.private_allocas);
+
+    return changed;
+}
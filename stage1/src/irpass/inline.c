@@ -0,0 +1,455 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Function inlining. Functions declared `inline` are always inlined where possible, and any
+// other function is inlined when its body is no larger than the inline threshold.
+// Callers are visited after their callees, so a callee has already had its own calls inlined by
+// the time it is copied; calls copied in from a callee are not themselves inlined again, which
+// keeps recursive functions from expanding forever.
+// A call to a function imported from another module is inlined from that module's definition,
+// as long as the copy doesn't need anything private to that module.
+
+#include "layec.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#define INLINE_THRESHOLD_O1 (20)
+#define INLINE_THRESHOLD_O2 (60)
+
+typedef struct inline_state {
+    layec_module* module;
+    layec_context* context;
+    layec_builder* builder;
+    int threshold;
+
+    // interned function name -> its definition, in any module, if it is visible outside of it.
+    ptrmap definitions;
+    // interned function name -> the function of that name in this module.
+    ptrmap declarations;
+} inline_state;
+
+static int64_t inline_instruction_count(layec_value* function) {
+    int64_t instruction_count = 0;
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        instruction_count += layec_block_instruction_count(layec_function_get_block_at_index(function, b));
+    }
+
+    return instruction_count;
+}
+
+static bool inline_linkage_is_visible(layec_linkage linkage) {
+    return linkage == LAYEC_LINK_IMPORTED || linkage == LAYEC_LINK_EXPORTED || linkage == LAYEC_LINK_REEXPORTED;
+}
+
+// the ABI pass rewrites signatures with aggregates in them, and may not have run on the callee's module yet.
+static bool inline_type_is_abi_neutral(layec_type* type) {
+    if (layec_type_is_integer(type)) {
+        return layec_type_size_in_bits(type) <= 64;
+    }
+
+    return layec_type_is_void(type) || layec_type_is_ptr(type) || layec_type_is_float(type);
+}
+
+static bool inline_signature_is_abi_neutral(layec_value* function) {
+    layec_type* function_type = layec_value_get_type(function);
+    for (int64_t i = 0, count = layec_function_type_parameter_count(function_type); i < count; i++) {
+        if (!inline_type_is_abi_neutral(layec_function_type_get_parameter_type_at_index(function_type, i))) {
+            return false;
+        }
+    }
+
+    return inline_type_is_abi_neutral(layec_function_return_type(function));
+}
+
+// whether the body of `callee`, which lives in another module, can be copied into this one.
+static bool inline_can_copy_across_modules(layec_value* callee) {
+    if (!inline_signature_is_abi_neutral(callee)) {
+        return false;
+    }
+
+    for (int64_t b = 0, bcount = layec_function_block_count(callee); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(callee, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (layec_value_get_kind(instruction) == LAYEC_IR_CALL) {
+                for (int64_t a = 0, acount = layec_instruction_call_argument_count(instruction); a < acount; a++) {
+                    if (!inline_type_is_abi_neutral(layec_value_get_type(layec_instruction_call_get_argument_at_index(instruction, a)))) {
+                        return false;
+                    }
+                }
+
+                if (!inline_type_is_abi_neutral(layec_value_get_type(instruction))) {
+                    return false;
+                }
+            }
+
+            for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+                layec_value* operand = layec_instruction_get_operand_at_index(instruction, o);
+                switch (layec_value_get_kind(operand)) {
+                    default: break;
+
+                    // globals, string literals included, belong to their module.
+                    case LAYEC_IR_GLOBAL_VARIABLE: return false;
+
+                    case LAYEC_IR_FUNCTION: {
+                        if (!inline_linkage_is_visible(layec_value_linkage(operand))) {
+                            return false;
+                        }
+                    } break;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// the function a call will run, if its body is known.
+static layec_value* inline_resolve_callee(inline_state* state, layec_value* call) {
+    layec_value* callee = layec_instruction_callee(call);
+    if (layec_value_get_kind(callee) != LAYEC_IR_FUNCTION) {
+        return NULL;
+    }
+
+    if (layec_function_block_count(callee) != 0) {
+        return callee;
+    }
+
+    layec_value* definition = ptrmap_get(&state->definitions, layec_function_name(callee).data);
+    if (definition == NULL || layec_value_get_type(definition) != layec_value_get_type(callee)) {
+        return NULL;
+    }
+
+    return definition;
+}
+
+static bool inline_should_inline(inline_state* state, layec_value* caller, layec_value* call, layec_value* callee) {
+    if (callee == caller || layec_function_is_variadic(callee)) {
+        return false;
+    }
+
+    if (layec_instruction_call_argument_count(call) != layec_function_parameter_count(callee)) {
+        return false;
+    }
+
+    bool is_inline = layec_function_is_inline(callee) || layec_function_is_inline(layec_instruction_callee(call));
+    if (!is_inline && inline_instruction_count(callee) > state->threshold) {
+        return false;
+    }
+
+    if (layec_value_module(callee) != state->module && !inline_can_copy_across_modules(callee)) {
+        return false;
+    }
+
+    return true;
+}
+
+// a function from another module, as seen from this one.
+static layec_value* inline_get_declaration(inline_state* state, layec_value* function) {
+    string_view name = layec_function_name(function);
+    layec_value* declaration = ptrmap_get(&state->declarations, name.data);
+    if (declaration != NULL) {
+        return declaration;
+    }
+
+    layec_type* function_type = layec_value_get_type(function);
+
+    dynarr(layec_value*) parameters = NULL;
+    for (int64_t i = 0, count = layec_function_parameter_count(function); i < count; i++) {
+        layec_type* parameter_type = layec_function_type_get_parameter_type_at_index(function_type, i);
+        arr_push(parameters, layec_create_parameter(state->module, layec_value_location(function), parameter_type, SV_EMPTY, i));
+    }
+
+    declaration = layec_module_create_function(state->module, layec_value_location(function), name, function_type, parameters, LAYEC_LINK_IMPORTED);
+    layec_function_set_inline(declaration, layec_function_is_inline(function));
+    ptrmap_set(&state->declarations, name.data, declaration);
+    return declaration;
+}
+
+static layec_value* inline_map_value(inline_state* state, ptrmap* value_map, layec_value* value) {
+    layec_value* mapped = ptrmap_get(value_map, value);
+    if (mapped != NULL) {
+        return mapped;
+    }
+
+    if (layec_value_get_kind(value) == LAYEC_IR_FUNCTION && layec_value_module(value) != state->module) {
+        return inline_get_declaration(state, value);
+    }
+
+    return value;
+}
+
+static void inline_call(inline_state* state, layec_value* caller, layec_value* call, layec_value* callee) {
+    layec_location location = layec_value_location(call);
+    layec_value* call_block = layec_instruction_get_parent_block(call);
+    layec_value* continue_block = layec_block_split_before(call);
+
+    ptrmap value_map = {0};
+    for (int64_t i = 0, count = layec_function_parameter_count(callee); i < count; i++) {
+        ptrmap_set(&value_map, layec_function_get_parameter_at_index(callee, i), layec_instruction_call_get_argument_at_index(call, i));
+    }
+
+    int64_t first_block_index = layec_function_block_count(caller);
+    int64_t callee_block_count = layec_function_block_count(callee);
+    for (int64_t b = 0; b < callee_block_count; b++) {
+        ptrmap_set(&value_map, layec_function_get_block_at_index(callee, b), layec_function_append_block(caller, SV_EMPTY));
+    }
+
+    for (int64_t b = 0; b < callee_block_count; b++) {
+        layec_value* callee_block = layec_function_get_block_at_index(callee, b);
+        layec_builder_position_at_end(state->builder, ptrmap_get(&value_map, callee_block));
+
+        for (int64_t i = 0, icount = layec_block_instruction_count(callee_block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(callee_block, i);
+            layec_value* clone = layec_instruction_clone(instruction, state->module);
+            layec_builder_insert(state->builder, clone);
+            ptrmap_set(&value_map, instruction, clone);
+        }
+    }
+
+    layec_type* result_type = layec_value_get_type(call);
+    bool has_result = !layec_type_is_void(result_type);
+
+    dynarr(layec_value*) return_values = NULL;
+    dynarr(layec_value*) return_blocks = NULL;
+    dynarr(layec_value*) entry_allocas = NULL;
+
+    for (int64_t b = first_block_index; b < first_block_index + callee_block_count; b++) {
+        layec_value* block = layec_function_get_block_at_index(caller, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+                layec_value* operand = layec_instruction_get_operand_at_index(instruction, o);
+                layec_instruction_set_operand_at_index(instruction, o, inline_map_value(state, &value_map, operand));
+            }
+
+            if (layec_value_get_kind(instruction) == LAYEC_IR_PHI) {
+                for (int64_t p = 0, pcount = layec_instruction_phi_incoming_value_count(instruction); p < pcount; p++) {
+                    layec_value* incoming_block = layec_instruction_phi_incoming_block_at_index(instruction, p);
+                    layec_instruction_phi_set_incoming_block_at_index(instruction, p, ptrmap_get(&value_map, incoming_block));
+                }
+            }
+
+            if (b == first_block_index && layec_value_get_kind(instruction) == LAYEC_IR_ALLOCA) {
+                arr_push(entry_allocas, instruction);
+            }
+        }
+
+        for (int64_t s = 0, scount = layec_block_successor_count(block); s < scount; s++) {
+            layec_block_set_successor_at_index(block, s, ptrmap_get(&value_map, layec_block_get_successor_at_index(block, s)));
+        }
+
+        layec_value* terminator = layec_block_get_instruction_at_index(block, layec_block_instruction_count(block) - 1);
+        if (layec_value_get_kind(terminator) == LAYEC_IR_RETURN) {
+            if (has_result) {
+                arr_push(return_values, layec_instruction_return_value(terminator));
+                arr_push(return_blocks, block);
+            }
+
+            layec_instruction_erase(terminator);
+            layec_builder_position_at_end(state->builder, block);
+            layec_build_branch(state->builder, layec_value_location(terminator), continue_block);
+        }
+    }
+
+    layec_builder_position_at_end(state->builder, call_block);
+    layec_build_branch(state->builder, location, ptrmap_get(&value_map, layec_function_get_block_at_index(callee, 0)));
+
+    // allocas in the entry block are the callee's stack frame; anywhere else they would run once per call.
+    layec_value* entry_block = layec_function_get_block_at_index(caller, 0);
+    for (int64_t i = arr_count(entry_allocas) - 1; i >= 0; i--) {
+        layec_instruction_remove_from_parent(entry_allocas[i]);
+        layec_builder_position_before(state->builder, layec_block_get_instruction_at_index(entry_block, 0));
+        layec_builder_insert(state->builder, entry_allocas[i]);
+    }
+
+    if (has_result) {
+        layec_value* result = NULL;
+        if (arr_count(return_values) == 0) {
+            result = layec_poison_constant(state->context, location, result_type);
+        } else if (arr_count(return_values) == 1) {
+            result = return_values[0];
+        } else {
+            layec_builder_position_before(state->builder, call);
+            result = layec_build_phi(state->builder, location, result_type);
+            for (int64_t r = 0; r < arr_count(return_values); r++) {
+                layec_instruction_phi_add_incoming_value(result, return_values[r], return_blocks[r]);
+            }
+        }
+
+        layec_value_replace_all_uses_with(call, result);
+    }
+
+    layec_instruction_erase(call);
+
+    arr_free(return_values);
+    arr_free(return_blocks);
+    arr_free(entry_allocas);
+    ptrmap_free(&value_map);
+}
+
+static void inline_calls_in_function(inline_state* state, layec_value* caller) {
+    // collected up front, so calls copied in from a callee aren't considered.
+    dynarr(layec_value*) calls = NULL;
+    for (int64_t b = 0, bcount = layec_function_block_count(caller); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(caller, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (layec_value_get_kind(instruction) == LAYEC_IR_CALL) {
+                arr_push(calls, instruction);
+            }
+        }
+    }
+
+    for (int64_t c = 0; c < arr_count(calls); c++) {
+        layec_value* callee = inline_resolve_callee(state, calls[c]);
+        if (callee == NULL || !inline_should_inline(state, caller, calls[c], callee)) {
+            continue;
+        }
+
+        inline_call(state, caller, calls[c], callee);
+    }
+
+    arr_free(calls);
+}
+
+// defined functions of the module, each after every function it calls (other than through a cycle).
+static dynarr(layec_value*) inline_bottom_up_order(inline_state* state) {
+    dynarr(layec_value*) order = NULL;
+    ptrmap visited = {0};
+
+    // a negative entry means "every callee of function -(entry + 1) has been visited".
+    dynarr(int64_t) stack = NULL;
+    ptrmap function_indices = {0};
+    for (int64_t f = 0, fcount = layec_module_function_count(state->module); f < fcount; f++) {
+        layec_value* function = layec_module_get_function_at_index(state->module, f);
+        ptrmap_set(&function_indices, function, (void*)(intptr_t)(f + 1));
+    }
+
+    for (int64_t f = layec_module_function_count(state->module) - 1; f >= 0; f--) {
+        arr_push(stack, f);
+    }
+
+    while (arr_count(stack) > 0) {
+        int64_t entry = *arr_back(stack);
+        arr_pop(stack);
+
+        if (entry < 0) {
+            arr_push(order, layec_module_get_function_at_index(state->module, -(entry + 1)));
+            continue;
+        }
+
+        layec_value* function = layec_module_get_function_at_index(state->module, entry);
+        if (layec_function_block_count(function) == 0 || ptrmap_contains(&visited, function)) {
+            continue;
+        }
+
+        ptrmap_set(&visited, function, function);
+        arr_push(stack, -(entry + 1));
+
+        for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+            layec_value* block = layec_function_get_block_at_index(function, b);
+            for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+                layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+                if (layec_value_get_kind(instruction) != LAYEC_IR_CALL) {
+                    continue;
+                }
+
+                layec_value* callee = layec_instruction_callee(instruction);
+                int64_t callee_index = (int64_t)(intptr_t)ptrmap_get(&function_indices, callee) - 1;
+                if (callee_index >= 0 && !ptrmap_contains(&visited, callee)) {
+                    arr_push(stack, callee_index);
+                }
+            }
+        }
+    }
+
+    arr_free(stack);
+    ptrmap_free(&function_indices);
+    ptrmap_free(&visited);
+    return order;
+}
+
+void layec_irpass_inline(layec_module* module) {
+    assert(module != NULL);
+    layec_context* context = layec_module_context(module);
+    assert(context != NULL);
+
+    inline_state state = {
+        .module = module,
+        .context = context,
+        .builder = layec_builder_create(context),
+        .threshold = context->inline_threshold,
+    };
+
+    if (state.threshold < 0) {
+        state.threshold = context->optimization_level >= 2 ? INLINE_THRESHOLD_O2 : INLINE_THRESHOLD_O1;
+    }
+
+    for (int64_t m = 0, mcount = arr_count(context->ir_modules); m < mcount; m++) {
+        layec_module* other_module = context->ir_modules[m];
+        if (other_module == NULL || other_module == module) {
+            continue;
+        }
+
+        for (int64_t f = 0, fcount = layec_module_function_count(other_module); f < fcount; f++) {
+            layec_value* function = layec_module_get_function_at_index(other_module, f);
+            if (layec_function_block_count(function) != 0 && inline_linkage_is_visible(layec_value_linkage(function))) {
+                ptrmap_set(&state.definitions, layec_function_name(function).data, function);
+            }
+        }
+    }
+
+    for (int64_t f = 0, fcount = layec_module_function_count(module); f < fcount; f++) {
+        layec_value* function = layec_module_get_function_at_index(module, f);
+        ptrmap_set(&state.declarations, layec_function_name(function).data, function);
+    }
+
+    dynarr(layec_value*) order = inline_bottom_up_order(&state);
+    for (int64_t f = 0; f < arr_count(order); f++) {
+        inline_calls_in_function(&state, order[f]);
+    }
+
+    arr_free(order);
+    ptrmap_free(&state.definitions);
+    ptrmap_free(&state.declarations);
+    layec_builder_destroy(state.builder);
+}
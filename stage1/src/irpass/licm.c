@@ -0,0 +1,400 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Loop-invariant code motion.
+// Every loop is first given a preheader: a block outside the loop whose only successor is the
+// header, through which every entry into the loop goes. Instructions whose operands are all
+// defined outside a loop are then moved to the end of its preheader, innermost loops first so an
+// instruction can leave a whole nest. Only instructions which can't fault are moved, since the
+// preheader runs even when the loop body doesn't; loads are moved when nothing in the loop may
+// write what they read and they either run on every trip through the loop or read a stack slot.
+
+#include "layec.h"
+
+#include <assert.h>
+
+typedef struct licm_incoming {
+    layec_value* value;
+    layec_value* block;
+} licm_incoming;
+
+typedef struct licm_loop_entry {
+    layec_value* header;
+    dynarr(layec_value*) outside_predecessors;
+} licm_loop_entry;
+
+typedef struct licm_memory {
+    // a call or builtin may write anything.
+    bool writes_unknown;
+    // the base of every address stored to in the loop.
+    dynarr(layec_value*) store_bases;
+} licm_memory;
+
+static bool licm_contains_block(dynarr(layec_value*) blocks, layec_value* block) {
+    for (int64_t i = 0; i < arr_count(blocks); i++) {
+        if (blocks[i] == block) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void licm_insert_preheader(layec_builder* builder, layec_value* function, licm_loop_entry* entry) {
+    layec_value* header = entry->header;
+    layec_value* preheader = layec_function_append_block(function, SV_EMPTY);
+    layec_builder_position_at_end(builder, preheader);
+
+    // the header's phis now get whatever came from outside the loop from the preheader, merged by a
+    // phi there if the outside predecessors disagree.
+    dynarr(licm_incoming) incoming = NULL;
+    for (int64_t i = 0, icount = layec_block_instruction_count(header); i < icount; i++) {
+        layec_value* phi = layec_block_get_instruction_at_index(header, i);
+        if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+            break;
+        }
+
+        arr_set_count(incoming, 0);
+        for (int64_t p = layec_instruction_phi_incoming_value_count(phi) - 1; p >= 0; p--) {
+            layec_value* block = layec_instruction_phi_incoming_block_at_index(phi, p);
+            if (!licm_contains_block(entry->outside_predecessors, block)) {
+                continue;
+            }
+
+            licm_incoming value = {
+                .value = layec_instruction_phi_incoming_value_at_index(phi, p),
+                .block = block,
+            };
+
+            arr_push(incoming, value);
+            layec_instruction_phi_remove_incoming_value_at_index(phi, p);
+        }
+
+        if (arr_count(incoming) == 0) {
+            continue;
+        }
+
+        bool is_uniform = true;
+        for (int64_t v = 1; v < arr_count(incoming); v++) {
+            is_uniform &= incoming[v].value == incoming[0].value;
+        }
+
+        layec_value* value = incoming[0].value;
+        if (!is_uniform) {
+            value = layec_build_phi(builder, layec_value_location(phi), layec_value_get_type(phi));
+            for (int64_t v = arr_count(incoming) - 1; v >= 0; v--) {
+                layec_instruction_phi_add_incoming_value(value, incoming[v].value, incoming[v].block);
+            }
+        }
+
+        layec_instruction_phi_add_incoming_value(phi, value, preheader);
+    }
+
+    arr_free(incoming);
+
+    layec_build_branch(builder, layec_value_location(layec_block_get_instruction_at_index(header, 0)), header);
+    layec_builder_reset(builder);
+
+    for (int64_t p = 0; p < arr_count(entry->outside_predecessors); p++) {
+        layec_value* predecessor = entry->outside_predecessors[p];
+        for (int64_t s = 0, scount = layec_block_successor_count(predecessor); s < scount; s++) {
+            if (layec_block_get_successor_at_index(predecessor, s) == header) {
+                layec_block_set_successor_at_index(predecessor, s, preheader);
+            }
+        }
+    }
+}
+
+// gives every loop which doesn't have one a preheader, returning true if any were added.
+static bool licm_insert_preheaders(layec_pass_manager* pass_manager, layec_builder* builder, layec_value* function) {
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    layec_loop_info* loop_info = layec_loop_info_get(pass_manager, function);
+
+    // everything is collected before anything changes, since changing the CFG invalidates both analyses.
+    dynarr(licm_loop_entry) entries = NULL;
+    for (int64_t l = 0, lcount = layec_loop_info_loop_count(loop_info); l < lcount; l++) {
+        layec_loop* loop = layec_loop_info_get_loop_at_index(loop_info, l);
+        layec_value* header = layec_loop_header(loop);
+
+        // NOTE(local): the entry block has to stay first, so a loop back to it gets no preheader.
+        if (layec_block_index(header) == 0 || layec_loop_get_preheader(loop, cfg) != NULL) {
+            continue;
+        }
+
+        licm_loop_entry entry = {
+            .header = header,
+        };
+
+        for (int64_t p = 0, pcount = layec_cfg_predecessor_count(cfg, header); p < pcount; p++) {
+            layec_value* predecessor = layec_cfg_get_predecessor_at_index(cfg, header, p);
+            if (!layec_loop_contains(loop, predecessor)) {
+                arr_push(entry.outside_predecessors, predecessor);
+            }
+        }
+
+        arr_push(entries, entry);
+    }
+
+    for (int64_t e = 0; e < arr_count(entries); e++) {
+        licm_insert_preheader(builder, function, &entries[e]);
+        arr_free(entries[e].outside_predecessors);
+    }
+
+    bool changed = arr_count(entries) != 0;
+    arr_free(entries);
+
+    return changed;
+}
+
+static layec_value* licm_address_base(layec_value* address, int64_t* offset, bool* has_offset) {
+    *offset = 0;
+    *has_offset = true;
+
+    while (layec_value_get_kind(address) == LAYEC_IR_PTRADD) {
+        layec_value* offset_value = layec_instruction_ptradd_get_offset(address);
+        if (layec_value_get_kind(offset_value) == LAYEC_IR_INTEGER_CONSTANT) {
+            *offset += layec_value_integer_constant(offset_value);
+        } else {
+            *has_offset = false;
+        }
+
+        address = layec_instruction_ptradd_get_address(address);
+    }
+
+    return address;
+}
+
+static bool licm_is_object(layec_value* base) {
+    layec_value_kind kind = layec_value_get_kind(base);
+    return kind == LAYEC_IR_ALLOCA || kind == LAYEC_IR_GLOBAL_VARIABLE;
+}
+
+static void licm_find_memory_writes(layec_loop* loop, licm_memory* memory) {
+    memory->writes_unknown = false;
+    arr_set_count(memory->store_bases, 0);
+
+    for (int64_t b = 0, bcount = layec_loop_block_count(loop); b < bcount; b++) {
+        layec_value* block = layec_loop_get_block_at_index(loop, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            switch (layec_value_get_kind(instruction)) {
+                default: break;
+
+                case LAYEC_IR_CALL:
+                case LAYEC_IR_BUILTIN: {
+                    memory->writes_unknown = true;
+                } break;
+
+                case LAYEC_IR_STORE: {
+                    int64_t offset = 0;
+                    bool has_offset = false;
+                    arr_push(memory->store_bases, licm_address_base(layec_instruction_get_address(instruction), &offset, &has_offset));
+                } break;
+            }
+        }
+    }
+}
+
+// the preheader runs even if the loop body doesn't, so only instructions which can't fault move.
+static bool licm_can_speculate(layec_value* instruction) {
+    layec_value_kind kind = layec_value_get_kind(instruction);
+    if (kind == LAYEC_IR_PTRADD || (kind >= LAYEC_IR_ZEXT && kind <= LAYEC_IR_FPEXT)) {
+        return true;
+    }
+
+    if (kind < LAYEC_IR_ADD || kind > LAYEC_IR_FCMP_TRUE) {
+        return false;
+    }
+
+    switch (kind) {
+        default: return true;
+
+        case LAYEC_IR_SDIV:
+        case LAYEC_IR_UDIV:
+        case LAYEC_IR_SMOD:
+        case LAYEC_IR_UMOD: {
+            layec_value* divisor = layec_instruction_binary_get_rhs(instruction);
+            if (layec_value_get_kind(divisor) != LAYEC_IR_INTEGER_CONSTANT || layec_value_integer_constant(divisor) == 0) {
+                return false;
+            }
+
+            // the most negative value divided by -1 overflows.
+            bool is_signed = kind == LAYEC_IR_SDIV || kind == LAYEC_IR_SMOD;
+            return !is_signed || layec_value_integer_constant(divisor) != -1;
+        }
+    }
+}
+
+static bool licm_is_invariant(layec_loop* loop, layec_value* value) {
+    layec_value* block = layec_instruction_get_parent_block(value);
+    return block == NULL || !layec_loop_contains(loop, block);
+}
+
+// true if the load runs on every trip through the loop which leaves it, or can't fault anyway.
+static bool licm_load_is_safe(layec_dominator_tree* dominator_tree, layec_loop* loop, layec_value* load) {
+    int64_t offset = 0;
+    bool has_offset = false;
+    layec_value* base = licm_address_base(layec_instruction_get_address(load), &offset, &has_offset);
+
+    if (layec_value_get_kind(base) == LAYEC_IR_ALLOCA && has_offset) {
+        int64_t slot_size = layec_type_size_in_bytes(layec_instruction_get_alloca_type(base)) * layec_instruction_get_alloca_element_count(base);
+        if (offset >= 0 && offset + layec_type_size_in_bytes(layec_value_get_type(load)) <= slot_size) {
+            return true;
+        }
+    }
+
+    layec_value* block = layec_instruction_get_parent_block(load);
+    for (int64_t b = 0, bcount = layec_loop_block_count(loop); b < bcount; b++) {
+        layec_value* exiting_block = layec_loop_get_block_at_index(loop, b);
+        for (int64_t s = 0, scount = layec_block_successor_count(exiting_block); s < scount; s++) {
+            if (layec_loop_contains(loop, layec_block_get_successor_at_index(exiting_block, s))) {
+                continue;
+            }
+
+            if (!layec_dominator_tree_dominates(dominator_tree, block, exiting_block)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool licm_load_is_invariant(licm_memory* memory, layec_value* load) {
+    if (memory->writes_unknown) {
+        return false;
+    }
+
+    if (arr_count(memory->store_bases) == 0) {
+        return true;
+    }
+
+    int64_t offset = 0;
+    bool has_offset = false;
+    layec_value* base = licm_address_base(layec_instruction_get_address(load), &offset, &has_offset);
+    if (!licm_is_object(base)) {
+        return false;
+    }
+
+    // distinct allocas and globals are distinct objects.
+    for (int64_t s = 0; s < arr_count(memory->store_bases); s++) {
+        if (memory->store_bases[s] == base || !licm_is_object(memory->store_bases[s])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool licm_can_hoist(layec_dominator_tree* dominator_tree, layec_loop* loop, licm_memory* memory, layec_value* instruction) {
+    if (layec_value_get_kind(instruction) == LAYEC_IR_LOAD) {
+        if (!licm_load_is_invariant(memory, instruction) || !licm_load_is_safe(dominator_tree, loop, instruction)) {
+            return false;
+        }
+    } else if (!licm_can_speculate(instruction)) {
+        return false;
+    }
+
+    for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+        if (!licm_is_invariant(loop, layec_instruction_get_operand_at_index(instruction, o))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool layec_irpass_licm_function(layec_pass_manager* pass_manager, layec_value* function) {
+    assert(pass_manager != NULL);
+    assert(function != NULL);
+
+    layec_context* context = layec_value_context(function);
+    assert(context != NULL);
+
+    layec_builder* builder = layec_builder_create(context);
+    bool changed = licm_insert_preheaders(pass_manager, builder, function);
+
+    // moving instructions between blocks leaves the CFG alone, so these stay valid from here on.
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    layec_dominator_tree* dominator_tree = layec_dominator_tree_get(pass_manager, function);
+    layec_loop_info* loop_info = layec_loop_info_get(pass_manager, function);
+
+    licm_memory memory = {0};
+
+    // loops come before the loops nested in them, so walking backwards goes from the inside out.
+    for (int64_t l = layec_loop_info_loop_count(loop_info) - 1; l >= 0; l--) {
+        layec_loop* loop = layec_loop_info_get_loop_at_index(loop_info, l);
+        layec_value* preheader = layec_loop_get_preheader(loop, cfg);
+        if (preheader == NULL) {
+            continue;
+        }
+
+        licm_find_memory_writes(loop, &memory);
+
+        int64_t hoisted_count = 0;
+        for (int64_t b = 0, bcount = layec_loop_block_count(loop); b < bcount; b++) {
+            layec_value* block = layec_loop_get_block_at_index(loop, b);
+            for (int64_t i = 0; i < layec_block_instruction_count(block); i++) {
+                layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+                if (!licm_can_hoist(dominator_tree, loop, &memory, instruction)) {
+                    continue;
+                }
+
+                layec_instruction_remove_from_parent(instruction);
+                layec_builder_position_before(builder, layec_block_get_instruction_at_index(preheader, layec_block_instruction_count(preheader) - 1));
+                layec_builder_insert(builder, instruction);
+                layec_builder_reset(builder);
+
+                hoisted_count++;
+                i--;
+            }
+        }
+
+        if (hoisted_count != 0) {
+            layec_pass_manager_remark(pass_manager, function, layec_loop_header(loop), "hoisted %lld instruction%s out of the loop", (long long)hoisted_count, hoisted_count == 1 ? "" : "s");
+            changed = true;
+        }
+    }
+
+    arr_free(memory.store_bases);
+    layec_builder_destroy(builder);
+
+    return changed;
+}
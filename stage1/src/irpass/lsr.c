@@ -0,0 +1,323 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Loop strength reduction.
+// An address computed in a loop as `ptradd base, i * size`, where `base` is defined outside the
+// loop and `i` is an induction variable stepping by a constant, is replaced by a pointer induction
+// variable of its own. It starts at the address for the first trip through the loop and is bumped by
+// `step * size` on every trip around it, so the multiply goes away.
+// NOTE(local): only loops with a preheader and one latch are handled; LICM runs first and gives
+// every loop a preheader and moves the invariant bases out.
+
+#include "layec.h"
+
+#include <assert.h>
+
+typedef struct lsr_induction_variable {
+    layec_value* phi;
+    layec_value* start;
+    int64_t step;
+} lsr_induction_variable;
+
+typedef struct lsr_pointer {
+    layec_value* base;
+    layec_value* induction_phi;
+    int64_t scale;
+    layec_value* phi;
+} lsr_pointer;
+
+typedef struct lsr_state {
+    layec_builder* builder;
+    layec_loop* loop;
+    layec_value* preheader;
+    layec_value* latch;
+
+    dynarr(lsr_induction_variable) induction_variables;
+    dynarr(lsr_pointer) pointers;
+} lsr_state;
+
+static bool lsr_is_int_constant(layec_value* value) {
+    return layec_value_get_kind(value) == LAYEC_IR_INTEGER_CONSTANT;
+}
+
+// finds `phi = [start, preheader], [phi + step, latch]` in the loop header.
+static void lsr_find_induction_variables(lsr_state* state) {
+    layec_value* header = layec_loop_header(state->loop);
+    arr_set_count(state->induction_variables, 0);
+
+    for (int64_t i = 0, icount = layec_block_instruction_count(header); i < icount; i++) {
+        layec_value* phi = layec_block_get_instruction_at_index(header, i);
+        if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+            break;
+        }
+
+        if (!layec_type_is_integer(layec_value_get_type(phi)) || layec_instruction_phi_incoming_value_count(phi) != 2) {
+            continue;
+        }
+
+        layec_value* start = NULL;
+        layec_value* next = NULL;
+        for (int64_t p = 0; p < 2; p++) {
+            layec_value* block = layec_instruction_phi_incoming_block_at_index(phi, p);
+            if (block == state->preheader) {
+                start = layec_instruction_phi_incoming_value_at_index(phi, p);
+            } else if (block == state->latch) {
+                next = layec_instruction_phi_incoming_value_at_index(phi, p);
+            }
+        }
+
+        if (start == NULL || next == NULL) {
+            continue;
+        }
+
+        layec_value_kind kind = layec_value_get_kind(next);
+        if (kind != LAYEC_IR_ADD && kind != LAYEC_IR_SUB) {
+            continue;
+        }
+
+        layec_value* lhs = layec_instruction_binary_get_lhs(next);
+        layec_value* rhs = layec_instruction_binary_get_rhs(next);
+
+        int64_t step = 0;
+        if (lhs == phi && lsr_is_int_constant(rhs)) {
+            step = kind == LAYEC_IR_ADD ? layec_value_integer_constant(rhs) : -layec_value_integer_constant(rhs);
+        } else if (kind == LAYEC_IR_ADD && rhs == phi && lsr_is_int_constant(lhs)) {
+            step = layec_value_integer_constant(lhs);
+        } else {
+            continue;
+        }
+
+        lsr_induction_variable induction_variable = {
+            .phi = phi,
+            .start = start,
+            .step = step,
+        };
+
+        arr_push(state->induction_variables, induction_variable);
+    }
+}
+
+static lsr_induction_variable* lsr_get_induction_variable(lsr_state* state, layec_value* value) {
+    for (int64_t i = 0; i < arr_count(state->induction_variables); i++) {
+        if (state->induction_variables[i].phi == value) {
+            return &state->induction_variables[i];
+        }
+    }
+
+    return NULL;
+}
+
+// matches an offset of `i`, `i * scale`, `scale * i` or `i << shift` for an induction variable `i`.
+static lsr_induction_variable* lsr_match_offset(lsr_state* state, layec_value* offset, int64_t* scale) {
+    *scale = 1;
+
+    lsr_induction_variable* induction_variable = lsr_get_induction_variable(state, offset);
+    if (induction_variable != NULL) {
+        return induction_variable;
+    }
+
+    layec_value_kind kind = layec_value_get_kind(offset);
+    if (kind != LAYEC_IR_MUL && kind != LAYEC_IR_SHL) {
+        return NULL;
+    }
+
+    layec_value* lhs = layec_instruction_binary_get_lhs(offset);
+    layec_value* rhs = layec_instruction_binary_get_rhs(offset);
+
+    if (kind == LAYEC_IR_MUL && lsr_is_int_constant(lhs)) {
+        layec_value* temp = lhs;
+        lhs = rhs;
+        rhs = temp;
+    }
+
+    induction_variable = lsr_get_induction_variable(state, lhs);
+    if (induction_variable == NULL || !lsr_is_int_constant(rhs)) {
+        return NULL;
+    }
+
+    int64_t constant = layec_value_integer_constant(rhs);
+    if (kind == LAYEC_IR_SHL) {
+        if (constant < 0 || constant >= 63) {
+            return NULL;
+        }
+
+        constant = (int64_t)1 << constant;
+    }
+
+    *scale = constant;
+    return induction_variable;
+}
+
+static layec_value* lsr_get_pointer(lsr_state* state, layec_value* address, layec_value* base, lsr_induction_variable* induction_variable, int64_t scale) {
+    for (int64_t p = 0; p < arr_count(state->pointers); p++) {
+        lsr_pointer* pointer = &state->pointers[p];
+        if (pointer->base == base && pointer->induction_phi == induction_variable->phi && pointer->scale == scale) {
+            return pointer->phi;
+        }
+    }
+
+    layec_location location = layec_value_location(address);
+    layec_type* offset_type = layec_value_get_type(induction_variable->phi);
+
+    // the start is computed in the preheader, where both the base and the start of `i` are available.
+    layec_builder_position_before(state->builder, layec_block_get_instruction_at_index(state->preheader, layec_block_instruction_count(state->preheader) - 1));
+    layec_value* start_offset = layec_build_mul(state->builder, location, induction_variable->start, layec_int_constant(layec_builder_get_context(state->builder), location, offset_type, scale));
+    layec_value* start = base;
+    if (!lsr_is_int_constant(start_offset) || layec_value_integer_constant(start_offset) != 0) {
+        start = layec_build_ptradd(state->builder, location, base, start_offset);
+    }
+
+    layec_value* header = layec_loop_header(state->loop);
+    layec_builder_position_before(state->builder, layec_block_get_instruction_at_index(header, 0));
+    layec_value* phi = layec_build_phi(state->builder, location, layec_value_get_type(address));
+
+    layec_builder_position_before(state->builder, layec_block_get_instruction_at_index(state->latch, layec_block_instruction_count(state->latch) - 1));
+    layec_value* stride = layec_int_constant(layec_builder_get_context(state->builder), location, offset_type, (int64_t)((uint64_t)induction_variable->step * (uint64_t)scale));
+    layec_value* next = layec_build_ptradd(state->builder, location, phi, stride);
+    layec_builder_reset(state->builder);
+
+    layec_instruction_phi_add_incoming_value(phi, start, state->preheader);
+    layec_instruction_phi_add_incoming_value(phi, next, state->latch);
+
+    lsr_pointer pointer = {
+        .base = base,
+        .induction_phi = induction_variable->phi,
+        .scale = scale,
+        .phi = phi,
+    };
+
+    arr_push(state->pointers, pointer);
+    return phi;
+}
+
+static int64_t lsr_loop(lsr_state* state) {
+    layec_loop* loop = state->loop;
+    arr_set_count(state->pointers, 0);
+
+    lsr_find_induction_variables(state);
+    if (arr_count(state->induction_variables) == 0) {
+        return 0;
+    }
+
+    int64_t reduced_count = 0;
+    for (int64_t b = 0, bcount = layec_loop_block_count(loop); b < bcount; b++) {
+        layec_value* block = layec_loop_get_block_at_index(loop, b);
+        for (int64_t i = 0; i < layec_block_instruction_count(block); i++) {
+            layec_value* address = layec_block_get_instruction_at_index(block, i);
+            if (layec_value_get_kind(address) != LAYEC_IR_PTRADD) {
+                continue;
+            }
+
+            layec_value* base = layec_instruction_ptradd_get_address(address);
+            layec_value* base_block = layec_instruction_get_parent_block(base);
+            if (base_block != NULL && layec_loop_contains(loop, base_block)) {
+                continue;
+            }
+
+            // the offset has to be as wide as the pointer for the bumped pointer to wrap the same way.
+            layec_value* offset = layec_instruction_ptradd_get_offset(address);
+            if (layec_type_size_in_bits(layec_value_get_type(offset)) != layec_type_size_in_bits(layec_value_get_type(address))) {
+                continue;
+            }
+
+            int64_t scale = 0;
+            lsr_induction_variable* induction_variable = lsr_match_offset(state, offset, &scale);
+            if (induction_variable == NULL) {
+                continue;
+            }
+
+            // the new pointer has the value of the address on the same trip through the loop, which is only
+            // true inside it; after the loop exits, the pointer may have been bumped one more time.
+            layec_value* pointer = lsr_get_pointer(state, address, base, induction_variable, scale);
+            for (layec_use* use = layec_value_first_use(address), *next = NULL; use != NULL; use = next) {
+                next = layec_use_next(use);
+                layec_value* user = layec_use_get_user(use);
+                if (layec_loop_contains(loop, layec_instruction_get_parent_block(user))) {
+                    layec_instruction_set_operand_at_index(user, layec_use_operand_index(use), pointer);
+                }
+            }
+
+            reduced_count++;
+        }
+    }
+
+    return reduced_count;
+}
+
+bool layec_irpass_lsr_function(layec_pass_manager* pass_manager, layec_value* function) {
+    assert(pass_manager != NULL);
+    assert(function != NULL);
+
+    layec_context* context = layec_value_context(function);
+    assert(context != NULL);
+
+    // only instructions are added, so neither analysis goes stale while this runs.
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    layec_loop_info* loop_info = layec_loop_info_get(pass_manager, function);
+
+    lsr_state state = {
+        .builder = layec_builder_create(context),
+    };
+
+    bool changed = false;
+    for (int64_t l = 0, lcount = layec_loop_info_loop_count(loop_info); l < lcount; l++) {
+        layec_loop* loop = layec_loop_info_get_loop_at_index(loop_info, l);
+        layec_value* preheader = layec_loop_get_preheader(loop, cfg);
+        if (preheader == NULL || layec_loop_latch_count(loop) != 1 || layec_cfg_predecessor_count(cfg, layec_loop_header(loop)) != 2) {
+            continue;
+        }
+
+        state.loop = loop;
+        state.preheader = preheader;
+        state.latch = layec_loop_get_latch_at_index(loop, 0);
+
+        int64_t reduced_count = lsr_loop(&state);
+        if (reduced_count != 0) {
+            layec_pass_manager_remark(pass_manager, function, layec_loop_header(loop), "replaced %lld address computation%s with pointer increments", (long long)reduced_count, reduced_count == 1 ? "" : "s");
+            changed = true;
+        }
+    }
+
+    arr_free(state.induction_variables);
+    arr_free(state.pointers);
+    layec_builder_destroy(state.builder);
+
+    return changed;
+}
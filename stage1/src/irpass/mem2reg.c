@@ -0,0 +1,560 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Promotes stack slots to SSA values.
+// An alloca of a single int, float or pointer is promotable when it is only ever loaded from,
+// stored to or zeroed with a memset of its exact size. Phis are placed on the iterated dominance
+// frontier of the blocks which define the slot, then every load is replaced by the value reaching it
+// while walking the dominator tree.
+
+#include "layec.h"
+
+#include <assert.h>
+#include <string.h>
+
+typedef struct mem2reg_phi {
+    layec_value* phi;
+    int64_t slot_index;
+} mem2reg_phi;
+
+typedef struct mem2reg_slot {
+    layec_value* alloca;
+    layec_type* type;
+    bool escapes;
+    dynarr(int64_t) def_blocks;
+} mem2reg_slot;
+
+typedef struct mem2reg_block {
+    layec_value* block;
+    dynarr(mem2reg_phi) phis;
+    int64_t phi_stamp;
+    int64_t work_stamp;
+} mem2reg_block;
+
+typedef struct mem2reg_undo {
+    int64_t slot_index;
+    layec_value* previous_value;
+} mem2reg_undo;
+
+typedef struct mem2reg_state {
+    layec_context* context;
+    layec_builder* builder;
+    layec_pass_manager* pass_manager;
+    layec_value* function;
+
+    layec_cfg* cfg;
+    layec_dominator_tree* dominator_tree;
+    layec_dominance_frontier* dominance_frontier;
+
+    dynarr(mem2reg_slot) slots;
+    dynarr(mem2reg_block) blocks;
+
+    // alloca -> slot index + 1
+    ptrmap slot_lookup;
+    // every phi inserted by this pass, so unused ones can be removed again
+    ptrmap inserted_phis;
+
+    dynarr(layec_value*) current_values;
+    dynarr(mem2reg_undo) undo_log;
+} mem2reg_state;
+
+static bool mem2reg_function(mem2reg_state* state, layec_value* function);
+
+void layec_irpass_mem2reg(layec_module* module) {
+    assert(module != NULL);
+
+    // the analyses are only ever requested through a pass manager, so run on a private one.
+    layec_pass_manager* pass_manager = layec_pass_manager_create(layec_module_context(module));
+    for (int64_t i = 0, count = layec_module_function_count(module); i < count; i++) {
+        layec_irpass_mem2reg_function(pass_manager, layec_module_get_function_at_index(module, i));
+    }
+
+    layec_pass_manager_destroy(pass_manager);
+    layec_irpass_validate(module);
+}
+
+bool layec_irpass_mem2reg_function(layec_pass_manager* pass_manager, layec_value* function) {
+    assert(pass_manager != NULL);
+    assert(function != NULL);
+    if (layec_function_block_count(function) == 0) {
+        return false;
+    }
+
+    layec_context* context = layec_value_context(function);
+    assert(context != NULL);
+
+    mem2reg_state state = {
+        .context = context,
+        .builder = layec_builder_create(context),
+        .pass_manager = pass_manager,
+    };
+
+    bool changed = mem2reg_function(&state, function);
+
+    arr_free(state.slots);
+    arr_free(state.blocks);
+    ptrmap_free(&state.slot_lookup);
+    ptrmap_free(&state.inserted_phis);
+    arr_free(state.current_values);
+    arr_free(state.undo_log);
+
+    layec_builder_destroy(state.builder);
+    return changed;
+}
+
+static mem2reg_slot* mem2reg_get_slot(mem2reg_state* state, layec_value* value) {
+    int64_t slot_index = (int64_t)(intptr_t)ptrmap_get(&state->slot_lookup, value) - 1;
+    if (slot_index < 0) {
+        return NULL;
+    }
+
+    return &state->slots[slot_index];
+}
+
+static int64_t mem2reg_slot_index(mem2reg_state* state, mem2reg_slot* slot) {
+    return (int64_t)(slot - state->slots);
+}
+
+static bool mem2reg_is_promotable_type(layec_type* type) {
+    return layec_type_is_integer(type) || layec_type_is_float(type) || layec_type_is_ptr(type);
+}
+
+static bool mem2reg_is_int_constant(layec_value* value, int64_t constant) {
+    return layec_value_get_kind(value) == LAYEC_IR_INTEGER_CONSTANT && layec_value_integer_constant(value) == constant;
+}
+
+// a memset which writes zero over exactly the whole slot is just a store of zero.
+static bool mem2reg_is_zeroing_memset(mem2reg_slot* slot, layec_value* memset) {
+    if (layec_value_get_kind(memset) != LAYEC_IR_BUILTIN || layec_instruction_builtin_kind(memset) != LAYEC_BUILTIN_MEMSET) {
+        return false;
+    }
+
+    assert(layec_instruction_builtin_argument_count(memset) == 3);
+    if (layec_instruction_builtin_get_argument_at_index(memset, 0) != slot->alloca) {
+        return false;
+    }
+
+    // NOTE(local): there's no way to build a zero pointer constant here, so pointer slots stay in memory.
+    if (!layec_type_is_integer(slot->type) && !layec_type_is_float(slot->type)) {
+        return false;
+    }
+
+    return mem2reg_is_int_constant(layec_instruction_builtin_get_argument_at_index(memset, 1), 0) &&
+           mem2reg_is_int_constant(layec_instruction_builtin_get_argument_at_index(memset, 2), layec_type_size_in_bytes(slot->type));
+}
+
+static layec_value* mem2reg_zero_value(mem2reg_state* state, mem2reg_slot* slot) {
+    layec_location location = layec_value_location(slot->alloca);
+    if (layec_type_is_float(slot->type)) {
+        return layec_float_constant(state->context, location, slot->type, 0.0);
+    }
+
+    return layec_int_constant(state->context, location, slot->type, 0);
+}
+
+static void mem2reg_find_slots(mem2reg_state* state) {
+    layec_value* function = state->function;
+
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (layec_value_get_kind(instruction) != LAYEC_IR_ALLOCA) {
+                continue;
+            }
+
+            layec_type* element_type = layec_instruction_get_alloca_type(instruction);
+            if (layec_instruction_get_alloca_element_count(instruction) != 1 || !mem2reg_is_promotable_type(element_type)) {
+                continue;
+            }
+
+            mem2reg_slot slot = {
+                .alloca = instruction,
+                .type = element_type,
+            };
+
+            arr_push(state->slots, slot);
+            ptrmap_set(&state->slot_lookup, instruction, (void*)(intptr_t)arr_count(state->slots));
+        }
+    }
+
+    if (arr_count(state->slots) == 0) {
+        return;
+    }
+
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            layec_value_kind kind = layec_value_get_kind(instruction);
+
+            for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+                mem2reg_slot* slot = mem2reg_get_slot(state, layec_instruction_get_operand_at_index(instruction, o));
+                if (slot == NULL || slot->escapes) {
+                    continue;
+                }
+
+                if (kind == LAYEC_IR_LOAD && layec_value_get_type(instruction) == slot->type) {
+                    continue;
+                }
+
+                if (kind == LAYEC_IR_STORE && o == 0 && layec_value_get_type(layec_instruction_get_operand(instruction)) == slot->type) {
+                    arr_push(slot->def_blocks, b);
+                    continue;
+                }
+
+                if (o == 0 && mem2reg_is_zeroing_memset(slot, instruction)) {
+                    arr_push(slot->def_blocks, b);
+                    continue;
+                }
+
+                slot->escapes = true;
+            }
+        }
+    }
+}
+
+static void mem2reg_init_blocks(mem2reg_state* state) {
+    layec_value* function = state->function;
+    int64_t block_count = layec_function_block_count(function);
+
+    state->cfg = layec_cfg_get(state->pass_manager, function);
+    state->dominator_tree = layec_dominator_tree_get(state->pass_manager, function);
+    state->dominance_frontier = layec_dominance_frontier_get(state->pass_manager, function);
+
+    arr_set_count(state->blocks, block_count);
+    memset(state->blocks, 0, (size_t)block_count * sizeof *state->blocks);
+
+    for (int64_t b = 0; b < block_count; b++) {
+        state->blocks[b].block = layec_function_get_block_at_index(function, b);
+        assert(layec_block_index(state->blocks[b].block) == b);
+    }
+}
+
+static void mem2reg_place_phis(mem2reg_state* state) {
+    dynarr(int64_t) worklist = NULL;
+
+    for (int64_t s = 0; s < arr_count(state->slots); s++) {
+        mem2reg_slot* slot = &state->slots[s];
+        if (slot->escapes) {
+            continue;
+        }
+
+        int64_t stamp = s + 1;
+        arr_set_count(worklist, 0);
+
+        for (int64_t d = 0; d < arr_count(slot->def_blocks); d++) {
+            int64_t b = slot->def_blocks[d];
+            if (!layec_cfg_is_reachable(state->cfg, state->blocks[b].block) || state->blocks[b].work_stamp == stamp) {
+                continue;
+            }
+
+            state->blocks[b].work_stamp = stamp;
+            arr_push(worklist, b);
+        }
+
+        while (arr_count(worklist) > 0) {
+            int64_t b = *arr_back(worklist);
+            arr_pop(worklist);
+
+            layec_value* block = state->blocks[b].block;
+            for (int64_t f = 0, fcount = layec_dominance_frontier_count(state->dominance_frontier, block); f < fcount; f++) {
+                int64_t frontier_index = layec_block_index(layec_dominance_frontier_get_block_at_index(state->dominance_frontier, block, f));
+                mem2reg_block* frontier_block = &state->blocks[frontier_index];
+                if (frontier_block->phi_stamp == stamp) {
+                    continue;
+                }
+
+                frontier_block->phi_stamp = stamp;
+
+                assert(layec_block_instruction_count(frontier_block->block) > 0);
+                layec_builder_position_before(state->builder, layec_block_get_instruction_at_index(frontier_block->block, 0));
+                layec_value* phi = layec_build_phi(state->builder, layec_value_location(slot->alloca), slot->type);
+                layec_builder_reset(state->builder);
+
+                mem2reg_phi block_phi = {
+                    .phi = phi,
+                    .slot_index = s,
+                };
+
+                arr_push(frontier_block->phis, block_phi);
+                ptrmap_set(&state->inserted_phis, phi, phi);
+
+                if (frontier_block->work_stamp != stamp) {
+                    frontier_block->work_stamp = stamp;
+                    arr_push(worklist, frontier_index);
+                }
+            }
+        }
+    }
+
+    arr_free(worklist);
+}
+
+static layec_value* mem2reg_current_value(mem2reg_state* state, int64_t slot_index) {
+    layec_value* value = state->current_values[slot_index];
+    if (value == NULL) {
+        mem2reg_slot* slot = &state->slots[slot_index];
+        value = layec_poison_constant(state->context, layec_value_location(slot->alloca), slot->type);
+        state->current_values[slot_index] = value;
+    }
+
+    return value;
+}
+
+static void mem2reg_set_current_value(mem2reg_state* state, int64_t slot_index, layec_value* value) {
+    mem2reg_undo undo = {
+        .slot_index = slot_index,
+        .previous_value = state->current_values[slot_index],
+    };
+
+    arr_push(state->undo_log, undo);
+    state->current_values[slot_index] = value;
+}
+
+static void mem2reg_fill_successor_phis(mem2reg_state* state, layec_value* block) {
+    for (int64_t s = 0, scount = layec_block_successor_count(block); s < scount; s++) {
+        mem2reg_block* successor = &state->blocks[layec_block_index(layec_block_get_successor_at_index(block, s))];
+        for (int64_t p = 0; p < arr_count(successor->phis); p++) {
+            mem2reg_phi block_phi = successor->phis[p];
+            layec_value* value = mem2reg_current_value(state, block_phi.slot_index);
+            layec_instruction_phi_add_incoming_value(block_phi.phi, value, block);
+        }
+    }
+}
+
+static void mem2reg_rename_block(mem2reg_state* state, int64_t b) {
+    mem2reg_block* block = &state->blocks[b];
+
+    for (int64_t p = 0; p < arr_count(block->phis); p++) {
+        mem2reg_set_current_value(state, block->phis[p].slot_index, block->phis[p].phi);
+    }
+
+    for (int64_t i = 0, icount = layec_block_instruction_count(block->block); i < icount; i++) {
+        layec_value* instruction = layec_block_get_instruction_at_index(block->block, i);
+        switch (layec_value_get_kind(instruction)) {
+            default: break;
+
+            case LAYEC_IR_LOAD: {
+                mem2reg_slot* slot = mem2reg_get_slot(state, layec_instruction_get_address(instruction));
+                if (slot == NULL || slot->escapes) {
+                    break;
+                }
+
+                // if the value is a load which is only replaced later (in an unreachable block), its
+                // replacement still reaches these uses, since they become uses of that load here.
+                layec_value* value = mem2reg_current_value(state, mem2reg_slot_index(state, slot));
+                layec_value_replace_all_uses_with(instruction, value);
+                layec_instruction_mark_for_removal(instruction);
+            } break;
+
+            case LAYEC_IR_STORE: {
+                mem2reg_slot* slot = mem2reg_get_slot(state, layec_instruction_get_address(instruction));
+                if (slot == NULL || slot->escapes) {
+                    break;
+                }
+
+                layec_value* value = layec_instruction_get_operand(instruction);
+                mem2reg_set_current_value(state, mem2reg_slot_index(state, slot), value);
+                layec_instruction_mark_for_removal(instruction);
+            } break;
+
+            case LAYEC_IR_BUILTIN: {
+                if (layec_instruction_builtin_argument_count(instruction) == 0) {
+                    break;
+                }
+
+                mem2reg_slot* slot = mem2reg_get_slot(state, layec_instruction_builtin_get_argument_at_index(instruction, 0));
+                if (slot == NULL || slot->escapes || !mem2reg_is_zeroing_memset(slot, instruction)) {
+                    break;
+                }
+
+                mem2reg_set_current_value(state, mem2reg_slot_index(state, slot), mem2reg_zero_value(state, slot));
+                layec_instruction_mark_for_removal(instruction);
+            } break;
+        }
+    }
+
+    mem2reg_fill_successor_phis(state, block->block);
+}
+
+static void mem2reg_rename(mem2reg_state* state) {
+    int64_t slot_count = arr_count(state->slots);
+    arr_set_count(state->current_values, slot_count);
+    memset(state->current_values, 0, (size_t)slot_count * sizeof *state->current_values);
+    arr_set_count(state->undo_log, 0);
+
+    // walk the dominator tree; a negative entry means "leave block -(entry + 1)".
+    // the undo log is rolled back to where it was when the block was entered.
+    dynarr(int64_t) stack = NULL;
+    dynarr(int64_t) undo_marks = NULL;
+    arr_push(stack, 0);
+
+    while (arr_count(stack) > 0) {
+        int64_t entry = *arr_back(stack);
+        arr_pop(stack);
+
+        if (entry < 0) {
+            int64_t undo_mark = *arr_back(undo_marks);
+            arr_pop(undo_marks);
+
+            while (arr_count(state->undo_log) > undo_mark) {
+                mem2reg_undo undo = *arr_back(state->undo_log);
+                arr_pop(state->undo_log);
+                state->current_values[undo.slot_index] = undo.previous_value;
+            }
+
+            continue;
+        }
+
+        arr_push(undo_marks, arr_count(state->undo_log));
+        mem2reg_rename_block(state, entry);
+
+        arr_push(stack, -(entry + 1));
+        layec_value* block = state->blocks[entry].block;
+        for (int64_t c = layec_dominator_tree_child_count(state->dominator_tree, block) - 1; c >= 0; c--) {
+            arr_push(stack, layec_block_index(layec_dominator_tree_get_child_at_index(state->dominator_tree, block, c)));
+        }
+    }
+
+    arr_free(stack);
+    arr_free(undo_marks);
+
+    // unreachable blocks have no reaching definitions, so every load there is poison.
+    // they can still branch into reachable blocks, and those edges need phi entries too.
+    for (int64_t b = 0; b < arr_count(state->blocks); b++) {
+        if (layec_cfg_is_reachable(state->cfg, state->blocks[b].block)) {
+            continue;
+        }
+
+        memset(state->current_values, 0, (size_t)slot_count * sizeof *state->current_values);
+        mem2reg_rename_block(state, b);
+        arr_set_count(state->undo_log, 0);
+    }
+}
+
+// phis are placed on the whole iterated frontier, so many of them are never read.
+// a phi is kept only if something other than an unused phi depends on it.
+static void mem2reg_remove_unused_phis(mem2reg_state* state) {
+    layec_value* function = state->function;
+
+    ptrmap live_phis = {0};
+    dynarr(layec_value*) worklist = NULL;
+
+    for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, i);
+            if (layec_instruction_is_marked_for_removal(instruction) || ptrmap_contains(&state->inserted_phis, instruction)) {
+                continue;
+            }
+
+            for (int64_t o = 0, ocount = layec_instruction_operand_count(instruction); o < ocount; o++) {
+                layec_value* operand = layec_instruction_get_operand_at_index(instruction, o);
+                if (ptrmap_contains(&state->inserted_phis, operand) && !ptrmap_contains(&live_phis, operand)) {
+                    ptrmap_set(&live_phis, operand, operand);
+                    arr_push(worklist, operand);
+                }
+            }
+        }
+    }
+
+    while (arr_count(worklist) > 0) {
+        layec_value* phi = *arr_back(worklist);
+        arr_pop(worklist);
+
+        for (int64_t o = 0, ocount = layec_instruction_operand_count(phi); o < ocount; o++) {
+            layec_value* operand = layec_instruction_get_operand_at_index(phi, o);
+            if (ptrmap_contains(&state->inserted_phis, operand) && !ptrmap_contains(&live_phis, operand)) {
+                ptrmap_set(&live_phis, operand, operand);
+                arr_push(worklist, operand);
+            }
+        }
+    }
+
+    for (int64_t b = 0; b < arr_count(state->blocks); b++) {
+        mem2reg_block* block = &state->blocks[b];
+        for (int64_t p = 0; p < arr_count(block->phis); p++) {
+            if (!ptrmap_contains(&live_phis, block->phis[p].phi)) {
+                layec_instruction_mark_for_removal(block->phis[p].phi);
+            }
+        }
+    }
+
+    ptrmap_free(&live_phis);
+    arr_free(worklist);
+}
+
+static bool mem2reg_function(mem2reg_state* state, layec_value* function) {
+    assert(function != NULL);
+    state->function = function;
+
+    mem2reg_find_slots(state);
+
+    bool has_promotable_slots = false;
+    for (int64_t s = 0; s < arr_count(state->slots); s++) {
+        has_promotable_slots |= !state->slots[s].escapes;
+    }
+
+    if (has_promotable_slots) {
+        mem2reg_init_blocks(state);
+        mem2reg_place_phis(state);
+        mem2reg_rename(state);
+        mem2reg_remove_unused_phis(state);
+
+        for (int64_t s = 0; s < arr_count(state->slots); s++) {
+            if (!state->slots[s].escapes) {
+                layec_instruction_mark_for_removal(state->slots[s].alloca);
+            }
+        }
+
+        layec_function_remove_marked_instructions(function);
+    }
+
+    for (int64_t s = 0; s < arr_count(state->slots); s++) {
+        arr_free(state->slots[s].def_blocks);
+    }
+
+    for (int64_t b = 0; b < arr_count(state->blocks); b++) {
+        arr_free(state->blocks[b].phis);
+    }
+
+    return has_promotable_slots;
+}
@@ -0,0 +1,511 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Instruction simplification: folds operations on constants and applies algebraic identities.
+// When optimizing, `layec_simplify_unary` and `layec_simplify_binary` are used by the builder, so
+// most of this happens as the IR is generated; the pass catches what only becomes constant later,
+// like the loads mem2reg replaces with stored constants.
+
+#include "layec.h"
+
+#include <assert.h>
+#include <math.h>
+
+static bool simplify_is_int_constant(layec_value* value) {
+    return layec_value_get_kind(value) == LAYEC_IR_INTEGER_CONSTANT && layec_type_is_integer(layec_value_get_type(value));
+}
+
+static bool simplify_is_float_constant(layec_value* value) {
+    return layec_value_get_kind(value) == LAYEC_IR_FLOAT_CONSTANT;
+}
+
+// integer constants of up to 64 bits are folded; wider ones are left alone.
+static int simplify_foldable_bit_width(layec_type* type) {
+    if (!layec_type_is_integer(type)) return 0;
+    int bit_width = layec_type_size_in_bits(type);
+    return bit_width <= 64 ? bit_width : 0;
+}
+
+static uint64_t simplify_unsigned_value(int64_t value, int bit_width) {
+    assert(bit_width > 0 && bit_width <= 64);
+    if (bit_width == 64) return (uint64_t)value;
+    return (uint64_t)value & ((UINT64_C(1) << bit_width) - 1);
+}
+
+static int64_t simplify_signed_value(int64_t value, int bit_width) {
+    uint64_t sign_bit = UINT64_C(1) << (bit_width - 1);
+    return (int64_t)((simplify_unsigned_value(value, bit_width) ^ sign_bit) - sign_bit);
+}
+
+static layec_value* simplify_int_result(layec_context* context, layec_location location, layec_type* type, uint64_t value) {
+    int bit_width = simplify_foldable_bit_width(type);
+    assert(bit_width > 0);
+
+    // booleans are 0 or 1, every other width is stored sign extended, the same as irgen writes them.
+    int64_t canonical_value = bit_width == 1 ? (int64_t)(value & 1) : simplify_signed_value((int64_t)value, bit_width);
+    return layec_int_constant(context, location, type, canonical_value);
+}
+
+// NOTE(local): the backends print non-integral floats with "%f", which loses precision, so only
+// folds with an exactly printable result are allowed.
+static layec_value* simplify_float_result(layec_context* context, layec_location location, layec_type* type, double value) {
+    if (!(value >= -9007199254740992.0 && value <= 9007199254740992.0) || (double)(int64_t)value != value) {
+        return NULL;
+    }
+
+    if (value == 0 && signbit(value)) {
+        return NULL;
+    }
+
+    if (layec_type_size_in_bits(type) == 32 && (double)(float)value != value) {
+        return NULL;
+    }
+
+    return layec_float_constant(context, location, type, value);
+}
+
+static layec_value* simplify_fold_unary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* operand, layec_type* type) {
+    layec_type* operand_type = layec_value_get_type(operand);
+
+    if (simplify_is_int_constant(operand)) {
+        int operand_bit_width = simplify_foldable_bit_width(operand_type);
+        if (operand_bit_width == 0) return NULL;
+
+        int64_t value = layec_value_integer_constant(operand);
+        switch (kind) {
+            default: return NULL;
+
+            case LAYEC_IR_ZEXT: {
+                if (simplify_foldable_bit_width(type) == 0) return NULL;
+                return simplify_int_result(context, location, type, simplify_unsigned_value(value, operand_bit_width));
+            }
+
+            case LAYEC_IR_SEXT: {
+                if (simplify_foldable_bit_width(type) == 0) return NULL;
+                return simplify_int_result(context, location, type, (uint64_t)simplify_signed_value(value, operand_bit_width));
+            }
+
+            case LAYEC_IR_TRUNC: {
+                if (simplify_foldable_bit_width(type) == 0) return NULL;
+                return simplify_int_result(context, location, type, (uint64_t)value);
+            }
+
+            case LAYEC_IR_NEG: return simplify_int_result(context, location, type, 0 - (uint64_t)value);
+            case LAYEC_IR_COMPL: return simplify_int_result(context, location, type, ~(uint64_t)value);
+
+            case LAYEC_IR_SITOFP: {
+                double float_value = (double)simplify_signed_value(value, operand_bit_width);
+                return simplify_float_result(context, location, type, float_value);
+            }
+
+            case LAYEC_IR_UITOFP: {
+                double float_value = (double)simplify_unsigned_value(value, operand_bit_width);
+                return simplify_float_result(context, location, type, float_value);
+            }
+        }
+    }
+
+    if (simplify_is_float_constant(operand)) {
+        double value = layec_value_float_constant(operand);
+        switch (kind) {
+            default: return NULL;
+
+            case LAYEC_IR_NEG: return simplify_float_result(context, location, type, -value);
+            case LAYEC_IR_FPEXT:
+            case LAYEC_IR_FPTRUNC: return simplify_float_result(context, location, type, value);
+
+            case LAYEC_IR_FPTOSI: {
+                int bit_width = simplify_foldable_bit_width(type);
+                if (bit_width == 0 || value != value) return NULL;
+
+                // out of range conversions are poison, so those are left for the backend to deal with.
+                double limit = (double)(UINT64_C(1) << (bit_width - 1));
+                if (value <= -limit - 1 || value >= limit) return NULL;
+                return simplify_int_result(context, location, type, (uint64_t)(int64_t)value);
+            }
+
+            case LAYEC_IR_FPTOUI: {
+                int bit_width = simplify_foldable_bit_width(type);
+                if (bit_width == 0 || value != value) return NULL;
+
+                double limit = 2.0 * (double)(UINT64_C(1) << (bit_width - 1));
+                if (value <= -1 || value >= limit) return NULL;
+                return simplify_int_result(context, location, type, (uint64_t)value);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+layec_value* layec_simplify_unary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* operand, layec_type* type) {
+    assert(context != NULL);
+    assert(operand != NULL);
+    assert(type != NULL);
+
+    if (kind == LAYEC_IR_COPY) {
+        return operand;
+    }
+
+    if (kind == LAYEC_IR_BITCAST && layec_value_get_type(operand) == type) {
+        return operand;
+    }
+
+    return simplify_fold_unary(context, location, kind, operand, type);
+}
+
+static layec_value* simplify_fold_int_binary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* lhs, layec_value* rhs, layec_type* type) {
+    int bit_width = simplify_foldable_bit_width(layec_value_get_type(lhs));
+    if (bit_width == 0) return NULL;
+
+    uint64_t a = simplify_unsigned_value(layec_value_integer_constant(lhs), bit_width);
+    uint64_t b = simplify_unsigned_value(layec_value_integer_constant(rhs), bit_width);
+    int64_t sa = simplify_signed_value(layec_value_integer_constant(lhs), bit_width);
+    int64_t sb = simplify_signed_value(layec_value_integer_constant(rhs), bit_width);
+    int64_t signed_min = simplify_signed_value((int64_t)(UINT64_C(1) << (bit_width - 1)), bit_width);
+
+    switch (kind) {
+        default: return NULL;
+
+        case LAYEC_IR_ADD: return simplify_int_result(context, location, type, a + b);
+        case LAYEC_IR_SUB: return simplify_int_result(context, location, type, a - b);
+        case LAYEC_IR_MUL: return simplify_int_result(context, location, type, a * b);
+        case LAYEC_IR_AND: return simplify_int_result(context, location, type, a & b);
+        case LAYEC_IR_OR: return simplify_int_result(context, location, type, a | b);
+        case LAYEC_IR_XOR: return simplify_int_result(context, location, type, a ^ b);
+
+        // division by zero and the one overflowing signed division are undefined; leave them be.
+        case LAYEC_IR_SDIV: {
+            if (sb == 0 || (sa == signed_min && sb == -1)) return NULL;
+            return simplify_int_result(context, location, type, (uint64_t)(sa / sb));
+        }
+
+        case LAYEC_IR_SMOD: {
+            if (sb == 0 || (sa == signed_min && sb == -1)) return NULL;
+            return simplify_int_result(context, location, type, (uint64_t)(sa % sb));
+        }
+
+        case LAYEC_IR_UDIV: {
+            if (b == 0) return NULL;
+            return simplify_int_result(context, location, type, a / b);
+        }
+
+        case LAYEC_IR_UMOD: {
+            if (b == 0) return NULL;
+            return simplify_int_result(context, location, type, a % b);
+        }
+
+        // shifting by the bit width or more is poison.
+        case LAYEC_IR_SHL: {
+            if (b >= (uint64_t)bit_width) return NULL;
+            return simplify_int_result(context, location, type, a << b);
+        }
+
+        case LAYEC_IR_SHR: {
+            if (b >= (uint64_t)bit_width) return NULL;
+            return simplify_int_result(context, location, type, a >> b);
+        }
+
+        case LAYEC_IR_SAR: {
+            if (b >= (uint64_t)bit_width) return NULL;
+            // right shifting a negative value is implementation defined in C, so do it by hand.
+            uint64_t shifted = sa < 0 ? ~(~(uint64_t)sa >> b) : (uint64_t)sa >> b;
+            return simplify_int_result(context, location, type, shifted);
+        }
+
+        case LAYEC_IR_ICMP_EQ: return simplify_int_result(context, location, type, a == b);
+        case LAYEC_IR_ICMP_NE: return simplify_int_result(context, location, type, a != b);
+        case LAYEC_IR_ICMP_SLT: return simplify_int_result(context, location, type, sa < sb);
+        case LAYEC_IR_ICMP_SLE: return simplify_int_result(context, location, type, sa <= sb);
+        case LAYEC_IR_ICMP_SGT: return simplify_int_result(context, location, type, sa > sb);
+        case LAYEC_IR_ICMP_SGE: return simplify_int_result(context, location, type, sa >= sb);
+        case LAYEC_IR_ICMP_ULT: return simplify_int_result(context, location, type, a < b);
+        case LAYEC_IR_ICMP_ULE: return simplify_int_result(context, location, type, a <= b);
+        case LAYEC_IR_ICMP_UGT: return simplify_int_result(context, location, type, a > b);
+        case LAYEC_IR_ICMP_UGE: return simplify_int_result(context, location, type, a >= b);
+    }
+}
+
+static layec_value* simplify_fold_float_binary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* lhs, layec_value* rhs, layec_type* type) {
+    double a = layec_value_float_constant(lhs);
+    double b = layec_value_float_constant(rhs);
+    bool unordered = a != a || b != b;
+
+    switch (kind) {
+        default: return NULL;
+
+        case LAYEC_IR_FADD: return simplify_float_result(context, location, type, a + b);
+        case LAYEC_IR_FSUB: return simplify_float_result(context, location, type, a - b);
+        case LAYEC_IR_FMUL: return simplify_float_result(context, location, type, a * b);
+        case LAYEC_IR_FDIV: return simplify_float_result(context, location, type, a / b);
+
+        case LAYEC_IR_FCMP_FALSE: return simplify_int_result(context, location, type, 0);
+        case LAYEC_IR_FCMP_OEQ: return simplify_int_result(context, location, type, !unordered && a == b);
+        case LAYEC_IR_FCMP_OGT: return simplify_int_result(context, location, type, !unordered && a > b);
+        case LAYEC_IR_FCMP_OGE: return simplify_int_result(context, location, type, !unordered && a >= b);
+        case LAYEC_IR_FCMP_OLT: return simplify_int_result(context, location, type, !unordered && a < b);
+        case LAYEC_IR_FCMP_OLE: return simplify_int_result(context, location, type, !unordered && a <= b);
+        case LAYEC_IR_FCMP_ONE: return simplify_int_result(context, location, type, !unordered && a != b);
+        case LAYEC_IR_FCMP_ORD: return simplify_int_result(context, location, type, !unordered);
+        case LAYEC_IR_FCMP_UEQ: return simplify_int_result(context, location, type, unordered || a == b);
+        case LAYEC_IR_FCMP_UGT: return simplify_int_result(context, location, type, unordered || a > b);
+        case LAYEC_IR_FCMP_UGE: return simplify_int_result(context, location, type, unordered || a >= b);
+        case LAYEC_IR_FCMP_ULT: return simplify_int_result(context, location, type, unordered || a < b);
+        case LAYEC_IR_FCMP_ULE: return simplify_int_result(context, location, type, unordered || a <= b);
+        case LAYEC_IR_FCMP_UNE: return simplify_int_result(context, location, type, unordered || a != b);
+        case LAYEC_IR_FCMP_UNO: return simplify_int_result(context, location, type, unordered);
+        case LAYEC_IR_FCMP_TRUE: return simplify_int_result(context, location, type, 1);
+    }
+}
+
+static bool simplify_is_int_value(layec_value* value, int64_t constant) {
+    if (!simplify_is_int_constant(value)) return false;
+
+    int bit_width = simplify_foldable_bit_width(layec_value_get_type(value));
+    if (bit_width == 0) return false;
+
+    return simplify_unsigned_value(layec_value_integer_constant(value), bit_width) == simplify_unsigned_value(constant, bit_width);
+}
+
+static bool simplify_is_commutative(layec_value_kind kind) {
+    switch (kind) {
+        default: return false;
+
+        case LAYEC_IR_ADD:
+        case LAYEC_IR_MUL:
+        case LAYEC_IR_AND:
+        case LAYEC_IR_OR:
+        case LAYEC_IR_XOR:
+        case LAYEC_IR_ICMP_EQ:
+        case LAYEC_IR_ICMP_NE: return true;
+    }
+}
+
+// identities for integer operations where at most one side is constant.
+// floats are left alone, since x + 0.0 is not x when x is -0.0 and similar.
+static layec_value* simplify_int_identity(layec_context* context, layec_location location, layec_value_kind kind, layec_value* lhs, layec_value* rhs, layec_type* type) {
+    if (simplify_foldable_bit_width(layec_value_get_type(lhs)) == 0) {
+        return NULL;
+    }
+
+    // canonicalize constants to the right.
+    if (simplify_is_commutative(kind) && simplify_is_int_constant(lhs) && !simplify_is_int_constant(rhs)) {
+        layec_value* temp = lhs;
+        lhs = rhs;
+        rhs = temp;
+    }
+
+    if (lhs == rhs) {
+        switch (kind) {
+            default: break;
+
+            case LAYEC_IR_AND:
+            case LAYEC_IR_OR: return lhs;
+
+            case LAYEC_IR_SUB:
+            case LAYEC_IR_XOR: return simplify_int_result(context, location, type, 0);
+
+            case LAYEC_IR_ICMP_EQ:
+            case LAYEC_IR_ICMP_SLE:
+            case LAYEC_IR_ICMP_SGE:
+            case LAYEC_IR_ICMP_ULE:
+            case LAYEC_IR_ICMP_UGE: return simplify_int_result(context, location, type, 1);
+
+            case LAYEC_IR_ICMP_NE:
+            case LAYEC_IR_ICMP_SLT:
+            case LAYEC_IR_ICMP_SGT:
+            case LAYEC_IR_ICMP_ULT:
+            case LAYEC_IR_ICMP_UGT: return simplify_int_result(context, location, type, 0);
+        }
+    }
+
+    switch (kind) {
+        default: return NULL;
+
+        case LAYEC_IR_ADD:
+        case LAYEC_IR_SUB:
+        case LAYEC_IR_OR:
+        case LAYEC_IR_XOR:
+        case LAYEC_IR_SHL:
+        case LAYEC_IR_SHR:
+        case LAYEC_IR_SAR: {
+            if (simplify_is_int_value(rhs, 0)) return lhs;
+            if (kind == LAYEC_IR_OR && simplify_is_int_value(rhs, -1)) return rhs;
+            return NULL;
+        }
+
+        case LAYEC_IR_MUL: {
+            if (simplify_is_int_value(rhs, 1)) return lhs;
+            if (simplify_is_int_value(rhs, 0)) return rhs;
+            return NULL;
+        }
+
+        case LAYEC_IR_AND: {
+            if (simplify_is_int_value(rhs, -1)) return lhs;
+            if (simplify_is_int_value(rhs, 0)) return rhs;
+            return NULL;
+        }
+
+        case LAYEC_IR_SDIV:
+        case LAYEC_IR_UDIV: {
+            if (simplify_is_int_value(rhs, 1)) return lhs;
+            return NULL;
+        }
+
+        case LAYEC_IR_SMOD:
+        case LAYEC_IR_UMOD: {
+            if (simplify_is_int_value(rhs, 1)) return simplify_int_result(context, location, type, 0);
+            return NULL;
+        }
+    }
+}
+
+layec_value* layec_simplify_binary(layec_context* context, layec_location location, layec_value_kind kind, layec_value* lhs, layec_value* rhs, layec_type* type) {
+    assert(context != NULL);
+    assert(lhs != NULL);
+    assert(rhs != NULL);
+    assert(type != NULL);
+
+    if (simplify_is_int_constant(lhs) && simplify_is_int_constant(rhs)) {
+        return simplify_fold_int_binary(context, location, kind, lhs, rhs, type);
+    }
+
+    if (simplify_is_float_constant(lhs) && simplify_is_float_constant(rhs)) {
+        return simplify_fold_float_binary(context, location, kind, lhs, rhs, type);
+    }
+
+    return simplify_int_identity(context, location, kind, lhs, rhs, type);
+}
+
+// a phi whose incoming values are all the same value, ignoring itself, is that value.
+static layec_value* simplify_phi(layec_value* phi) {
+    layec_value* common_value = NULL;
+    for (int64_t i = 0, count = layec_instruction_phi_incoming_value_count(phi); i < count; i++) {
+        layec_value* value = layec_instruction_phi_incoming_value_at_index(phi, i);
+        if (value == phi || value == common_value) {
+            continue;
+        }
+
+        if (common_value != NULL) {
+            return NULL;
+        }
+
+        common_value = value;
+    }
+
+    return common_value;
+}
+
+static layec_value* simplify_instruction(layec_context* context, layec_value* instruction) {
+    layec_value_kind kind = layec_value_get_kind(instruction);
+    layec_location location = layec_value_location(instruction);
+    layec_type* type = layec_value_get_type(instruction);
+
+    if (kind == LAYEC_IR_PHI) {
+        return simplify_phi(instruction);
+    }
+
+    int64_t operand_count = layec_instruction_operand_count(instruction);
+    if (kind >= LAYEC_IR_ZEXT && kind <= LAYEC_IR_FPEXT) {
+        assert(operand_count == 1);
+        return layec_simplify_unary(context, location, kind, layec_instruction_get_operand_at_index(instruction, 0), type);
+    }
+
+    if (kind >= LAYEC_IR_ADD && kind <= LAYEC_IR_FCMP_TRUE) {
+        assert(operand_count == 2);
+        layec_value* lhs = layec_instruction_get_operand_at_index(instruction, 0);
+        layec_value* rhs = layec_instruction_get_operand_at_index(instruction, 1);
+        return layec_simplify_binary(context, location, kind, lhs, rhs, type);
+    }
+
+    return NULL;
+}
+
+bool layec_irpass_simplify_function(layec_pass_manager* pass_manager, layec_value* function) {
+    (void)pass_manager;
+    assert(function != NULL);
+    layec_context* context = layec_value_context(function);
+    assert(context != NULL);
+
+    bool changed = false;
+
+    // everything is looked at once, in order, then the users of anything replaced are looked at
+    // again since their operands changed; that covers values flowing around a loop to a phi.
+    dynarr(layec_value*) worklist = NULL;
+    for (int64_t b = layec_function_block_count(function) - 1; b >= 0; b--) {
+        layec_value* block = layec_function_get_block_at_index(function, b);
+        for (int64_t i = layec_block_instruction_count(block) - 1; i >= 0; i--) {
+            arr_push(worklist, layec_block_get_instruction_at_index(block, i));
+        }
+    }
+
+    while (arr_count(worklist) > 0) {
+        layec_value* instruction = *arr_back(worklist);
+        arr_pop(worklist);
+
+        if (layec_instruction_is_marked_for_removal(instruction)) {
+            continue;
+        }
+
+        layec_value* simplified = simplify_instruction(context, instruction);
+        if (simplified == NULL) {
+            continue;
+        }
+
+        for (layec_use* use = layec_value_first_use(instruction); use != NULL; use = layec_use_next(use)) {
+            layec_value* user = layec_use_get_user(use);
+            if (user != instruction) {
+                arr_push(worklist, user);
+            }
+        }
+
+        layec_value_replace_all_uses_with(instruction, simplified);
+        layec_instruction_mark_for_removal(instruction);
+        changed = true;
+    }
+
+    arr_free(worklist);
+
+    if (changed) {
+        layec_function_remove_marked_instructions(function);
+    }
+
+    return changed;
+}
@@ -0,0 +1,368 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Control flow simplification: folds conditional branches whose condition is known, merges blocks
+// into their only predecessor and threads jumps through blocks which do nothing but branch.
+// Each sweep works from one snapshot of the predecessors; anything a transformation touches is
+// marked dirty and left alone until the next sweep, when the predecessors are recomputed.
+
+#include "layec.h"
+
+#include <assert.h>
+
+typedef struct simplifycfg_block {
+    // one entry per incoming edge, so a conditional branching here on both sides appears twice.
+    dynarr(layec_value*) predecessors;
+    bool is_dirty;
+} simplifycfg_block;
+
+typedef struct simplifycfg_state {
+    layec_value* function;
+    layec_builder* builder;
+    dynarr(simplifycfg_block) blocks;
+} simplifycfg_state;
+
+static simplifycfg_block* simplifycfg_get_block(simplifycfg_state* state, layec_value* block) {
+    int64_t block_index = layec_block_index(block);
+    assert(block_index >= 0 && block_index < arr_count(state->blocks));
+    return &state->blocks[block_index];
+}
+
+static void simplifycfg_free_blocks(simplifycfg_state* state) {
+    for (int64_t b = 0; b < arr_count(state->blocks); b++) {
+        arr_free(state->blocks[b].predecessors);
+    }
+
+    arr_set_count(state->blocks, 0);
+}
+
+static void simplifycfg_compute_predecessors(simplifycfg_state* state) {
+    simplifycfg_free_blocks(state);
+
+    int64_t block_count = layec_function_block_count(state->function);
+    for (int64_t b = 0; b < block_count; b++) {
+        arr_push(state->blocks, (simplifycfg_block){0});
+    }
+
+    for (int64_t b = 0; b < block_count; b++) {
+        layec_value* block = layec_function_get_block_at_index(state->function, b);
+        for (int64_t s = 0, scount = layec_block_successor_count(block); s < scount; s++) {
+            simplifycfg_block* successor = simplifycfg_get_block(state, layec_block_get_successor_at_index(block, s));
+            arr_push(successor->predecessors, block);
+        }
+    }
+}
+
+static void simplifycfg_mark_dirty(simplifycfg_state* state, layec_value* block) {
+    simplifycfg_get_block(state, block)->is_dirty = true;
+}
+
+static bool simplifycfg_is_dirty(simplifycfg_state* state, layec_value* block) {
+    return simplifycfg_get_block(state, block)->is_dirty;
+}
+
+static bool simplifycfg_block_has_phis(layec_value* block) {
+    return layec_block_instruction_count(block) > 0 &&
+           layec_value_get_kind(layec_block_get_instruction_at_index(block, 0)) == LAYEC_IR_PHI;
+}
+
+// a block which only branches somewhere else.
+static bool simplifycfg_is_forwarding_block(layec_value* block) {
+    return layec_block_instruction_count(block) == 1 &&
+           layec_value_get_kind(layec_block_get_instruction_at_index(block, 0)) == LAYEC_IR_BRANCH;
+}
+
+// leaves at most `keep_count` of the phi entries for `predecessor` in `block`, once edges from it have been removed.
+static void simplifycfg_trim_phi_entries(layec_value* block, layec_value* predecessor, int64_t keep_count) {
+    for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+        layec_value* phi = layec_block_get_instruction_at_index(block, i);
+        if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+            break;
+        }
+
+        int64_t seen_count = 0;
+        for (int64_t p = 0; p < layec_instruction_phi_incoming_value_count(phi);) {
+            if (layec_instruction_phi_incoming_block_at_index(phi, p) != predecessor) {
+                p++;
+                continue;
+            }
+
+            seen_count++;
+            if (seen_count > keep_count) {
+                layec_instruction_phi_remove_incoming_value_at_index(phi, p);
+            } else {
+                p++;
+            }
+        }
+    }
+}
+
+static bool simplifycfg_fold_branch(simplifycfg_state* state, layec_value* block) {
+    if (layec_block_is_marked_for_removal(block) || !layec_block_is_terminated(block)) {
+        return false;
+    }
+
+    layec_value* terminator = layec_block_get_instruction_at_index(block, layec_block_instruction_count(block) - 1);
+    if (layec_value_get_kind(terminator) != LAYEC_IR_COND_BRANCH) {
+        return false;
+    }
+
+    layec_value* pass_block = layec_instruction_branch_get_pass(terminator);
+    layec_value* fail_block = layec_instruction_branch_get_fail(terminator);
+    layec_value* condition = layec_instruction_get_value(terminator);
+
+    layec_value* target = NULL;
+    layec_value* dropped = NULL;
+    if (pass_block == fail_block) {
+        target = pass_block;
+    } else if (layec_value_get_kind(condition) == LAYEC_IR_INTEGER_CONSTANT) {
+        bool condition_value = layec_value_integer_constant(condition) != 0;
+        target = condition_value ? pass_block : fail_block;
+        dropped = condition_value ? fail_block : pass_block;
+    } else {
+        return false;
+    }
+
+    layec_location location = layec_value_location(terminator);
+    layec_instruction_erase(terminator);
+    layec_builder_position_at_end(state->builder, block);
+    layec_build_branch(state->builder, location, target);
+
+    if (dropped != NULL) {
+        simplifycfg_trim_phi_entries(dropped, block, 0);
+        simplifycfg_mark_dirty(state, dropped);
+    } else {
+        simplifycfg_trim_phi_entries(target, block, 1);
+    }
+
+    simplifycfg_mark_dirty(state, block);
+    simplifycfg_mark_dirty(state, target);
+    return true;
+}
+
+static bool simplifycfg_merge_into_predecessor(simplifycfg_state* state, layec_value* block) {
+    simplifycfg_block* info = simplifycfg_get_block(state, block);
+    if (layec_block_index(block) == 0 || info->is_dirty || arr_count(info->predecessors) != 1) {
+        return false;
+    }
+
+    layec_value* predecessor = info->predecessors[0];
+    if (predecessor == block || simplifycfg_is_dirty(state, predecessor)) {
+        return false;
+    }
+
+    layec_value* predecessor_terminator = layec_block_get_instruction_at_index(predecessor, layec_block_instruction_count(predecessor) - 1);
+    if (layec_value_get_kind(predecessor_terminator) != LAYEC_IR_BRANCH) {
+        return false;
+    }
+
+    // with only one way in, every phi has exactly one value.
+    while (simplifycfg_block_has_phis(block)) {
+        layec_value* phi = layec_block_get_instruction_at_index(block, 0);
+        assert(layec_instruction_phi_incoming_value_count(phi) == 1);
+        layec_value_replace_all_uses_with(phi, layec_instruction_phi_incoming_value_at_index(phi, 0));
+        layec_instruction_erase(phi);
+    }
+
+    layec_instruction_erase(predecessor_terminator);
+    layec_block_move_instructions_to_end(block, predecessor);
+
+    for (int64_t s = 0, scount = layec_block_successor_count(predecessor); s < scount; s++) {
+        layec_value* successor = layec_block_get_successor_at_index(predecessor, s);
+        for (int64_t i = 0, icount = layec_block_instruction_count(successor); i < icount; i++) {
+            layec_value* phi = layec_block_get_instruction_at_index(successor, i);
+            if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+                break;
+            }
+
+            for (int64_t p = 0, pcount = layec_instruction_phi_incoming_value_count(phi); p < pcount; p++) {
+                if (layec_instruction_phi_incoming_block_at_index(phi, p) == block) {
+                    layec_instruction_phi_set_incoming_block_at_index(phi, p, predecessor);
+                }
+            }
+        }
+
+        simplifycfg_mark_dirty(state, successor);
+    }
+
+    layec_block_mark_for_removal(block);
+    simplifycfg_mark_dirty(state, block);
+    simplifycfg_mark_dirty(state, predecessor);
+    return true;
+}
+
+// integer constants aren't uniqued, so equal ones are usually different values.
+static bool simplifycfg_same_value(layec_value* first, layec_value* second) {
+    if (first == second) {
+        return true;
+    }
+
+    return layec_value_get_kind(first) == LAYEC_IR_INTEGER_CONSTANT &&
+           layec_value_get_kind(second) == LAYEC_IR_INTEGER_CONSTANT &&
+           layec_value_get_type(first) == layec_value_get_type(second) &&
+           layec_value_integer_constant(first) == layec_value_integer_constant(second);
+}
+
+// whether every phi in `block` has the same value coming from `first` as from `second`, if it has one from both.
+static bool simplifycfg_phi_values_agree(layec_value* block, layec_value* first, layec_value* second) {
+    for (int64_t i = 0, icount = layec_block_instruction_count(block); i < icount; i++) {
+        layec_value* phi = layec_block_get_instruction_at_index(block, i);
+        if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+            break;
+        }
+
+        layec_value* first_value = NULL;
+        layec_value* second_value = NULL;
+        for (int64_t p = 0, pcount = layec_instruction_phi_incoming_value_count(phi); p < pcount; p++) {
+            layec_value* incoming_block = layec_instruction_phi_incoming_block_at_index(phi, p);
+            if (incoming_block == first) {
+                first_value = layec_instruction_phi_incoming_value_at_index(phi, p);
+            } else if (incoming_block == second) {
+                second_value = layec_instruction_phi_incoming_value_at_index(phi, p);
+            }
+        }
+
+        if (first_value != NULL && second_value != NULL && !simplifycfg_same_value(first_value, second_value)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool simplifycfg_thread_through(simplifycfg_state* state, layec_value* block) {
+    simplifycfg_block* info = simplifycfg_get_block(state, block);
+    if (layec_block_index(block) == 0 || info->is_dirty || !simplifycfg_is_forwarding_block(block)) {
+        return false;
+    }
+
+    layec_value* target = layec_block_get_successor_at_index(block, 0);
+    if (target == block || simplifycfg_is_dirty(state, target)) {
+        return false;
+    }
+
+    // chains are threaded from their end, and a cycle of forwarding blocks is left alone entirely.
+    if (simplifycfg_is_forwarding_block(target)) {
+        return false;
+    }
+
+    bool target_has_phis = simplifycfg_block_has_phis(target);
+
+    bool changed = false;
+    for (int64_t p = 0; p < arr_count(info->predecessors); p++) {
+        layec_value* predecessor = info->predecessors[p];
+        if (simplifycfg_is_dirty(state, predecessor)) {
+            continue;
+        }
+
+        // the target's phis can't take two different values from the same predecessor.
+        if (target_has_phis && !simplifycfg_phi_values_agree(target, block, predecessor)) {
+            continue;
+        }
+
+        for (int64_t s = 0, scount = layec_block_successor_count(predecessor); s < scount; s++) {
+            if (layec_block_get_successor_at_index(predecessor, s) != block) {
+                continue;
+            }
+
+            layec_block_set_successor_at_index(predecessor, s, target);
+
+            for (int64_t i = 0, icount = layec_block_instruction_count(target); i < icount; i++) {
+                layec_value* phi = layec_block_get_instruction_at_index(target, i);
+                if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+                    break;
+                }
+
+                for (int64_t e = 0, ecount = layec_instruction_phi_incoming_value_count(phi); e < ecount; e++) {
+                    if (layec_instruction_phi_incoming_block_at_index(phi, e) == block) {
+                        layec_instruction_phi_add_incoming_value(phi, layec_instruction_phi_incoming_value_at_index(phi, e), predecessor);
+                        break;
+                    }
+                }
+            }
+        }
+
+        simplifycfg_mark_dirty(state, predecessor);
+        changed = true;
+    }
+
+    if (changed) {
+        simplifycfg_mark_dirty(state, block);
+        simplifycfg_mark_dirty(state, target);
+    }
+
+    return changed;
+}
+
+bool layec_irpass_simplifycfg_function(layec_pass_manager* pass_manager, layec_value* function) {
+    (void)pass_manager;
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    simplifycfg_state state = {
+        .function = function,
+        .builder = layec_builder_create(layec_value_context(function)),
+    };
+
+    bool changed = layec_function_remove_unreachable_blocks(function);
+    for (bool changed_this_sweep = true; changed_this_sweep;) {
+        changed_this_sweep = false;
+        simplifycfg_compute_predecessors(&state);
+
+        for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+            layec_value* block = layec_function_get_block_at_index(function, b);
+            changed_this_sweep |= simplifycfg_fold_branch(&state, block);
+            changed_this_sweep |= simplifycfg_merge_into_predecessor(&state, block);
+            changed_this_sweep |= simplifycfg_thread_through(&state, block);
+        }
+
+        if (changed_this_sweep) {
+            layec_function_remove_marked_blocks(function);
+            layec_function_remove_unreachable_blocks(function);
+            changed = true;
+        }
+    }
+
+    simplifycfg_free_blocks(&state);
+    arr_free(state.blocks);
+    layec_builder_destroy(state.builder);
+
+    return changed;
+}
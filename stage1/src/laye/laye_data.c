@@ -43,31 +43,66 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <assert.h>
 
-laye_symbol* laye_symbol_create(laye_module* module, laye_symbol_kind kind, string_view name) {
+// name indices map the data pointer of an interned name, which identifies it, to a position
+// offset by one, since a NULL value means the name is absent.
+
+// returns the recorded position for `name`, or -1 if it has not been added.
+static int64_t laye_name_index_find(lca_ptrmap* index, layec_symbol name) {
+    assert(index != NULL);
+    return (int64_t)(uintptr_t)lca_ptrmap_get(index, name.data) - 1;
+}
+
+// records `position` for `name` unless the name is already present, in which case the
+// earlier position is kept to match the first-match semantics of a linear search.
+static void laye_name_index_add(lca_ptrmap* index, layec_symbol name, int64_t position) {
+    assert(index != NULL);
+    assert(name.data != NULL);
+    assert(position >= 0);
+
+    if (!lca_ptrmap_contains(index, name.data)) {
+        lca_ptrmap_set(index, name.data, (void*)(uintptr_t)(position + 1));
+    }
+}
+
+laye_symbol* laye_symbol_create(laye_module* module, laye_symbol_kind kind, layec_symbol name) {
     if (kind == LAYE_SYMBOL_ENTITY) {
         assert(name.count > 0);
     }
+
+    assert(name.count == 0 || layec_symbol_is_interned(module->context, name));
     
     laye_symbol* symbol = lca_arena_push(module->arena, sizeof *symbol);
     assert(symbol != NULL);
+    symbol->module = module;
     symbol->kind = kind;
     symbol->name = name;
     arr_push(module->_all_symbols, symbol);
     return symbol;
 }
 
-laye_symbol* laye_symbol_lookup(laye_symbol* symbol_namespace, string_view name) {
+laye_symbol* laye_symbol_lookup(laye_symbol* symbol_namespace, layec_symbol name) {
     assert(symbol_namespace != NULL);
     assert(symbol_namespace->kind == LAYE_SYMBOL_NAMESPACE);
+    assert(layec_symbol_is_interned(symbol_namespace->module->context, name));
 
-    for (int64_t i = 0, count = arr_count(symbol_namespace->symbols); i < count; i++) {
-        laye_symbol* lookup = symbol_namespace->symbols[i];
-        if (string_view_equals(name, lookup->name)) {
-            return lookup;
-        }
+    int64_t position = laye_name_index_find(&symbol_namespace->symbol_index, name);
+    if (position < 0) {
+        return NULL;
     }
 
-    return NULL;
+    assert(position < arr_count(symbol_namespace->symbols));
+    return symbol_namespace->symbols[position];
+}
+
+void laye_symbol_namespace_add(laye_symbol* symbol_namespace, laye_symbol* symbol) {
+    assert(symbol_namespace != NULL);
+    assert(symbol_namespace->kind == LAYE_SYMBOL_NAMESPACE);
+    assert(symbol_namespace->module != NULL);
+    assert(symbol_namespace->module->context != NULL);
+    assert(symbol != NULL);
+
+    laye_name_index_add(&symbol_namespace->symbol_index, symbol->name, arr_count(symbol_namespace->symbols));
+    arr_push(symbol_namespace->symbols, symbol);
 }
 
 void laye_symbol_destroy(laye_symbol* symbol) {
@@ -77,6 +112,7 @@ void laye_symbol_destroy(laye_symbol* symbol) {
         arr_free(symbol->nodes);
     } else {
         arr_free(symbol->symbols);
+        lca_ptrmap_free(&symbol->symbol_index);
     }
 }
 
@@ -146,6 +182,8 @@ void laye_scope_destroy(laye_scope* scope) {
     if (scope == NULL) return;
     arr_free(scope->type_declarations);
     arr_free(scope->value_declarations);
+    lca_ptrmap_free(&scope->type_index);
+    lca_ptrmap_free(&scope->value_index);
     *scope = (laye_scope){0};
 }
 
@@ -153,7 +191,7 @@ void laye_scope_declare(laye_scope* scope, laye_node* declaration) {
     laye_scope_declare_aliased(scope, declaration, declaration->declared_name);
 }
 
-void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, string_view alias) {
+void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, layec_symbol alias) {
     assert(scope != NULL);
     assert(declaration != NULL);
     assert(laye_node_is_decl(declaration));
@@ -162,23 +200,23 @@ void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, strin
 
     laye_module* module = scope->module;
     assert(module != NULL);
+    assert(layec_symbol_is_interned(module->context, alias));
 
     bool is_type_declaration = declaration->kind == LAYE_NODE_DECL_STRUCT || declaration->kind == LAYE_NODE_DECL_ENUM || declaration->kind == LAYE_NODE_DECL_ALIAS || declaration->kind == LAYE_NODE_DECL_TEMPLATE_TYPE;
     dynarr(laye_aliased_node)* entity_namespace = is_type_declaration ? &scope->type_declarations : &scope->value_declarations;
     assert(entity_namespace != NULL);
+    lca_ptrmap* entity_index = is_type_declaration ? &scope->type_index : &scope->value_index;
+    assert(entity_index != NULL);
 
     if (!is_type_declaration) {
-        for (int64_t i = 0, count = arr_count(*entity_namespace); i < count; i++) {
-            laye_aliased_node entry = (*entity_namespace)[i];
-            
-            string_view existing_name = entry.name;
-            laye_node* existing_declaration = entry.node;
+        // NOTE(local): only function overloads may share a name, so checking the first
+        // declaration with this name is equivalent to checking all of them.
+        int64_t existing_position = laye_name_index_find(entity_index, alias);
+        if (existing_position >= 0) {
+            laye_node* existing_declaration = (*entity_namespace)[existing_position].node;
             assert(existing_declaration != NULL);
 
-            if (
-                string_view_equals(existing_name, alias) &&
-                (declaration->kind != LAYE_NODE_DECL_FUNCTION || existing_declaration->kind != LAYE_NODE_DECL_FUNCTION)
-            ) {
+            if (declaration->kind != LAYE_NODE_DECL_FUNCTION || existing_declaration->kind != LAYE_NODE_DECL_FUNCTION) {
                 assert(module->context != NULL);
                 layec_write_error(module->context, declaration->location, "redeclaration of '%.*s' in this scope.", STR_EXPAND(alias));
                 return;
@@ -186,35 +224,36 @@ void laye_scope_declare_aliased(laye_scope* scope, laye_node* declaration, strin
         }
     }
 
+    laye_name_index_add(entity_index, alias, arr_count(*entity_namespace));
     arr_push(*entity_namespace, ((laye_aliased_node){
         .name = alias,
         .node = declaration,
     }));
 }
 
-static laye_node* laye_scope_lookup_from(laye_scope* scope, dynarr(laye_aliased_node) declarations, string_view name) {
+static laye_node* laye_scope_lookup_from(laye_scope* scope, dynarr(laye_aliased_node) declarations, lca_ptrmap* index, layec_symbol name) {
     assert(scope != NULL);
     assert(scope->module != NULL);
+    assert(layec_symbol_is_interned(scope->module->context, name));
 
-    for (int64_t i = 0, count = arr_count(declarations); i < count; i++) {
-        laye_aliased_node entry = declarations[i];
-        assert(entry.node != NULL);
-
-        if (string_view_equals(entry.name, name))
-            return entry.node;
+    int64_t position = laye_name_index_find(index, name);
+    if (position < 0) {
+        return NULL;
     }
 
-    return NULL;
+    assert(position < arr_count(declarations));
+    assert(declarations[position].node != NULL);
+    return declarations[position].node;
 }
 
-laye_node* laye_scope_lookup_value(laye_scope* scope, string_view value_name) {
+laye_node* laye_scope_lookup_value(laye_scope* scope, layec_symbol value_name) {
     assert(scope != NULL);
-    return laye_scope_lookup_from(scope, scope->value_declarations, value_name);
+    return laye_scope_lookup_from(scope, scope->value_declarations, &scope->value_index, value_name);
 }
 
-laye_node* laye_scope_lookup_type(laye_scope* scope, string_view type_name) {
+laye_node* laye_scope_lookup_type(laye_scope* scope, layec_symbol type_name) {
     assert(scope != NULL);
-    return laye_scope_lookup_from(scope, scope->type_declarations, type_name);
+    return laye_scope_lookup_from(scope, scope->type_declarations, &scope->type_index, type_name);
 }
 
 laye_node* laye_node_create(laye_module* module, laye_node_kind kind, layec_location location, laye_type type) {
@@ -45,80 +45,71 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 typedef enum laye_builtin_runtime_function {
     LAYE_RUNTIME_ASSERT_FUNCTION,
+    LAYE_RUNTIME_FUNCTION_COUNT,
 } laye_builtin_runtime_function;
 
-typedef enum laye_irvalue_kv_kind {
-    LAYE_IRKV_NODE,
-    LAYE_IRKV_BUILTIN,
-} laye_irvalue_kv_kind;
-
-typedef struct laye_irvalue_kv {
-    laye_irvalue_kv_kind kind;
-
-    laye_module* module;
-    union {
-        laye_node* node;
-        laye_builtin_runtime_function builtin;
-    };
-
-    layec_value* value;
-} laye_irvalue_kv;
+// IR values generated for a single module.
+// imported declarations are generated once for every module which imports them,
+// so the same node may map to a different value in each module.
+typedef struct laye_irgen_module_values {
+    // maps laye_node* to the layec_value* generated for it.
+    ptrmap node_values;
+    layec_value* builtin_values[LAYE_RUNTIME_FUNCTION_COUNT];
+} laye_irgen_module_values;
 
 typedef struct laye_irgen {
-    dynarr(laye_irvalue_kv) ir_values;
+    // maps laye_module* to its laye_irgen_module_values*.
+    ptrmap module_values;
+    dynarr(laye_irgen_module_values*) _all_module_values;
 } laye_irgen;
 
-// NOTE(local): this pointer can and will move, it should never be stored
-static laye_irvalue_kv* laye_irgen_irvalue_kv_get_for_node(laye_irgen* irgen, laye_module* module, laye_node* node) {
-    for (int64_t i = 0, count = arr_count(irgen->ir_values); i < count; i++) {
-        laye_irvalue_kv* kv = &irgen->ir_values[i];
-        if (kv->kind == LAYE_IRKV_NODE && kv->module == module && kv->node == node)
-            return kv;
-    }
-
-    laye_irvalue_kv kv = {
-        .kind = LAYE_IRKV_NODE,
-        .module = module,
-        .node = node,
-    };
-
-    arr_push(irgen->ir_values, kv);
-    return arr_back(irgen->ir_values);
-}
+static laye_irgen_module_values* laye_irgen_get_module_values(laye_irgen* irgen, laye_module* module) {
+    assert(irgen != NULL);
+    assert(module != NULL);
 
-static laye_irvalue_kv* laye_irgen_irvalue_kv_get_for_builtin(laye_irgen* irgen, laye_module* module, laye_builtin_runtime_function builtin) {
-    for (int64_t i = 0, count = arr_count(irgen->ir_values); i < count; i++) {
-        laye_irvalue_kv* kv = &irgen->ir_values[i];
-        if (kv->kind == LAYE_IRKV_BUILTIN && kv->module == module && kv->builtin == builtin)
-            return kv;
+    laye_irgen_module_values* module_values = ptrmap_get(&irgen->module_values, module);
+    if (module_values == NULL) {
+        module_values = lca_allocate(module->context->allocator, sizeof *module_values);
+        assert(module_values != NULL);
+        ptrmap_set(&irgen->module_values, module, module_values);
+        arr_push(irgen->_all_module_values, module_values);
     }
 
-    laye_irvalue_kv kv = {
-        .kind = LAYE_IRKV_BUILTIN,
-        .module = module,
-        .builtin = builtin,
-    };
-
-    arr_push(irgen->ir_values, kv);
-    return arr_back(irgen->ir_values);
+    return module_values;
 }
 
 static layec_value* laye_irgen_ir_value_get(laye_irgen* irgen, laye_module* module, laye_node* node) {
-    return laye_irgen_irvalue_kv_get_for_node(irgen, module, node)->value;
+    return ptrmap_get(&laye_irgen_get_module_values(irgen, module)->node_values, node);
 }
 
 static layec_value* laye_irgen_ir_value_get_builtin(laye_irgen* irgen, laye_module* module, laye_builtin_runtime_function builtin) {
-    return laye_irgen_irvalue_kv_get_for_builtin(irgen, module, builtin)->value;
+    assert(builtin >= 0 && builtin < LAYE_RUNTIME_FUNCTION_COUNT);
+    return laye_irgen_get_module_values(irgen, module)->builtin_values[builtin];
 }
 
 static void laye_irgen_ir_value_set(laye_irgen* irgen, laye_module* module, laye_node* node, layec_value* value) {
     assert(value != NULL);
-    laye_irgen_irvalue_kv_get_for_node(irgen, module, node)->value = value;
+    ptrmap_set(&laye_irgen_get_module_values(irgen, module)->node_values, node, value);
 }
 
 static void laye_irgen_ir_value_set_builtin(laye_irgen* irgen, laye_module* module, laye_builtin_runtime_function builtin, layec_value* value) {
     assert(value != NULL);
-    laye_irgen_irvalue_kv_get_for_builtin(irgen, module, builtin)->value = value;
+    assert(builtin >= 0 && builtin < LAYE_RUNTIME_FUNCTION_COUNT);
+    laye_irgen_get_module_values(irgen, module)->builtin_values[builtin] = value;
+}
+
+static void laye_irgen_destroy(laye_irgen* irgen, layec_context* context) {
+    assert(irgen != NULL);
+    assert(context != NULL);
+
+    for (int64_t i = 0, count = arr_count(irgen->_all_module_values); i < count; i++) {
+        laye_irgen_module_values* module_values = irgen->_all_module_values[i];
+        ptrmap_free(&module_values->node_values);
+        lca_deallocate(context->allocator, module_values);
+    }
+
+    arr_free(irgen->_all_module_values);
+    ptrmap_free(&irgen->module_values);
 }
 
 static layec_type* laye_convert_type(laye_type type);
@@ -168,7 +159,6 @@ static void laye_irgen_generate_declaration(laye_irgen* irgen, laye_module* modu
             layec_value* ir_parameter = layec_create_parameter(ir_module, parameter_node->location, parameter_type, parameter_node->declared_name, i);
 
             laye_irgen_ir_value_set(irgen, module, parameter_node, ir_parameter);
-            // parameter_node->ir_value = ir_parameter;
             arr_push(parameters, ir_parameter);
         }
 
@@ -182,8 +172,8 @@ static void laye_irgen_generate_declaration(laye_irgen* irgen, laye_module* modu
         );
 
         assert(ir_function != NULL);
+        layec_function_set_inline(ir_function, node->attributes.is_inline);
         laye_irgen_ir_value_set(irgen, module, node, ir_function);
-        // node->ir_value = ir_function;
     }
 }
 
@@ -211,7 +201,6 @@ static void laye_irgen_generate_imported_function_declarations(laye_irgen* irgen
             assert(node != NULL);
 
             laye_irgen_generate_declaration(irgen, module, node);
-            // assert(node->ir_value != NULL);
         }
     }
 }
@@ -220,8 +209,8 @@ static layec_value* laye_irgen_get_runtime_assert_function(laye_irgen* irgen, la
     assert(irgen != NULL);
     assert(module != NULL);
 
-    laye_irvalue_kv* kv = laye_irgen_irvalue_kv_get_for_builtin(irgen, module, LAYE_RUNTIME_ASSERT_FUNCTION);
-    if (kv->value == NULL) {
+    layec_value* assert_function = laye_irgen_ir_value_get_builtin(irgen, module, LAYE_RUNTIME_ASSERT_FUNCTION);
+    if (assert_function == NULL) {
         layec_context* context = module->context;
 
         dynarr(layec_type*) parameter_types = NULL;
@@ -233,7 +222,7 @@ static layec_value* laye_irgen_get_runtime_assert_function(laye_irgen* irgen, la
         arr_push(parameter_types, laye_convert_type(LTY(context->laye_types.i8_buffer)));
 
         layec_type* function_type = layec_function_type(context, layec_void_type(context), parameter_types, LAYEC_CCC, false);
-        kv->value = layec_module_create_function(
+        assert_function = layec_module_create_function(
             module->ir_module,
             (layec_location){0},
             SV_CONSTANT("__laye_assert_fail"),
@@ -241,10 +230,12 @@ static layec_value* laye_irgen_get_runtime_assert_function(laye_irgen* irgen, la
             NULL,
             LAYEC_LINK_REEXPORTED
         );
+
+        laye_irgen_ir_value_set_builtin(irgen, module, LAYE_RUNTIME_ASSERT_FUNCTION, assert_function);
     }
 
-    assert(kv->value != NULL);
-    return kv->value;
+    assert(assert_function != NULL);
+    return assert_function;
 }
 
 void laye_generate_ir(layec_context* context) {
@@ -290,7 +281,6 @@ void laye_generate_ir(layec_context* context) {
             assert(top_level_node != NULL);
 
             laye_irgen_generate_declaration(&irgen, module, top_level_node);
-            // assert(top_level_node->ir_value != NULL);
         }
     }
 
@@ -310,7 +300,6 @@ void laye_generate_ir(layec_context* context) {
 
             if (top_level_node->kind == LAYE_NODE_DECL_FUNCTION) {
                 layec_value* function = laye_irgen_ir_value_get(&irgen, module, top_level_node);
-                // layec_value* function = top_level_node->ir_value;
                 assert(function != NULL);
                 assert(layec_value_is_function(function));
 
@@ -318,6 +307,8 @@ void laye_generate_ir(layec_context* context) {
                     continue;
                 }
 
+                layec_trace_begin(context, "irgen", layec_function_name(function), layec_module_name(ir_module));
+
                 layec_value* entry_block = layec_function_append_block(function, SV_CONSTANT("entry"));
                 assert(entry_block != NULL);
                 layec_builder_position_at_end(builder, entry_block);
@@ -335,7 +326,6 @@ void laye_generate_ir(layec_context* context) {
 
                     layec_value* ir_parameter = laye_irgen_ir_value_get(&irgen, module, parameter_node);
                     assert(ir_parameter != NULL);
-                    // assert(parameter_node->ir_value != NULL);
                     layec_value* store = layec_build_store(builder, parameter_node->location, alloca, ir_parameter);
                     assert(store != NULL);
 
@@ -346,13 +336,14 @@ void laye_generate_ir(layec_context* context) {
                 laye_generate_node(&irgen, builder, top_level_node->decl_function.body);
 
                 layec_builder_reset(builder);
+                layec_trace_end(context);
             }
         }
 
         layec_builder_destroy(builder);
     }
 
-    arr_free(irgen.ir_values);
+    laye_irgen_destroy(&irgen, context);
 }
 
 static layec_type* laye_convert_type(laye_type type) {
@@ -505,7 +496,6 @@ static layec_value* laye_generate_node(laye_irgen* irgen, layec_builder* builder
             }
 
             laye_irgen_ir_value_set(irgen, node->module, node, alloca);
-            // node->ir_value = alloca;
             return layec_void_constant(context);
         }
 
@@ -1536,7 +1526,6 @@ static layec_value* laye_generate_node(laye_irgen* irgen, layec_builder* builder
             assert(node->nameref.referenced_declaration != NULL);
             layec_value* ir_value_referenced = laye_irgen_ir_value_get(irgen, node->module, node->nameref.referenced_declaration);
             assert(ir_value_referenced != NULL);
-            // assert(node->nameref.referenced_declaration->ir_value != NULL);
             return ir_value_referenced;
         }
 
@@ -252,6 +252,7 @@ laye_module* laye_parse(layec_context* context, layec_sourceid sourceid) {
     module->scope = module_scope;
 
     layec_source source = layec_context_get_source(context, sourceid);
+    layec_trace_begin(context, "parse", string_as_view(source.name), SV_EMPTY);
 
     laye_parser p = {
         .context = context,
@@ -281,6 +282,7 @@ laye_module* laye_parse(layec_context* context, layec_sourceid sourceid) {
 
     arr_free(p.break_continue_stack);
 
+    layec_trace_end(context);
     return module;
 }
 
@@ -1313,7 +1315,7 @@ static laye_parse_result laye_parse_declaration_continue(laye_parser* p, dynarr(
                 layec_write_error(p->context, p->token.location, "Expected an identifier.");
                 name_token.kind = LAYE_TOKEN_INVALID;
                 name_token.location.length = 0;
-                name_token.string_value = SV_CONSTANT("<invalid>");
+                name_token.string_value = layec_context_intern_string_view(p->context, SV_CONSTANT("<invalid>"));
             }
 
             layec_location parameter_location = name_token.location.length != 0 ? name_token.location : parameter_type.node->location;
@@ -1872,11 +1874,8 @@ static laye_parse_result laye_parse_primary_expression(laye_parser* p) {
             assert(operand_result.node != NULL);
             assert(operand_result.node->type.node != NULL);
 
-            laye_node* reftype = laye_node_create(p->module, LAYE_NODE_TYPE_POINTER, operand_result.node->location, LTY(p->context->laye_types.type));
-            assert(reftype != NULL);
-            reftype->type_container.element_type = operand_result.node->type;
-
-            laye_node* expr = laye_node_create(p->module, LAYE_NODE_UNARY, operand_result.node->location, LTY(reftype));
+            // the pointer type is only known once sema has analysed the operand.
+            laye_node* expr = laye_node_create(p->module, LAYE_NODE_UNARY, operand_result.node->location, LTY(p->context->laye_types.unknown));
             assert(expr != NULL);
             expr->unary.operand = operand_result.node;
             expr->unary.operator = operator_token;
@@ -51,6 +51,10 @@ typedef struct laye_sema {
 
     laye_node* current_function;
     laye_node* current_yield_target;
+
+    // the type nodes sema creates itself, so each distinct pointer, buffer, reference or
+    // primitive type only gets one node.
+    lca_hashset canonical_types;
 } laye_sema;
 
 static bool laye_sema_analyse_type(laye_sema* sema, laye_type* type);
@@ -73,8 +77,8 @@ static void laye_sema_lvalue_to_rvalue(laye_sema* sema, laye_node** node, bool s
 static bool laye_sema_implicit_dereference(laye_sema* sema, laye_node** node);
 static bool laye_sema_implicit_de_reference(laye_sema* sema, laye_node** node);
 
+static laye_type laye_sema_get_canonical_type(laye_sema* sema, laye_module* module, layec_location location, laye_node key);
 static laye_type laye_sema_get_pointer_to_type(laye_sema* sema, laye_type element_type, bool is_modifiable);
-static laye_type laye_sema_get_buffer_of_type(laye_sema* sema, laye_type element_type, bool is_modifiable);
 static laye_type laye_sema_get_reference_to_type(laye_sema* sema, laye_type element_type, bool is_modifiable);
 
 static laye_node* laye_create_constant_node(laye_sema* sema, laye_node* node, layec_evaluated_constant eval_result);
@@ -90,7 +94,7 @@ static laye_node* laye_sema_lookup_entity(laye_module* from_module, laye_nameref
     assert(search_scope != NULL);
 
     assert(arr_count(nameref.pieces) >= 1);
-    string_view first_name = nameref.pieces[0].string_value;
+    layec_symbol first_name = nameref.pieces[0].string_value;
 
     assert(nameref.kind == LAYE_NAMEREF_DEFAULT && "only the default representation of a nameref is supported at this time");
 
@@ -114,17 +118,9 @@ static laye_node* laye_sema_lookup_entity(laye_module* from_module, laye_nameref
         for (int64_t name_index = 0, name_count = arr_count(nameref.pieces); name_index < name_count; name_index++) {
             // bool is_last_name = name_index == name_count - 1;
             laye_token name_piece_token = nameref.pieces[name_index];
-            string_view name_piece = name_piece_token.string_value;
-
-            laye_symbol* symbol_matching = NULL;
-            for (int64_t symbol_index = 0, symbol_count = arr_count(search_namespace->symbols); symbol_index < symbol_count && symbol_matching == NULL; symbol_index++) {
-                laye_symbol* symbol_imported = search_namespace->symbols[symbol_index];
-                assert(symbol_imported != NULL);
+            layec_symbol name_piece = name_piece_token.string_value;
 
-                if (string_view_equals(symbol_imported->name, name_piece)) {
-                    symbol_matching = symbol_imported;
-                }
-            }
+            laye_symbol* symbol_matching = laye_symbol_lookup(search_namespace, name_piece);
 
             if (symbol_matching == NULL) {
                 layec_write_error(
@@ -274,7 +270,7 @@ static bool is_identifier_char(int c) {
     return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 256;
 }
 
-static string_view import_string_to_laye_identifier_string(laye_node* import_node) {
+static layec_symbol import_string_to_laye_identifier_string(laye_node* import_node) {
     assert(import_node != NULL);
     assert(import_node->module != NULL);
     assert(import_node->module->context != NULL);
@@ -310,14 +306,14 @@ static string_view import_string_to_laye_identifier_string(laye_node* import_nod
         // layec_write_note(context, import_node->decl_import.module_name.location, "calculated module name: '%.*s'\n", STR_EXPAND(module_name));
     }
 
-    return module_name;
+    return layec_context_intern_string_view(context, module_name);
 }
 
 static void laye_sema_add_symbol_shallow_copy(layec_context* context, laye_module* module, laye_symbol* namespace_symbol, laye_symbol* symbol) {
     laye_symbol* existing_symbol = laye_symbol_lookup(namespace_symbol, symbol->name);
     if (existing_symbol == NULL) {
         existing_symbol = laye_symbol_create(module, symbol->kind, symbol->name);
-        arr_push(namespace_symbol->symbols, existing_symbol);
+        laye_symbol_namespace_add(namespace_symbol, existing_symbol);
     }
 
     assert(existing_symbol != NULL);
@@ -329,7 +325,7 @@ static void laye_sema_add_symbol_shallow_copy(layec_context* context, laye_modul
         assert(arr_count(existing_symbol->symbols) == 0);
 
         for (int64_t j = 0, j_count = arr_count(symbol->symbols); j < j_count; j++) {
-            arr_push(existing_symbol->symbols, symbol->symbols[j]);
+            laye_symbol_namespace_add(existing_symbol, symbol->symbols[j]);
         }
     } else {
         assert(existing_symbol->kind == LAYE_SYMBOL_ENTITY);
@@ -358,7 +354,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
             if (imported_symbol == NULL) {
                 imported_symbol = laye_symbol_create(module, exported_symbol->kind, exported_symbol->name);
                 assert(imported_symbol != NULL);
-                arr_push(module->imports->symbols, imported_symbol);
+                laye_symbol_namespace_add(module->imports, imported_symbol);
             } else {
                 if (exported_symbol->kind == LAYE_SYMBOL_NAMESPACE) {
                     layec_write_error(context, query->location, "Wildcard imports symbol '%.*s', which is a namespace. This symbol has already been declared, and namespace names cannot be overloaded.");
@@ -379,7 +375,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
                 assert(arr_count(imported_symbol->symbols) == 0);
 
                 for (int64_t j = 0, j_count = arr_count(exported_symbol->symbols); j < j_count; j++) {
-                    arr_push(imported_symbol->symbols, exported_symbol->symbols[j]);
+                    laye_symbol_namespace_add(imported_symbol, exported_symbol->symbols[j]);
                 }
             } else {
                 assert(imported_symbol->kind == LAYE_SYMBOL_ENTITY);
@@ -401,7 +397,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
             bool is_last_name_in_path = i == count - 1;
 
             laye_token search_token = query->import_query.pieces[i];
-            string_view search_name = search_token.string_value;
+            layec_symbol search_name = search_token.string_value;
 
             assert(search_namespace != NULL);
 
@@ -420,16 +416,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
 
             assert(search_namespace->kind == LAYE_SYMBOL_NAMESPACE);
 
-            laye_symbol* found_lookup_symbol = NULL;
-            for (int64_t j = 0, j_count = arr_count(search_namespace->symbols); j < j_count; j++) {
-                laye_symbol* search_symbol = search_namespace->symbols[j];
-                assert(search_symbol != NULL);
-
-                if (string_view_equals(search_symbol->name, search_name)) {
-                    found_lookup_symbol = search_symbol;
-                    break;
-                }
-            }
+            laye_symbol* found_lookup_symbol = laye_symbol_lookup(search_namespace, search_name);
 
             if (found_lookup_symbol == NULL) {
                 layec_write_error(
@@ -453,7 +440,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
             return;
         }
 
-        string_view query_result_name = query->import_query.alias.string_value;
+        layec_symbol query_result_name = query->import_query.alias.string_value;
         if (query_result_name.count == 0) {
             query_result_name = query->import_query.pieces[arr_count(query->import_query.pieces) - 1].string_value;
         }
@@ -462,7 +449,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
         if (imported_symbol == NULL) {
             imported_symbol = laye_symbol_create(module, resolved_symbol->kind, query_result_name);
             assert(imported_symbol != NULL);
-            arr_push(module->imports->symbols, imported_symbol);
+            laye_symbol_namespace_add(module->imports, imported_symbol);
         } else {
             if (resolved_symbol->kind == LAYE_SYMBOL_NAMESPACE) {
                 layec_write_error(context, query->location, "Query imports symbol '%.*s', which is a namespace. This symbol has already been declared, and namespace names cannot be overloaded.");
@@ -481,7 +468,7 @@ static void laye_sema_resolve_import_query(layec_context* context, laye_module*
             assert(arr_count(imported_symbol->symbols) == 0);
 
             for (int64_t j = 0, j_count = arr_count(resolved_symbol->symbols); j < j_count; j++) {
-                arr_push(imported_symbol->symbols, resolved_symbol->symbols[j]);
+                laye_symbol_namespace_add(imported_symbol, resolved_symbol->symbols[j]);
             }
         } else {
             assert(imported_symbol->kind == LAYE_SYMBOL_ENTITY);
@@ -635,7 +622,7 @@ static void laye_sema_build_module_symbol_tables(layec_context* context, laye_mo
                 bool is_export_import = top_level_node->attributes.linkage == LAYEC_LINK_EXPORTED;
 
                 if (arr_count(top_level_node->decl_import.import_queries) == 0) {
-                    string_view module_name = import_string_to_laye_identifier_string(top_level_node);
+                    layec_symbol module_name = import_string_to_laye_identifier_string(top_level_node);
                     assert(module_name.count > 0);
 
                     if (laye_symbol_lookup(module->imports, module_name) != NULL) {
@@ -644,11 +631,11 @@ static void laye_sema_build_module_symbol_tables(layec_context* context, laye_mo
                         laye_symbol* import_scope = laye_symbol_create(module, LAYE_SYMBOL_NAMESPACE, module_name);
                         assert(import_scope != NULL);
 
-                        arr_push(module->imports->symbols, import_scope);
+                        laye_symbol_namespace_add(module->imports, import_scope);
 
                         if (is_export_import) {
                             assert(laye_symbol_lookup(module->exports, module_name) == NULL && "somehow, this module already exports something with the same name");
-                            arr_push(module->exports->symbols, import_scope);
+                            laye_symbol_namespace_add(module->exports, import_scope);
                         }
 
                         // shallow-copy all of the referenced module's exports into this new scope for our own imports (and potentially exports)
@@ -660,7 +647,7 @@ static void laye_sema_build_module_symbol_tables(layec_context* context, laye_mo
                             laye_symbol* imported_symbol = referenced_module->exports->symbols[export_index];
                             assert(imported_symbol != NULL);
                             assert(laye_symbol_lookup(import_scope, imported_symbol->name) == NULL);
-                            arr_push(import_scope->symbols, imported_symbol);
+                            laye_symbol_namespace_add(import_scope, imported_symbol);
                         }
                     }
                 } else {
@@ -692,7 +679,7 @@ static void laye_sema_build_module_symbol_tables(layec_context* context, laye_mo
                     }
                 } else {
                     export_symbol = laye_symbol_create(module, LAYE_SYMBOL_ENTITY, top_level_node->declared_name);
-                    arr_push(module->exports->symbols, export_symbol);
+                    laye_symbol_namespace_add(module->exports, export_symbol);
                 }
 
                 assert(export_symbol != NULL);
@@ -803,11 +790,21 @@ void laye_analyse(layec_context* context) {
     for (int64_t i = 0, count = arr_count(ordered_nodes); i < count; i++) {
         laye_node* node = ordered_nodes[i];
         assert(node != NULL);
+
+        string_view trace_name = node->declared_name;
+        if (trace_name.count == 0) {
+            trace_name = string_view_from_cstring(laye_node_kind_to_cstring(node->kind));
+        }
+
+        layec_trace_begin(context, "sema", trace_name, string_as_view(laye_module_get_source(node->module).name));
         laye_sema_analyse_node(&sema, &node, NOTY);
         assert(node != NULL);
+        layec_trace_end(context);
     }
 
     arr_free(ordered_nodes);
+
+    lca_hashset_free(&sema.canonical_types);
 }
 
 static laye_node* laye_sema_build_struct_type(laye_sema* sema, laye_node* node, laye_node* parent_struct) {
@@ -1260,10 +1257,8 @@ static bool laye_sema_analyse_node(laye_sema* sema, laye_node** node_ref, laye_t
                     }
                 }
 
-                laye_type element_reference_type = LTY(laye_node_create(node->module, LAYE_NODE_TYPE_REFERENCE, node->foreach.element_binding->location, LTY(sema->context->laye_types.type)));
+                laye_type element_reference_type = laye_sema_get_reference_to_type(sema, iterable_type.node->type_container.element_type, false);
                 assert(element_reference_type.node != NULL);
-                element_reference_type.node->compiler_generated = true;
-                element_reference_type.node->type_container.element_type = iterable_type.node->type_container.element_type;
                 node->foreach.element_binding->declared_type = element_reference_type;
                 if (!laye_sema_analyse_node(sema, &node->foreach.element_binding, NOTY)) {
                     node->sema_state = LAYEC_SEMA_ERRORED;
@@ -1616,7 +1611,7 @@ static bool laye_sema_analyse_node(laye_sema* sema, laye_node** node_ref, laye_t
             value_type = node->member.value->type;
 
             layec_location member_location = node->member.field_name.location;
-            string_view member_name = node->member.field_name.string_value;
+            layec_symbol member_name = node->member.field_name.string_value;
 
             switch (value_type.node->kind) {
                 default: {
@@ -1641,7 +1636,7 @@ static bool laye_sema_analyse_node(laye_sema* sema, laye_node** node_ref, laye_t
 
                     for (int64_t i = 0, count = arr_count(struct_type_node->type_struct.fields); i < count; i++) {
                         laye_struct_type_field f = struct_type_node->type_struct.fields[i];
-                        if (string_view_equals(member_name, f.name)) {
+                        if (layec_symbol_equals(member_name, f.name)) {
                             member_type = f.type;
                             break;
                         } else {
@@ -1820,8 +1815,7 @@ static bool laye_sema_analyse_node(laye_sema* sema, laye_node** node_ref, laye_t
                         break;
                     }
 
-                    assert(laye_type_is_pointer(node->type)); // from the parser, already constructed
-                    node->type.node->type_container.element_type = node->unary.operand->type;
+                    node->type = laye_sema_get_pointer_to_type(sema, node->unary.operand->type, false);
                 } break;
 
                 case '*': {
@@ -2541,10 +2535,19 @@ static void laye_sema_convert_to_c_varargs_or_error(laye_sema* sema, laye_node**
 
     if (laye_type_is_int((*node)->type)) {
         if (type_size < sema->context->target->c.size_of_int) {
-            laye_type ffi_int_type = LTY(laye_node_create((*node)->module, LAYE_NODE_TYPE_INT, (*node)->location, LTY(sema->context->laye_types.type)));
+            laye_type ffi_int_type = laye_sema_get_canonical_type(
+                sema,
+                (*node)->module,
+                (*node)->location,
+                (laye_node){
+                    .kind = LAYE_NODE_TYPE_INT,
+                    .type_primitive = {
+                        .bit_width = sema->context->target->c.size_of_int,
+                        .is_signed = laye_type_is_signed_int((*node)->type),
+                    },
+                }
+            );
             assert(ffi_int_type.node != NULL);
-            ffi_int_type.node->type_primitive.is_signed = laye_type_is_signed_int((*node)->type);
-            ffi_int_type.node->type_primitive.bit_width = sema->context->target->c.size_of_int;
             laye_sema_analyse_type(sema, &ffi_int_type);
             laye_sema_insert_implicit_cast(sema, node, ffi_int_type);
             laye_sema_analyse_node(sema, node, NOTY);
@@ -2554,9 +2557,18 @@ static void laye_sema_convert_to_c_varargs_or_error(laye_sema* sema, laye_node**
 
     if (laye_type_is_float((*node)->type)) {
         if (type_size < sema->context->target->c.size_of_double) {
-            laye_type ffi_double_type = LTY(laye_node_create((*node)->module, LAYE_NODE_TYPE_FLOAT, (*node)->location, LTY(sema->context->laye_types.type)));
+            laye_type ffi_double_type = laye_sema_get_canonical_type(
+                sema,
+                (*node)->module,
+                (*node)->location,
+                (laye_node){
+                    .kind = LAYE_NODE_TYPE_FLOAT,
+                    .type_primitive = {
+                        .bit_width = sema->context->target->c.size_of_double,
+                    },
+                }
+            );
             assert(ffi_double_type.node != NULL);
-            ffi_double_type.node->type_primitive.bit_width = sema->context->target->c.size_of_double;
             laye_sema_analyse_type(sema, &ffi_double_type);
             laye_sema_insert_implicit_cast(sema, node, ffi_double_type);
             laye_sema_analyse_node(sema, node, NOTY);
@@ -2710,38 +2722,167 @@ static bool laye_sema_implicit_de_reference(laye_sema* sema, laye_node** node) {
     return laye_expr_is_lvalue(*node);
 }
 
-static laye_type laye_sema_get_pointer_to_type(laye_sema* sema, laye_type element_type, bool is_modifiable) {
+static uint64_t laye_sema_canonical_type_hash(laye_node* type) {
+    uint64_t hash = lca_hash_combine(LCA_HASH_SEED, (uint64_t)type->kind);
+
+    switch (type->kind) {
+        default: {
+            fprintf(stderr, "for node kind %s\n", laye_node_kind_to_cstring(type->kind));
+            assert(false && "unsupported kind in laye_sema_canonical_type_hash");
+            return 0;
+        }
+
+        case LAYE_NODE_TYPE_VOID:
+        case LAYE_NODE_TYPE_NORETURN: {
+        } break;
+
+        case LAYE_NODE_TYPE_BOOL:
+        case LAYE_NODE_TYPE_INT: {
+            hash = lca_hash_combine(hash, (uint64_t)type->type_primitive.bit_width);
+            hash = lca_hash_combine(hash, (uint64_t)type->type_primitive.is_signed);
+            hash = lca_hash_combine(hash, (uint64_t)type->type_primitive.is_platform_specified);
+        } break;
+
+        case LAYE_NODE_TYPE_FLOAT: {
+            hash = lca_hash_combine(hash, (uint64_t)type->type_primitive.bit_width);
+        } break;
+
+        // the element type is already canonical, so its node is its identity.
+        case LAYE_NODE_TYPE_REFERENCE:
+        case LAYE_NODE_TYPE_POINTER:
+        case LAYE_NODE_TYPE_BUFFER: {
+            hash = lca_hash_combine(hash, (uint64_t)(uintptr_t)type->type_container.element_type.node);
+            hash = lca_hash_combine(hash, (uint64_t)type->type_container.element_type.is_modifiable);
+        } break;
+    }
+
+    return hash;
+}
+
+static bool laye_sema_canonical_type_equals(const void* value, const void* key) {
+    const laye_node* a = value;
+    const laye_node* b = key;
+
+    if (a->kind != b->kind) {
+        return false;
+    }
+
+    switch (a->kind) {
+        default: {
+            fprintf(stderr, "for node kind %s\n", laye_node_kind_to_cstring(a->kind));
+            assert(false && "unsupported kind in laye_sema_canonical_type_equals");
+            return false;
+        }
+
+        case LAYE_NODE_TYPE_VOID:
+        case LAYE_NODE_TYPE_NORETURN: {
+            return true;
+        }
+
+        case LAYE_NODE_TYPE_BOOL:
+        case LAYE_NODE_TYPE_INT: {
+            return a->type_primitive.bit_width == b->type_primitive.bit_width && a->type_primitive.is_signed == b->type_primitive.is_signed &&
+                   a->type_primitive.is_platform_specified == b->type_primitive.is_platform_specified;
+        }
+
+        case LAYE_NODE_TYPE_FLOAT: {
+            return a->type_primitive.bit_width == b->type_primitive.bit_width;
+        }
+
+        case LAYE_NODE_TYPE_REFERENCE:
+        case LAYE_NODE_TYPE_POINTER:
+        case LAYE_NODE_TYPE_BUFFER: {
+            return a->type_container.element_type.node == b->type_container.element_type.node &&
+                   a->type_container.element_type.is_modifiable == b->type_container.element_type.is_modifiable;
+        }
+    }
+}
+
+// returns the one compiler-generated type node matching `key` (only its kind and the fields
+// for that kind are read), creating it in `module` at `location` the first time it is asked for.
+// the element types of container keys must already be canonical, since they are compared by node.
+static laye_type laye_sema_get_canonical_type(laye_sema* sema, laye_module* module, layec_location location, laye_node key) {
     assert(sema != NULL);
     assert(sema->context != NULL);
-    assert(element_type.node != NULL);
-    assert(element_type.node->module != NULL);
-    assert(laye_node_is_type(element_type.node));
-    laye_node* type = laye_node_create(element_type.node->module, LAYE_NODE_TYPE_POINTER, element_type.node->location, LTY(sema->context->laye_types.type));
+    assert(module != NULL);
+
+    uint64_t hash = laye_sema_canonical_type_hash(&key);
+    laye_node* existing_type = lca_hashset_find(&sema->canonical_types, hash, laye_sema_canonical_type_equals, &key);
+    if (existing_type != NULL) {
+        return LTY(existing_type);
+    }
+
+    laye_node* type = laye_node_create(module, key.kind, location, LTY(sema->context->laye_types.type));
     assert(type != NULL);
-    type->type_container.element_type = element_type;
+    type->compiler_generated = true;
+
+    if (key.kind == LAYE_NODE_TYPE_BOOL || key.kind == LAYE_NODE_TYPE_INT || key.kind == LAYE_NODE_TYPE_FLOAT) {
+        type->type_primitive = key.type_primitive;
+    } else if (key.kind != LAYE_NODE_TYPE_VOID && key.kind != LAYE_NODE_TYPE_NORETURN) {
+        type->type_container.element_type = key.type_container.element_type;
+    }
+
+    lca_hashset_insert(&sema->canonical_types, hash, type);
+
     return LTY(type);
 }
 
-static laye_type laye_sema_get_buffer_of_type(laye_sema* sema, laye_type element_type, bool is_modifiable) {
+static laye_type laye_sema_get_container_type(laye_sema* sema, laye_node_kind kind, laye_type element_type, bool is_modifiable);
+
+// the node standing for `type` in canonical type keys: the shared node for primitive and
+// container types, which the parser creates anew for every use, and `type` itself for the
+// other types, whose identity is their declaration.
+static laye_node* laye_sema_canonical_type_node(laye_sema* sema, laye_node* type) {
+    switch (type->kind) {
+        default: return type;
+
+        case LAYE_NODE_TYPE_VOID:
+        case LAYE_NODE_TYPE_NORETURN:
+        case LAYE_NODE_TYPE_BOOL:
+        case LAYE_NODE_TYPE_INT:
+        case LAYE_NODE_TYPE_FLOAT: {
+            laye_node key = {
+                .kind = type->kind,
+                .type_primitive = type->type_primitive,
+            };
+
+            laye_type canonical_type = laye_sema_get_canonical_type(sema, type->module, type->location, key);
+            laye_sema_analyse_type(sema, &canonical_type);
+            return canonical_type.node;
+        }
+
+        case LAYE_NODE_TYPE_REFERENCE:
+        case LAYE_NODE_TYPE_POINTER:
+        case LAYE_NODE_TYPE_BUFFER: {
+            return laye_sema_get_container_type(sema, type->kind, type->type_container.element_type, false).node;
+        }
+    }
+}
+
+static laye_type laye_sema_get_container_type(laye_sema* sema, laye_node_kind kind, laye_type element_type, bool is_modifiable) {
     assert(sema != NULL);
     assert(sema->context != NULL);
     assert(element_type.node != NULL);
     assert(element_type.node->module != NULL);
     assert(laye_node_is_type(element_type.node));
-    laye_node* type = laye_node_create(element_type.node->module, LAYE_NODE_TYPE_BUFFER, element_type.node->location, LTY(sema->context->laye_types.type));
-    assert(type != NULL);
-    type->type_container.element_type = element_type;
-    return LTY(type);
+
+    laye_node key = {
+        .kind = kind,
+        .type_container = {
+            .element_type = element_type,
+        },
+    };
+    key.type_container.element_type.node = laye_sema_canonical_type_node(sema, element_type.node);
+
+    laye_type type = laye_sema_get_canonical_type(sema, element_type.node->module, element_type.node->location, key);
+    laye_sema_analyse_type(sema, &type);
+    return laye_type_qualify(type.node, is_modifiable);
+}
+
+static laye_type laye_sema_get_pointer_to_type(laye_sema* sema, laye_type element_type, bool is_modifiable) {
+    return laye_sema_get_container_type(sema, LAYE_NODE_TYPE_POINTER, element_type, is_modifiable);
 }
 
 static laye_type laye_sema_get_reference_to_type(laye_sema* sema, laye_type element_type, bool is_modifiable) {
-    assert(sema != NULL);
-    assert(sema->context != NULL);
-    assert(element_type.node != NULL);
-    assert(element_type.node->module != NULL);
-    assert(laye_node_is_type(element_type.node));
-    laye_node* type = laye_node_create(element_type.node->module, LAYE_NODE_TYPE_REFERENCE, element_type.node->location, LTY(sema->context->laye_types.type));
-    assert(type != NULL);
-    type->type_container.element_type = element_type;
-    return LTY(type);
+    return laye_sema_get_container_type(sema, LAYE_NODE_TYPE_REFERENCE, element_type, is_modifiable);
 }
@@ -0,0 +1,750 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Analyses of a function's control flow graph, usually requested through the pass manager so they
+// are computed once and shared by every pass until the blocks of the function or the edges between
+// them change. Blocks are referred to by their index, which is their position in the function.
+
+#include <assert.h>
+#include <string.h>
+
+#include "layec.h"
+
+typedef struct layec_cfg_node {
+    layec_value* block;
+    dynarr(int64_t) predecessors;
+    dynarr(int64_t) successors;
+    // -1 for unreachable blocks.
+    int64_t rpo_number;
+} layec_cfg_node;
+
+struct layec_cfg {
+    lca_allocator allocator;
+    dynarr(layec_cfg_node) nodes;
+    dynarr(int64_t) rpo;
+};
+
+typedef struct layec_dominator_tree_node {
+    dynarr(int64_t) children;
+    // -1 for the entry block and for unreachable blocks.
+    int64_t idom;
+    // the interval of the node in a depth-first walk of the tree, for constant time dominance queries.
+    // both are -1 for unreachable blocks.
+    int64_t preorder_number;
+    int64_t postorder_number;
+} layec_dominator_tree_node;
+
+struct layec_dominator_tree {
+    lca_allocator allocator;
+    dynarr(layec_value*) blocks;
+    dynarr(layec_dominator_tree_node) nodes;
+};
+
+struct layec_dominance_frontier {
+    lca_allocator allocator;
+    dynarr(layec_value*) blocks;
+    dynarr(dynarr(int64_t)) frontiers;
+};
+
+struct layec_loop {
+    layec_loop_info* loop_info;
+    layec_loop* parent;
+    int64_t depth;
+    // the header comes first, the rest are in reverse post-order.
+    dynarr(layec_value*) blocks;
+    dynarr(layec_value*) latches;
+};
+
+struct layec_loop_info {
+    lca_allocator allocator;
+    dynarr(layec_loop*) loops;
+    // block index -> the innermost loop containing it
+    dynarr(layec_loop*) block_loops;
+};
+
+static lca_allocator layec_analysis_allocator(layec_value* function) {
+    return layec_value_context(function)->allocator;
+}
+
+static int64_t layec_analysis_block_index(dynarr(layec_value*) blocks, layec_value* block) {
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+
+    int64_t index = layec_block_index(block);
+    assert(index >= 0 && index < arr_count(blocks));
+    assert(blocks[index] == block);
+    return index;
+}
+
+// ===== Control Flow Graph =====
+
+static int64_t layec_cfg_node_index(layec_cfg* cfg, layec_value* block) {
+    assert(cfg != NULL);
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+
+    int64_t index = layec_block_index(block);
+    assert(index >= 0 && index < arr_count(cfg->nodes));
+    assert(cfg->nodes[index].block == block);
+    return index;
+}
+
+static void* layec_cfg_compute(layec_pass_manager* pass_manager, layec_value* function) {
+    (void)pass_manager;
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    int64_t block_count = layec_function_block_count(function);
+    assert(block_count > 0);
+
+    lca_allocator allocator = layec_analysis_allocator(function);
+    layec_cfg* cfg = lca_allocate(allocator, sizeof *cfg);
+    assert(cfg != NULL);
+    *cfg = (layec_cfg){
+        .allocator = allocator,
+    };
+
+    arr_set_count(cfg->nodes, block_count);
+    memset(cfg->nodes, 0, (size_t)block_count * sizeof *cfg->nodes);
+
+    for (int64_t b = 0; b < block_count; b++) {
+        cfg->nodes[b].block = layec_function_get_block_at_index(function, b);
+        assert(layec_block_index(cfg->nodes[b].block) == b);
+        cfg->nodes[b].rpo_number = -1;
+    }
+
+    for (int64_t b = 0; b < block_count; b++) {
+        layec_cfg_node* node = &cfg->nodes[b];
+        for (int64_t s = 0, scount = layec_block_successor_count(node->block); s < scount; s++) {
+            int64_t successor_index = layec_block_index(layec_block_get_successor_at_index(node->block, s));
+
+            bool is_duplicate = false;
+            for (int64_t i = 0; i < arr_count(node->successors); i++) {
+                is_duplicate |= node->successors[i] == successor_index;
+            }
+
+            if (is_duplicate) {
+                continue;
+            }
+
+            arr_push(node->successors, successor_index);
+            arr_push(cfg->nodes[successor_index].predecessors, b);
+        }
+    }
+
+    // reverse post-order of everything reachable from the entry block.
+    // the visit stack holds (block, next successor) pairs flattened into one array.
+    dynarr(int64_t) postorder = NULL;
+    dynarr(int64_t) stack = NULL;
+    arr_push(stack, 0);
+    arr_push(stack, 0);
+    cfg->nodes[0].rpo_number = 0;
+
+    while (arr_count(stack) > 0) {
+        int64_t b = stack[arr_count(stack) - 2];
+        int64_t* next_successor = arr_back(stack);
+        layec_cfg_node* node = &cfg->nodes[b];
+
+        if (*next_successor < arr_count(node->successors)) {
+            int64_t successor_index = node->successors[*next_successor];
+            *next_successor += 1;
+
+            if (cfg->nodes[successor_index].rpo_number < 0) {
+                cfg->nodes[successor_index].rpo_number = 0;
+                arr_push(stack, successor_index);
+                arr_push(stack, 0);
+            }
+        } else {
+            arr_push(postorder, b);
+            arr_pop(stack);
+            arr_pop(stack);
+        }
+    }
+
+    for (int64_t i = arr_count(postorder) - 1; i >= 0; i--) {
+        cfg->nodes[postorder[i]].rpo_number = arr_count(cfg->rpo);
+        arr_push(cfg->rpo, postorder[i]);
+    }
+
+    arr_free(postorder);
+    arr_free(stack);
+
+    return cfg;
+}
+
+static void layec_cfg_destroy(void* result) {
+    layec_cfg* cfg = result;
+    if (cfg == NULL) return;
+
+    for (int64_t b = 0; b < arr_count(cfg->nodes); b++) {
+        arr_free(cfg->nodes[b].predecessors);
+        arr_free(cfg->nodes[b].successors);
+    }
+
+    arr_free(cfg->nodes);
+    arr_free(cfg->rpo);
+
+    lca_allocator allocator = cfg->allocator;
+    *cfg = (layec_cfg){0};
+    lca_deallocate(allocator, cfg);
+}
+
+const layec_analysis_info layec_cfg_analysis = {
+    .name = "cfg",
+    .compute = layec_cfg_compute,
+    .destroy = layec_cfg_destroy,
+    .depends_only_on_cfg = true,
+};
+
+layec_cfg* layec_cfg_get(layec_pass_manager* pass_manager, layec_value* function) {
+    return layec_pass_manager_get_analysis(pass_manager, &layec_cfg_analysis, function);
+}
+
+int64_t layec_cfg_predecessor_count(layec_cfg* cfg, layec_value* block) {
+    return arr_count(cfg->nodes[layec_cfg_node_index(cfg, block)].predecessors);
+}
+
+layec_value* layec_cfg_get_predecessor_at_index(layec_cfg* cfg, layec_value* block, int64_t predecessor_index) {
+    layec_cfg_node* node = &cfg->nodes[layec_cfg_node_index(cfg, block)];
+    assert(predecessor_index >= 0 && predecessor_index < arr_count(node->predecessors));
+    return cfg->nodes[node->predecessors[predecessor_index]].block;
+}
+
+int64_t layec_cfg_successor_count(layec_cfg* cfg, layec_value* block) {
+    return arr_count(cfg->nodes[layec_cfg_node_index(cfg, block)].successors);
+}
+
+layec_value* layec_cfg_get_successor_at_index(layec_cfg* cfg, layec_value* block, int64_t successor_index) {
+    layec_cfg_node* node = &cfg->nodes[layec_cfg_node_index(cfg, block)];
+    assert(successor_index >= 0 && successor_index < arr_count(node->successors));
+    return cfg->nodes[node->successors[successor_index]].block;
+}
+
+bool layec_cfg_is_reachable(layec_cfg* cfg, layec_value* block) {
+    return cfg->nodes[layec_cfg_node_index(cfg, block)].rpo_number >= 0;
+}
+
+int64_t layec_cfg_reachable_block_count(layec_cfg* cfg) {
+    assert(cfg != NULL);
+    return arr_count(cfg->rpo);
+}
+
+layec_value* layec_cfg_get_block_in_reverse_postorder(layec_cfg* cfg, int64_t rpo_index) {
+    assert(cfg != NULL);
+    assert(rpo_index >= 0 && rpo_index < arr_count(cfg->rpo));
+    return cfg->nodes[cfg->rpo[rpo_index]].block;
+}
+
+// ===== Dominator Tree =====
+
+static void* layec_dominator_tree_compute(layec_pass_manager* pass_manager, layec_value* function) {
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    int64_t block_count = arr_count(cfg->nodes);
+
+    lca_allocator allocator = layec_analysis_allocator(function);
+    layec_dominator_tree* tree = lca_allocate(allocator, sizeof *tree);
+    assert(tree != NULL);
+    *tree = (layec_dominator_tree){
+        .allocator = allocator,
+    };
+
+    arr_set_count(tree->nodes, block_count);
+    memset(tree->nodes, 0, (size_t)block_count * sizeof *tree->nodes);
+
+    for (int64_t b = 0; b < block_count; b++) {
+        arr_push(tree->blocks, cfg->nodes[b].block);
+        tree->nodes[b].idom = -1;
+        tree->nodes[b].preorder_number = -1;
+        tree->nodes[b].postorder_number = -1;
+    }
+
+    // immediate dominators, from Cooper, Harvey and Kennedy's "A Simple, Fast Dominance Algorithm".
+    tree->nodes[0].idom = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (int64_t i = 1; i < arr_count(cfg->rpo); i++) {
+            int64_t b = cfg->rpo[i];
+
+            int64_t new_idom = -1;
+            for (int64_t p = 0; p < arr_count(cfg->nodes[b].predecessors); p++) {
+                int64_t other = cfg->nodes[b].predecessors[p];
+                if (tree->nodes[other].idom < 0) {
+                    continue;
+                }
+
+                if (new_idom < 0) {
+                    new_idom = other;
+                    continue;
+                }
+
+                while (other != new_idom) {
+                    while (cfg->nodes[other].rpo_number > cfg->nodes[new_idom].rpo_number) {
+                        other = tree->nodes[other].idom;
+                    }
+
+                    while (cfg->nodes[new_idom].rpo_number > cfg->nodes[other].rpo_number) {
+                        new_idom = tree->nodes[new_idom].idom;
+                    }
+                }
+            }
+
+            assert(new_idom >= 0);
+            if (tree->nodes[b].idom != new_idom) {
+                tree->nodes[b].idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    tree->nodes[0].idom = -1;
+    for (int64_t i = 1; i < arr_count(cfg->rpo); i++) {
+        int64_t b = cfg->rpo[i];
+        arr_push(tree->nodes[tree->nodes[b].idom].children, b);
+    }
+
+    // number the tree; a negative entry means "leave node -(entry + 1)".
+    int64_t walk_number = 0;
+    dynarr(int64_t) stack = NULL;
+    arr_push(stack, 0);
+
+    while (arr_count(stack) > 0) {
+        int64_t entry = *arr_back(stack);
+        arr_pop(stack);
+
+        if (entry < 0) {
+            tree->nodes[-(entry + 1)].postorder_number = walk_number++;
+            continue;
+        }
+
+        layec_dominator_tree_node* node = &tree->nodes[entry];
+        node->preorder_number = walk_number++;
+        arr_push(stack, -(entry + 1));
+
+        for (int64_t c = arr_count(node->children) - 1; c >= 0; c--) {
+            arr_push(stack, node->children[c]);
+        }
+    }
+
+    arr_free(stack);
+
+    return tree;
+}
+
+static void layec_dominator_tree_destroy(void* result) {
+    layec_dominator_tree* tree = result;
+    if (tree == NULL) return;
+
+    for (int64_t b = 0; b < arr_count(tree->nodes); b++) {
+        arr_free(tree->nodes[b].children);
+    }
+
+    arr_free(tree->nodes);
+    arr_free(tree->blocks);
+
+    lca_allocator allocator = tree->allocator;
+    *tree = (layec_dominator_tree){0};
+    lca_deallocate(allocator, tree);
+}
+
+const layec_analysis_info layec_dominator_tree_analysis = {
+    .name = "dominator-tree",
+    .compute = layec_dominator_tree_compute,
+    .destroy = layec_dominator_tree_destroy,
+    .depends_only_on_cfg = true,
+};
+
+layec_dominator_tree* layec_dominator_tree_get(layec_pass_manager* pass_manager, layec_value* function) {
+    return layec_pass_manager_get_analysis(pass_manager, &layec_dominator_tree_analysis, function);
+}
+
+bool layec_dominator_tree_is_reachable(layec_dominator_tree* tree, layec_value* block) {
+    return tree->nodes[layec_analysis_block_index(tree->blocks, block)].preorder_number >= 0;
+}
+
+layec_value* layec_dominator_tree_immediate_dominator(layec_dominator_tree* tree, layec_value* block) {
+    int64_t idom = tree->nodes[layec_analysis_block_index(tree->blocks, block)].idom;
+    return idom < 0 ? NULL : tree->blocks[idom];
+}
+
+int64_t layec_dominator_tree_child_count(layec_dominator_tree* tree, layec_value* block) {
+    return arr_count(tree->nodes[layec_analysis_block_index(tree->blocks, block)].children);
+}
+
+layec_value* layec_dominator_tree_get_child_at_index(layec_dominator_tree* tree, layec_value* block, int64_t child_index) {
+    layec_dominator_tree_node* node = &tree->nodes[layec_analysis_block_index(tree->blocks, block)];
+    assert(child_index >= 0 && child_index < arr_count(node->children));
+    return tree->blocks[node->children[child_index]];
+}
+
+bool layec_dominator_tree_dominates(layec_dominator_tree* tree, layec_value* dominator, layec_value* block) {
+    layec_dominator_tree_node* dominator_node = &tree->nodes[layec_analysis_block_index(tree->blocks, dominator)];
+    layec_dominator_tree_node* node = &tree->nodes[layec_analysis_block_index(tree->blocks, block)];
+
+    // nothing is dominated by, nor dominates, an unreachable block.
+    if (dominator_node->preorder_number < 0 || node->preorder_number < 0) {
+        return false;
+    }
+
+    return dominator_node->preorder_number <= node->preorder_number && node->postorder_number <= dominator_node->postorder_number;
+}
+
+// ===== Dominance Frontiers =====
+
+static void* layec_dominance_frontier_compute(layec_pass_manager* pass_manager, layec_value* function) {
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    layec_dominator_tree* tree = layec_dominator_tree_get(pass_manager, function);
+    int64_t block_count = arr_count(cfg->nodes);
+
+    lca_allocator allocator = layec_analysis_allocator(function);
+    layec_dominance_frontier* frontier = lca_allocate(allocator, sizeof *frontier);
+    assert(frontier != NULL);
+    *frontier = (layec_dominance_frontier){
+        .allocator = allocator,
+    };
+
+    arr_set_count(frontier->frontiers, block_count);
+    memset(frontier->frontiers, 0, (size_t)block_count * sizeof *frontier->frontiers);
+    for (int64_t b = 0; b < block_count; b++) {
+        arr_push(frontier->blocks, cfg->nodes[b].block);
+    }
+
+    // only join points can be in a frontier.
+    for (int64_t i = 0; i < arr_count(cfg->rpo); i++) {
+        int64_t b = cfg->rpo[i];
+        layec_cfg_node* node = &cfg->nodes[b];
+        if (arr_count(node->predecessors) < 2) {
+            continue;
+        }
+
+        for (int64_t p = 0; p < arr_count(node->predecessors); p++) {
+            int64_t runner = node->predecessors[p];
+            if (cfg->nodes[runner].rpo_number < 0) {
+                continue;
+            }
+
+            while (runner != tree->nodes[b].idom) {
+                // every insertion for `b` happens in this loop, so checking the back is enough to deduplicate.
+                if (arr_count(frontier->frontiers[runner]) == 0 || *arr_back(frontier->frontiers[runner]) != b) {
+                    arr_push(frontier->frontiers[runner], b);
+                }
+
+                runner = tree->nodes[runner].idom;
+            }
+        }
+    }
+
+    return frontier;
+}
+
+static void layec_dominance_frontier_destroy(void* result) {
+    layec_dominance_frontier* frontier = result;
+    if (frontier == NULL) return;
+
+    for (int64_t b = 0; b < arr_count(frontier->frontiers); b++) {
+        arr_free(frontier->frontiers[b]);
+    }
+
+    arr_free(frontier->frontiers);
+    arr_free(frontier->blocks);
+
+    lca_allocator allocator = frontier->allocator;
+    *frontier = (layec_dominance_frontier){0};
+    lca_deallocate(allocator, frontier);
+}
+
+const layec_analysis_info layec_dominance_frontier_analysis = {
+    .name = "dominance-frontier",
+    .compute = layec_dominance_frontier_compute,
+    .destroy = layec_dominance_frontier_destroy,
+    .depends_only_on_cfg = true,
+};
+
+layec_dominance_frontier* layec_dominance_frontier_get(layec_pass_manager* pass_manager, layec_value* function) {
+    return layec_pass_manager_get_analysis(pass_manager, &layec_dominance_frontier_analysis, function);
+}
+
+int64_t layec_dominance_frontier_count(layec_dominance_frontier* frontier, layec_value* block) {
+    return arr_count(frontier->frontiers[layec_analysis_block_index(frontier->blocks, block)]);
+}
+
+layec_value* layec_dominance_frontier_get_block_at_index(layec_dominance_frontier* frontier, layec_value* block, int64_t frontier_index) {
+    dynarr(int64_t) block_frontier = frontier->frontiers[layec_analysis_block_index(frontier->blocks, block)];
+    assert(frontier_index >= 0 && frontier_index < arr_count(block_frontier));
+    return frontier->blocks[block_frontier[frontier_index]];
+}
+
+// ===== Loops =====
+
+static void* layec_loop_info_compute(layec_pass_manager* pass_manager, layec_value* function) {
+    layec_cfg* cfg = layec_cfg_get(pass_manager, function);
+    layec_dominator_tree* tree = layec_dominator_tree_get(pass_manager, function);
+    int64_t block_count = arr_count(cfg->nodes);
+
+    lca_allocator allocator = layec_analysis_allocator(function);
+    layec_loop_info* loop_info = lca_allocate(allocator, sizeof *loop_info);
+    assert(loop_info != NULL);
+    *loop_info = (layec_loop_info){
+        .allocator = allocator,
+    };
+
+    arr_set_count(loop_info->block_loops, block_count);
+    memset(loop_info->block_loops, 0, (size_t)block_count * sizeof *loop_info->block_loops);
+
+    dynarr(int64_t) stamps = NULL;
+    arr_set_count(stamps, block_count);
+    memset(stamps, 0, (size_t)block_count * sizeof *stamps);
+    dynarr(int64_t) worklist = NULL;
+
+    // a back edge goes to a block dominating its source; the loop is everything which reaches the
+    // source of a back edge without going through the header.
+    for (int64_t i = 0; i < arr_count(cfg->rpo); i++) {
+        int64_t header = cfg->rpo[i];
+        layec_cfg_node* header_node = &cfg->nodes[header];
+        int64_t stamp = i + 1;
+
+        layec_loop* loop = NULL;
+        for (int64_t p = 0; p < arr_count(header_node->predecessors); p++) {
+            int64_t latch = header_node->predecessors[p];
+            if (!layec_dominator_tree_dominates(tree, header_node->block, cfg->nodes[latch].block)) {
+                continue;
+            }
+
+            if (loop == NULL) {
+                loop = lca_allocate(allocator, sizeof *loop);
+                assert(loop != NULL);
+                *loop = (layec_loop){
+                    .loop_info = loop_info,
+                };
+
+                stamps[header] = stamp;
+            }
+
+            arr_push(loop->latches, cfg->nodes[latch].block);
+            if (stamps[latch] != stamp) {
+                stamps[latch] = stamp;
+                arr_push(worklist, latch);
+            }
+        }
+
+        if (loop == NULL) {
+            continue;
+        }
+
+        while (arr_count(worklist) > 0) {
+            int64_t b = *arr_back(worklist);
+            arr_pop(worklist);
+
+            for (int64_t p = 0; p < arr_count(cfg->nodes[b].predecessors); p++) {
+                int64_t predecessor = cfg->nodes[b].predecessors[p];
+                if (cfg->nodes[predecessor].rpo_number < 0 || stamps[predecessor] == stamp) {
+                    continue;
+                }
+
+                stamps[predecessor] = stamp;
+                arr_push(worklist, predecessor);
+            }
+        }
+
+        arr_push(loop->blocks, header_node->block);
+        for (int64_t j = i + 1; j < arr_count(cfg->rpo); j++) {
+            if (stamps[cfg->rpo[j]] == stamp) {
+                arr_push(loop->blocks, cfg->nodes[cfg->rpo[j]].block);
+            }
+        }
+
+        arr_push(loop_info->loops, loop);
+    }
+
+    // a loop nested in another is strictly smaller than it, so ordering by size puts every loop
+    // before the loops nested in it. the sort is stable to keep the order of disjoint loops.
+    for (int64_t i = 1; i < arr_count(loop_info->loops); i++) {
+        layec_loop* loop = loop_info->loops[i];
+        int64_t j = i;
+        while (j > 0 && arr_count(loop_info->loops[j - 1]->blocks) < arr_count(loop->blocks)) {
+            loop_info->loops[j] = loop_info->loops[j - 1];
+            j--;
+        }
+
+        loop_info->loops[j] = loop;
+    }
+
+    // going from outer to inner loops, the innermost loop seen so far for the header is the parent.
+    for (int64_t i = 0; i < arr_count(loop_info->loops); i++) {
+        layec_loop* loop = loop_info->loops[i];
+        loop->parent = loop_info->block_loops[layec_block_index(loop->blocks[0])];
+        loop->depth = loop->parent == NULL ? 1 : loop->parent->depth + 1;
+
+        for (int64_t b = 0; b < arr_count(loop->blocks); b++) {
+            loop_info->block_loops[layec_block_index(loop->blocks[b])] = loop;
+        }
+    }
+
+    arr_free(stamps);
+    arr_free(worklist);
+
+    return loop_info;
+}
+
+static void layec_loop_info_destroy(void* result) {
+    layec_loop_info* loop_info = result;
+    if (loop_info == NULL) return;
+
+    lca_allocator allocator = loop_info->allocator;
+    for (int64_t i = 0; i < arr_count(loop_info->loops); i++) {
+        layec_loop* loop = loop_info->loops[i];
+        arr_free(loop->blocks);
+        arr_free(loop->latches);
+        *loop = (layec_loop){0};
+        lca_deallocate(allocator, loop);
+    }
+
+    arr_free(loop_info->loops);
+    arr_free(loop_info->block_loops);
+
+    *loop_info = (layec_loop_info){0};
+    lca_deallocate(allocator, loop_info);
+}
+
+const layec_analysis_info layec_loop_info_analysis = {
+    .name = "loop-info",
+    .compute = layec_loop_info_compute,
+    .destroy = layec_loop_info_destroy,
+    .depends_only_on_cfg = true,
+};
+
+layec_loop_info* layec_loop_info_get(layec_pass_manager* pass_manager, layec_value* function) {
+    return layec_pass_manager_get_analysis(pass_manager, &layec_loop_info_analysis, function);
+}
+
+int64_t layec_loop_info_loop_count(layec_loop_info* loop_info) {
+    assert(loop_info != NULL);
+    return arr_count(loop_info->loops);
+}
+
+layec_loop* layec_loop_info_get_loop_at_index(layec_loop_info* loop_info, int64_t loop_index) {
+    assert(loop_info != NULL);
+    assert(loop_index >= 0 && loop_index < arr_count(loop_info->loops));
+    return loop_info->loops[loop_index];
+}
+
+layec_loop* layec_loop_info_get_loop_for_block(layec_loop_info* loop_info, layec_value* block) {
+    assert(loop_info != NULL);
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+
+    int64_t index = layec_block_index(block);
+    assert(index >= 0 && index < arr_count(loop_info->block_loops));
+    return loop_info->block_loops[index];
+}
+
+layec_value* layec_loop_header(layec_loop* loop) {
+    assert(loop != NULL);
+    return loop->blocks[0];
+}
+
+layec_loop* layec_loop_parent(layec_loop* loop) {
+    assert(loop != NULL);
+    return loop->parent;
+}
+
+int64_t layec_loop_depth(layec_loop* loop) {
+    assert(loop != NULL);
+    return loop->depth;
+}
+
+int64_t layec_loop_block_count(layec_loop* loop) {
+    assert(loop != NULL);
+    return arr_count(loop->blocks);
+}
+
+layec_value* layec_loop_get_block_at_index(layec_loop* loop, int64_t block_index) {
+    assert(loop != NULL);
+    assert(block_index >= 0 && block_index < arr_count(loop->blocks));
+    return loop->blocks[block_index];
+}
+
+int64_t layec_loop_latch_count(layec_loop* loop) {
+    assert(loop != NULL);
+    return arr_count(loop->latches);
+}
+
+layec_value* layec_loop_get_latch_at_index(layec_loop* loop, int64_t latch_index) {
+    assert(loop != NULL);
+    assert(latch_index >= 0 && latch_index < arr_count(loop->latches));
+    return loop->latches[latch_index];
+}
+
+bool layec_loop_contains(layec_loop* loop, layec_value* block) {
+    for (layec_loop* other = layec_loop_info_get_loop_for_block(loop->loop_info, block); other != NULL; other = other->parent) {
+        if (other == loop) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+layec_value* layec_loop_get_preheader(layec_loop* loop, layec_cfg* cfg) {
+    assert(loop != NULL);
+    assert(cfg != NULL);
+
+    layec_value* header = layec_loop_header(loop);
+
+    layec_value* preheader = NULL;
+    for (int64_t p = 0, pcount = layec_cfg_predecessor_count(cfg, header); p < pcount; p++) {
+        layec_value* predecessor = layec_cfg_get_predecessor_at_index(cfg, header, p);
+        if (layec_loop_contains(loop, predecessor)) {
+            continue;
+        }
+
+        if (preheader != NULL) {
+            return NULL;
+        }
+
+        preheader = predecessor;
+    }
+
+    if (preheader == NULL || layec_cfg_successor_count(cfg, preheader) != 1) {
+        return NULL;
+    }
+
+    return preheader;
+}
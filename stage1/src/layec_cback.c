@@ -47,7 +47,9 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 typedef struct cback_codegen {
     layec_context* context;
     bool use_color;
-    string* output;
+    lca_writer* output;
+    // values declared at the top of the current function rather than where they are defined.
+    ptrmap hoisted_values;
 } cback_codegen;
 
 static void cback_print_module(cback_codegen* codegen, layec_module* module);
@@ -57,17 +59,25 @@ string layec_codegen_c(layec_module* module) {
     layec_context* context = layec_module_context(module);
     assert(context != NULL);
 
-    string output_string = string_create(context->allocator);
+    lca_writer output_writer = lca_writer_create(context->allocator);
+    layec_codegen_c_to_writer(module, &output_writer);
+    return lca_writer_to_string(&output_writer);
+}
+
+void layec_codegen_c_to_writer(layec_module* module, lca_writer* output) {
+    assert(module != NULL);
+    assert(output != NULL);
+    layec_context* context = layec_module_context(module);
+    assert(context != NULL);
 
     cback_codegen codegen = {
         .context = context,
         .use_color = context->use_color,
-        .output = &output_string,
+        .output = output,
     };
 
     cback_print_module(&codegen, module);
-
-    return output_string;
+    ptrmap_free(&codegen.hoisted_values);
 }
 
 static void cback_print_header(cback_codegen* codegen, layec_module* module);
@@ -90,12 +100,12 @@ static void cback_print_module(cback_codegen* codegen, layec_module* module) {
     cback_define_structs(codegen, context);
 
     for (int64_t i = 0, count = layec_module_global_count(module); i < count; i++) {
-        if (i > 0) lca_string_append_format(codegen->output, "\n");
+        if (i > 0) lca_writer_append_char(codegen->output, '\n');
         layec_value* global = layec_module_get_global_at_index(module, i);
         cback_print_global(codegen, global);
     }
 
-    if (layec_module_global_count(module) > 0) lca_string_append_format(codegen->output, "\n");
+    if (layec_module_global_count(module) > 0) lca_writer_append_char(codegen->output, '\n');
 
     for (int64_t i = 0, count = layec_module_function_count(module); i < count; i++) {
         //if (i > 0) lca_string_append_format(codegen->output,  "\n");
@@ -103,21 +113,24 @@ static void cback_print_module(cback_codegen* codegen, layec_module* module) {
         cback_declare_function(codegen, function);
     }
 
-    if (layec_module_function_count(module) > 0) lca_string_append_format(codegen->output,  "\n");
+    if (layec_module_function_count(module) > 0) lca_writer_append_char(codegen->output, '\n');
 
     for (int64_t i = 0, count = layec_module_function_count(module); i < count; i++) {
-        if (i > 0) lca_string_append_format(codegen->output,  "\n");
+        if (i > 0) lca_writer_append_char(codegen->output, '\n');
         layec_value* function = layec_module_get_function_at_index(module, i);
         cback_define_function(codegen, function);
     }
 }
 
 static void cback_print_header(cback_codegen* codegen, layec_module* module) {
-    lca_string_append_format(codegen->output, "// Source File: '%.*s'\n\n", STR_EXPAND(layec_module_name(module)));
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "// Source File: '");
+    lca_writer_append_view(codegen->output, layec_module_name(module));
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "'\n\n");
 
     Nob_String_Builder builder = {0};
     nob_read_entire_file("./stage1/src/lyir_cir_preamble.h", &builder);
-    string_append_format(codegen->output, "%.*s\n", (int)builder.count, builder.items);
+    lca_writer_append_data(codegen->output, builder.items, builder.count);
+    lca_writer_append_char(codegen->output, '\n');
     nob_sb_free(builder);
 }
 
@@ -125,12 +138,16 @@ static void cback_declare_structs(cback_codegen* codegen, layec_context* context
     for (int64_t i = 0; i < layec_context_get_struct_type_count(codegen->context); i++) {
         layec_type* struct_type = layec_context_get_struct_type_at_index(codegen->context, i);
         if (layec_type_struct_is_named(struct_type)) {
-            lca_string_append_format(codegen->output, "typedef struct %.*s %.*s;\n", STR_EXPAND(layec_type_struct_name(struct_type)), STR_EXPAND(layec_type_struct_name(struct_type)));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "typedef struct ");
+            lca_writer_append_view(codegen->output, layec_type_struct_name(struct_type));
+            lca_writer_append_char(codegen->output, ' ');
+            lca_writer_append_view(codegen->output, layec_type_struct_name(struct_type));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ";\n");
         }
     }
 
     if (layec_context_get_struct_type_count(codegen->context) > 0) {
-        lca_string_append_format(codegen->output, "\n");
+        lca_writer_append_char(codegen->output, '\n');
     }
 }
 
@@ -138,18 +155,22 @@ static void cback_define_structs(cback_codegen* codegen, layec_context* context)
     for (int64_t i = 0; i < layec_context_get_struct_type_count(codegen->context); i++) {
         layec_type* struct_type = layec_context_get_struct_type_at_index(codegen->context, i);
         if (layec_type_struct_is_named(struct_type)) {
-            lca_string_append_format(codegen->output, "struct %.*s {\n", STR_EXPAND(layec_type_struct_name(struct_type)), STR_EXPAND(layec_type_struct_name(struct_type)));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "struct ");
+            lca_writer_append_view(codegen->output, layec_type_struct_name(struct_type));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " {\n");
 
             for (int64_t member_index = 0; member_index < layec_type_struct_member_count(struct_type); member_index++) {
-                lca_string_append_format(codegen->output, "    ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "    ");
 
                 layec_type* member_type = layec_type_struct_get_member_type_at_index(struct_type, member_index);
                 cback_print_type(codegen, member_type);
 
-                lca_string_append_format(codegen->output, " member_%d;\n", member_index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " member_");
+                lca_writer_append_int(codegen->output, member_index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, ";\n");
             }
         
-            lca_string_append_format(codegen->output, "};\n\n");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "};\n\n");
         }
     }
 }
@@ -161,9 +182,10 @@ static void cback_print_block_name(cback_codegen* codegen, layec_value* block) {
     if (layec_block_has_name(block)) {
         string_view block_name = layec_block_name(block);
         // TODO(local): probably need to sanitize this
-        lca_string_append_format(codegen->output, "%.*s", STR_EXPAND(block_name));
+        lca_writer_append_view(codegen->output, block_name);
     } else {
-        lca_string_append_format(codegen->output, "lyir_bb_%ld", layec_block_index(block));
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_bb_");
+        lca_writer_append_int(codegen->output, layec_block_index(block));
     }
 }
 
@@ -172,10 +194,12 @@ static void cback_print_global(cback_codegen* codegen, layec_value* global) {
 
 static void cback_print_function_prototype(cback_codegen* codegen, layec_value* function) {
     cback_print_type(codegen, layec_function_return_type(function));
-    lca_string_append_format(codegen->output, " %.*s(", STR_EXPAND(layec_function_name(function)));
+    lca_writer_append_char(codegen->output, ' ');
+    lca_writer_append_view(codegen->output, layec_function_name(function));
+    lca_writer_append_char(codegen->output, '(');
 
     for (int64_t i = 0; i < layec_function_parameter_count(function); i++) {
-        if (i > 0) lca_string_append_format(codegen->output, ", ");
+        if (i > 0) LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
 
         layec_value* param = layec_function_get_parameter_at_index(function, i);
         assert(param != NULL);
@@ -184,151 +208,265 @@ static void cback_print_function_prototype(cback_codegen* codegen, layec_value*
         assert(param_type != NULL);
 
         cback_print_type(codegen, param_type);
-        lca_string_append_format(codegen->output, " %.*s", STR_EXPAND(layec_value_name(param)));
+        lca_writer_append_char(codegen->output, ' ');
+        lca_writer_append_view(codegen->output, layec_value_name(param));
     }
 
     if (layec_function_is_variadic(function)) {
         if (layec_function_parameter_count(function) > 0) {
-            lca_string_append_format(codegen->output, ", ...");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ...");
         } else {
-            lca_string_append_format(codegen->output, "...");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "...");
         }
     }
 
-    lca_string_append_format(codegen->output, ")");
+    lca_writer_append_char(codegen->output, ')');
 }
 
 static void cback_declare_function(cback_codegen* codegen, layec_value* function) {
     cback_print_function_prototype(codegen, function);
-    lca_string_append_format(codegen->output, ";\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, ";\n");
+}
+
+// C has no phis, so a phi becomes a variable declared at the top of the function which every
+// incoming edge assigns to before its `goto`. Values used in a block printed before the one
+// defining them are declared up there as well, since C would reject the use otherwise.
+static void cback_declare_hoisted_values(cback_codegen* codegen, layec_value* function) {
+    ptrmap_clear(&codegen->hoisted_values);
+
+    for (int64_t block_index = 0; block_index < layec_function_block_count(function); block_index++) {
+        layec_value* block = layec_function_get_block_at_index(function, block_index);
+        for (int64_t inst_index = 0; inst_index < layec_block_instruction_count(block); inst_index++) {
+            layec_value* inst = layec_block_get_instruction_at_index(block, inst_index);
+            if (layec_value_get_kind(inst) == LAYEC_IR_PHI) {
+                ptrmap_set(&codegen->hoisted_values, inst, inst);
+            }
+
+            for (int64_t i = 0, count = layec_instruction_operand_count(inst); i < count; i++) {
+                layec_value* operand = layec_instruction_get_operand_at_index(inst, i);
+                if (!layec_value_is_instruction(operand) || layec_value_get_kind(operand) == LAYEC_IR_ALLOCA) {
+                    continue;
+                }
+
+                layec_value* operand_block = layec_instruction_get_parent_block(operand);
+                if (operand_block != NULL && layec_block_index(operand_block) > block_index) {
+                    ptrmap_set(&codegen->hoisted_values, operand, operand);
+                }
+            }
+        }
+    }
+
+    for (int64_t block_index = 0; block_index < layec_function_block_count(function); block_index++) {
+        layec_value* block = layec_function_get_block_at_index(function, block_index);
+        for (int64_t inst_index = 0; inst_index < layec_block_instruction_count(block); inst_index++) {
+            layec_value* inst = layec_block_get_instruction_at_index(block, inst_index);
+            if (!ptrmap_contains(&codegen->hoisted_values, inst)) {
+                continue;
+            }
+
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "    ");
+            cback_print_value(codegen, inst, true);
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ";\n");
+        }
+    }
+}
+
+static layec_value* cback_phi_incoming_value_for_block(layec_value* phi, layec_value* block) {
+    for (int64_t i = 0, count = layec_instruction_phi_incoming_value_count(phi); i < count; i++) {
+        if (layec_instruction_phi_incoming_block_at_index(phi, i) == block) {
+            return layec_instruction_phi_incoming_value_at_index(phi, i);
+        }
+    }
+
+    assert(false && "phi has no incoming value for a predecessor block");
+    return NULL;
+}
+
+// assigns every phi of `to_block` its value along the edge from `from_block`.
+// the copies happen in parallel, so they go through temporaries when one phi reads another.
+static void cback_print_phi_copies(cback_codegen* codegen, layec_value* from_block, layec_value* to_block) {
+    bool needs_temporaries = false;
+    int64_t phi_count = 0;
+
+    for (; phi_count < layec_block_instruction_count(to_block); phi_count++) {
+        layec_value* phi = layec_block_get_instruction_at_index(to_block, phi_count);
+        if (layec_value_get_kind(phi) != LAYEC_IR_PHI) {
+            break;
+        }
+
+        layec_value* value = cback_phi_incoming_value_for_block(phi, from_block);
+        if (layec_value_get_kind(value) == LAYEC_IR_PHI && layec_instruction_get_parent_block(value) == to_block) {
+            needs_temporaries = true;
+        }
+    }
+
+    if (needs_temporaries) {
+        for (int64_t i = 0; i < phi_count; i++) {
+            layec_value* phi = layec_block_get_instruction_at_index(to_block, i);
+            cback_print_type(codegen, layec_value_get_type(phi));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " lyir_phi_tmp_");
+            lca_writer_append_int(codegen->output, i);
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
+            cback_print_value(codegen, cback_phi_incoming_value_for_block(phi, from_block), false);
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "; ");
+        }
+    }
+
+    for (int64_t i = 0; i < phi_count; i++) {
+        layec_value* phi = layec_block_get_instruction_at_index(to_block, i);
+        cback_print_value(codegen, phi, false);
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
+        if (needs_temporaries) {
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_phi_tmp_");
+            lca_writer_append_int(codegen->output, i);
+        } else {
+            cback_print_value(codegen, cback_phi_incoming_value_for_block(phi, from_block), false);
+        }
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "; ");
+    }
 }
 
 static void cback_define_function(cback_codegen* codegen, layec_value* function) {
     cback_print_function_prototype(codegen, function);
-    lca_string_append_format(codegen->output, " {\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, " {\n");
+
+    cback_declare_hoisted_values(codegen, function);
 
     for (int64_t block_index = 0; block_index < layec_function_block_count(function); block_index++) {
         layec_value* block = layec_function_get_block_at_index(function, block_index);
         assert(block != NULL);
 
         cback_print_block_name(codegen, block);
-        lca_string_append_format(codegen->output, ":;\n");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, ":;\n");
         for (int64_t inst_index = 0; inst_index < layec_block_instruction_count(block); inst_index++) {
             layec_value* inst = layec_block_get_instruction_at_index(block, inst_index);
             assert(inst != NULL);
 
-            lca_string_append_format(codegen->output, "    ");
+            // phis are assigned on the incoming edges instead.
+            if (layec_value_get_kind(inst) == LAYEC_IR_PHI) {
+                continue;
+            }
+
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "    ");
 
             if (!layec_type_is_void(layec_value_get_type(inst))) {
-                cback_print_value(codegen, inst, true);
-                lca_string_append_format(codegen->output, " = ");
+                cback_print_value(codegen, inst, !ptrmap_contains(&codegen->hoisted_values, inst));
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
             }
             
             switch (layec_value_get_kind(inst)) {
                 default: {
                     fprintf(stderr, "for lyir type '%s'\n", layec_value_kind_to_cstring(layec_value_get_kind(inst)));
                     //assert(false && "unhandled LYIR instruction in C backend\n");
-                    lca_string_append_format(codegen->output, "<<%s>>;", layec_value_kind_to_cstring(layec_value_get_kind(inst)));
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "<<");
+                    lca_writer_append_cstring(codegen->output, layec_value_kind_to_cstring(layec_value_get_kind(inst)));
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ">>;");
                 } break;
 
                 case LAYEC_IR_RETURN: {
-                    lca_string_append_format(codegen->output, "return");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "return");
 
                     if (layec_instruction_return_has_value(inst)) {
-                        lca_string_append_format(codegen->output, " ");
+                        lca_writer_append_char(codegen->output, ' ');
                         cback_print_value(codegen, layec_instruction_return_value(inst), false);
                     }
 
-                    lca_string_append_format(codegen->output, ";");
+                    lca_writer_append_char(codegen->output, ';');
                 } break;
 
                 case LAYEC_IR_BRANCH: {
-                    lca_string_append_format(codegen->output, "goto ");
-                    cback_print_block_name(codegen, layec_instruction_branch_get_pass(inst));
-                    lca_string_append_format(codegen->output, ";");
+                    layec_value* pass_block = layec_instruction_branch_get_pass(inst);
+                    cback_print_phi_copies(codegen, block, pass_block);
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "goto ");
+                    cback_print_block_name(codegen, pass_block);
+                    lca_writer_append_char(codegen->output, ';');
                 } break;
 
                 case LAYEC_IR_COND_BRANCH: {
                     layec_value* condition_value = layec_instruction_get_value(inst);
                     layec_value* pass_block = layec_instruction_branch_get_pass(inst);
                     layec_value* fail_block = layec_instruction_branch_get_fail(inst);
-                    lca_string_append_format(codegen->output, "if (");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "if (");
                     cback_print_value(codegen, condition_value, false);
-                    lca_string_append_format(codegen->output, ") { goto ");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ") { ");
+                    cback_print_phi_copies(codegen, block, pass_block);
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "goto ");
                     cback_print_block_name(codegen, pass_block);
-                    lca_string_append_format(codegen->output, "; } else { goto ");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "; } else { ");
+                    cback_print_phi_copies(codegen, block, fail_block);
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "goto ");
                     cback_print_block_name(codegen, fail_block);
-                    lca_string_append_format(codegen->output, "; }");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "; }");
                 } break;
 
                 case LAYEC_IR_ALLOCA: {
-                    lca_string_append_format(codegen->output, "{0};");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "{0};");
                 } break;
 
                 case LAYEC_IR_STORE: {
-                    lca_string_append_format(codegen->output, "*(");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "*(");
                     cback_print_type(codegen, layec_value_get_type(layec_instruction_get_operand(inst)));
-                    lca_string_append_format(codegen->output, "*)(");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "*)(");
                     cback_print_value(codegen, layec_instruction_get_address(inst), false);
-                    lca_string_append_format(codegen->output, ") = ");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ") = ");
                     cback_print_value(codegen, layec_instruction_get_operand(inst), false);
-                    lca_string_append_format(codegen->output, ";");
+                    lca_writer_append_char(codegen->output, ';');
                 } break;
 
                 case LAYEC_IR_LOAD: {
-                    lca_string_append_format(codegen->output, "*(");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "*(");
                     cback_print_type(codegen, layec_value_get_type(inst));
-                    lca_string_append_format(codegen->output, "*)(");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "*)(");
                     cback_print_value(codegen, layec_instruction_get_address(inst), false);
-                    lca_string_append_format(codegen->output, ");");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ");");
                 } break;
 
                 case LAYEC_IR_ADD: {
-                    lca_string_append_format(codegen->output, "(");
+                    lca_writer_append_char(codegen->output, '(');
                     cback_print_value(codegen, layec_instruction_binary_get_lhs(inst), false);
-                    lca_string_append_format(codegen->output, ") + (");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ") + (");
                     cback_print_value(codegen, layec_instruction_binary_get_rhs(inst), false);
-                    lca_string_append_format(codegen->output, ");");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ");");
                 } break;
 
                 case LAYEC_IR_SUB: {
-                    lca_string_append_format(codegen->output, "(");
+                    lca_writer_append_char(codegen->output, '(');
                     cback_print_value(codegen, layec_instruction_binary_get_lhs(inst), false);
-                    lca_string_append_format(codegen->output, ") - (");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ") - (");
                     cback_print_value(codegen, layec_instruction_binary_get_rhs(inst), false);
-                    lca_string_append_format(codegen->output, ");");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ");");
                 } break;
 
                 case LAYEC_IR_ICMP_SLT: {
-                    lca_string_append_format(codegen->output, "(");
+                    lca_writer_append_char(codegen->output, '(');
                     cback_print_value(codegen, layec_instruction_binary_get_lhs(inst), false);
-                    lca_string_append_format(codegen->output, ") < (");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ") < (");
                     cback_print_value(codegen, layec_instruction_binary_get_rhs(inst), false);
-                    lca_string_append_format(codegen->output, ");");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ");");
                 } break;
 
                 case LAYEC_IR_CALL: {
                     cback_print_value(codegen, layec_instruction_callee(inst), false);
-                    lca_string_append_format(codegen->output, "(");
+                    lca_writer_append_char(codegen->output, '(');
 
                     for (int64_t i = 0, count = layec_instruction_call_argument_count(inst); i < count; i++) {
                         if (i > 0) {
-                            lca_string_append_format(codegen->output, ", ");
+                            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
                         }
 
                         layec_value* argument = layec_instruction_call_get_argument_at_index(inst, i);
                         cback_print_value(codegen, argument, false);
                     }
 
-                    lca_string_append_format(codegen->output, ");");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ");");
                 } break;
             }
 
-            lca_string_append_format(codegen->output, "\n");
+            lca_writer_append_char(codegen->output, '\n');
         }
     }
 
-    lca_string_append_format(codegen->output, "}\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "}\n");
 }
 
 static void cback_print_type(cback_codegen* codegen, layec_type* type) {
@@ -339,27 +477,29 @@ static void cback_print_type(cback_codegen* codegen, layec_type* type) {
         } break;
 
         case LAYEC_TYPE_VOID: {
-            lca_string_append_format(codegen->output, "void");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "void");
         } break;
 
         case LAYEC_TYPE_POINTER: {
-            lca_string_append_format(codegen->output, "lyir_ptr");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_ptr");
         } break;
 
         case LAYEC_TYPE_INTEGER: {
             int bit_width = layec_type_size_in_bits(type);
             if (bit_width == 1) {
-                lca_string_append_format(codegen->output, "lyir_bool");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_bool");
             } else if (bit_width == 8) {
-                lca_string_append_format(codegen->output, "lyir_i8");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_i8");
             } else if (bit_width == 16) {
-                lca_string_append_format(codegen->output, "lyir_i16");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_i16");
             } else if (bit_width == 32) {
-                lca_string_append_format(codegen->output, "lyir_i32");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_i32");
             } else if (bit_width == 64) {
-                lca_string_append_format(codegen->output, "lyir_i64");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_i64");
             } else {
-                lca_string_append_format(codegen->output, "_BitInt(%d)", bit_width);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "_BitInt(");
+                lca_writer_append_int(codegen->output, bit_width);
+                lca_writer_append_char(codegen->output, ')');
                 //fprintf(stderr, "unsupported bit width: %d\n", bit_width);
                 //assert(false && "unsupported int bit width in C backend");
             }
@@ -368,9 +508,9 @@ static void cback_print_type(cback_codegen* codegen, layec_type* type) {
         case LAYEC_TYPE_FLOAT: {
             int bit_width = layec_type_size_in_bits(type);
             if (bit_width == 32) {
-                lca_string_append_format(codegen->output, "lyir_f32");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_f32");
             } else if (bit_width == 64) {
-                lca_string_append_format(codegen->output, "lyir_f64");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_f64");
             } else {
                 fprintf(stderr, "unsupported bit width: %d\n", bit_width);
                 assert(false && "unsupported float bit width in C backend");
@@ -382,7 +522,7 @@ static void cback_print_type(cback_codegen* codegen, layec_type* type) {
 static void cback_print_value(cback_codegen* codegen, layec_value* value, bool include_type) {
     if (include_type) {
         cback_print_type(codegen, layec_value_get_type(value));
-        lca_string_append_format(codegen->output, " ");
+        lca_writer_append_char(codegen->output, ' ');
     }
 
     switch (layec_value_get_kind(value)) {
@@ -390,46 +530,53 @@ static void cback_print_value(cback_codegen* codegen, layec_value* value, bool i
             string_view name = layec_value_name(value);
             if (name.count == 0) {
                 int64_t index = layec_value_index(value);
-                lca_string_append_format(codegen->output, "lyir_inst_%lld", index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_inst_");
+                lca_writer_append_int(codegen->output, index);
             } else {
-                lca_string_append_format(codegen->output, "%.*s", STR_EXPAND(name));
+                lca_writer_append_view(codegen->output, name);
             }
         } break;
 
         case LAYEC_IR_FUNCTION: {
-            lca_string_append_format(codegen->output, "%.*s", STR_EXPAND(layec_function_name(value)));
+            lca_writer_append_view(codegen->output, layec_function_name(value));
         } break;
 
         case LAYEC_IR_GLOBAL_VARIABLE: {
             string_view name = layec_value_name(value);
             if (name.count == 0) {
                 int64_t index = layec_value_index(value);
-                lca_string_append_format(codegen->output, "lyir_glbl_%lld", index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_glbl_");
+                lca_writer_append_int(codegen->output, index);
             } else {
-                lca_string_append_format(codegen->output, "%.*s", STR_EXPAND(name));
+                lca_writer_append_view(codegen->output, name);
             }
         } break;
 
         case LAYEC_IR_INTEGER_CONSTANT: {
             int64_t ival = layec_value_integer_constant(value);
             if (layec_type_is_ptr(layec_value_get_type(value)) && ival == 0)
-                lca_string_append_format(codegen->output, "NULL");
-            else lca_string_append_format(codegen->output, "%lld", ival);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "NULL");
+            else lca_writer_append_int(codegen->output, ival);
         } break;
 
         case LAYEC_IR_FLOAT_CONSTANT: {
             double float_value = layec_value_float_constant(value);
-            lca_string_append_format(codegen->output, "%f", float_value);
+            lca_writer_append_float(codegen->output, float_value);
+        } break;
+
+        case LAYEC_IR_POISON: {
+            lca_writer_append_char(codegen->output, '0');
         } break;
 
         case LAYEC_IR_ALLOCA: {
-            if (!include_type) lca_string_append_format(codegen->output, "&");
+            if (!include_type) lca_writer_append_char(codegen->output, '&');
             string_view name = layec_value_name(value);
             if (name.count == 0) {
                 int64_t index = layec_value_index(value);
-                lca_string_append_format(codegen->output, "lyir_inst_%lld", index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "lyir_inst_");
+                lca_writer_append_int(codegen->output, index);
             } else {
-                lca_string_append_format(codegen->output, "%.*s", STR_EXPAND(name));
+                lca_writer_append_view(codegen->output, name);
             }
         } break;
     }
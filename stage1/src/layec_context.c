@@ -42,6 +42,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "layec.h"
 #include "laye.h"
@@ -115,6 +116,7 @@ layec_context* layec_context_create(lca_allocator allocator) {
     assert(context->target != NULL);
 
     context->max_interned_string_size = 1024 * 1024;
+    context->inline_threshold = -1;
 
     context->string_arena = lca_arena_create(allocator, context->max_interned_string_size);
     assert(context->string_arena != NULL);
@@ -192,12 +194,15 @@ layec_context* layec_context_create(lca_allocator allocator) {
 void layec_context_destroy(layec_context* context) {
     if (context == NULL) return;
 
+    layec_trace_close(context);
+
     lca_allocator allocator = context->allocator;
 
     for (int64_t i = 0, count = arr_count(context->sources); i < count; i++) {
         layec_source* source = &context->sources[i];
         string_destroy(&source->name);
         string_destroy(&source->text);
+        arr_free(source->line_starts);
     }
 
     arr_free(context->sources);
@@ -206,7 +211,7 @@ void layec_context_destroy(layec_context* context) {
     arr_free(context->link_libraries);
 
     lca_arena_destroy(context->string_arena);
-    arr_free(context->_interned_strings);
+    lca_hashset_free(&context->_interned_strings);
 
     for (int64_t i = 0, count = arr_count(context->allocated_strings); i < count; i++) {
         string* string = &context->allocated_strings[i];
@@ -249,8 +254,9 @@ void layec_context_destroy(layec_context* context) {
     for (int64_t i = 0, count = arr_count(context->_all_types); i < count; i++) {
         layec_type_destroy(context->_all_types[i]);
     }
-    
-    arr_free(context->types.int_types);
+
+    lca_hashset_free(&context->_unique_types);
+
     arr_free(context->_all_types);
     arr_free(context->_all_struct_types);
     lca_arena_destroy(context->type_arena);
@@ -344,32 +350,54 @@ layec_source layec_context_get_source(layec_context* context, layec_sourceid sou
     return context->sources[sourceid];
 }
 
+static void layec_source_build_line_starts(layec_source* source) {
+    assert(source != NULL);
+    assert(source->line_starts == NULL);
+
+    const char* text = source->text.data;
+    int64_t count = source->text.count;
+
+    arr_push(source->line_starts, 0);
+
+    // NOTE(local): memchr is vectorized by every libc we care about, so this is far faster than a byte loop
+    const char* newline = count > 0 ? memchr(text, '\n', (size_t)count) : NULL;
+    while (newline != NULL) {
+        int64_t line_start = (int64_t)(newline - text) + 1;
+        arr_push(source->line_starts, line_start);
+        newline = line_start < count ? memchr(text + line_start, '\n', (size_t)(count - line_start)) : NULL;
+    }
+}
+
 bool layec_context_get_location_info(layec_context* context, layec_location location, string_view* out_name, int64_t* out_line, int64_t* out_column) {
     assert(context != NULL);
 
     if (location.offset < 0) return false;
 
-    layec_source source = layec_context_get_source(context, location.sourceid);
-    if (out_name != NULL) *out_name = string_as_view(source.name);
+    assert(location.sourceid >= 0 && location.sourceid < arr_count(context->sources));
+    layec_source* source = &context->sources[location.sourceid];
+    if (out_name != NULL) *out_name = string_as_view(source->name);
 
-    if (location.offset >= source.text.count) return false;
-    if (location.offset + location.length > source.text.count) return false;
+    if (location.offset >= source->text.count) return false;
+    if (location.offset + location.length > source->text.count) return false;
 
-    int64_t last_line_start_offset = 0;
-    int64_t line_number = 1;
+    if (source->line_starts == NULL) {
+        layec_source_build_line_starts(source);
+    }
 
-    char lastc = 0;
-    for (int64_t i = 0; i <= location.offset; i++) {
-        if (lastc == '\n') {
-            last_line_start_offset = i;
-            line_number++;
+    // find the last line which starts at or before the offset.
+    int64_t low = 0;
+    int64_t high = arr_count(source->line_starts) - 1;
+    while (low < high) {
+        int64_t middle = low + (high - low + 1) / 2;
+        if (source->line_starts[middle] <= location.offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
         }
-
-        lastc = source.text.data[i];
     }
 
-    if (out_line != NULL) *out_line = line_number;
-    if (out_column != NULL) *out_column = 1 + (location.offset - last_line_start_offset);
+    if (out_line != NULL) *out_line = low + 1;
+    if (out_column != NULL) *out_column = 1 + (location.offset - source->line_starts[low]);
 
     return true;
 }
@@ -502,19 +530,68 @@ void layec_write_ice(layec_context* context, layec_location location, const char
 
 #undef GET_MESSAGE
 
-string_view layec_context_intern_string_view(layec_context* context, string_view s) {
-    if (s.count + 1 > context->max_interned_string_size) {
+// every interned string is one allocation in the string arena: its symbol, then its NUL-terminated
+// contents, unless those are too large for an arena block and live in `allocated_strings` instead.
+// allocations are padded so each one stays aligned for the next.
+typedef struct layec_interned_string {
+    layec_symbol symbol;
+    char data[];
+} layec_interned_string;
+
+static bool layec_interned_string_equals(const void* value, const void* key) {
+    return string_view_equals(((const layec_interned_string*)value)->symbol, *(const string_view*)key);
+}
+
+static layec_interned_string* layec_context_find_interned_string(layec_context* context, string_view s, uint64_t hash) {
+    return lca_hashset_find(&context->_interned_strings, hash, layec_interned_string_equals, &s);
+}
+
+layec_symbol layec_context_intern_string_view(layec_context* context, string_view s) {
+    assert(context != NULL);
+    assert(s.count == 0 || s.data != NULL);
+
+    uint64_t hash = lca_hash_bytes(LCA_HASH_SEED, s.data, (size_t)s.count);
+    layec_interned_string* interned_string = layec_context_find_interned_string(context, s, hash);
+    if (interned_string != NULL) {
+        return interned_string->symbol;
+    }
+
+    size_t alignment = _Alignof(layec_interned_string);
+    size_t size = sizeof(layec_interned_string) + (size_t)s.count + 1;
+    bool fits_in_arena = (int64_t)size <= context->max_interned_string_size;
+    if (!fits_in_arena) {
+        size = sizeof(layec_interned_string);
+    }
+
+    interned_string = lca_arena_push(context->string_arena, (size + alignment - 1) & ~(alignment - 1));
+    assert(interned_string != NULL);
+
+    if (fits_in_arena) {
+        memcpy(interned_string->data, s.data, (size_t)s.count);
+        interned_string->symbol = (layec_symbol){
+            .data = interned_string->data,
+            .count = s.count,
+        };
+    } else {
         string allocated_string = string_view_to_string(context->allocator, s);
         arr_push(context->allocated_strings, allocated_string);
-        return string_as_view(allocated_string);
+        interned_string->symbol = string_as_view(allocated_string);
     }
 
-    // TODO(local): these aren't properly interned yet, do that eventually.
+    assert(interned_string->symbol.data != NULL);
+    lca_hashset_insert(&context->_interned_strings, hash, interned_string);
 
-    char* arena_string_data = lca_arena_push(context->string_arena, s.count + 1);
-    memcpy(arena_string_data, s.data, (size_t)s.count);
-    
-    string arena_string = string_from_data(context->allocator, arena_string_data, s.count, s.count + 1);
+    return interned_string->symbol;
+}
+
+bool layec_symbol_is_interned(layec_context* context, string_view s) {
+    assert(context != NULL);
+    layec_interned_string* interned_string = layec_context_find_interned_string(context, s, lca_hash_bytes(LCA_HASH_SEED, s.data, (size_t)s.count));
+    return interned_string != NULL && interned_string->symbol.data == s.data;
+}
 
-    return string_as_view(arena_string);
+bool layec_symbol_equals(layec_symbol a, layec_symbol b) {
+    // equal contents in different storage means one of them was never interned.
+    assert((a.data == b.data || !string_view_equals(a, b)) && "symbols must be interned");
+    return a.data == b.data && a.count == b.count;
 }
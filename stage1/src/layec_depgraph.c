@@ -65,46 +65,62 @@ void layec_dependency_graph_destroy(layec_dependency_graph* graph) {
 
     for (int64_t i = 0, count = arr_count(graph->entries); i < count; i++) {
         arr_free(graph->entries[i]->dependencies);
+        ptrmap_free(&graph->entries[i]->dependency_set);
     }
 
     arr_free(graph->entries);
+    ptrmap_free(&graph->entry_lookup);
     lca_arena_destroy(graph->arena);
 
     *graph = (layec_dependency_graph){0};
     lca_deallocate(allocator, graph);
 }
 
+// dependency lists at most this long are searched linearly for duplicates.
+#define DEPENDENCY_SET_THRESHOLD (16)
+
 void layec_depgraph_add_dependency(layec_dependency_graph* graph, layec_dependency_entity* node, layec_dependency_entity* dependency) {
     assert(graph != NULL);
     assert(graph->arena != NULL);
     assert(node != NULL);
 
-    layec_dependency_entry* entry = NULL;
-    for (int64_t i = 0, count = arr_count(graph->entries); i < count; i++) {
-        if (graph->entries[i]->node == node) {
-            entry = graph->entries[i];
-            break;
-        }
-    }
-
+    layec_dependency_entry* entry = ptrmap_get(&graph->entry_lookup, node);
     if (entry == NULL) {
         entry = lca_arena_push(graph->arena, sizeof *entry);
         entry->node = node;
         arr_push(graph->entries, entry);
+        ptrmap_set(&graph->entry_lookup, node, entry);
     }
 
     assert(entry != NULL);
     assert(entry->node == node);
 
-    if (dependency != NULL) {
-        for (int64_t i = 0, count = arr_count(entry->dependencies); i < count; i++) {
+    if (dependency == NULL) {
+        return;
+    }
+
+    int64_t dependency_count = arr_count(entry->dependencies);
+    if (dependency_count < DEPENDENCY_SET_THRESHOLD) {
+        for (int64_t i = 0; i < dependency_count; i++) {
             if (entry->dependencies[i] == dependency) {
                 return;
             }
         }
+    } else {
+        if (dependency_count == DEPENDENCY_SET_THRESHOLD && entry->dependency_set.count == 0) {
+            for (int64_t i = 0; i < dependency_count; i++) {
+                ptrmap_set(&entry->dependency_set, entry->dependencies[i], entry->dependencies[i]);
+            }
+        }
 
-        arr_push(entry->dependencies, dependency);
+        if (ptrmap_contains(&entry->dependency_set, dependency)) {
+            return;
+        }
+
+        ptrmap_set(&entry->dependency_set, dependency, dependency);
     }
+
+    arr_push(entry->dependencies, dependency);
 }
 
 void layec_depgraph_ensure_tracked(layec_dependency_graph* graph, layec_dependency_entity* node) {
@@ -114,120 +130,125 @@ void layec_depgraph_ensure_tracked(layec_dependency_graph* graph, layec_dependen
     layec_depgraph_add_dependency(graph, node, NULL);
 }
 
-static int64_t dynarr_index_of(dynarr(void*) entities, void* entity) {
-    for (int64_t i = 0, count = arr_count(entities); i < count; i++) {
-        if (entity == entities[i])
-            return i;
-    }
+typedef enum layec_dependency_mark {
+    LAYEC_DEPMARK_UNVISITED,
+    LAYEC_DEPMARK_ON_STACK,
+    LAYEC_DEPMARK_RESOLVED,
+} layec_dependency_mark;
+
+typedef struct layec_dependency_frame {
+    layec_dependency_entity* entity;
+    // NULL when the entity has no dependencies of its own.
+    layec_dependency_entry* entry;
+    int64_t next_dependency_index;
+} layec_dependency_frame;
+
+static layec_dependency_mark layec_dependency_get_mark(ptrmap* marks, layec_dependency_entity* entity) {
+    return (layec_dependency_mark)(uintptr_t)ptrmap_get(marks, entity);
+}
 
-    return -1;
+static void layec_dependency_set_mark(ptrmap* marks, layec_dependency_entity* entity, layec_dependency_mark mark) {
+    ptrmap_set(marks, entity, (void*)(uintptr_t)mark);
 }
 
+// post-order depth-first walk from `root`, appending every entity to `ordered` once all of
+// its dependencies have been appended. uses an explicit stack so long dependency chains
+// can't overflow the native one.
 static layec_dependency_order_result resolve_dependencies(
     layec_dependency_graph* graph,
     // clang-format off
-    dynarr(layec_dependency_entity*)* resolved,
-    dynarr(layec_dependency_entity*)* seen,
+    dynarr(layec_dependency_entity*)* ordered,
+    dynarr(layec_dependency_frame)* stack,
     // clang-format on
-    layec_dependency_entity* entity
+    ptrmap* marks,
+    layec_dependency_entity* root
 ) {
-#define RESOLVED (*resolved)
-#define SEEN     (*seen)
-
     assert(graph != NULL);
-    assert(resolved != NULL);
-    assert(seen != NULL);
+    assert(ordered != NULL);
+    assert(stack != NULL);
+    assert(marks != NULL);
 
     layec_dependency_order_result result = {0};
-    if (-1 != dynarr_index_of(RESOLVED, entity)) {
+    if (layec_dependency_get_mark(marks, root) == LAYEC_DEPMARK_RESOLVED) {
         return result;
     }
 
-    arr_push(SEEN, entity);
+    assert(layec_dependency_get_mark(marks, root) == LAYEC_DEPMARK_UNVISITED);
+    assert(arr_count(*stack) == 0);
 
-    int64_t entry_index = -1; // dynarr_index_of((void**)graph->entries, entity);
-    for (int64_t i = 0; i < arr_count(graph->entries) && entry_index == -1; i++) {
-        if (graph->entries[i]->node == entity) {
-            entry_index = i;
-        }
-    }
+    layec_dependency_set_mark(marks, root, LAYEC_DEPMARK_ON_STACK);
+    arr_push(*stack, ((layec_dependency_frame){
+        .entity = root,
+        .entry = ptrmap_get(&graph->entry_lookup, root),
+    }));
 
-    bool requires_resolution = entry_index >= 0 && arr_count(graph->entries[entry_index]->dependencies) >= 0;
+    while (arr_count(*stack) > 0) {
+        layec_dependency_frame* frame = arr_back(*stack);
 
-    if (requires_resolution) {
-#define DEPS (*dependencies)
-        dynarr(layec_dependency_entity*)* dependencies = &graph->entries[entry_index]->dependencies;
-
-        for (int64_t i = 0, count = arr_count(DEPS); i < count; i++) {
-            layec_dependency_entity* dep = DEPS[i];
+        if (frame->entry != NULL && frame->next_dependency_index < arr_count(frame->entry->dependencies)) {
+            layec_dependency_entity* dep = frame->entry->dependencies[frame->next_dependency_index];
             assert(dep != NULL);
+            frame->next_dependency_index++;
 
-            if (-1 != dynarr_index_of((void**)RESOLVED, dep)) {
+            layec_dependency_mark dep_mark = layec_dependency_get_mark(marks, dep);
+            if (dep_mark == LAYEC_DEPMARK_RESOLVED) {
                 continue;
             }
 
-            int64_t dep_seen_index = dynarr_index_of((void**)SEEN, dep);
-            if (-1 != dep_seen_index) {
+            if (dep_mark == LAYEC_DEPMARK_ON_STACK) {
                 result.status = LAYEC_DEP_CYCLE;
-                result.from = entity;
+                result.from = frame->entity;
                 result.to = dep;
+                arr_set_count(*stack, 0);
                 return result;
             }
 
-            layec_dependency_order_result dep_result = resolve_dependencies(
-                graph,
-                resolved,
-                seen,
-                dep
-            );
+            layec_dependency_set_mark(marks, dep, LAYEC_DEPMARK_ON_STACK);
+            arr_push(*stack, ((layec_dependency_frame){
+                .entity = dep,
+                .entry = ptrmap_get(&graph->entry_lookup, dep),
+            }));
 
-            if (dep_result.status != LAYEC_DEP_OK) {
-                return dep_result;
-            }
+            continue;
         }
-#undef DEPS
-    }
 
-    arr_push(RESOLVED, entity);
-
-    int64_t seen_index = dynarr_index_of((void**)SEEN, entity);
-    assert(seen_index >= 0);
-    assert(seen_index < arr_count(SEEN));
-    if (arr_count(SEEN) == 1) {
-        arr_pop(SEEN);
-    } else {
-        SEEN[seen_index] = SEEN[arr_count(SEEN) - 1];
-        SEEN[arr_count(SEEN) - 1] = NULL;
-        arr_set_count(SEEN, arr_count(SEEN) - 1);
+        layec_dependency_set_mark(marks, frame->entity, LAYEC_DEPMARK_RESOLVED);
+        arr_push(*ordered, frame->entity);
+        arr_pop(*stack);
     }
 
     return result;
-
-#undef SEEN
-#undef RESOLVED
 }
 
 layec_dependency_order_result layec_dependency_graph_get_ordered_entities(layec_dependency_graph* graph) {
     assert(graph != NULL);
 
-    layec_dependency_order_result result = {0};
-    dynarr(layec_dependency_entity*) seen = NULL;
+    dynarr(layec_dependency_entity*) ordered = NULL;
+    dynarr(layec_dependency_frame) stack = NULL;
+    ptrmap marks = {0};
 
     for (int64_t i = 0, count = arr_count(graph->entries); i < count; i++) {
         layec_dependency_order_result entry_result = resolve_dependencies(
             graph,
-            &result.ordered_entities,
-            &seen,
+            &ordered,
+            &stack,
+            &marks,
             graph->entries[i]->node
         );
 
         if (entry_result.status != LAYEC_DEP_OK) {
-            arr_free(seen);
+            arr_free(ordered);
+            arr_free(stack);
+            ptrmap_free(&marks);
             return entry_result;
         }
     }
 
-    arr_free(seen);
+    arr_free(stack);
+    ptrmap_free(&marks);
+
+    layec_dependency_order_result result = {0};
     result.status = LAYEC_DEP_OK;
+    result.ordered_entities = ordered;
     return result;
 }
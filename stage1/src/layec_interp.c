@@ -0,0 +1,1278 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "layec.h"
+
+// foreign functions are called through a variadic function pointer taking six integers, with every
+// float argument passed after them as one of eight variadic doubles. that only works where integer
+// and float arguments go in separate registers and variadic arguments are passed like named ones,
+// which is true of the SysV x86_64 and the non-Apple AArch64 calling conventions.
+#if !defined(_WIN32) && (defined(__x86_64__) || (defined(__aarch64__) && !defined(__APPLE__)))
+#    define LAYEC_INTERP_FOREIGN_CALLS 1
+#    include <dlfcn.h>
+#else
+#    define LAYEC_INTERP_FOREIGN_CALLS 0
+#endif
+
+// the compiler is usually built with AddressSanitizer, whose leak checker would otherwise blame
+// it for whatever the interpreted program allocates through foreign calls and never frees.
+#if defined(__SANITIZE_ADDRESS__)
+#    include <sanitizer/lsan_interface.h>
+#    define INTERP_IGNORE_LEAKS_BEGIN() __lsan_disable()
+#    define INTERP_IGNORE_LEAKS_END()   __lsan_enable()
+#else
+#    define INTERP_IGNORE_LEAKS_BEGIN()
+#    define INTERP_IGNORE_LEAKS_END()
+#endif
+
+#define INTERP_STACK_SIZE         (8 * 1024 * 1024)
+// interpreted calls recurse on the host stack too, taking around 2 KiB of it each in a sanitized
+// build; this keeps them well within the usual 8 MiB.
+#define INTERP_MAX_CALL_DEPTH     2048
+#define INTERP_ARENA_BLOCK_SIZE   (1024 * 1024)
+#define INTERP_FOREIGN_INT_COUNT  6
+#define INTERP_FOREIGN_REAL_COUNT 8
+
+#if LAYEC_INTERP_FOREIGN_CALLS
+typedef int64_t (*interp_foreign_int_function)(int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, ...);
+typedef double (*interp_foreign_real_function)(int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, ...);
+#endif
+
+// every value lives in a 64-bit slot of its frame. integers are kept zero-extended from their
+// width, floats as their IEEE bits (a float in the low 32), and aggregates as the address of
+// their bytes. memory is read and written in the host's byte order, which is little-endian on
+// every target the compiler has.
+typedef struct interp_function interp_function;
+
+typedef struct interp_instruction {
+    layec_value* value;
+    layec_value_kind kind;
+    // the slot of the result, or -1 if there is none.
+    int64_t result;
+    int64_t operand_count;
+    int64_t* operands;
+    // the width of the result, and of the first operand or the stored value; 0 for aggregates.
+    int bits;
+    int operand_bits;
+    // the bytes a load or store moves.
+    int64_t size;
+    bool is_aggregate;
+    // where an alloca, or a load or call producing an aggregate, keeps its memory in the frame.
+    int64_t frame_offset;
+    int64_t targets[2];
+    layec_builtin_kind builtin_kind;
+    // the callee of a direct call; indirect calls look theirs up from the address.
+    interp_function* callee;
+} interp_instruction;
+
+typedef struct interp_phi {
+    int64_t result;
+    int64_t incoming_count;
+    int64_t* incoming_blocks;
+    int64_t* incoming_slots;
+} interp_phi;
+
+typedef struct interp_block {
+    // phis are assigned all at once when the block is branched to, rather than executed.
+    int64_t phi_count;
+    interp_phi* phis;
+    int64_t instruction_count;
+    interp_instruction* instructions;
+} interp_block;
+
+struct interp_function {
+    layec_value* function;
+    // the address of a function found in the host process, or NULL if it's interpreted.
+    void* foreign_address;
+    bool is_prepared;
+    bool has_failed;
+    // slots start out as these, which holds the constants; parameters come first.
+    int64_t slot_count;
+    uint64_t* initial_slots;
+    int64_t frame_size;
+    int64_t block_count;
+    interp_block* blocks;
+};
+
+struct layec_interp {
+    layec_context* context;
+    lca_arena* arena;
+    // every function value seen, declarations included, to its interp_function.
+    lca_ptrmap functions;
+    // the interp_functions themselves, so a function pointer can be told apart from a foreign one.
+    lca_ptrmap function_addresses;
+    // global value to the address of its storage.
+    lca_ptrmap globals;
+    dynarr(void*) global_storage;
+    void* host_library;
+    unsigned char* stack;
+    int64_t stack_top;
+    int64_t call_depth;
+};
+
+static void* interp_push(layec_interp* interp, int64_t size) {
+    assert(size >= 0);
+    // the arena doesn't align its allocations, so every one is kept a multiple of 16.
+    size = (size + 15) & ~(int64_t)15;
+    assert(size <= INTERP_ARENA_BLOCK_SIZE);
+    return lca_arena_push(interp->arena, (size_t)size);
+}
+
+static unsigned char* interp_stack_push(layec_interp* interp, int64_t size) {
+    assert(size >= 0);
+    size = (size + 15) & ~(int64_t)15;
+    if (interp->stack_top + size > INTERP_STACK_SIZE) {
+        return NULL;
+    }
+
+    unsigned char* memory = interp->stack + interp->stack_top;
+    interp->stack_top += size;
+    return memory;
+}
+
+static uint64_t interp_truncate(int bits, uint64_t value) {
+    if (bits >= 64) return value;
+    return value & ((UINT64_C(1) << bits) - 1);
+}
+
+static int64_t interp_sign_extend(int bits, uint64_t value) {
+    if (bits >= 64) return (int64_t)value;
+    uint64_t sign_bit = UINT64_C(1) << (bits - 1);
+    return (int64_t)((interp_truncate(bits, value) ^ sign_bit) - sign_bit);
+}
+
+static double interp_to_double(int bits, uint64_t value) {
+    if (bits == 32) {
+        uint32_t float_bits = (uint32_t)value;
+        float f;
+        memcpy(&f, &float_bits, sizeof f);
+        return f;
+    }
+
+    double d;
+    memcpy(&d, &value, sizeof d);
+    return d;
+}
+
+static uint64_t interp_from_double(int bits, double d) {
+    if (bits == 32) {
+        float f = (float)d;
+        uint32_t float_bits;
+        memcpy(&float_bits, &f, sizeof float_bits);
+        return float_bits;
+    }
+
+    uint64_t value;
+    memcpy(&value, &d, sizeof value);
+    return value;
+}
+
+static int interp_type_bits(layec_type* type) {
+    if (layec_type_is_integer(type) || layec_type_is_float(type) || layec_type_is_ptr(type)) {
+        return layec_type_size_in_bits(type);
+    }
+
+    return 0;
+}
+
+static bool interp_type_is_aggregate(layec_type* type) {
+    return layec_type_is_array(type) || layec_type_is_struct(type);
+}
+
+static bool interp_check_type(layec_interp* interp, layec_value* value, layec_type* type) {
+    int bits = interp_type_bits(type);
+    if (layec_type_is_integer(type) && bits > 64) {
+        layec_write_error(interp->context, layec_value_location(value), "The interpreter can't operate on %d-bit integers.", bits);
+        return false;
+    }
+
+    if (layec_type_is_float(type) && bits != 32 && bits != 64) {
+        layec_write_error(interp->context, layec_value_location(value), "The interpreter can't operate on %d-bit floats.", bits);
+        return false;
+    }
+
+    return true;
+}
+
+static void* interp_lookup_host_symbol(layec_interp* interp, string_view name) {
+#if LAYEC_INTERP_FOREIGN_CALLS
+    if (interp->host_library == NULL) {
+        interp->host_library = dlopen(NULL, RTLD_LAZY);
+        if (interp->host_library == NULL) {
+            return NULL;
+        }
+    }
+
+    return dlsym(interp->host_library, lca_temp_sprintf("%.*s", STR_EXPAND(name)));
+#else
+    (void)interp;
+    (void)name;
+    return NULL;
+#endif
+}
+
+// ========== Symbols ==========
+
+static layec_value* interp_find_function_definition(layec_interp* interp, layec_value* function) {
+    if (layec_function_block_count(function) > 0) {
+        return function;
+    }
+
+    string_view name = layec_function_name(function);
+    for (int64_t i = 0, count = arr_count(interp->context->ir_modules); i < count; i++) {
+        layec_module* module = interp->context->ir_modules[i];
+        if (module == NULL) continue;
+
+        for (int64_t j = 0, function_count = layec_module_function_count(module); j < function_count; j++) {
+            layec_value* candidate = layec_module_get_function_at_index(module, j);
+            if (layec_function_block_count(candidate) > 0 && string_view_equals(layec_function_name(candidate), name)) {
+                return candidate;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static layec_value* interp_find_global_definition(layec_interp* interp, layec_value* global) {
+    string_view name = layec_value_name(global);
+    for (int64_t i = 0, count = arr_count(interp->context->ir_modules); i < count; i++) {
+        layec_module* module = interp->context->ir_modules[i];
+        if (module == NULL) continue;
+
+        for (int64_t j = 0, global_count = layec_module_global_count(module); j < global_count; j++) {
+            layec_value* candidate = layec_module_get_global_at_index(module, j);
+            if (layec_value_linkage(candidate) != LAYEC_LINK_IMPORTED && string_view_equals(layec_value_name(candidate), name)) {
+                return candidate;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// declarations resolve to the definition of the same name in any module, or failing that to a
+// function of the host process, which is how calls into libc work.
+static interp_function* interp_get_function(layec_interp* interp, layec_value* function) {
+    interp_function* result = ptrmap_get(&interp->functions, function);
+    if (result != NULL) {
+        return result;
+    }
+
+    layec_value* definition = interp_find_function_definition(interp, function);
+    if (definition != NULL && definition != function) {
+        result = interp_get_function(interp, definition);
+        if (result != NULL) {
+            ptrmap_set(&interp->functions, function, result);
+        }
+
+        return result;
+    }
+
+    void* foreign_address = NULL;
+    if (definition == NULL) {
+        foreign_address = interp_lookup_host_symbol(interp, layec_function_name(function));
+        if (foreign_address == NULL) {
+            layec_write_error(
+                interp->context,
+                layec_value_location(function),
+                "The interpreter could not find a definition of '%.*s' in the program or the compiler's process.",
+                STR_EXPAND(layec_function_name(function))
+            );
+            return NULL;
+        }
+    }
+
+    result = interp_push(interp, sizeof *result);
+    result->function = function;
+    result->foreign_address = foreign_address;
+
+    ptrmap_set(&interp->functions, function, result);
+    ptrmap_set(&interp->function_addresses, result, result);
+    return result;
+}
+
+static bool interp_constant(layec_interp* interp, layec_value* value, uint64_t* out_value);
+
+static void* interp_get_global(layec_interp* interp, layec_value* global) {
+    void* address = ptrmap_get(&interp->globals, global);
+    if (address != NULL) {
+        return address;
+    }
+
+    if (layec_value_linkage(global) == LAYEC_LINK_IMPORTED) {
+        layec_value* definition = interp_find_global_definition(interp, global);
+        if (definition != NULL) {
+            address = interp_get_global(interp, definition);
+        } else {
+            address = interp_lookup_host_symbol(interp, layec_value_name(global));
+            if (address == NULL) {
+                layec_write_error(
+                    interp->context,
+                    layec_value_location(global),
+                    "The interpreter could not find a definition of '%.*s' in the program or the compiler's process.",
+                    STR_EXPAND(layec_value_name(global))
+                );
+            }
+        }
+
+        if (address != NULL) {
+            ptrmap_set(&interp->globals, global, address);
+        }
+
+        return address;
+    }
+
+    layec_type* type = layec_instruction_get_alloca_type(global);
+    int64_t size = layec_type_size_in_bytes(type);
+    address = lca_allocate(interp->context->allocator, (size_t)(size > 0 ? size : 1));
+    memset(address, 0, (size_t)(size > 0 ? size : 1));
+    arr_push(interp->global_storage, address);
+
+    // registered before initializing, since the initializer may refer to the global itself.
+    ptrmap_set(&interp->globals, global, address);
+
+    layec_value* initial_value = layec_instruction_get_value(global);
+    if (layec_value_get_kind(initial_value) == LAYEC_IR_ARRAY_CONSTANT) {
+        int64_t length = layec_array_constant_length(initial_value);
+        memcpy(address, layec_array_constant_data(initial_value), (size_t)(length < size ? length : size));
+    } else {
+        uint64_t value = 0;
+        if (!interp_constant(interp, initial_value, &value)) {
+            return NULL;
+        }
+
+        memcpy(address, &value, (size_t)(size < 8 ? size : 8));
+    }
+
+    return address;
+}
+
+static bool interp_constant(layec_interp* interp, layec_value* value, uint64_t* out_value) {
+    layec_type* type = layec_value_get_type(value);
+    switch (layec_value_get_kind(value)) {
+        default: {
+            layec_write_error(
+                interp->context,
+                layec_value_location(value),
+                "The interpreter can't use a %s as an operand.",
+                layec_value_kind_to_cstring(layec_value_get_kind(value))
+            );
+            return false;
+        }
+
+        case LAYEC_IR_INTEGER_CONSTANT: {
+            if (!interp_check_type(interp, value, type)) return false;
+            *out_value = interp_truncate(interp_type_bits(type), (uint64_t)layec_value_integer_constant(value));
+            return true;
+        }
+
+        case LAYEC_IR_FLOAT_CONSTANT: {
+            if (!interp_check_type(interp, value, type)) return false;
+            *out_value = interp_from_double(interp_type_bits(type), layec_value_float_constant(value));
+            return true;
+        }
+
+        case LAYEC_IR_VOID_CONSTANT:
+        case LAYEC_IR_POISON: {
+            *out_value = 0;
+            return true;
+        }
+
+        case LAYEC_IR_ARRAY_CONSTANT: {
+            *out_value = (uint64_t)(uintptr_t)layec_array_constant_data(value);
+            return true;
+        }
+
+        case LAYEC_IR_GLOBAL_VARIABLE: {
+            void* address = interp_get_global(interp, value);
+            if (address == NULL) return false;
+            *out_value = (uint64_t)(uintptr_t)address;
+            return true;
+        }
+
+        case LAYEC_IR_FUNCTION: {
+            interp_function* function = interp_get_function(interp, value);
+            if (function == NULL) return false;
+            // interpreted functions are identified by their interp_function, which only the
+            // interpreter can call; passing one to foreign code won't work.
+            if (function->foreign_address != NULL) {
+                *out_value = (uint64_t)(uintptr_t)function->foreign_address;
+            } else {
+                *out_value = (uint64_t)(uintptr_t)function;
+            }
+
+            return true;
+        }
+    }
+}
+
+// ========== Preparation ==========
+
+typedef struct interp_prepare_state {
+    layec_interp* interp;
+    // values and blocks to their index plus one, so that NULL means "not seen".
+    lca_ptrmap slot_indices;
+    lca_ptrmap block_indices;
+    dynarr(uint64_t) initial_slots;
+    int64_t frame_size;
+} interp_prepare_state;
+
+static bool interp_operand_slot(interp_prepare_state* state, layec_value* value, int64_t* out_slot) {
+    void* index = ptrmap_get(&state->slot_indices, value);
+    if (index != NULL) {
+        *out_slot = (int64_t)(intptr_t)index - 1;
+        return true;
+    }
+
+    uint64_t constant = 0;
+    if (!interp_constant(state->interp, value, &constant)) {
+        return false;
+    }
+
+    *out_slot = arr_count(state->initial_slots);
+    arr_push(state->initial_slots, constant);
+    ptrmap_set(&state->slot_indices, value, (void*)(intptr_t)(*out_slot + 1));
+    return true;
+}
+
+static int64_t interp_block_position(interp_prepare_state* state, layec_value* block) {
+    void* index = ptrmap_get(&state->block_indices, block);
+    assert(index != NULL && "branch to a block of another function");
+    return (int64_t)(intptr_t)index - 1;
+}
+
+static int64_t interp_frame_allocate(interp_prepare_state* state, int64_t size, int64_t align) {
+    // frames are 16-byte aligned, so nothing needs more than that.
+    assert(align > 0 && align <= 16);
+    int64_t offset = (state->frame_size + align - 1) / align * align;
+    state->frame_size = offset + size;
+    return offset;
+}
+
+static bool interp_prepare_instruction(interp_prepare_state* state, layec_value* value, interp_instruction* instruction) {
+    layec_interp* interp = state->interp;
+    layec_type* type = layec_value_get_type(value);
+
+    instruction->value = value;
+    instruction->kind = layec_value_get_kind(value);
+    instruction->result = -1;
+    instruction->bits = interp_type_bits(type);
+    instruction->is_aggregate = interp_type_is_aggregate(type);
+
+    if (!layec_type_is_void(type)) {
+        void* index = ptrmap_get(&state->slot_indices, value);
+        assert(index != NULL);
+        instruction->result = (int64_t)(intptr_t)index - 1;
+    }
+
+    if (!interp_check_type(interp, value, type)) {
+        return false;
+    }
+
+    instruction->operand_count = layec_instruction_operand_count(value);
+    instruction->operands = interp_push(interp, instruction->operand_count * (int64_t)sizeof(int64_t));
+    for (int64_t i = 0; i < instruction->operand_count; i++) {
+        if (!interp_operand_slot(state, layec_instruction_get_operand_at_index(value, i), &instruction->operands[i])) {
+            return false;
+        }
+    }
+
+    if (instruction->operand_count > 0) {
+        int64_t typed_operand_index = instruction->kind == LAYEC_IR_STORE ? 1 : 0;
+        layec_type* operand_type = layec_value_get_type(layec_instruction_get_operand_at_index(value, typed_operand_index));
+        if (!interp_check_type(interp, value, operand_type)) {
+            return false;
+        }
+
+        instruction->operand_bits = interp_type_bits(operand_type);
+        if (instruction->kind == LAYEC_IR_STORE) {
+            instruction->size = layec_type_size_in_bytes(operand_type);
+            instruction->is_aggregate = interp_type_is_aggregate(operand_type);
+        }
+    }
+
+    switch (instruction->kind) {
+        default: break;
+
+        case LAYEC_IR_ALLOCA: {
+            layec_type* element_type = layec_instruction_get_alloca_type(value);
+            int64_t size = layec_type_size_in_bytes(element_type) * layec_instruction_get_alloca_element_count(value);
+            instruction->frame_offset = interp_frame_allocate(state, size, layec_type_align_in_bytes(element_type));
+        } break;
+
+        case LAYEC_IR_LOAD:
+        case LAYEC_IR_CALL: {
+            if (instruction->kind == LAYEC_IR_LOAD) {
+                instruction->size = layec_type_size_in_bytes(type);
+            }
+
+            if (instruction->is_aggregate) {
+                instruction->size = layec_type_size_in_bytes(type);
+                instruction->frame_offset = interp_frame_allocate(state, instruction->size, layec_type_align_in_bytes(type));
+            }
+
+            if (instruction->kind == LAYEC_IR_CALL) {
+                layec_value* callee = layec_instruction_callee(value);
+                if (layec_value_get_kind(callee) == LAYEC_IR_FUNCTION) {
+                    instruction->callee = interp_get_function(interp, callee);
+                    if (instruction->callee == NULL) {
+                        return false;
+                    }
+                }
+            }
+        } break;
+
+        case LAYEC_IR_BRANCH: {
+            instruction->targets[0] = interp_block_position(state, layec_instruction_branch_get_pass(value));
+        } break;
+
+        case LAYEC_IR_COND_BRANCH: {
+            instruction->targets[0] = interp_block_position(state, layec_instruction_branch_get_pass(value));
+            instruction->targets[1] = interp_block_position(state, layec_instruction_branch_get_fail(value));
+        } break;
+
+        case LAYEC_IR_BUILTIN: {
+            instruction->builtin_kind = layec_instruction_builtin_kind(value);
+            if (instruction->builtin_kind != LAYEC_BUILTIN_MEMSET && instruction->builtin_kind != LAYEC_BUILTIN_MEMCOPY) {
+                layec_write_error(interp->context, layec_value_location(value), "The interpreter can only run the memset and memcopy builtins.");
+                return false;
+            }
+        } break;
+    }
+
+    return true;
+}
+
+static bool interp_prepare_phi(interp_prepare_state* state, layec_value* value, interp_phi* phi) {
+    void* index = ptrmap_get(&state->slot_indices, value);
+    assert(index != NULL);
+    phi->result = (int64_t)(intptr_t)index - 1;
+
+    if (!interp_check_type(state->interp, value, layec_value_get_type(value))) {
+        return false;
+    }
+
+    phi->incoming_count = layec_instruction_phi_incoming_value_count(value);
+    phi->incoming_blocks = interp_push(state->interp, phi->incoming_count * (int64_t)sizeof(int64_t));
+    phi->incoming_slots = interp_push(state->interp, phi->incoming_count * (int64_t)sizeof(int64_t));
+    for (int64_t i = 0; i < phi->incoming_count; i++) {
+        phi->incoming_blocks[i] = interp_block_position(state, layec_instruction_phi_incoming_block_at_index(value, i));
+        if (!interp_operand_slot(state, layec_instruction_phi_incoming_value_at_index(value, i), &phi->incoming_slots[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// decodes a function into blocks of slot-indexed instructions the first time it's called.
+static bool interp_prepare_function(layec_interp* interp, interp_function* function) {
+    if (function->is_prepared) return true;
+    if (function->has_failed) return false;
+
+    layec_value* definition = function->function;
+    assert(layec_function_block_count(definition) > 0);
+
+    if (layec_function_is_variadic(definition)) {
+        layec_write_error(
+            interp->context,
+            layec_value_location(definition),
+            "The interpreter can't run the variadic function '%.*s'.",
+            STR_EXPAND(layec_function_name(definition))
+        );
+        function->has_failed = true;
+        return false;
+    }
+
+    interp_prepare_state state = {
+        .interp = interp,
+    };
+
+    for (int64_t i = 0, count = layec_function_parameter_count(definition); i < count; i++) {
+        layec_value* parameter = layec_function_get_parameter_at_index(definition, i);
+        arr_push(state.initial_slots, 0);
+        ptrmap_set(&state.slot_indices, parameter, (void*)(intptr_t)(i + 1));
+    }
+
+    // every result gets its slot up front, since phis can refer to values defined later on.
+    int64_t block_count = layec_function_block_count(definition);
+    for (int64_t i = 0; i < block_count; i++) {
+        layec_value* block = layec_function_get_block_at_index(definition, i);
+        ptrmap_set(&state.block_indices, block, (void*)(intptr_t)(i + 1));
+
+        for (int64_t j = 0, count = layec_block_instruction_count(block); j < count; j++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, j);
+            if (!layec_type_is_void(layec_value_get_type(instruction))) {
+                ptrmap_set(&state.slot_indices, instruction, (void*)(intptr_t)(arr_count(state.initial_slots) + 1));
+                arr_push(state.initial_slots, 0);
+            }
+        }
+    }
+
+    bool success = true;
+    interp_block* blocks = interp_push(interp, block_count * (int64_t)sizeof *blocks);
+    for (int64_t i = 0; success && i < block_count; i++) {
+        layec_value* block = layec_function_get_block_at_index(definition, i);
+        int64_t count = layec_block_instruction_count(block);
+
+        for (int64_t j = 0; j < count; j++) {
+            layec_value_kind kind = layec_value_get_kind(layec_block_get_instruction_at_index(block, j));
+            if (kind == LAYEC_IR_PHI) {
+                blocks[i].phi_count++;
+            } else if (kind != LAYEC_IR_NOP) {
+                blocks[i].instruction_count++;
+            }
+        }
+
+        blocks[i].phis = interp_push(interp, blocks[i].phi_count * (int64_t)sizeof(interp_phi));
+        blocks[i].instructions = interp_push(interp, blocks[i].instruction_count * (int64_t)sizeof(interp_instruction));
+
+        int64_t phi_index = 0;
+        int64_t instruction_index = 0;
+        for (int64_t j = 0; success && j < count; j++) {
+            layec_value* instruction = layec_block_get_instruction_at_index(block, j);
+            layec_value_kind kind = layec_value_get_kind(instruction);
+            if (kind == LAYEC_IR_PHI) {
+                success = interp_prepare_phi(&state, instruction, &blocks[i].phis[phi_index++]);
+            } else if (kind != LAYEC_IR_NOP) {
+                success = interp_prepare_instruction(&state, instruction, &blocks[i].instructions[instruction_index++]);
+            }
+        }
+    }
+
+    if (success) {
+        function->slot_count = arr_count(state.initial_slots);
+        function->initial_slots = interp_push(interp, function->slot_count * (int64_t)sizeof(uint64_t));
+        if (function->slot_count > 0) {
+            memcpy(function->initial_slots, state.initial_slots, (size_t)function->slot_count * sizeof(uint64_t));
+        }
+
+        function->frame_size = state.frame_size;
+        function->block_count = block_count;
+        function->blocks = blocks;
+        function->is_prepared = true;
+    } else {
+        function->has_failed = true;
+    }
+
+    arr_free(state.initial_slots);
+    ptrmap_free(&state.slot_indices);
+    ptrmap_free(&state.block_indices);
+    return success;
+}
+
+// ========== Execution ==========
+
+static bool interp_call_foreign(layec_interp* interp, interp_instruction* instruction, void* address, const uint64_t* slots, uint64_t* out_result) {
+#if LAYEC_INTERP_FOREIGN_CALLS
+    int64_t ints[INTERP_FOREIGN_INT_COUNT] = {0};
+    double reals[INTERP_FOREIGN_REAL_COUNT] = {0};
+    int64_t int_count = 0;
+    int64_t real_count = 0;
+
+    for (int64_t i = 1; i < instruction->operand_count; i++) {
+        layec_type* type = layec_value_get_type(layec_instruction_get_operand_at_index(instruction->value, i));
+        uint64_t value = slots[instruction->operands[i]];
+
+        if (layec_type_is_float(type)) {
+            if (real_count == INTERP_FOREIGN_REAL_COUNT) goto too_many_arguments;
+            // a float's bits are already where the callee reads them from, in the low half.
+            memcpy(&reals[real_count++], &value, sizeof(double));
+        } else if (layec_type_is_integer(type) || layec_type_is_ptr(type)) {
+            if (int_count == INTERP_FOREIGN_INT_COUNT) goto too_many_arguments;
+            ints[int_count++] = interp_sign_extend(layec_type_size_in_bits(type), value);
+        } else {
+            layec_write_error(
+                interp->context,
+                layec_value_location(instruction->value),
+                "The interpreter can't pass a %s to a foreign function.",
+                layec_type_kind_to_cstring(layec_type_get_kind(type))
+            );
+            return false;
+        }
+    }
+
+    if (instruction->is_aggregate) {
+        layec_write_error(interp->context, layec_value_location(instruction->value), "The interpreter can't return an aggregate from a foreign function.");
+        return false;
+    }
+
+    if (layec_type_is_float(layec_value_get_type(instruction->value))) {
+        interp_foreign_real_function function;
+        memcpy(&function, &address, sizeof function);
+        INTERP_IGNORE_LEAKS_BEGIN();
+        double result = function(
+            ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+            reals[0], reals[1], reals[2], reals[3], reals[4], reals[5], reals[6], reals[7]
+        );
+        INTERP_IGNORE_LEAKS_END();
+
+        uint64_t result_bits;
+        memcpy(&result_bits, &result, sizeof result_bits);
+        *out_result = interp_truncate(instruction->bits, result_bits);
+    } else {
+        interp_foreign_int_function function;
+        memcpy(&function, &address, sizeof function);
+        INTERP_IGNORE_LEAKS_BEGIN();
+        int64_t result = function(
+            ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+            reals[0], reals[1], reals[2], reals[3], reals[4], reals[5], reals[6], reals[7]
+        );
+        INTERP_IGNORE_LEAKS_END();
+
+        *out_result = instruction->bits == 0 ? 0 : interp_truncate(instruction->bits, (uint64_t)result);
+    }
+
+    return true;
+
+too_many_arguments:;
+    layec_write_error(
+        interp->context,
+        layec_value_location(instruction->value),
+        "The interpreter can pass at most %d integer and %d floating-point arguments to a foreign function.",
+        INTERP_FOREIGN_INT_COUNT,
+        INTERP_FOREIGN_REAL_COUNT
+    );
+    return false;
+#else
+    (void)address;
+    (void)slots;
+    (void)out_result;
+    layec_write_error(interp->context, layec_value_location(instruction->value), "The interpreter can't call foreign functions on this platform.");
+    return false;
+#endif
+}
+
+static bool interp_fcmp(layec_value_kind kind, double lhs, double rhs) {
+    bool is_ordered = !isnan(lhs) && !isnan(rhs);
+    switch (kind) {
+        default: assert(false && "unreachable"); return false;
+        case LAYEC_IR_FCMP_FALSE: return false;
+        case LAYEC_IR_FCMP_OEQ: return is_ordered && lhs == rhs;
+        case LAYEC_IR_FCMP_OGT: return is_ordered && lhs > rhs;
+        case LAYEC_IR_FCMP_OGE: return is_ordered && lhs >= rhs;
+        case LAYEC_IR_FCMP_OLT: return is_ordered && lhs < rhs;
+        case LAYEC_IR_FCMP_OLE: return is_ordered && lhs <= rhs;
+        case LAYEC_IR_FCMP_ONE: return is_ordered && lhs != rhs;
+        case LAYEC_IR_FCMP_ORD: return is_ordered;
+        case LAYEC_IR_FCMP_UEQ: return !is_ordered || lhs == rhs;
+        case LAYEC_IR_FCMP_UGT: return !is_ordered || lhs > rhs;
+        case LAYEC_IR_FCMP_UGE: return !is_ordered || lhs >= rhs;
+        case LAYEC_IR_FCMP_ULT: return !is_ordered || lhs < rhs;
+        case LAYEC_IR_FCMP_ULE: return !is_ordered || lhs <= rhs;
+        case LAYEC_IR_FCMP_UNE: return !is_ordered || lhs != rhs;
+        case LAYEC_IR_FCMP_UNO: return !is_ordered;
+        case LAYEC_IR_FCMP_TRUE: return true;
+    }
+}
+
+static bool interp_execute(layec_interp* interp, interp_function* function, const uint64_t* arguments, uint64_t* out_result) {
+    if (!interp_prepare_function(interp, function)) {
+        return false;
+    }
+
+    layec_context* context = interp->context;
+    int64_t saved_stack_top = interp->stack_top;
+
+    uint64_t* slots = (uint64_t*)interp_stack_push(interp, function->slot_count * (int64_t)sizeof(uint64_t));
+    unsigned char* frame = interp_stack_push(interp, function->frame_size);
+    if (slots == NULL || frame == NULL) {
+        layec_write_error(
+            context,
+            layec_value_location(function->function),
+            "The interpreter ran out of stack space calling '%.*s'.",
+            STR_EXPAND(layec_function_name(function->function))
+        );
+        goto failure;
+    }
+
+    int64_t parameter_count = layec_function_parameter_count(function->function);
+    if (function->slot_count > 0) {
+        memcpy(slots, function->initial_slots, (size_t)function->slot_count * sizeof(uint64_t));
+    }
+
+    if (parameter_count > 0) {
+        memcpy(slots, arguments, (size_t)parameter_count * sizeof(uint64_t));
+    }
+
+    int64_t block_index = 0;
+    for (;;) {
+        interp_block* block = &function->blocks[block_index];
+        int64_t next_block_index = -1;
+
+        for (int64_t i = 0; i < block->instruction_count; i++) {
+            interp_instruction* instruction = &block->instructions[i];
+            const int64_t* operands = instruction->operands;
+            int bits = instruction->bits;
+            uint64_t value = 0;
+
+            switch (instruction->kind) {
+                default: {
+                    layec_write_error(
+                        context,
+                        layec_value_location(instruction->value),
+                        "The interpreter can't run %s instructions.",
+                        layec_value_kind_to_cstring(instruction->kind)
+                    );
+                    goto failure;
+                }
+
+                case LAYEC_IR_ALLOCA: {
+                    value = (uint64_t)(uintptr_t)(frame + instruction->frame_offset);
+                } break;
+
+                case LAYEC_IR_LOAD: {
+                    unsigned char* address = (unsigned char*)(uintptr_t)slots[operands[0]];
+                    if (address == NULL) {
+                        layec_write_error(context, layec_value_location(instruction->value), "Load from a null pointer.");
+                        goto failure;
+                    }
+
+                    if (instruction->is_aggregate) {
+                        memcpy(frame + instruction->frame_offset, address, (size_t)instruction->size);
+                        value = (uint64_t)(uintptr_t)(frame + instruction->frame_offset);
+                    } else {
+                        memcpy(&value, address, (size_t)instruction->size);
+                        if (layec_type_is_integer(layec_value_get_type(instruction->value))) {
+                            value = interp_truncate(bits, value);
+                        }
+                    }
+                } break;
+
+                case LAYEC_IR_STORE: {
+                    unsigned char* address = (unsigned char*)(uintptr_t)slots[operands[0]];
+                    if (address == NULL) {
+                        layec_write_error(context, layec_value_location(instruction->value), "Store to a null pointer.");
+                        goto failure;
+                    }
+
+                    uint64_t stored = slots[operands[1]];
+                    if (instruction->is_aggregate) {
+                        memmove(address, (const void*)(uintptr_t)stored, (size_t)instruction->size);
+                    } else {
+                        memcpy(address, &stored, (size_t)instruction->size);
+                    }
+                } continue;
+
+                case LAYEC_IR_PTRADD: {
+                    int64_t offset = interp_sign_extend(interp_type_bits(layec_value_get_type(layec_instruction_ptradd_get_offset(instruction->value))), slots[operands[1]]);
+                    value = slots[operands[0]] + (uint64_t)offset;
+                } break;
+
+                case LAYEC_IR_BUILTIN: {
+                    void* destination = (void*)(uintptr_t)slots[operands[0]];
+                    uint64_t byte_count = slots[operands[2]];
+                    if (byte_count == 0) continue;
+
+                    if (instruction->builtin_kind == LAYEC_BUILTIN_MEMSET) {
+                        memset(destination, (int)(uint8_t)slots[operands[1]], (size_t)byte_count);
+                    } else {
+                        memmove(destination, (const void*)(uintptr_t)slots[operands[1]], (size_t)byte_count);
+                    }
+                } continue;
+
+                case LAYEC_IR_CALL: {
+                    interp_function* callee = instruction->callee;
+                    if (callee == NULL) {
+                        void* address = (void*)(uintptr_t)slots[operands[0]];
+                        if (address == NULL) {
+                            layec_write_error(context, layec_value_location(instruction->value), "Call through a null function pointer.");
+                            goto failure;
+                        }
+
+                        callee = ptrmap_get(&interp->function_addresses, address);
+                        if (callee == NULL) {
+                            if (!interp_call_foreign(interp, instruction, address, slots, &value)) goto failure;
+                            break;
+                        }
+                    }
+
+                    if (callee->foreign_address != NULL) {
+                        if (!interp_call_foreign(interp, instruction, callee->foreign_address, slots, &value)) goto failure;
+                        break;
+                    }
+
+                    int64_t argument_count = instruction->operand_count - 1;
+                    if (argument_count != layec_function_parameter_count(callee->function)) {
+                        layec_write_error(
+                            context,
+                            layec_value_location(instruction->value),
+                            "'%.*s' takes %lld arguments, but was called with %lld.",
+                            STR_EXPAND(layec_function_name(callee->function)),
+                            (long long)layec_function_parameter_count(callee->function),
+                            (long long)argument_count
+                        );
+                        goto failure;
+                    }
+
+                    int64_t call_stack_top = interp->stack_top;
+                    uint64_t* call_arguments = (uint64_t*)interp_stack_push(interp, argument_count * (int64_t)sizeof(uint64_t));
+                    if (call_arguments == NULL) {
+                        layec_write_error(context, layec_value_location(instruction->value), "The interpreter ran out of stack space.");
+                        goto failure;
+                    }
+
+                    for (int64_t j = 0; j < argument_count; j++) {
+                        call_arguments[j] = slots[operands[j + 1]];
+                    }
+
+                    if (interp->call_depth == INTERP_MAX_CALL_DEPTH) {
+                        layec_write_error(
+                            context,
+                            layec_value_location(instruction->value),
+                            "The interpreter reached its limit of %d nested calls.",
+                            INTERP_MAX_CALL_DEPTH
+                        );
+                        goto failure;
+                    }
+
+                    interp->call_depth++;
+                    bool call_succeeded = interp_execute(interp, callee, call_arguments, &value);
+                    interp->call_depth--;
+                    interp->stack_top = call_stack_top;
+                    if (!call_succeeded) goto failure;
+
+                    // the callee's frame is gone, so an aggregate result is copied out of it
+                    // before anything else can reuse that stack.
+                    if (instruction->is_aggregate) {
+                        memcpy(frame + instruction->frame_offset, (const void*)(uintptr_t)value, (size_t)instruction->size);
+                        value = (uint64_t)(uintptr_t)(frame + instruction->frame_offset);
+                    }
+                } break;
+
+                case LAYEC_IR_BRANCH: {
+                    next_block_index = instruction->targets[0];
+                } goto take_branch;
+
+                case LAYEC_IR_COND_BRANCH: {
+                    next_block_index = slots[operands[0]] != 0 ? instruction->targets[0] : instruction->targets[1];
+                } goto take_branch;
+
+                case LAYEC_IR_RETURN: {
+                    *out_result = instruction->operand_count > 0 ? slots[operands[0]] : 0;
+                    interp->stack_top = saved_stack_top;
+                } return true;
+
+                case LAYEC_IR_UNREACHABLE: {
+                    layec_write_error(context, layec_value_location(instruction->value), "Reached unreachable code.");
+                } goto failure;
+
+                case LAYEC_IR_COPY:
+                case LAYEC_IR_BITCAST:
+                case LAYEC_IR_ZEXT: value = slots[operands[0]]; break;
+                case LAYEC_IR_SEXT: value = interp_truncate(bits, (uint64_t)interp_sign_extend(instruction->operand_bits, slots[operands[0]])); break;
+                case LAYEC_IR_TRUNC: value = interp_truncate(bits, slots[operands[0]]); break;
+
+                case LAYEC_IR_NEG: {
+                    if (layec_type_is_float(layec_value_get_type(instruction->value))) {
+                        value = interp_from_double(bits, -interp_to_double(bits, slots[operands[0]]));
+                    } else {
+                        value = interp_truncate(bits, 0 - slots[operands[0]]);
+                    }
+                } break;
+
+                case LAYEC_IR_COMPL: value = interp_truncate(bits, ~slots[operands[0]]); break;
+
+                case LAYEC_IR_FPTOUI: value = interp_truncate(bits, (uint64_t)interp_to_double(instruction->operand_bits, slots[operands[0]])); break;
+                case LAYEC_IR_FPTOSI: value = interp_truncate(bits, (uint64_t)(int64_t)interp_to_double(instruction->operand_bits, slots[operands[0]])); break;
+                case LAYEC_IR_UITOFP: value = interp_from_double(bits, (double)slots[operands[0]]); break;
+                case LAYEC_IR_SITOFP: value = interp_from_double(bits, (double)interp_sign_extend(instruction->operand_bits, slots[operands[0]])); break;
+                case LAYEC_IR_FPTRUNC:
+                case LAYEC_IR_FPEXT: value = interp_from_double(bits, interp_to_double(instruction->operand_bits, slots[operands[0]])); break;
+
+                case LAYEC_IR_ADD: value = interp_truncate(bits, slots[operands[0]] + slots[operands[1]]); break;
+                case LAYEC_IR_SUB: value = interp_truncate(bits, slots[operands[0]] - slots[operands[1]]); break;
+                case LAYEC_IR_MUL: value = interp_truncate(bits, slots[operands[0]] * slots[operands[1]]); break;
+                case LAYEC_IR_AND: value = slots[operands[0]] & slots[operands[1]]; break;
+                case LAYEC_IR_OR: value = slots[operands[0]] | slots[operands[1]]; break;
+                case LAYEC_IR_XOR: value = slots[operands[0]] ^ slots[operands[1]]; break;
+
+                case LAYEC_IR_SDIV:
+                case LAYEC_IR_SMOD:
+                case LAYEC_IR_UDIV:
+                case LAYEC_IR_UMOD: {
+                    uint64_t lhs = slots[operands[0]];
+                    uint64_t rhs = slots[operands[1]];
+                    if (rhs == 0) {
+                        layec_write_error(context, layec_value_location(instruction->value), "Division by zero.");
+                        goto failure;
+                    }
+
+                    if (instruction->kind == LAYEC_IR_UDIV) {
+                        value = lhs / rhs;
+                    } else if (instruction->kind == LAYEC_IR_UMOD) {
+                        value = lhs % rhs;
+                    } else {
+                        int64_t signed_lhs = interp_sign_extend(bits, lhs);
+                        int64_t signed_rhs = interp_sign_extend(bits, rhs);
+                        // dividing the smallest value by -1 overflows in C, so -1 is done by hand.
+                        if (signed_rhs == -1) {
+                            value = instruction->kind == LAYEC_IR_SDIV ? interp_truncate(bits, 0 - lhs) : 0;
+                        } else if (instruction->kind == LAYEC_IR_SDIV) {
+                            value = interp_truncate(bits, (uint64_t)(signed_lhs / signed_rhs));
+                        } else {
+                            value = interp_truncate(bits, (uint64_t)(signed_lhs % signed_rhs));
+                        }
+                    }
+                } break;
+
+                case LAYEC_IR_SHL:
+                case LAYEC_IR_SHR:
+                case LAYEC_IR_SAR: {
+                    uint64_t lhs = slots[operands[0]];
+                    uint64_t amount = slots[operands[1]];
+                    if (instruction->kind == LAYEC_IR_SAR) {
+                        int64_t signed_lhs = interp_sign_extend(bits, lhs);
+                        value = interp_truncate(bits, (uint64_t)(signed_lhs >> (amount >= (uint64_t)bits ? bits - 1 : (int)amount)));
+                    } else if (amount >= (uint64_t)bits) {
+                        value = 0;
+                    } else if (instruction->kind == LAYEC_IR_SHL) {
+                        value = interp_truncate(bits, lhs << amount);
+                    } else {
+                        value = lhs >> amount;
+                    }
+                } break;
+
+                case LAYEC_IR_FADD:
+                case LAYEC_IR_FSUB:
+                case LAYEC_IR_FMUL:
+                case LAYEC_IR_FDIV:
+                case LAYEC_IR_FMOD: {
+                    double lhs = interp_to_double(bits, slots[operands[0]]);
+                    double rhs = interp_to_double(bits, slots[operands[1]]);
+                    double result = 0;
+                    switch (instruction->kind) {
+                        default: assert(false && "unreachable"); break;
+                        case LAYEC_IR_FADD: result = lhs + rhs; break;
+                        case LAYEC_IR_FSUB: result = lhs - rhs; break;
+                        case LAYEC_IR_FMUL: result = lhs * rhs; break;
+                        case LAYEC_IR_FDIV: result = lhs / rhs; break;
+                        case LAYEC_IR_FMOD: result = fmod(lhs, rhs); break;
+                    }
+
+                    value = interp_from_double(bits, result);
+                } break;
+
+                case LAYEC_IR_ICMP_EQ: value = slots[operands[0]] == slots[operands[1]]; break;
+                case LAYEC_IR_ICMP_NE: value = slots[operands[0]] != slots[operands[1]]; break;
+                case LAYEC_IR_ICMP_ULT: value = slots[operands[0]] < slots[operands[1]]; break;
+                case LAYEC_IR_ICMP_ULE: value = slots[operands[0]] <= slots[operands[1]]; break;
+                case LAYEC_IR_ICMP_UGT: value = slots[operands[0]] > slots[operands[1]]; break;
+                case LAYEC_IR_ICMP_UGE: value = slots[operands[0]] >= slots[operands[1]]; break;
+
+                case LAYEC_IR_ICMP_SLT:
+                case LAYEC_IR_ICMP_SLE:
+                case LAYEC_IR_ICMP_SGT:
+                case LAYEC_IR_ICMP_SGE: {
+                    int64_t lhs = interp_sign_extend(instruction->operand_bits, slots[operands[0]]);
+                    int64_t rhs = interp_sign_extend(instruction->operand_bits, slots[operands[1]]);
+                    switch (instruction->kind) {
+                        default: assert(false && "unreachable"); break;
+                        case LAYEC_IR_ICMP_SLT: value = lhs < rhs; break;
+                        case LAYEC_IR_ICMP_SLE: value = lhs <= rhs; break;
+                        case LAYEC_IR_ICMP_SGT: value = lhs > rhs; break;
+                        case LAYEC_IR_ICMP_SGE: value = lhs >= rhs; break;
+                    }
+                } break;
+
+                case LAYEC_IR_FCMP_FALSE:
+                case LAYEC_IR_FCMP_OEQ:
+                case LAYEC_IR_FCMP_OGT:
+                case LAYEC_IR_FCMP_OGE:
+                case LAYEC_IR_FCMP_OLT:
+                case LAYEC_IR_FCMP_OLE:
+                case LAYEC_IR_FCMP_ONE:
+                case LAYEC_IR_FCMP_ORD:
+                case LAYEC_IR_FCMP_UEQ:
+                case LAYEC_IR_FCMP_UGT:
+                case LAYEC_IR_FCMP_UGE:
+                case LAYEC_IR_FCMP_ULT:
+                case LAYEC_IR_FCMP_ULE:
+                case LAYEC_IR_FCMP_UNE:
+                case LAYEC_IR_FCMP_UNO:
+                case LAYEC_IR_FCMP_TRUE: {
+                    double lhs = interp_to_double(instruction->operand_bits, slots[operands[0]]);
+                    double rhs = interp_to_double(instruction->operand_bits, slots[operands[1]]);
+                    value = interp_fcmp(instruction->kind, lhs, rhs);
+                } break;
+            }
+
+            if (instruction->result >= 0) {
+                slots[instruction->result] = value;
+            }
+        }
+
+        layec_write_error(context, layec_value_location(function->function), "The interpreter fell off the end of a block without a terminator.");
+        goto failure;
+
+    take_branch:;
+        // phis read their incoming values before any of them are assigned, as they all happen
+        // at once on the edge.
+        interp_block* next_block = &function->blocks[next_block_index];
+        if (next_block->phi_count > 0) {
+            int64_t phi_stack_top = interp->stack_top;
+            uint64_t* incoming = (uint64_t*)interp_stack_push(interp, next_block->phi_count * (int64_t)sizeof(uint64_t));
+            if (incoming == NULL) {
+                layec_write_error(context, layec_value_location(function->function), "The interpreter ran out of stack space.");
+                goto failure;
+            }
+
+            for (int64_t p = 0; p < next_block->phi_count; p++) {
+                interp_phi* phi = &next_block->phis[p];
+                int64_t incoming_index = 0;
+                while (incoming_index < phi->incoming_count && phi->incoming_blocks[incoming_index] != block_index) {
+                    incoming_index++;
+                }
+
+                assert(incoming_index < phi->incoming_count && "phi has no value for the block branching to it");
+                incoming[p] = slots[phi->incoming_slots[incoming_index]];
+            }
+
+            for (int64_t p = 0; p < next_block->phi_count; p++) {
+                slots[next_block->phis[p].result] = incoming[p];
+            }
+
+            interp->stack_top = phi_stack_top;
+        }
+
+        block_index = next_block_index;
+    }
+
+failure:;
+    interp->stack_top = saved_stack_top;
+    return false;
+}
+
+// ========== Interpreter API ==========
+
+layec_interp* layec_interp_create(layec_context* context) {
+    assert(context != NULL);
+
+    layec_interp* interp = lca_allocate(context->allocator, sizeof *interp);
+    assert(interp != NULL);
+    *interp = (layec_interp){
+        .context = context,
+        .arena = lca_arena_create(context->allocator, INTERP_ARENA_BLOCK_SIZE),
+        .stack = lca_allocate(context->allocator, INTERP_STACK_SIZE),
+    };
+
+    assert(interp->arena != NULL);
+    assert(interp->stack != NULL);
+    return interp;
+}
+
+void layec_interp_destroy(layec_interp* interp) {
+    if (interp == NULL) return;
+
+    lca_allocator allocator = interp->context->allocator;
+    for (int64_t i = 0, count = arr_count(interp->global_storage); i < count; i++) {
+        lca_deallocate(allocator, interp->global_storage[i]);
+    }
+
+#if LAYEC_INTERP_FOREIGN_CALLS
+    if (interp->host_library != NULL) {
+        dlclose(interp->host_library);
+    }
+#endif
+
+    arr_free(interp->global_storage);
+    ptrmap_free(&interp->functions);
+    ptrmap_free(&interp->function_addresses);
+    ptrmap_free(&interp->globals);
+    lca_arena_destroy(interp->arena);
+    lca_deallocate(allocator, interp->stack);
+    lca_deallocate(allocator, interp);
+}
+
+layec_value* layec_interp_find_function(layec_interp* interp, string_view name) {
+    assert(interp != NULL);
+
+    for (int64_t i = 0, count = arr_count(interp->context->ir_modules); i < count; i++) {
+        layec_module* module = interp->context->ir_modules[i];
+        if (module == NULL) continue;
+
+        for (int64_t j = 0, function_count = layec_module_function_count(module); j < function_count; j++) {
+            layec_value* function = layec_module_get_function_at_index(module, j);
+            if (layec_function_block_count(function) > 0 && string_view_equals(layec_function_name(function), name)) {
+                return function;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+bool layec_interp_call(layec_interp* interp, layec_value* function, int64_t argument_count, const uint64_t* arguments, uint64_t* out_result) {
+    assert(interp != NULL);
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+    assert(argument_count == layec_function_parameter_count(function));
+    assert(argument_count == 0 || arguments != NULL);
+
+    interp_function* callee = interp_get_function(interp, function);
+    if (callee == NULL) {
+        return false;
+    }
+
+    if (callee->foreign_address != NULL) {
+        layec_write_error(
+            interp->context,
+            layec_value_location(function),
+            "'%.*s' has no definition for the interpreter to run.",
+            STR_EXPAND(layec_function_name(function))
+        );
+        return false;
+    }
+
+    uint64_t result = 0;
+    bool success = interp_execute(interp, callee, arguments, &result);
+    assert(interp->stack_top == 0);
+
+    if (success && out_result != NULL) {
+        *out_result = result;
+    }
+
+    return success;
+}
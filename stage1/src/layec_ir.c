@@ -46,7 +46,7 @@ void layec_value_destroy(layec_value* value);
 
 struct layec_module {
     layec_context* context;
-    string_view name;
+    layec_symbol name;
 
     lca_arena* arena;
     dynarr(layec_value*) functions;
@@ -86,10 +86,15 @@ struct layec_type {
     };
 };
 
-typedef struct layec_incoming_value {
+struct layec_use {
+    // the value in this operand slot, and the instruction it is an operand of.
     layec_value* value;
-    layec_value* block;
-} layec_incoming_value;
+    layec_value* user;
+    // links in the list of uses of `value`. `prev_next` points at whichever pointer points at
+    // this use, so a use can unlink itself without searching the list.
+    layec_use* next;
+    layec_use** prev_next;
+};
 
 struct layec_value {
     layec_value_kind kind;
@@ -99,17 +104,26 @@ struct layec_value {
 
     layec_type* type;
 
-    string_view name;
+    layec_symbol name;
     int64_t index;
     layec_linkage linkage;
 
-    // for values which want their uses tracked, a list of all users of this value.
-    dynarr(layec_value*) users;
+    // the head of the list of every operand slot which refers to this value.
+    layec_use* uses;
+
+    // the operands of an instruction, in the order described by `layec_instruction_operand_count`.
+    // they live in `inline_operands` until an instruction with a variable number of them outgrows it.
+    layec_use* operands;
+    int64_t operand_count;
+    int64_t operand_capacity;
+    layec_use inline_operands[2];
 
     layec_value* parent_block;
+    // set by `layec_instruction_mark_for_removal`, the instruction is taken out of its
+    // block the next time `layec_function_remove_marked_instructions` is called.
+    bool is_marked_for_removal;
 
-    layec_value* address;
-    layec_value* operand;
+    // the initializer of a global variable.
     layec_value* value;
 
     union {
@@ -118,7 +132,6 @@ struct layec_value {
 
         struct {
             layec_builtin_kind kind;
-            dynarr(layec_value*) arguments;
         } builtin;
 
         struct {
@@ -128,16 +141,25 @@ struct layec_value {
         } array;
 
         struct {
-            string_view name;
+            layec_symbol name;
             int64_t index;
             layec_value* parent_function;
             dynarr(layec_value*) instructions;
         } block;
 
         struct {
-            string_view name;
+            layec_symbol name;
             dynarr(layec_value*) parameters;
             dynarr(layec_value*) blocks;
+            // set when instructions are added, instruction indices are then
+            // recalculated the next time one of them is requested.
+            bool has_stale_indices;
+            // declared `inline` in the source; the inliner always inlines calls to it when it can.
+            bool is_inline;
+            // bumped on every change to the function, and `cfg_version` also on every change to its
+            // blocks or the edges between them, so cached analyses can tell when they are stale.
+            int64_t version;
+            int64_t cfg_version;
         } function;
 
         int64_t parameter_index;
@@ -147,27 +169,19 @@ struct layec_value {
             int64_t element_count;
         } alloca;
 
-        layec_value* return_value;
-
-        struct {
-            layec_value* lhs;
-            layec_value* rhs;
-        } binary;
-
         struct {
             layec_value* pass;
             layec_value* fail;
         } branch;
 
-        dynarr(layec_incoming_value) incoming_values;
+        // the block each incoming value of a phi comes from, parallel to its operands.
+        dynarr(layec_value*) incoming_blocks;
 
         struct {
-            layec_value* callee;
             // we may need to store a separate callee type, since opaque pointers are a thing
             // and we may be calling through a function pointer, for example
             layec_type* callee_type;
             layec_calling_convention calling_convention;
-            dynarr(layec_value*) arguments;
             bool is_tail_call : 1;
         } call;
     };
@@ -181,44 +195,166 @@ struct layec_builder {
     int64_t insert_index;
 };
 
-static void layec_value_add_user(layec_value* value, layec_value* user) {
+static void layec_use_link(layec_use* use, layec_value* value) {
+    assert(use != NULL);
+    assert(use->value == NULL);
     assert(value != NULL);
-    assert(user != NULL);
 
-    for (int64_t i = 0, count = arr_count(value->users); i < count; i++) {
-        if (value->users[i] == user) {
-            return;
-        }
+    use->value = value;
+    use->next = value->uses;
+    use->prev_next = &value->uses;
+    if (value->uses != NULL) {
+        value->uses->prev_next = &use->next;
+    }
+
+    value->uses = use;
+}
+
+static void layec_use_unlink(layec_use* use) {
+    assert(use != NULL);
+    if (use->value == NULL) {
+        return;
+    }
+
+    assert(use->prev_next != NULL);
+    *use->prev_next = use->next;
+    if (use->next != NULL) {
+        use->next->prev_next = use->prev_next;
     }
 
-    arr_push(value->users, user);
+    use->value = NULL;
+    use->next = NULL;
+    use->prev_next = NULL;
 }
 
-static void layec_value_remove_user(layec_value* value, layec_value* user) {
+static void layec_use_set(layec_use* use, layec_value* value) {
+    assert(use != NULL);
     assert(value != NULL);
-    assert(user != NULL);
 
-    for (int64_t i = 0, count = arr_count(value->users); i < count; i++) {
-        if (value->users[i] == user) {
-            if (i != count - 1) {
-                value->users[i] = value->users[count - 1];
-            }
+    if (use->value == value) {
+        return;
+    }
 
-            arr_pop(value->users);
-            return;
-        }
+    layec_use_unlink(use);
+    layec_use_link(use, value);
+}
+
+static void layec_instruction_reserve_operands(layec_value* instruction, int64_t capacity) {
+    assert(instruction != NULL);
+    assert(instruction->operands != NULL);
+
+    if (capacity <= instruction->operand_capacity) {
+        return;
+    }
+
+    int64_t new_capacity = instruction->operand_capacity * 2;
+    if (new_capacity < capacity) {
+        new_capacity = capacity;
+    }
+
+    lca_allocator allocator = instruction->context->allocator;
+    layec_use* operands = lca_allocate(allocator, (size_t)new_capacity * sizeof *operands);
+    assert(operands != NULL);
+
+    // the uses are about to move, so take them out of their lists and put them back at their new address.
+    for (int64_t i = 0, count = instruction->operand_count; i < count; i++) {
+        layec_value* value = instruction->operands[i].value;
+        layec_use_unlink(&instruction->operands[i]);
+        operands[i] = (layec_use){ .user = instruction };
+        layec_use_link(&operands[i], value);
     }
+
+    if (instruction->operands != instruction->inline_operands) {
+        lca_deallocate(allocator, instruction->operands);
+    }
+
+    instruction->operands = operands;
+    instruction->operand_capacity = new_capacity;
+}
+
+static void layec_instruction_add_operand(layec_value* instruction, layec_value* operand) {
+    assert(instruction != NULL);
+    assert(operand != NULL);
+
+    layec_instruction_reserve_operands(instruction, instruction->operand_count + 1);
+    layec_use* use = &instruction->operands[instruction->operand_count];
+    *use = (layec_use){ .user = instruction };
+    layec_use_link(use, operand);
+    instruction->operand_count++;
+}
+
+static void layec_instruction_remove_operand_at_index(layec_value* instruction, int64_t operand_index) {
+    assert(instruction != NULL);
+    assert(operand_index >= 0);
+    assert(operand_index < instruction->operand_count);
+
+    int64_t count = instruction->operand_count;
+    for (int64_t i = operand_index; i < count - 1; i++) {
+        layec_use_set(&instruction->operands[i], instruction->operands[i + 1].value);
+    }
+
+    layec_use_unlink(&instruction->operands[count - 1]);
+    instruction->operand_count--;
 }
 
-int64_t layec_value_get_user_count(layec_value* value) {
+// unlinks the operands of an instruction which is going away, so the values it used don't keep it as a use.
+static void layec_instruction_drop_operands(layec_value* instruction) {
+    assert(instruction != NULL);
+
+    for (int64_t i = 0, count = instruction->operand_count; i < count; i++) {
+        layec_use_unlink(&instruction->operands[i]);
+    }
+
+    instruction->operand_count = 0;
+    if (instruction->kind == LAYEC_IR_PHI) {
+        arr_set_count(instruction->incoming_blocks, 0);
+    }
+}
+
+layec_use* layec_value_first_use(layec_value* value) {
     assert(value != NULL);
-    return arr_count(value->users);
+    return value->uses;
 }
 
-layec_value* layec_value_get_user_at_index(layec_value* value, int64_t user_index) {
+bool layec_value_has_uses(layec_value* value) {
     assert(value != NULL);
-    assert(user_index >= 0 && user_index < arr_count(value->users));
-    return value->users[user_index];
+    return value->uses != NULL;
+}
+
+int64_t layec_value_use_count(layec_value* value) {
+    assert(value != NULL);
+
+    int64_t count = 0;
+    for (layec_use* use = value->uses; use != NULL; use = use->next) {
+        count++;
+    }
+
+    return count;
+}
+
+layec_use* layec_use_next(layec_use* use) {
+    assert(use != NULL);
+    return use->next;
+}
+
+layec_value* layec_use_get_value(layec_use* use) {
+    assert(use != NULL);
+    assert(use->value != NULL);
+    return use->value;
+}
+
+layec_value* layec_use_get_user(layec_use* use) {
+    assert(use != NULL);
+    assert(use->user != NULL);
+    return use->user;
+}
+
+int64_t layec_use_operand_index(layec_use* use) {
+    assert(use != NULL);
+    assert(use->user != NULL);
+    int64_t operand_index = use - use->user->operands;
+    assert(operand_index >= 0 && operand_index < use->user->operand_count);
+    return operand_index;
 }
 
 int64_t layec_context_get_struct_type_count(layec_context* context) {
@@ -249,6 +385,11 @@ void layec_module_destroy(layec_module* module) {
 
     lca_allocator allocator = module->context->allocator;
 
+    // constants outlive the module, so nothing in it may be left in their lists of uses.
+    for (int64_t i = 0, count = arr_count(module->_all_values); i < count; i++) {
+        layec_instruction_drop_operands(module->_all_values[i]);
+    }
+
     for (int64_t i = 0, count = arr_count(module->_all_values); i < count; i++) {
         layec_value_destroy(module->_all_values[i]);
     }
@@ -267,6 +408,10 @@ void layec_module_destroy(layec_module* module) {
 void layec_value_destroy(layec_value* value) {
     assert(value != NULL);
 
+    if (value->operands != NULL && value->operands != value->inline_operands) {
+        lca_deallocate(value->context->allocator, value->operands);
+    }
+
     switch (value->kind) {
         default: break;
 
@@ -279,16 +424,8 @@ void layec_value_destroy(layec_value* value) {
             arr_free(value->block.instructions);
         } break;
 
-        case LAYEC_IR_CALL: {
-            arr_free(value->call.arguments);
-        } break;
-
         case LAYEC_IR_PHI: {
-            arr_free(value->incoming_values);
-        } break;
-
-        case LAYEC_IR_BUILTIN: {
-            arr_free(value->builtin.arguments);
+            arr_free(value->incoming_blocks);
         } break;
     }
 }
@@ -306,33 +443,126 @@ static layec_type* layec_type_create(layec_context* context, layec_type_kind kin
     return type;
 }
 
+// NOTE(local): types are shared, and every one of them is in `_all_types`, so this
+// only releases memory owned by `type` itself and never recurses into other types.
 void layec_type_destroy(layec_type* type) {
     if (type == NULL) return;
 
     switch (type->kind) {
         default: break;
 
+        case LAYEC_TYPE_FUNCTION: {
+            arr_free(type->function.parameter_types);
+        } break;
+
+        case LAYEC_TYPE_STRUCT: {
+            arr_free(type->_struct.members);
+        } break;
+    }
+}
+
+// component types are already unique, so they hash and compare by address.
+static uint64_t layec_type_structural_hash(layec_type* type) {
+    uint64_t hash = lca_hash_combine(LCA_HASH_SEED, (uint64_t)type->kind);
+
+    switch (type->kind) {
+        default: {
+            fprintf(stderr, "for type kind %s\n", layec_type_kind_to_cstring(type->kind));
+            assert(false && "unimplemented kind in layec_type_structural_hash");
+            return 0;
+        }
+
+        case LAYEC_TYPE_INTEGER: {
+            hash = lca_hash_combine(hash, (uint64_t)type->primitive_bit_width);
+        } break;
+
         case LAYEC_TYPE_ARRAY: {
-            layec_type_destroy(type->array.element_type);
+            hash = lca_hash_combine(hash, (uint64_t)(uintptr_t)type->array.element_type);
+            hash = lca_hash_combine(hash, (uint64_t)type->array.length);
         } break;
 
         case LAYEC_TYPE_FUNCTION: {
-            layec_type_destroy(type->function.return_type);
+            hash = lca_hash_combine(hash, (uint64_t)(uintptr_t)type->function.return_type);
             for (int64_t i = 0, count = arr_count(type->function.parameter_types); i < count; i++) {
-                layec_type_destroy(type->function.parameter_types[i]);
+                hash = lca_hash_combine(hash, (uint64_t)(uintptr_t)type->function.parameter_types[i]);
             }
 
-            arr_free(type->function.parameter_types);
+            hash = lca_hash_combine(hash, (uint64_t)type->function.calling_convention);
+            hash = lca_hash_combine(hash, (uint64_t)type->function.is_variadic);
         } break;
+    }
 
-        case LAYEC_TYPE_STRUCT: {
-            for (int64_t i = 0, count = arr_count(type->_struct.members); i < count; i++) {
-                layec_type_destroy(type->_struct.members[i].type);
+    return hash;
+}
+
+static bool layec_type_structurally_equals(layec_type* a, layec_type* b) {
+    if (a->kind != b->kind) {
+        return false;
+    }
+
+    switch (a->kind) {
+        default: {
+            fprintf(stderr, "for type kind %s\n", layec_type_kind_to_cstring(a->kind));
+            assert(false && "unimplemented kind in layec_type_structurally_equals");
+            return false;
+        }
+
+        case LAYEC_TYPE_INTEGER: {
+            return a->primitive_bit_width == b->primitive_bit_width;
+        }
+
+        case LAYEC_TYPE_ARRAY: {
+            return a->array.element_type == b->array.element_type && a->array.length == b->array.length;
+        }
+
+        case LAYEC_TYPE_FUNCTION: {
+            if (a->function.return_type != b->function.return_type ||
+                a->function.calling_convention != b->function.calling_convention ||
+                a->function.is_variadic != b->function.is_variadic) {
+                return false;
             }
 
-            arr_free(type->_struct.members);
-        } break;
+            int64_t parameter_count = arr_count(a->function.parameter_types);
+            if (parameter_count != arr_count(b->function.parameter_types)) {
+                return false;
+            }
+
+            for (int64_t i = 0; i < parameter_count; i++) {
+                if (a->function.parameter_types[i] != b->function.parameter_types[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+}
+
+static bool layec_type_unique_equals(const void* value, const void* key) {
+    return layec_type_structurally_equals((layec_type*)value, (layec_type*)key);
+}
+
+// returns the unique type structurally equal to `key`, creating it from `key` if there is
+// none yet. `key` is only a description and is never stored itself; any memory it owns
+// is either moved into the new type or released.
+static layec_type* layec_type_get_unique(layec_context* context, layec_type key) {
+    assert(context != NULL);
+
+    key.context = context;
+    uint64_t hash = layec_type_structural_hash(&key);
+
+    layec_type* existing_type = lca_hashset_find(&context->_unique_types, hash, layec_type_unique_equals, &key);
+    if (existing_type != NULL) {
+        layec_type_destroy(&key);
+        return existing_type;
     }
+
+    layec_type* type = layec_type_create(context, key.kind);
+    assert(type != NULL);
+    *type = key;
+
+    lca_hashset_insert(&context->_unique_types, hash, type);
+    return type;
 }
 
 const char* layec_type_kind_to_cstring(layec_type_kind kind) {
@@ -361,6 +591,8 @@ static layec_value* layec_value_create(layec_module* module, layec_location loca
     value->context = module->context;
     value->location = location;
     value->type = type;
+    value->operands = value->inline_operands;
+    value->operand_capacity = sizeof value->inline_operands / sizeof *value->inline_operands;
     arr_push(module->_all_values, value);
 
     return value;
@@ -376,6 +608,16 @@ string_view layec_module_name(layec_module* module) {
     return module->name;
 }
 
+int64_t layec_module_value_count(layec_module* module) {
+    assert(module != NULL);
+    return arr_count(module->_all_values);
+}
+
+lca_arena_stats layec_module_arena_stats(layec_module* module) {
+    assert(module != NULL);
+    return lca_arena_get_stats(module->arena);
+}
+
 int64_t layec_module_global_count(layec_module* module) {
     assert(module != NULL);
     return arr_count(module->globals);
@@ -467,12 +709,55 @@ bool layec_function_is_variadic(layec_value* function) {
     return function->type->function.is_variadic;
 }
 
+bool layec_function_is_inline(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+    return function->function.is_inline;
+}
+
+void layec_function_set_inline(layec_value* function, bool is_inline) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+    function->function.is_inline = is_inline;
+}
+
+int64_t layec_function_version(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+    return function->function.version;
+}
+
+int64_t layec_function_cfg_version(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+    return function->function.cfg_version;
+}
+
 void layec_function_set_parameter_type_at_index(layec_value* function, int64_t parameter_index, layec_type* param_type) {
     assert(function != NULL);
     assert(layec_value_is_function(function));
     assert(function->type != NULL);
     assert(layec_type_is_function(function->type));
-    layec_function_type_set_parameter_type_at_index(function->type, parameter_index, param_type);
+    assert(param_type != NULL);
+
+    // function types are shared, so build a new one rather than changing it in place.
+    layec_type* function_type = function->type;
+    assert(parameter_index >= 0);
+    assert(parameter_index < arr_count(function_type->function.parameter_types));
+
+    dynarr(layec_type*) parameter_types = NULL;
+    for (int64_t i = 0, count = arr_count(function_type->function.parameter_types); i < count; i++) {
+        arr_push(parameter_types, i == parameter_index ? param_type : function_type->function.parameter_types[i]);
+    }
+
+    function->type = layec_function_type(
+        function->context,
+        function_type->function.return_type,
+        parameter_types,
+        function_type->function.calling_convention,
+        function_type->function.is_variadic
+    );
+
     function->function.parameters[parameter_index]->type = param_type;
 }
 
@@ -526,6 +811,11 @@ layec_context* layec_value_context(layec_value* value) {
     return value->context;
 }
 
+layec_module* layec_value_module(layec_value* value) {
+    assert(value != NULL);
+    return value->module;
+}
+
 layec_location layec_value_location(layec_value* value) {
     assert(value != NULL);
     return value->location;
@@ -541,8 +831,37 @@ string_view layec_value_name(layec_value* value) {
     return value->name;
 }
 
+static void layec_function_calculate_instruction_indices(layec_value* function);
+static int64_t layec_instruction_get_index_within_block(layec_value* instruction);
+
+static void layec_function_note_change(layec_value* function, bool changes_cfg) {
+    assert(function != NULL);
+    assert(function->kind == LAYEC_IR_FUNCTION);
+
+    function->function.version++;
+    if (changes_cfg) {
+        function->function.cfg_version++;
+    }
+}
+
+// instructions not (or no longer) in a function don't count as a change to anything.
+static void layec_instruction_note_change(layec_value* instruction) {
+    if (instruction->parent_block != NULL && instruction->parent_block->block.parent_function != NULL) {
+        layec_function_note_change(instruction->parent_block->block.parent_function, false);
+    }
+}
+
 int64_t layec_value_index(layec_value* value) {
     assert(value != NULL);
+
+    if (value->parent_block != NULL) {
+        layec_value* function = value->parent_block->block.parent_function;
+        assert(function != NULL);
+        if (function->function.has_stale_indices) {
+            layec_function_calculate_instruction_indices(function);
+        }
+    }
+
     return value->index;
 }
 
@@ -587,14 +906,14 @@ bool layec_instruction_global_is_string(layec_value* global) {
 bool layec_instruction_return_has_value(layec_value* _return) {
     assert(_return != NULL);
     assert(_return->kind == LAYEC_IR_RETURN);
-    return _return->return_value != NULL;
+    return _return->operand_count != 0;
 }
 
 layec_value* layec_instruction_return_value(layec_value* _return) {
     assert(_return != NULL);
     assert(_return->kind == LAYEC_IR_RETURN);
-    assert(_return->return_value != NULL);
-    return _return->return_value;
+    assert(_return->operand_count == 1);
+    return _return->operands[0].value;
 }
 
 layec_type* layec_instruction_get_alloca_type(layec_value* alloca) {
@@ -603,34 +922,69 @@ layec_type* layec_instruction_get_alloca_type(layec_value* alloca) {
     return alloca->alloca.element_type;
 }
 
+int64_t layec_instruction_get_alloca_element_count(layec_value* alloca) {
+    assert(alloca != NULL);
+    assert(alloca->kind == LAYEC_IR_ALLOCA);
+    return alloca->alloca.element_count;
+}
+
+static bool layec_value_kind_is_unary(layec_value_kind kind) {
+    return kind >= LAYEC_IR_ZEXT && kind <= LAYEC_IR_FPEXT;
+}
+
+static bool layec_value_kind_is_binary(layec_value_kind kind) {
+    return kind >= LAYEC_IR_ADD && kind <= LAYEC_IR_FCMP_TRUE;
+}
+
 layec_value* layec_instruction_get_address(layec_value* instruction) {
     assert(instruction != NULL);
-    assert(instruction->address != NULL);
-    return instruction->address;
+    assert(instruction->kind == LAYEC_IR_LOAD || instruction->kind == LAYEC_IR_STORE || instruction->kind == LAYEC_IR_PTRADD);
+    assert(instruction->operands[0].value != NULL);
+    return instruction->operands[0].value;
 }
 
 layec_value* layec_instruction_get_operand(layec_value* instruction) {
     assert(instruction != NULL);
-    assert(instruction->operand != NULL);
-    return instruction->operand;
+
+    // the stored value of a store and the offset of a ptradd follow their address.
+    layec_value* operand = NULL;
+    if (instruction->kind == LAYEC_IR_STORE || instruction->kind == LAYEC_IR_PTRADD) {
+        operand = instruction->operands[1].value;
+    } else {
+        assert(layec_value_kind_is_unary(instruction->kind));
+        operand = instruction->operands[0].value;
+    }
+
+    assert(operand != NULL);
+    return operand;
 }
 
 layec_value* layec_instruction_binary_get_lhs(layec_value* instruction) {
     assert(instruction != NULL);
-    assert(instruction->binary.lhs != NULL);
-    return instruction->binary.lhs;
+    assert(layec_value_kind_is_binary(instruction->kind));
+    assert(instruction->operands[0].value != NULL);
+    return instruction->operands[0].value;
 }
 
 layec_value* layec_instruction_binary_get_rhs(layec_value* instruction) {
     assert(instruction != NULL);
-    assert(instruction->binary.rhs != NULL);
-    return instruction->binary.rhs;
+    assert(layec_value_kind_is_binary(instruction->kind));
+    assert(instruction->operands[1].value != NULL);
+    return instruction->operands[1].value;
 }
 
 layec_value* layec_instruction_get_value(layec_value* instruction) {
     assert(instruction != NULL);
-    assert(instruction->value != NULL);
-    return instruction->value;
+
+    // the initializer of a global is not an operand, since globals aren't instructions.
+    if (instruction->kind == LAYEC_IR_GLOBAL_VARIABLE) {
+        assert(instruction->value != NULL);
+        return instruction->value;
+    }
+
+    assert(instruction->kind == LAYEC_IR_COND_BRANCH);
+    assert(instruction->operands[0].value != NULL);
+    return instruction->operands[0].value;
 }
 
 layec_value* layec_instruction_branch_get_pass(layec_value* instruction) {
@@ -648,46 +1002,39 @@ layec_value* layec_instruction_branch_get_fail(layec_value* instruction) {
 layec_value* layec_instruction_callee(layec_value* call) {
     assert(call != NULL);
     assert(call->kind == LAYEC_IR_CALL);
-    assert(call->call.callee != NULL);
-    return call->call.callee;
+    assert(call->operands[0].value != NULL);
+    return call->operands[0].value;
 }
 
 int64_t layec_instruction_call_argument_count(layec_value* call) {
     assert(call != NULL);
     assert(call->kind == LAYEC_IR_CALL);
-    return arr_count(call->call.arguments);
+    assert(call->operand_count >= 1);
+    return call->operand_count - 1;
 }
 
 layec_value* layec_instruction_call_get_argument_at_index(layec_value* call, int64_t argument_index) {
     assert(call != NULL);
     assert(call->kind == LAYEC_IR_CALL);
     assert(argument_index >= 0);
-    int64_t count = arr_count(call->call.arguments);
-    assert(argument_index < count);
-    layec_value* argument = call->call.arguments[argument_index];
+    assert(argument_index < call->operand_count - 1);
+    layec_value* argument = call->operands[argument_index + 1].value;
     assert(argument != NULL);
     return argument;
 }
 
-void layec_instruction_call_set_arguments(layec_value* call, dynarr(layec_value*) arguments) {
-    assert(call != NULL);
-    assert(call->kind == LAYEC_IR_CALL);
-    call->call.arguments = arguments;
-}
-
 int64_t layec_instruction_builtin_argument_count(layec_value* builtin) {
     assert(builtin != NULL);
     assert(builtin->kind == LAYEC_IR_BUILTIN);
-    return arr_count(builtin->builtin.arguments);
+    return builtin->operand_count;
 }
 
 layec_value* layec_instruction_builtin_get_argument_at_index(layec_value* builtin, int64_t argument_index) {
     assert(builtin != NULL);
     assert(builtin->kind == LAYEC_IR_BUILTIN);
     assert(argument_index >= 0);
-    int64_t count = arr_count(builtin->builtin.arguments);
-    assert(argument_index < count);
-    layec_value* argument = builtin->builtin.arguments[argument_index];
+    assert(argument_index < builtin->operand_count);
+    layec_value* argument = builtin->operands[argument_index].value;
     assert(argument != NULL);
     return argument;
 }
@@ -699,24 +1046,23 @@ void layec_instruction_phi_add_incoming_value(layec_value* phi, layec_value* val
     assert(block != NULL);
     assert(block->kind == LAYEC_IR_BLOCK);
 
-    layec_incoming_value incoming_value = {
-        .value = value,
-        .block = block,
-    };
-
-    arr_push(phi->incoming_values, incoming_value);
+    layec_instruction_add_operand(phi, value);
+    arr_push(phi->incoming_blocks, block);
+    assert(phi->operand_count == arr_count(phi->incoming_blocks));
+    layec_instruction_note_change(phi);
 }
 
 int64_t layec_instruction_phi_incoming_value_count(layec_value* phi) {
     assert(phi != NULL);
     assert(phi->kind == LAYEC_IR_PHI);
-    return arr_count(phi->incoming_values);
+    return phi->operand_count;
 }
 
 layec_value* layec_instruction_phi_incoming_value_at_index(layec_value* phi, int64_t index) {
     assert(phi != NULL);
     assert(phi->kind == LAYEC_IR_PHI);
-    layec_value* value = phi->incoming_values[index].value;
+    assert(index >= 0 && index < phi->operand_count);
+    layec_value* value = phi->operands[index].value;
     assert(value != NULL);
     return value;
 }
@@ -724,24 +1070,452 @@ layec_value* layec_instruction_phi_incoming_value_at_index(layec_value* phi, int
 layec_value* layec_instruction_phi_incoming_block_at_index(layec_value* phi, int64_t index) {
     assert(phi != NULL);
     assert(phi->kind == LAYEC_IR_PHI);
-    layec_value* block = phi->incoming_values[index].block;
+    assert(index >= 0 && index < arr_count(phi->incoming_blocks));
+    layec_value* block = phi->incoming_blocks[index];
     assert(block != NULL);
     assert(block->kind == LAYEC_IR_BLOCK);
     return block;
 }
 
+void layec_instruction_phi_set_incoming_block_at_index(layec_value* phi, int64_t index, layec_value* block) {
+    assert(phi != NULL);
+    assert(phi->kind == LAYEC_IR_PHI);
+    assert(index >= 0);
+    assert(index < arr_count(phi->incoming_blocks));
+    assert(block != NULL);
+    assert(block->kind == LAYEC_IR_BLOCK);
+    phi->incoming_blocks[index] = block;
+    layec_instruction_note_change(phi);
+}
+
+void layec_instruction_phi_remove_incoming_value_at_index(layec_value* phi, int64_t index) {
+    assert(phi != NULL);
+    assert(phi->kind == LAYEC_IR_PHI);
+    assert(index >= 0);
+    assert(index < arr_count(phi->incoming_blocks));
+
+    layec_instruction_remove_operand_at_index(phi, index);
+
+    int64_t count = arr_count(phi->incoming_blocks);
+    for (int64_t i = index; i < count - 1; i++) {
+        phi->incoming_blocks[i] = phi->incoming_blocks[i + 1];
+    }
+
+    arr_set_count(phi->incoming_blocks, count - 1);
+    layec_instruction_note_change(phi);
+}
+
+int64_t layec_instruction_operand_count(layec_value* instruction) {
+    assert(instruction != NULL);
+    // unary instructions, loads and condition branches have one operand; binary instructions have two.
+    // a store is its address then the value, a ptradd its address then the offset, a call its callee
+    // then the arguments, and a phi its incoming values in the same order as its incoming blocks.
+    return instruction->operand_count;
+}
+
+layec_value* layec_instruction_get_operand_at_index(layec_value* instruction, int64_t operand_index) {
+    assert(instruction != NULL);
+    assert(operand_index >= 0);
+    assert(operand_index < instruction->operand_count);
+    layec_value* operand = instruction->operands[operand_index].value;
+    assert(operand != NULL);
+    return operand;
+}
+
+void layec_instruction_set_operand_at_index(layec_value* instruction, int64_t operand_index, layec_value* operand) {
+    assert(instruction != NULL);
+    assert(operand_index >= 0);
+    assert(operand_index < instruction->operand_count);
+    assert(operand != NULL);
+    layec_use_set(&instruction->operands[operand_index], operand);
+    layec_instruction_note_change(instruction);
+}
+
+void layec_value_replace_all_uses_with(layec_value* value, layec_value* replacement) {
+    assert(value != NULL);
+    assert(replacement != NULL);
+    assert(value != replacement);
+
+    while (value->uses != NULL) {
+        layec_use* use = value->uses;
+        layec_use_set(use, replacement);
+        layec_instruction_note_change(use->user);
+    }
+}
+
+layec_value* layec_instruction_get_parent_block(layec_value* instruction) {
+    assert(instruction != NULL);
+    return instruction->parent_block;
+}
+
+layec_value* layec_instruction_clone(layec_value* instruction, layec_module* module) {
+    assert(instruction != NULL);
+    assert(instruction->parent_block != NULL);
+    assert(module != NULL);
+    assert(module->context == instruction->context);
+
+    layec_value* clone = layec_value_create(module, instruction->location, instruction->kind, instruction->type, SV_EMPTY);
+    assert(clone != NULL);
+
+    layec_module* clone_module = clone->module;
+    *clone = *instruction;
+    clone->module = clone_module;
+    clone->name = SV_EMPTY;
+    clone->index = -1;
+    clone->uses = NULL;
+    clone->parent_block = NULL;
+    clone->is_marked_for_removal = false;
+
+    // the clone needs its own uses of the operands, and its own copy of anything else the instruction owns.
+    clone->operands = clone->inline_operands;
+    clone->operand_count = 0;
+    clone->operand_capacity = sizeof clone->inline_operands / sizeof *clone->inline_operands;
+    for (int64_t i = 0, count = instruction->operand_count; i < count; i++) {
+        layec_instruction_add_operand(clone, instruction->operands[i].value);
+    }
+
+    if (instruction->kind == LAYEC_IR_PHI) {
+        clone->incoming_blocks = NULL;
+        for (int64_t i = 0, count = arr_count(instruction->incoming_blocks); i < count; i++) {
+            arr_push(clone->incoming_blocks, instruction->incoming_blocks[i]);
+        }
+    }
+
+    return clone;
+}
+
+void layec_instruction_remove_from_parent(layec_value* instruction) {
+    assert(instruction != NULL);
+    layec_value* block = instruction->parent_block;
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+
+    int64_t count = arr_count(block->block.instructions);
+    for (int64_t i = 0; i < count; i++) {
+        if (block->block.instructions[i] != instruction) {
+            continue;
+        }
+
+        for (int64_t j = i; j < count - 1; j++) {
+            block->block.instructions[j] = block->block.instructions[j + 1];
+        }
+
+        arr_set_count(block->block.instructions, count - 1);
+        instruction->parent_block = NULL;
+
+        assert(block->block.parent_function != NULL);
+        block->block.parent_function->function.has_stale_indices = true;
+        layec_function_note_change(block->block.parent_function, layec_value_is_terminating_instruction(instruction));
+        return;
+    }
+
+    assert(false && "instruction is not in its parent block");
+}
+
+void layec_instruction_erase(layec_value* instruction) {
+    assert(instruction != NULL);
+    assert(instruction->uses == NULL);
+    layec_instruction_remove_from_parent(instruction);
+    layec_instruction_drop_operands(instruction);
+}
+
+void layec_instruction_mark_for_removal(layec_value* instruction) {
+    assert(instruction != NULL);
+    assert(instruction->parent_block != NULL);
+    instruction->is_marked_for_removal = true;
+}
+
+bool layec_instruction_is_marked_for_removal(layec_value* instruction) {
+    assert(instruction != NULL);
+    return instruction->is_marked_for_removal;
+}
+
+void layec_function_remove_marked_instructions(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    for (int64_t b = 0, bcount = arr_count(function->function.blocks); b < bcount; b++) {
+        layec_value* block = function->function.blocks[b];
+        assert(block != NULL);
+
+        bool removed_terminator = false;
+        int64_t kept_count = 0;
+        for (int64_t i = 0, icount = arr_count(block->block.instructions); i < icount; i++) {
+            layec_value* instruction = block->block.instructions[i];
+            if (instruction->is_marked_for_removal) {
+                removed_terminator |= layec_value_is_terminating_instruction(instruction);
+                layec_instruction_drop_operands(instruction);
+                instruction->parent_block = NULL;
+                instruction->is_marked_for_removal = false;
+                continue;
+            }
+
+            block->block.instructions[kept_count] = instruction;
+            kept_count++;
+        }
+
+        if (kept_count != arr_count(block->block.instructions)) {
+            arr_set_count(block->block.instructions, kept_count);
+            function->function.has_stale_indices = true;
+            layec_function_note_change(function, removed_terminator);
+        }
+    }
+}
+
+void layec_block_mark_for_removal(layec_value* block) {
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+    assert(block->block.parent_function != NULL);
+    block->is_marked_for_removal = true;
+}
+
+bool layec_block_is_marked_for_removal(layec_value* block) {
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+    return block->is_marked_for_removal;
+}
+
+void layec_function_remove_marked_blocks(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    int64_t kept_count = 0;
+    for (int64_t b = 0, bcount = arr_count(function->function.blocks); b < bcount; b++) {
+        layec_value* block = function->function.blocks[b];
+        assert(block != NULL);
+
+        if (block->is_marked_for_removal) {
+            for (int64_t i = 0, icount = arr_count(block->block.instructions); i < icount; i++) {
+                layec_instruction_drop_operands(block->block.instructions[i]);
+            }
+
+            block->block.parent_function = NULL;
+            block->is_marked_for_removal = false;
+            continue;
+        }
+
+        // block indices are their position in the function, so they shift down with the removals.
+        block->block.index = kept_count;
+        function->function.blocks[kept_count] = block;
+        kept_count++;
+    }
+
+    if (kept_count != arr_count(function->function.blocks)) {
+        arr_set_count(function->function.blocks, kept_count);
+        function->function.has_stale_indices = true;
+        layec_function_note_change(function, true);
+    }
+}
+
+bool layec_function_remove_unreachable_blocks(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    int64_t block_count = arr_count(function->function.blocks);
+    if (block_count == 0) {
+        return false;
+    }
+
+    // everything starts out marked, and the marks are cleared on the way through from the entry block.
+    for (int64_t b = 0; b < block_count; b++) {
+        function->function.blocks[b]->is_marked_for_removal = true;
+    }
+
+    dynarr(layec_value*) worklist = NULL;
+    function->function.blocks[0]->is_marked_for_removal = false;
+    arr_push(worklist, function->function.blocks[0]);
+
+    int64_t reachable_count = 1;
+    while (arr_count(worklist) > 0) {
+        layec_value* block = *arr_back(worklist);
+        arr_pop(worklist);
+
+        for (int64_t s = 0, scount = layec_block_successor_count(block); s < scount; s++) {
+            layec_value* successor = layec_block_get_successor_at_index(block, s);
+            if (!successor->is_marked_for_removal) {
+                continue;
+            }
+
+            successor->is_marked_for_removal = false;
+            arr_push(worklist, successor);
+            reachable_count++;
+        }
+    }
+
+    arr_free(worklist);
+
+    if (reachable_count == block_count) {
+        return false;
+    }
+
+    for (int64_t b = 0; b < block_count; b++) {
+        layec_value* block = function->function.blocks[b];
+        if (block->is_marked_for_removal) {
+            continue;
+        }
+
+        for (int64_t i = 0, icount = arr_count(block->block.instructions); i < icount; i++) {
+            layec_value* instruction = block->block.instructions[i];
+
+            // phis only ever sit at the start of a block.
+            if (instruction->kind != LAYEC_IR_PHI) {
+                break;
+            }
+
+            for (int64_t p = arr_count(instruction->incoming_blocks) - 1; p >= 0; p--) {
+                if (instruction->incoming_blocks[p]->is_marked_for_removal) {
+                    layec_instruction_phi_remove_incoming_value_at_index(instruction, p);
+                }
+            }
+        }
+    }
+
+    // a reachable block can only use values from a block dominating it, which is reachable too,
+    // but be defensive about anything which got here through a phi we just dropped.
+    for (int64_t b = 0; b < block_count; b++) {
+        layec_value* block = function->function.blocks[b];
+        if (!block->is_marked_for_removal) {
+            continue;
+        }
+
+        for (int64_t i = 0, icount = arr_count(block->block.instructions); i < icount; i++) {
+            layec_value* instruction = block->block.instructions[i];
+            for (layec_use* use = instruction->uses, *next = NULL; use != NULL; use = next) {
+                next = use->next;
+                if (use->user->parent_block->is_marked_for_removal) {
+                    continue;
+                }
+
+                layec_value* poison = layec_poison_constant(function->context, instruction->location, instruction->type);
+                layec_use_set(use, poison);
+                layec_instruction_note_change(use->user);
+            }
+        }
+    }
+
+    layec_function_remove_marked_blocks(function);
+    return true;
+}
+
+int64_t layec_block_successor_count(layec_value* block) {
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+
+    if (!layec_block_is_terminated(block)) {
+        return 0;
+    }
+
+    switch ((*arr_back(block->block.instructions))->kind) {
+        default: return 0;
+        case LAYEC_IR_BRANCH: return 1;
+        case LAYEC_IR_COND_BRANCH: return 2;
+    }
+}
+
+layec_value* layec_block_get_successor_at_index(layec_value* block, int64_t successor_index) {
+    assert(block != NULL);
+    assert(successor_index >= 0);
+    assert(successor_index < layec_block_successor_count(block));
+
+    layec_value* terminator = *arr_back(block->block.instructions);
+    layec_value* successor = successor_index == 0 ? terminator->branch.pass : terminator->branch.fail;
+    assert(successor != NULL);
+    return successor;
+}
+
+void layec_block_set_successor_at_index(layec_value* block, int64_t successor_index, layec_value* successor) {
+    assert(block != NULL);
+    assert(successor_index >= 0);
+    assert(successor_index < layec_block_successor_count(block));
+    assert(successor != NULL);
+    assert(layec_value_is_block(successor));
+    assert(successor->block.parent_function == block->block.parent_function);
+
+    layec_value* terminator = *arr_back(block->block.instructions);
+    if (successor_index == 0) {
+        terminator->branch.pass = successor;
+    } else {
+        terminator->branch.fail = successor;
+    }
+
+    layec_function_note_change(block->block.parent_function, true);
+}
+
+layec_value* layec_block_split_before(layec_value* instruction) {
+    assert(instruction != NULL);
+    layec_value* block = instruction->parent_block;
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+    layec_value* function = block->block.parent_function;
+    assert(function != NULL);
+
+    int64_t split_index = layec_instruction_get_index_within_block(instruction);
+    assert(split_index >= 0);
+
+    layec_value* tail_block = layec_function_append_block(function, SV_EMPTY);
+    for (int64_t i = split_index, icount = arr_count(block->block.instructions); i < icount; i++) {
+        layec_value* moved_instruction = block->block.instructions[i];
+        moved_instruction->parent_block = tail_block;
+        arr_push(tail_block->block.instructions, moved_instruction);
+    }
+
+    arr_set_count(block->block.instructions, split_index);
+    function->function.has_stale_indices = true;
+    layec_function_note_change(function, true);
+
+    // the terminator moved, so the edges out of `block` now leave from `tail_block`.
+    for (int64_t s = 0, scount = layec_block_successor_count(tail_block); s < scount; s++) {
+        layec_value* successor = layec_block_get_successor_at_index(tail_block, s);
+        for (int64_t i = 0, icount = arr_count(successor->block.instructions); i < icount; i++) {
+            layec_value* phi = successor->block.instructions[i];
+            if (phi->kind != LAYEC_IR_PHI) {
+                break;
+            }
+
+            for (int64_t p = 0, pcount = arr_count(phi->incoming_blocks); p < pcount; p++) {
+                if (phi->incoming_blocks[p] == block) {
+                    phi->incoming_blocks[p] = tail_block;
+                }
+            }
+        }
+    }
+
+    return tail_block;
+}
+
+void layec_block_move_instructions_to_end(layec_value* block, layec_value* destination) {
+    assert(block != NULL);
+    assert(layec_value_is_block(block));
+    assert(destination != NULL);
+    assert(layec_value_is_block(destination));
+    assert(block != destination);
+    assert(!layec_block_is_terminated(destination));
+
+    for (int64_t i = 0, icount = arr_count(block->block.instructions); i < icount; i++) {
+        layec_value* instruction = block->block.instructions[i];
+        instruction->parent_block = destination;
+        arr_push(destination->block.instructions, instruction);
+    }
+
+    arr_set_count(block->block.instructions, 0);
+
+    assert(destination->block.parent_function != NULL);
+    destination->block.parent_function->function.has_stale_indices = true;
+    layec_function_note_change(destination->block.parent_function, true);
+}
+
 layec_value* layec_instruction_ptradd_get_address(layec_value* ptradd) {
     assert(ptradd != NULL);
     assert(ptradd->kind == LAYEC_IR_PTRADD);
-    assert(layec_type_is_ptr(ptradd->address->type));
-    return ptradd->address;
+    assert(layec_type_is_ptr(ptradd->operands[0].value->type));
+    return ptradd->operands[0].value;
 }
 
 layec_value* layec_instruction_ptradd_get_offset(layec_value* ptradd) {
     assert(ptradd != NULL);
     assert(ptradd->kind == LAYEC_IR_PTRADD);
-    assert(layec_type_is_integer(ptradd->operand->type));
-    return ptradd->operand;
+    assert(layec_type_is_integer(ptradd->operands[1].value->type));
+    return ptradd->operands[1].value;
 }
 
 int64_t layec_value_integer_constant(layec_value* value) {
@@ -871,21 +1645,10 @@ layec_type* layec_int_type(layec_context* context, int bit_width) {
     assert(bit_width > 0);
     assert(bit_width <= 65535);
 
-    for (int64_t i = 0, count = arr_count(context->types.int_types); i < count; i++) {
-        layec_type* int_type = context->types.int_types[i];
-        assert(int_type != NULL);
-        assert(layec_type_is_integer(int_type));
-
-        if (int_type->primitive_bit_width == bit_width) {
-            return int_type;
-        }
-    }
-
-    layec_type* int_type = layec_type_create(context, LAYEC_TYPE_INTEGER);
-    assert(int_type != NULL);
-    int_type->primitive_bit_width = bit_width;
-    arr_push(context->types.int_types, int_type);
-    return int_type;
+    return layec_type_get_unique(context, (layec_type){
+        .kind = LAYEC_TYPE_INTEGER,
+        .primitive_bit_width = bit_width,
+    });
 }
 
 static layec_type* layec_create_float_type(layec_context* context, int bit_width) {
@@ -928,11 +1691,13 @@ layec_type* layec_array_type(layec_context* context, int64_t length, layec_type*
     assert(length >= 0);
     assert(element_type != NULL);
 
-    layec_type* array_type = layec_type_create(context, LAYEC_TYPE_ARRAY);
-    assert(array_type != NULL);
-    array_type->array.element_type = element_type;
-    array_type->array.length = length;
-    return array_type;
+    return layec_type_get_unique(context, (layec_type){
+        .kind = LAYEC_TYPE_ARRAY,
+        .array = {
+            .element_type = element_type,
+            .length = length,
+        },
+    });
 }
 
 layec_type* layec_function_type(
@@ -949,14 +1714,17 @@ layec_type* layec_function_type(
     }
     assert(calling_convention != LAYEC_DEFAULTCC);
 
-    layec_type* function_type = layec_type_create(context, LAYEC_TYPE_FUNCTION);
-    assert(function_type != NULL);
-    function_type->function.return_type = return_type;
-    function_type->function.parameter_types = parameter_types;
-    function_type->function.calling_convention = calling_convention;
-    function_type->function.is_variadic = is_variadic;
-
-    return function_type;
+    // NOTE(local): the returned type owns `parameter_types` from here on, or frees it
+    // if an identical function type already exists.
+    return layec_type_get_unique(context, (layec_type){
+        .kind = LAYEC_TYPE_FUNCTION,
+        .function = {
+            .return_type = return_type,
+            .parameter_types = parameter_types,
+            .calling_convention = calling_convention,
+            .is_variadic = is_variadic,
+        },
+    });
 }
 
 layec_type* layec_struct_type(layec_context* context, string_view name, dynarr(layec_struct_member) members) {
@@ -966,6 +1734,8 @@ layec_type* layec_struct_type(layec_context* context, string_view name, dynarr(l
         assert(members[i].type != NULL);
     }
 
+    // NOTE(local): named struct types are nominal, so they are not uniqued structurally;
+    // callers cache them per declaration instead.
     layec_type* struct_type = layec_type_create(context, LAYEC_TYPE_STRUCT);
     assert(struct_type != NULL);
     // TODO(local): unnamed struct types
@@ -1107,15 +1877,6 @@ bool layec_function_type_is_variadic(layec_type* function_type) {
     return function_type->function.is_variadic;
 }
 
-void layec_function_type_set_parameter_type_at_index(layec_type* function_type, int64_t parameter_index, layec_type* param_type) {
-    assert(function_type != NULL);
-    assert(layec_type_is_function(function_type));
-    assert(parameter_index >= 0);
-    assert(parameter_index < arr_count(function_type->function.parameter_types));
-    assert(param_type != NULL);
-    function_type->function.parameter_types[parameter_index] = param_type;
-}
-
 static layec_value* layec_value_create_in_context(layec_context* context, layec_location location, layec_value_kind kind, layec_type* type, string_view name) {
     assert(context != NULL);
     assert(type != NULL);
@@ -1208,6 +1969,7 @@ void layec_value_set_type(layec_value* value, layec_type* type) {
     assert(value != NULL);
     assert(type != NULL);
     value->type = type;
+    layec_instruction_note_change(value);
 }
 
 layec_value* layec_module_create_function(layec_module* module, layec_location location, string_view function_name, layec_type* function_type, dynarr(layec_value*) parameters, layec_linkage linkage) {
@@ -1237,6 +1999,7 @@ layec_value* layec_function_append_block(layec_value* function, string_view name
     block->block.parent_function = function;
     block->block.index = arr_count(function->function.blocks);
     arr_push(function->function.blocks, block);
+    layec_function_note_change(function, true);
     return block;
 }
 
@@ -1253,6 +2016,15 @@ layec_value* layec_void_constant(layec_context* context) {
     return context->values._void;
 }
 
+layec_value* layec_poison_constant(layec_context* context, layec_location location, layec_type* type) {
+    assert(context != NULL);
+    assert(type != NULL);
+
+    layec_value* poison_value = layec_value_create_in_context(context, location, LAYEC_IR_POISON, type, SV_EMPTY);
+    assert(poison_value != NULL);
+    return poison_value;
+}
+
 layec_value* layec_int_constant(layec_context* context, layec_location location, layec_type* type, int64_t value) {
     assert(context != NULL);
     assert(type != NULL);
@@ -1413,15 +2185,14 @@ layec_value* layec_builder_get_insert_block(layec_builder* builder) {
     return builder->block;
 }
 
-static void layec_builder_recalculate_instruction_indices(layec_builder* builder) {
-    assert(builder != NULL);
-    assert(builder->function != NULL);
-    assert(layec_value_is_function(builder->function));
+static void layec_function_calculate_instruction_indices(layec_value* function) {
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
 
-    int64_t instruction_index = layec_function_type_parameter_count(builder->function->type);
+    int64_t instruction_index = layec_function_type_parameter_count(function->type);
 
-    for (int64_t b = 0, bcount = arr_count(builder->function->function.blocks); b < bcount; b++) {
-        layec_value* block = builder->function->function.blocks[b];
+    for (int64_t b = 0, bcount = arr_count(function->function.blocks); b < bcount; b++) {
+        layec_value* block = function->function.blocks[b];
         assert(block != NULL);
         assert(layec_value_is_block(block));
 
@@ -1439,6 +2210,8 @@ static void layec_builder_recalculate_instruction_indices(layec_builder* builder
             instruction_index++;
         }
     }
+
+    function->function.has_stale_indices = false;
 }
 
 void layec_builder_insert(layec_builder* builder, layec_value* instruction) {
@@ -1459,16 +2232,19 @@ void layec_builder_insert(layec_builder* builder, layec_value* instruction) {
     arr_push(block->block.instructions, NULL);
 
     // move everything over if necessary
-    for (int64_t i = insert_index, count = arr_count(block->block.instructions) - 1; i < count; i++) {
-        block->block.instructions[i + 1] = block->block.instructions[i];
+    int64_t move_count = arr_count(block->block.instructions) - 1 - insert_index;
+    if (move_count > 0) {
+        memmove(&block->block.instructions[insert_index + 1], &block->block.instructions[insert_index], (size_t)move_count * sizeof *block->block.instructions);
     }
 
     block->block.instructions[insert_index] = instruction;
     builder->insert_index++;
 
+    // NOTE(local): indices are calculated lazily, since doing it for every insert is quadratic in the size of the function.
     instruction->index = -1;
-    layec_builder_recalculate_instruction_indices(builder);
-    assert(instruction->index >= 0);
+    assert(block->block.parent_function != NULL);
+    block->block.parent_function->function.has_stale_indices = true;
+    layec_function_note_change(block->block.parent_function, layec_value_is_terminating_instruction(instruction));
 }
 
 void layec_builder_insert_with_name(layec_builder* builder, layec_value* instruction, string_view name) {
@@ -1526,9 +2302,15 @@ layec_value* layec_build_call(layec_builder* builder, layec_location location, l
 
     layec_value* call = layec_value_create(builder->function->module, location, LAYEC_IR_CALL, result_type, name);
     assert(call != NULL);
-    call->call.callee = callee;
     call->call.callee_type = callee_type;
-    call->call.arguments = arguments;
+    layec_instruction_reserve_operands(call, 1 + arr_count(arguments));
+    layec_instruction_add_operand(call, callee);
+    for (int64_t i = 0, count = arr_count(arguments); i < count; i++) {
+        layec_instruction_add_operand(call, arguments[i]);
+    }
+
+    // the call takes ownership of the argument list, but only needed its contents.
+    arr_free(arguments);
     call->call.calling_convention = callee_type->function.calling_convention;
     call->call.is_tail_call = false;
 
@@ -1546,7 +2328,7 @@ layec_value* layec_build_return(layec_builder* builder, layec_location location,
 
     layec_value* ret = layec_value_create(builder->function->module, location, LAYEC_IR_RETURN, layec_void_type(builder->context), SV_EMPTY);
     assert(ret != NULL);
-    ret->return_value = value;
+    layec_instruction_add_operand(ret, value);
 
     layec_builder_insert(builder, ret);
     return ret;
@@ -1609,8 +2391,8 @@ layec_value* layec_build_store(layec_builder* builder, layec_location location,
 
     layec_value* store = layec_value_create(builder->function->module, location, LAYEC_IR_STORE, layec_void_type(builder->context), SV_EMPTY);
     assert(store != NULL);
-    store->address = address;
-    store->operand = value;
+    layec_instruction_add_operand(store, address);
+    layec_instruction_add_operand(store, value);
 
     layec_builder_insert(builder, store);
     return store;
@@ -1628,7 +2410,7 @@ layec_value* layec_build_load(layec_builder* builder, layec_location location, l
 
     layec_value* load = layec_value_create(builder->function->module, location, LAYEC_IR_LOAD, type, SV_EMPTY);
     assert(load != NULL);
-    load->address = address;
+    layec_instruction_add_operand(load, address);
 
     layec_builder_insert(builder, load);
     return load;
@@ -1667,7 +2449,7 @@ layec_value* layec_build_branch_conditional(layec_builder* builder, layec_locati
 
     layec_value* branch = layec_value_create(builder->function->module, location, LAYEC_IR_COND_BRANCH, layec_void_type(builder->context), SV_EMPTY);
     assert(branch != NULL);
-    branch->value = condition;
+    layec_instruction_add_operand(branch, condition);
     branch->branch.pass = pass_block;
     branch->branch.fail = fail_block;
 
@@ -1699,9 +2481,16 @@ layec_value* layec_build_unary(layec_builder* builder, layec_location location,
     assert(operand != NULL);
     assert(type != NULL);
 
+    if (builder->context->optimization_level >= 1) {
+        layec_value* simplified = layec_simplify_unary(builder->context, location, kind, operand, type);
+        if (simplified != NULL) {
+            return simplified;
+        }
+    }
+
     layec_value* unary = layec_value_create(builder->function->module, location, kind, type, SV_EMPTY);
     assert(unary != NULL);
-    unary->operand = operand;
+    layec_instruction_add_operand(unary, operand);
 
     layec_builder_insert(builder, unary);
     return unary;
@@ -1735,10 +2524,17 @@ static layec_value* layec_build_binary(layec_builder* builder, layec_location lo
     layec_type* rhs_type = layec_value_get_type(rhs);
     assert(lhs_type == rhs_type); // primitive types should be reference equal if done correctly
 
+    if (builder->context->optimization_level >= 1) {
+        layec_value* simplified = layec_simplify_binary(builder->context, location, kind, lhs, rhs, type);
+        if (simplified != NULL) {
+            return simplified;
+        }
+    }
+
     layec_value* cmp = layec_value_create(builder->function->module, location, kind, type, SV_EMPTY);
     assert(cmp != NULL);
-    cmp->binary.lhs = lhs;
-    cmp->binary.rhs = rhs;
+    layec_instruction_add_operand(cmp, lhs);
+    layec_instruction_add_operand(cmp, rhs);
 
     layec_builder_insert(builder, cmp);
     return cmp;
@@ -1970,18 +2766,18 @@ static layec_value* layec_build_builtin(layec_builder* builder, layec_location l
 layec_value* layec_build_builtin_memset(layec_builder* builder, layec_location location, layec_value* address, layec_value* value, layec_value* count) {
     layec_value* builtin = layec_build_builtin(builder, location, LAYEC_BUILTIN_MEMSET);
     assert(builtin != NULL);
-    arr_push(builtin->builtin.arguments, address);
-    arr_push(builtin->builtin.arguments, value);
-    arr_push(builtin->builtin.arguments, count);
+    layec_instruction_add_operand(builtin, address);
+    layec_instruction_add_operand(builtin, value);
+    layec_instruction_add_operand(builtin, count);
     return builtin;
 }
 
 layec_value* layec_build_builtin_memcpy(layec_builder* builder, layec_location location, layec_value* source_address, layec_value* dest_address, layec_value* count) {
     layec_value* builtin = layec_build_builtin(builder, location, LAYEC_BUILTIN_MEMSET);
     assert(builtin != NULL);
-    arr_push(builtin->builtin.arguments, source_address);
-    arr_push(builtin->builtin.arguments, dest_address);
-    arr_push(builtin->builtin.arguments, count);
+    layec_instruction_add_operand(builtin, source_address);
+    layec_instruction_add_operand(builtin, dest_address);
+    layec_instruction_add_operand(builtin, count);
     return builtin;
 }
 
@@ -1998,8 +2794,8 @@ layec_value* layec_build_ptradd(layec_builder* builder, layec_location location,
 
     layec_value* ptradd = layec_value_create(builder->function->module, location, LAYEC_IR_PTRADD, layec_ptr_type(builder->context), SV_EMPTY);
     assert(ptradd != NULL);
-    ptradd->address = address;
-    ptradd->operand = offset_value;
+    layec_instruction_add_operand(ptradd, address);
+    layec_instruction_add_operand(ptradd, offset_value);
 
     layec_builder_insert(builder, ptradd);
     return ptradd;
@@ -2016,57 +2812,68 @@ layec_value* layec_build_ptradd(layec_builder* builder, layec_location location,
 typedef struct layec_print_context {
     layec_context* context;
     bool use_color;
-    string* output;
+    lca_writer* output;
 } layec_print_context;
 
 static void layec_global_print(layec_print_context* print_context, layec_value* global);
 static void layec_function_print(layec_print_context* print_context, layec_value* function);
-static void layec_type_print_struct_type_to_string_literally(layec_type* type, string* s, bool use_color);
+static void layec_type_print_struct_type_to_writer_literally(layec_type* type, lca_writer* w, bool use_color);
 
 string layec_module_print(layec_module* module, bool use_color) {
     assert(module != NULL);
     assert(module->context != NULL);
 
-    string output_string = string_create(module->context->allocator);
+    lca_writer output_writer = lca_writer_create(module->context->allocator);
+    layec_module_print_to_writer(module, &output_writer, use_color);
+    return lca_writer_to_string(&output_writer);
+}
+
+void layec_module_print_to_writer(layec_module* module, lca_writer* output, bool use_color) {
+    assert(module != NULL);
+    assert(module->context != NULL);
+    assert(output != NULL);
 
     layec_print_context print_context = {
         .context = module->context,
         .use_color = use_color,
-        .output = &output_string,
+        .output = output,
     };
 
     // bool use_color = print_context.use_color;
 
-    lca_string_append_format(
-        print_context.output,
-        "%s; LayeC IR Module: %.*s%s\n",
-        COL(COL_COMMENT),
-        STR_EXPAND(module->name),
-        COL(RESET)
-    );
+    lca_writer_append_cstring(print_context.output, COL(COL_COMMENT));
+    LCA_WRITER_APPEND_LITERAL(print_context.output, "; LayeC IR Module: ");
+    lca_writer_append_view(print_context.output, module->name);
+    lca_writer_append_cstring(print_context.output, COL(RESET));
+    lca_writer_append_char(print_context.output, '\n');
 
     for (int64_t i = 0; i < layec_context_get_struct_type_count(module->context); i++) {
         layec_type* struct_type = layec_context_get_struct_type_at_index(module->context, i);
         if (layec_type_struct_is_named(struct_type)) {
-            lca_string_append_format(print_context.output, "%sdefine %s%.*s %s= ", COL(COL_KEYWORD), COL(COL_NAME), STR_EXPAND(layec_type_struct_name(struct_type)), COL(RESET));
-            layec_type_print_struct_type_to_string_literally(struct_type, print_context.output, use_color);
-            lca_string_append_format(print_context.output, "%s\n", COL(RESET));
+            lca_writer_append_cstring(print_context.output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context.output, "define ");
+            lca_writer_append_cstring(print_context.output, COL(COL_NAME));
+            lca_writer_append_view(print_context.output, layec_type_struct_name(struct_type));
+            lca_writer_append_char(print_context.output, ' ');
+            lca_writer_append_cstring(print_context.output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context.output, "= ");
+            layec_type_print_struct_type_to_writer_literally(struct_type, print_context.output, use_color);
+            lca_writer_append_cstring(print_context.output, COL(RESET));
+            lca_writer_append_char(print_context.output, '\n');
         }
     }
 
     for (int64_t i = 0, count = arr_count(module->globals); i < count; i++) {
-        if (i > 0) lca_string_append_format(print_context.output, "\n");
+        if (i > 0) lca_writer_append_char(print_context.output, '\n');
         layec_global_print(&print_context, module->globals[i]);
     }
 
-    if (arr_count(module->globals) > 0) lca_string_append_format(print_context.output, "\n");
+    if (arr_count(module->globals) > 0) lca_writer_append_char(print_context.output, '\n');
 
     for (int64_t i = 0, count = arr_count(module->functions); i < count; i++) {
-        if (i > 0) lca_string_append_format(print_context.output, "\n");
+        if (i > 0) lca_writer_append_char(print_context.output, '\n');
         layec_function_print(&print_context, module->functions[i]);
     }
-
-    return output_string;
 }
 
 static const char* ir_calling_convention_to_cstring(layec_calling_convention calling_convention) {
@@ -2092,23 +2899,21 @@ static void layec_instruction_print_name_if_required(layec_print_context* print_
     }
 
     if (instruction->name.count == 0) {
-        lca_string_append_format(
-            print_context->output,
-            "%s%%%lld %s= %s",
-            COL(COL_NAME),
-            instruction->index,
-            COL(COL_DELIM),
-            COL(RESET)
-        );
+        lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+        lca_writer_append_char(print_context->output, '%');
+        lca_writer_append_int(print_context->output, layec_value_index(instruction));
+        lca_writer_append_char(print_context->output, ' ');
+        lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "= ");
+        lca_writer_append_cstring(print_context->output, COL(RESET));
     } else {
-        lca_string_append_format(
-            print_context->output,
-            "%s%%%.*s %s= %s",
-            COL(COL_NAME),
-            STR_EXPAND(instruction->name),
-            COL(COL_DELIM),
-            COL(RESET)
-        );
+        lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+        lca_writer_append_char(print_context->output, '%');
+        lca_writer_append_view(print_context->output, instruction->name);
+        lca_writer_append_char(print_context->output, ' ');
+        lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "= ");
+        lca_writer_append_cstring(print_context->output, COL(RESET));
     }
 }
 
@@ -2119,7 +2924,7 @@ static void layec_instruction_print(layec_print_context* print_context, layec_va
 
     bool use_color = print_context->use_color;
 
-    lca_string_append_format(print_context->output, "  ");
+    LCA_WRITER_APPEND_LITERAL(print_context->output, "  ");
     layec_instruction_print_name_if_required(print_context, instruction);
 
     switch (instruction->kind) {
@@ -2129,88 +2934,117 @@ static void layec_instruction_print(layec_print_context* print_context, layec_va
         } break;
 
         case LAYEC_IR_NOP: {
-            lca_string_append_format(print_context->output, "%snop", COL(COL_KEYWORD));
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "nop");
         } break;
 
         case LAYEC_IR_ALLOCA: {
-            lca_string_append_format(print_context->output, "%salloca ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->alloca.element_type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "alloca ");
+            layec_type_print_to_writer(instruction->alloca.element_type, print_context->output, use_color);
             if (instruction->alloca.element_count != 1) {
-                lca_string_append_format(print_context->output, "%s, %s%lld", COL(COL_DELIM), COL(COL_CONSTANT), instruction->alloca.element_count);
+                lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+                lca_writer_append_cstring(print_context->output, COL(COL_CONSTANT));
+                lca_writer_append_int(print_context->output, instruction->alloca.element_count);
             }
         } break;
 
         case LAYEC_IR_STORE: {
-            lca_string_append_format(print_context->output, "%sstore ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->address, print_context->output, false, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "store ");
+            layec_value_print_to_writer(layec_instruction_get_address(instruction), print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_LOAD: {
-            lca_string_append_format(print_context->output, "%sload ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->address, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "load ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_address(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_BRANCH: {
-            lca_string_append_format(print_context->output, "%sbranch ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->branch.pass, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "branch ");
+            layec_value_print_to_writer(instruction->branch.pass, print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_COND_BRANCH: {
-            lca_string_append_format(print_context->output, "%sbranch ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->value, print_context->output, false, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->branch.pass, print_context->output, false, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->branch.fail, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "branch ");
+            layec_value_print_to_writer(layec_instruction_get_value(instruction), print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(instruction->branch.pass, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(instruction->branch.fail, print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_PHI: {
-            lca_string_append_format(print_context->output, "%sphi ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "phi ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
 
             for (int64_t i = 0, count = layec_instruction_phi_incoming_value_count(instruction); i < count; i++) {
-                if (i > 0) lca_string_append_format(print_context->output, "%s,", COL(RESET));
-                lca_string_append_format(print_context->output, "%s [ ", COL(RESET));
-                layec_value_print_to_string(layec_instruction_phi_incoming_value_at_index(instruction, i), print_context->output, false, use_color);
-                lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-                layec_value_print_to_string(layec_instruction_phi_incoming_block_at_index(instruction, i), print_context->output, false, use_color);
-                lca_string_append_format(print_context->output, "%s ]", COL(RESET));
+                if (i > 0) {
+                    lca_writer_append_cstring(print_context->output, COL(RESET));
+                    lca_writer_append_char(print_context->output, ',');
+                }
+                lca_writer_append_cstring(print_context->output, COL(RESET));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, " [ ");
+                layec_value_print_to_writer(layec_instruction_phi_incoming_value_at_index(instruction, i), print_context->output, false, use_color);
+                lca_writer_append_cstring(print_context->output, COL(RESET));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+                layec_value_print_to_writer(layec_instruction_phi_incoming_block_at_index(instruction, i), print_context->output, false, use_color);
+                lca_writer_append_cstring(print_context->output, COL(RESET));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, " ]");
             }
         } break;
 
         case LAYEC_IR_RETURN: {
-            lca_string_append_format(print_context->output, "%sreturn", COL(COL_KEYWORD));
-            if (instruction->return_value != NULL) {
-                lca_string_append_format(print_context->output, " ", COL(COL_KEYWORD));
-                layec_value_print_to_string(instruction->return_value, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "return");
+            if (layec_instruction_return_has_value(instruction)) {
+                lca_writer_append_char(print_context->output, ' ');
+                layec_value_print_to_writer(layec_instruction_return_value(instruction), print_context->output, true, use_color);
             }
         } break;
 
         case LAYEC_IR_UNREACHABLE: {
-            lca_string_append_format(print_context->output, "%sunreachable", COL(COL_KEYWORD));
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "unreachable");
         } break;
 
         case LAYEC_IR_CALL: {
-            lca_string_append_format(print_context->output, "%s%scall %s ", COL(COL_KEYWORD), (instruction->call.is_tail_call ? "tail " : ""), ir_calling_convention_to_cstring(instruction->call.calling_convention));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, " ");
-            layec_value_print_to_string(instruction->call.callee, print_context->output, false, use_color);
-            lca_string_append_format(print_context->output, "%s(", COL(COL_DELIM));
-
-            for (int64_t i = 0, count = arr_count(instruction->call.arguments); i < count; i++) {
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            lca_writer_append_cstring(print_context->output, (instruction->call.is_tail_call ? "tail " : ""));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "call ");
+            lca_writer_append_cstring(print_context->output, ir_calling_convention_to_cstring(instruction->call.calling_convention));
+            lca_writer_append_char(print_context->output, ' ');
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_char(print_context->output, ' ');
+            layec_value_print_to_writer(layec_instruction_callee(instruction), print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+            lca_writer_append_char(print_context->output, '(');
+
+            for (int64_t i = 0, count = layec_instruction_call_argument_count(instruction); i < count; i++) {
                 if (i > 0) {
-                    lca_string_append_format(print_context->output, "%s, ", COL(COL_DELIM));
+                    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+                    LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
                 }
 
-                layec_value* argument = instruction->call.arguments[i];
-                layec_value_print_to_string(argument, print_context->output, true, use_color);
+                layec_value* argument = layec_instruction_call_get_argument_at_index(instruction, i);
+                layec_value_print_to_writer(argument, print_context->output, true, use_color);
             }
 
-            lca_string_append_format(print_context->output, "%s)", COL(COL_DELIM));
+            lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+            lca_writer_append_char(print_context->output, ')');
         } break;
 
         case LAYEC_IR_BUILTIN: {
@@ -2221,383 +3055,493 @@ static void layec_instruction_print(layec_print_context* print_context, layec_va
                 case LAYEC_BUILTIN_MEMCOPY: builtin_name = "memcopy"; break;
             }
 
-            lca_string_append_format(print_context->output, "%sbuiltin ", COL(COL_KEYWORD));
-            lca_string_append_format(print_context->output, "%s@%s%s(", COL(COL_NAME), builtin_name, COL(COL_DELIM));
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "builtin ");
+            lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+            lca_writer_append_char(print_context->output, '@');
+            lca_writer_append_cstring(print_context->output, builtin_name);
+            lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+            lca_writer_append_char(print_context->output, '(');
 
-            for (int64_t i = 0, count = arr_count(instruction->builtin.arguments); i < count; i++) {
+            for (int64_t i = 0, count = layec_instruction_builtin_argument_count(instruction); i < count; i++) {
                 if (i > 0) {
-                    lca_string_append_format(print_context->output, "%s, ", COL(COL_DELIM));
+                    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+                    LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
                 }
 
-                layec_value* argument = instruction->builtin.arguments[i];
-                layec_value_print_to_string(argument, print_context->output, true, use_color);
+                layec_value* argument = layec_instruction_builtin_get_argument_at_index(instruction, i);
+                layec_value_print_to_writer(argument, print_context->output, true, use_color);
             }
 
-            lca_string_append_format(print_context->output, "%s)", COL(COL_DELIM));
+            lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+            lca_writer_append_char(print_context->output, ')');
         } break;
 
         case LAYEC_IR_BITCAST: {
-            lca_string_append_format(print_context->output, "%sbitcast ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "bitcast ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_SEXT: {
-            lca_string_append_format(print_context->output, "%ssext ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "sext ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_ZEXT: {
-            lca_string_append_format(print_context->output, "%szext ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "zext ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_TRUNC: {
-            lca_string_append_format(print_context->output, "%strunc ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "trunc ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_FPEXT: {
-            lca_string_append_format(print_context->output, "%sfpext ", COL(COL_KEYWORD));
-            layec_type_print_to_string(instruction->type, print_context->output, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fpext ");
+            layec_type_print_to_writer(instruction->type, print_context->output, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_NEG: {
-            lca_string_append_format(print_context->output, "%sneg ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "neg ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_COMPL: {
-            lca_string_append_format(print_context->output, "%scompl ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "compl ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
 
         case LAYEC_IR_ADD: {
-            lca_string_append_format(print_context->output, "%sadd ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "add ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FADD: {
-            lca_string_append_format(print_context->output, "%sfadd ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fadd ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SUB: {
-            lca_string_append_format(print_context->output, "%ssub ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "sub ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FSUB: {
-            lca_string_append_format(print_context->output, "%sfsub ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fsub ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_MUL: {
-            lca_string_append_format(print_context->output, "%smul ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "mul ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FMUL: {
-            lca_string_append_format(print_context->output, "%sfmul ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fmul ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SDIV: {
-            lca_string_append_format(print_context->output, "%ssdiv ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "sdiv ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_UDIV: {
-            lca_string_append_format(print_context->output, "%sudiv ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "udiv ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FDIV: {
-            lca_string_append_format(print_context->output, "%sfdiv ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fdiv ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SMOD: {
-            lca_string_append_format(print_context->output, "%ssmod ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "smod ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_UMOD: {
-            lca_string_append_format(print_context->output, "%sumod ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "umod ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FMOD: {
-            lca_string_append_format(print_context->output, "%sfmod ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fmod ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_AND: {
-            lca_string_append_format(print_context->output, "%sand ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "and ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_OR: {
-            lca_string_append_format(print_context->output, "%sor ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "or ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_XOR: {
-            lca_string_append_format(print_context->output, "%sxor ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "xor ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SHL: {
-            lca_string_append_format(print_context->output, "%sshl ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "shl ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SHR: {
-            lca_string_append_format(print_context->output, "%sshr ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "shr ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_SAR: {
-            lca_string_append_format(print_context->output, "%ssar ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "sar ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_EQ: {
-            lca_string_append_format(print_context->output, "%sicmp eq ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp eq ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_NE: {
-            lca_string_append_format(print_context->output, "%sicmp ne ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp ne ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_SLT: {
-            lca_string_append_format(print_context->output, "%sicmp slt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp slt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_ULT: {
-            lca_string_append_format(print_context->output, "%sicmp ult ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp ult ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_SLE: {
-            lca_string_append_format(print_context->output, "%sicmp sle ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp sle ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_ULE: {
-            lca_string_append_format(print_context->output, "%sicmp ule ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp ule ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_SGT: {
-            lca_string_append_format(print_context->output, "%sicmp sgt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp sgt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_UGT: {
-            lca_string_append_format(print_context->output, "%sicmp ugt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp ugt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_SGE: {
-            lca_string_append_format(print_context->output, "%sicmp sge ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp sge ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_ICMP_UGE: {
-            lca_string_append_format(print_context->output, "%sicmp uge ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "icmp uge ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_FALSE: {
-            lca_string_append_format(print_context->output, "%sfcmp false ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp false ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_OEQ: {
-            lca_string_append_format(print_context->output, "%sfcmp oeq ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp oeq ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_OGT: {
-            lca_string_append_format(print_context->output, "%sfcmp ogt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ogt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_OGE: {
-            lca_string_append_format(print_context->output, "%sfcmp oge ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp oge ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_OLT: {
-            lca_string_append_format(print_context->output, "%sfcmp olt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp olt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_OLE: {
-            lca_string_append_format(print_context->output, "%sfcmp ole ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ole ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_ONE: {
-            lca_string_append_format(print_context->output, "%sfcmp one ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp one ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_ORD: {
-            lca_string_append_format(print_context->output, "%sfcmp ord ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ord ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_UEQ: {
-            lca_string_append_format(print_context->output, "%sfcmp ueq ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ueq ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_UGT: {
-            lca_string_append_format(print_context->output, "%sfcmp ugt ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ugt ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_UGE: {
-            lca_string_append_format(print_context->output, "%sfcmp uge ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp uge ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_ULT: {
-            lca_string_append_format(print_context->output, "%sfcmp ult ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ult ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_ULE: {
-            lca_string_append_format(print_context->output, "%sfcmp ule ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp ule ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_UNE: {
-            lca_string_append_format(print_context->output, "%sfcmp une ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp une ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_UNO: {
-            lca_string_append_format(print_context->output, "%sfcmp uno ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp uno ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_FCMP_TRUE: {
-            lca_string_append_format(print_context->output, "%sfcmp true ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->binary.lhs, print_context->output, true, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->binary.rhs, print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "fcmp true ");
+            layec_value_print_to_writer(layec_instruction_binary_get_lhs(instruction), print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_binary_get_rhs(instruction), print_context->output, false, use_color);
         } break;
 
         case LAYEC_IR_PTRADD: {
-            lca_string_append_format(print_context->output, "%sptradd ptr ", COL(COL_KEYWORD));
-            layec_value_print_to_string(instruction->address, print_context->output, false, use_color);
-            lca_string_append_format(print_context->output, "%s, ", COL(RESET));
-            layec_value_print_to_string(instruction->operand, print_context->output, true, use_color);
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "ptradd ptr ");
+            layec_value_print_to_writer(layec_instruction_get_address(instruction), print_context->output, false, use_color);
+            lca_writer_append_cstring(print_context->output, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+            layec_value_print_to_writer(layec_instruction_get_operand(instruction), print_context->output, true, use_color);
         } break;
     }
 
-    lca_string_append_format(print_context->output, "%s\n", COL(RESET));
+    lca_writer_append_cstring(print_context->output, COL(RESET));
+    lca_writer_append_char(print_context->output, '\n');
 }
 
 static void layec_print_linkage(layec_print_context* print_context, layec_linkage linkage) {
@@ -2610,11 +3554,13 @@ static void layec_print_linkage(layec_print_context* print_context, layec_linkag
         default: break;
 
         case LAYEC_LINK_EXPORTED: {
-            lca_string_append_format(print_context->output, "%sexported ", COL(COL_KEYWORD));
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "exported ");
         } break;
 
         case LAYEC_LINK_REEXPORTED: {
-            lca_string_append_format(print_context->output, "%sreexported ", COL(COL_KEYWORD));
+            lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, "reexported ");
         } break;
     }
 }
@@ -2630,19 +3576,26 @@ static void layec_global_print(layec_print_context* print_context, layec_value*
 
     bool use_color = print_context->use_color;
 
-    lca_string_append_format(print_context->output, "%sdefine ", COL(COL_KEYWORD));
+    lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+    LCA_WRITER_APPEND_LITERAL(print_context->output, "define ");
     layec_print_linkage(print_context, global->linkage);
 
     if (global->name.count == 0) {
-        lca_string_append_format(print_context->output, "%sglobal.%lld", COL(COL_NAME), global->index);
+        lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "global.");
+        lca_writer_append_int(print_context->output, global->index);
     } else {
-        lca_string_append_format(print_context->output, "%s%.*s", COL(COL_NAME), STR_EXPAND(global->name));
+        lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+        lca_writer_append_view(print_context->output, global->name);
     }
 
-    lca_string_append_format(print_context->output, " %s= ", COL(COL_DELIM));
-    layec_value_print_to_string(global->value, print_context->output, true, use_color);
+    lca_writer_append_char(print_context->output, ' ');
+    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+    LCA_WRITER_APPEND_LITERAL(print_context->output, "= ");
+    layec_value_print_to_writer(global->value, print_context->output, true, use_color);
 
-    lca_string_append_format(print_context->output, "%s\n", COL(RESET));
+    lca_writer_append_cstring(print_context->output, COL(RESET));
+    lca_writer_append_char(print_context->output, '\n');
 }
 
 static void layec_function_print(layec_print_context* print_context, layec_value* function) {
@@ -2662,42 +3615,55 @@ static void layec_function_print(layec_print_context* print_context, layec_value
     bool use_color = print_context->use_color;
     bool is_declare = arr_count(function->function.blocks) == 0;
 
-    lca_string_append_format(print_context->output, "%s%s ", COL(COL_KEYWORD), is_declare ? "declare" : "define");
+    lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+    lca_writer_append_cstring(print_context->output, is_declare ? "declare" : "define");
+    lca_writer_append_char(print_context->output, ' ');
     layec_print_linkage(print_context, function->linkage);
 
-    lca_string_append_format(
-        print_context->output,
-        "%s %s%.*s%s(",
-        ir_calling_convention_to_cstring(function->type->function.calling_convention),
-        COL(COL_NAME),
-        STR_EXPAND(function->function.name),
-        COL(COL_DELIM)
-    );
+    if (function->function.is_inline) {
+        lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "inline ");
+    }
+
+    lca_writer_append_cstring(print_context->output, ir_calling_convention_to_cstring(function->type->function.calling_convention));
+    lca_writer_append_char(print_context->output, ' ');
+    lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+    lca_writer_append_view(print_context->output, function->function.name);
+    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+    lca_writer_append_char(print_context->output, '(');
 
     for (int64_t i = 0, count = arr_count(parameter_types); i < count; i++) {
-        if (i > 0) lca_string_append_format(print_context->output, "%s, ", COL(COL_DELIM));
-        layec_type_print_to_string(parameter_types[i], print_context->output, use_color);
-        lca_string_append_format(print_context->output, " %s%%%lld", COL(COL_NAME), i);
+        if (i > 0) {
+            lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+            LCA_WRITER_APPEND_LITERAL(print_context->output, ", ");
+        }
+        layec_type_print_to_writer(parameter_types[i], print_context->output, use_color);
+        lca_writer_append_char(print_context->output, ' ');
+        lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+        lca_writer_append_char(print_context->output, '%');
+        lca_writer_append_int(print_context->output, i);
     }
 
-    lca_string_append_format(print_context->output, "%s)", COL(COL_DELIM));
+    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+    lca_writer_append_char(print_context->output, ')');
 
     if (function_type->function.is_variadic) {
-        lca_string_append_format(print_context->output, " %svariadic", COL(COL_KEYWORD));
+        lca_writer_append_char(print_context->output, ' ');
+        lca_writer_append_cstring(print_context->output, COL(COL_KEYWORD));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "variadic");
     }
 
     if (!layec_type_is_void(return_type)) {
-        lca_string_append_format(print_context->output, " %s-> ", COL(COL_DELIM));
-        layec_type_print_to_string(return_type, print_context->output, use_color);
+        lca_writer_append_char(print_context->output, ' ');
+        lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+        LCA_WRITER_APPEND_LITERAL(print_context->output, "-> ");
+        layec_type_print_to_writer(return_type, print_context->output, use_color);
     }
 
-    lca_string_append_format(
-        print_context->output,
-        "%s%s%s\n",
-        COL(COL_DELIM),
-        is_declare ? "" : " {",
-        COL(RESET)
-    );
+    lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+    lca_writer_append_cstring(print_context->output, is_declare ? "" : " {");
+    lca_writer_append_cstring(print_context->output, COL(RESET));
+    lca_writer_append_char(print_context->output, '\n');
 
     if (!is_declare) {
         for (int64_t i = 0, count = arr_count(function->function.blocks); i < count; i++) {
@@ -2706,9 +3672,16 @@ static void layec_function_print(layec_print_context* print_context, layec_value
             assert(layec_value_is_block(block));
 
             if (block->block.name.count == 0) {
-                lca_string_append_format(print_context->output, "%s_bb%lld%s:\n", COL(COL_NAME), i, COL(COL_DELIM));
+                lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, "_bb");
+                lca_writer_append_int(print_context->output, i);
+                lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, ":\n");
             } else {
-                lca_string_append_format(print_context->output, "%s%.*s%s:\n", COL(COL_NAME), STR_EXPAND(block->block.name), COL(COL_DELIM));
+                lca_writer_append_cstring(print_context->output, COL(COL_NAME));
+                lca_writer_append_view(print_context->output, block->block.name);
+                lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+                LCA_WRITER_APPEND_LITERAL(print_context->output, ":\n");
             }
 
             for (int64_t j = 0, count2 = arr_count(block->block.instructions); j < count2; j++) {
@@ -2720,133 +3693,178 @@ static void layec_function_print(layec_print_context* print_context, layec_value
             }
         }
 
-        lca_string_append_format(print_context->output, "%s}%s\n", COL(COL_DELIM), COL(RESET));
+        lca_writer_append_cstring(print_context->output, COL(COL_DELIM));
+        lca_writer_append_char(print_context->output, '}');
+        lca_writer_append_cstring(print_context->output, COL(RESET));
+        lca_writer_append_char(print_context->output, '\n');
     }
 }
 
-static void layec_type_print_struct_type_to_string_literally(layec_type* type, string* s, bool use_color) {
-    lca_string_append_format(s, "%sstruct %s{", COL(COL_KEYWORD), COL(RESET));
+static void layec_type_print_struct_type_to_writer_literally(layec_type* type, lca_writer* w, bool use_color) {
+    lca_writer_append_cstring(w, COL(COL_KEYWORD));
+    LCA_WRITER_APPEND_LITERAL(w, "struct ");
+    lca_writer_append_cstring(w, COL(RESET));
+    lca_writer_append_char(w, '{');
 
     for (int64_t i = 0, count = arr_count(type->_struct.members); i < count; i++) {
         if (i > 0) {
-            lca_string_append_format(s, "%s, ", COL(RESET));
+            lca_writer_append_cstring(w, COL(RESET));
+            LCA_WRITER_APPEND_LITERAL(w, ", ");
         } else {
-            lca_string_append_format(s, " ");
+            lca_writer_append_char(w, ' ');
         }
 
         layec_type* member_type = type->_struct.members[i].type;
-        layec_type_print_to_string(member_type, s, use_color);
+        layec_type_print_to_writer(member_type, w, use_color);
     }
 
-    lca_string_append_format(s, "%s }", COL(RESET));
+    lca_writer_append_cstring(w, COL(RESET));
+    LCA_WRITER_APPEND_LITERAL(w, " }");
 }
 
-void layec_type_print_to_string(layec_type* type, string* s, bool use_color) {
+void layec_type_print_to_writer(layec_type* type, lca_writer* w, bool use_color) {
     assert(type != NULL);
-    assert(s != NULL);
+    assert(w != NULL);
 
     switch (type->kind) {
         default: {
             fprintf(stderr, "for type %s\n", layec_type_kind_to_cstring(type->kind));
-            assert(false && "unhandled type in layec_type_print_to_string");
+            assert(false && "unhandled type in layec_type_print_to_writer");
         } break;
 
         case LAYEC_TYPE_POINTER: {
-            lca_string_append_format(s, "%sptr", COL(COL_KEYWORD));
+            lca_writer_append_cstring(w, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(w, "ptr");
         } break;
 
         case LAYEC_TYPE_VOID: {
-            lca_string_append_format(s, "%svoid", COL(COL_KEYWORD));
+            lca_writer_append_cstring(w, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(w, "void");
         } break;
 
         case LAYEC_TYPE_INTEGER: {
-            lca_string_append_format(s, "%sint%d", COL(COL_KEYWORD), type->primitive_bit_width);
+            lca_writer_append_cstring(w, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(w, "int");
+            lca_writer_append_int(w, type->primitive_bit_width);
         } break;
 
         case LAYEC_TYPE_FLOAT: {
-            lca_string_append_format(s, "%sfloat%d", COL(COL_KEYWORD), type->primitive_bit_width);
+            lca_writer_append_cstring(w, COL(COL_KEYWORD));
+            LCA_WRITER_APPEND_LITERAL(w, "float");
+            lca_writer_append_int(w, type->primitive_bit_width);
         } break;
 
         case LAYEC_TYPE_ARRAY: {
-            layec_type_print_to_string(type->array.element_type, s, use_color);
-            lca_string_append_format(s, "%s[%s%lld%s]", COL(COL_DELIM), COL(COL_CONSTANT), type->array.length, COL(COL_DELIM));
+            layec_type_print_to_writer(type->array.element_type, w, use_color);
+            lca_writer_append_cstring(w, COL(COL_DELIM));
+            lca_writer_append_char(w, '[');
+            lca_writer_append_cstring(w, COL(COL_CONSTANT));
+            lca_writer_append_int(w, type->array.length);
+            lca_writer_append_cstring(w, COL(COL_DELIM));
+            lca_writer_append_char(w, ']');
         } break;
 
         case LAYEC_TYPE_STRUCT: {
             if (type->_struct.named) {
-                lca_string_append_format(s, "%s@%.*s", COL(COL_NAME), STR_EXPAND(type->_struct.name));
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                lca_writer_append_char(w, '@');
+                lca_writer_append_view(w, type->_struct.name);
             } else {
-                layec_type_print_struct_type_to_string_literally(type, s, use_color);
+                layec_type_print_struct_type_to_writer_literally(type, w, use_color);
             }
         } break;
     }
 
-    lca_string_append_format(s, "%s", COL(RESET));
+    lca_writer_append_cstring(w, COL(RESET));
 }
 
-void layec_value_print_to_string(layec_value* value, string* s, bool print_type, bool use_color) {
+void layec_value_print_to_writer(layec_value* value, lca_writer* w, bool print_type, bool use_color) {
     assert(value != NULL);
-    assert(s != NULL);
+    assert(w != NULL);
 
     if (print_type) {
-        layec_type_print_to_string(value->type, s, use_color);
-        lca_string_append_format(s, "%s ", COL(RESET));
+        layec_type_print_to_writer(value->type, w, use_color);
+        lca_writer_append_cstring(w, COL(RESET));
+        lca_writer_append_char(w, ' ');
     }
 
     switch (value->kind) {
         default: {
             if (value->name.count == 0) {
-                lca_string_append_format(s, "%s%%%lld", COL(COL_NAME), value->index);
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                lca_writer_append_char(w, '%');
+                lca_writer_append_int(w, layec_value_index(value));
             } else {
-                lca_string_append_format(s, "%s%%%.*s", COL(COL_NAME), STR_EXPAND(value->name));
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                lca_writer_append_char(w, '%');
+                lca_writer_append_view(w, value->name);
             }
         } break;
 
         case LAYEC_IR_FUNCTION: {
-            lca_string_append_format(s, "%s@%.*s", COL(COL_NAME), STR_EXPAND(value->function.name));
+            lca_writer_append_cstring(w, COL(COL_NAME));
+            lca_writer_append_char(w, '@');
+            lca_writer_append_view(w, value->function.name);
         } break;
 
         case LAYEC_IR_BLOCK: {
             if (value->block.name.count == 0) {
-                lca_string_append_format(s, "%s%%_bb%lld", COL(COL_NAME), value->block.index);
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                LCA_WRITER_APPEND_LITERAL(w, "%_bb");
+                lca_writer_append_int(w, value->block.index);
             } else {
-                lca_string_append_format(s, "%s%%%.*s", COL(COL_NAME), STR_EXPAND(value->block.name));
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                lca_writer_append_char(w, '%');
+                lca_writer_append_view(w, value->block.name);
             }
         } break;
 
         case LAYEC_IR_INTEGER_CONSTANT: {
-            lca_string_append_format(s, "%s%lld", COL(COL_CONSTANT), value->int_value);
+            lca_writer_append_cstring(w, COL(COL_CONSTANT));
+            lca_writer_append_int(w, value->int_value);
         } break;
 
         case LAYEC_IR_FLOAT_CONSTANT: {
-            lca_string_append_format(s, "%s%f", COL(COL_CONSTANT), value->float_value);
+            lca_writer_append_cstring(w, COL(COL_CONSTANT));
+            lca_writer_append_float(w, value->float_value);
+        } break;
+
+        case LAYEC_IR_POISON: {
+            lca_writer_append_cstring(w, COL(COL_CONSTANT));
+            LCA_WRITER_APPEND_LITERAL(w, "poison");
         } break;
 
         case LAYEC_IR_GLOBAL_VARIABLE: {
             if (value->name.count == 0) {
-                lca_string_append_format(s, "%s@global.%lld", COL(COL_NAME), value->index);
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                LCA_WRITER_APPEND_LITERAL(w, "@global.");
+                lca_writer_append_int(w, value->index);
             } else {
-                lca_string_append_format(s, "%s@%.*s", COL(COL_NAME), STR_EXPAND(value->name));
+                lca_writer_append_cstring(w, COL(COL_NAME));
+                lca_writer_append_char(w, '@');
+                lca_writer_append_view(w, value->name);
             }
         } break;
 
         case LAYEC_IR_ARRAY_CONSTANT: {
             if (value->array.is_string_literal) {
-                lca_string_append_format(s, "%s\"", COL(COL_CONSTANT));
+                lca_writer_append_cstring(w, COL(COL_CONSTANT));
+                lca_writer_append_char(w, '"');
                 for (int64_t i = 0; i < value->array.length; i++) {
                     uint8_t c = (uint8_t)value->array.data[i];
                     if (c < 32 || c > 127) {
-                        lca_string_append_format(s, "\\%02X", (int)c);
+                        lca_writer_append_char(w, '\\');
+                        lca_writer_append_hex(w, c, 2);
                     } else {
-                        lca_string_append_format(s, "%c", c);
+                        lca_writer_append_char(w, c);
                     }
                 }
-                lca_string_append_format(s, "\"");
+                lca_writer_append_char(w, '"');
             } else {
-                assert(false && "todo layec_value_print_to_string non-string arrays");
+                assert(false && "todo layec_value_print_to_writer non-string arrays");
             }
         } break;
     }
 
-    lca_string_append_format(s, "%s", COL(RESET));
+    lca_writer_append_cstring(w, COL(RESET));
 }
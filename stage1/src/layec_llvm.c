@@ -51,7 +51,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 typedef struct llvm_codegen {
     layec_context* context;
     bool use_color;
-    string* output;
+    lca_writer* output;
 } llvm_codegen;
 
 static void llvm_print_module(llvm_codegen* codegen, layec_module* module);
@@ -61,17 +61,24 @@ string layec_codegen_llvm(layec_module* module) {
     layec_context* context = layec_module_context(module);
     assert(context != NULL);
 
-    string output_string = string_create(context->allocator);
+    lca_writer output_writer = lca_writer_create(context->allocator);
+    layec_codegen_llvm_to_writer(module, &output_writer);
+    return lca_writer_to_string(&output_writer);
+}
+
+void layec_codegen_llvm_to_writer(layec_module* module, lca_writer* output) {
+    assert(module != NULL);
+    assert(output != NULL);
+    layec_context* context = layec_module_context(module);
+    assert(context != NULL);
 
     llvm_codegen codegen = {
         .context = context,
         .use_color = context->use_color,
-        .output = &output_string,
+        .output = output,
     };
 
     llvm_print_module(&codegen, module);
-
-    return output_string;
 }
 
 static void llvm_print_header(llvm_codegen* codegen, layec_module* module);
@@ -90,141 +97,150 @@ static void llvm_print_module(llvm_codegen* codegen, layec_module* module) {
     llvm_print_header(codegen, module);
 
     for (int64_t i = 0, count = layec_module_global_count(module); i < count; i++) {
-        if (i > 0) lca_string_append_format(codegen->output, "\n");
+        if (i > 0) lca_writer_append_char(codegen->output, '\n');
         layec_value* global = layec_module_get_global_at_index(module, i);
         llvm_print_global(codegen, global);
     }
 
-    if (layec_module_global_count(module) > 0) lca_string_append_format(codegen->output, "\n");
+    if (layec_module_global_count(module) > 0) lca_writer_append_char(codegen->output, '\n');
 
     for (int64_t i = 0, count = layec_module_function_count(module); i < count; i++) {
-        if (i > 0) lca_string_append_format(codegen->output,  "\n");
+        if (i > 0) lca_writer_append_char(codegen->output, '\n');
         layec_value* function = layec_module_get_function_at_index(module, i);
         llvm_print_function(codegen, function);
     }
 }
 
 static void llvm_print_header(llvm_codegen* codegen, layec_module* module) {
-    lca_string_append_format(codegen->output, "; ModuleID = '%.*s'\n", STR_EXPAND(layec_module_name(module)));
-    lca_string_append_format(codegen->output, "source_filename = \"%.*s\"\n", STR_EXPAND(layec_module_name(module)));
-    lca_string_append_format(codegen->output, "\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "; ModuleID = '");
+    lca_writer_append_view(codegen->output, layec_module_name(module));
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "'\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "source_filename = \"");
+    lca_writer_append_view(codegen->output, layec_module_name(module));
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "\"\n");
+    lca_writer_append_char(codegen->output, '\n');
 
     for (int64_t i = 0; i < layec_context_get_struct_type_count(codegen->context); i++) {
         layec_type* struct_type = layec_context_get_struct_type_at_index(codegen->context, i);
         if (layec_type_struct_is_named(struct_type)) {
-            lca_string_append_format(codegen->output, "%%%.*s = ", STR_EXPAND(layec_type_struct_name(struct_type)));
+            lca_writer_append_char(codegen->output, '%');
+            lca_writer_append_view(codegen->output, layec_type_struct_name(struct_type));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
             llvm_print_type_struct_literally(codegen, struct_type);
-            lca_string_append_format(codegen->output, "\n");
+            lca_writer_append_char(codegen->output, '\n');
         }
     }
 
     //lca_string_append_format(codegen->output, "declare void @%s(ptr, i8, i64, i1 immarg)\n", LLVM_MEMCPY_INTRINSIC);
     //lca_string_append_format(codegen->output, "\n");
 
-    lca_string_append_format(codegen->output, "declare void @%s(ptr, i8, i64, i1 immarg)\n", LLVM_MEMSET_INTRINSIC);
-    lca_string_append_format(codegen->output, "\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "declare void @");
+    lca_writer_append_cstring(codegen->output, LLVM_MEMSET_INTRINSIC);
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "(ptr, i8, i64, i1 immarg)\n");
+    lca_writer_append_char(codegen->output, '\n');
 }
 
 static void llvm_print_global(llvm_codegen* codegen, layec_value* global) {
     string_view name = layec_value_name(global);
     if (name.count == 0) {
         int64_t index = layec_value_index(global);
-        lca_string_append_format(codegen->output, "@.global.%lld", index);
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "@.global.");
+        lca_writer_append_int(codegen->output, index);
     } else {
-        lca_string_append_format(codegen->output, "@%.*s", STR_EXPAND(name));
+        lca_writer_append_char(codegen->output, '@');
+        lca_writer_append_view(codegen->output, name);
     }
 
     layec_linkage linkage = layec_value_linkage(global);
-    lca_string_append_format(codegen->output, " = %s", linkage == LAYEC_LINK_IMPORTED ? "external" : "private");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
+    lca_writer_append_cstring(codegen->output, linkage == LAYEC_LINK_IMPORTED ? "external" : "private");
 
     bool is_string = layec_instruction_global_is_string(global);
 
     if (is_string) {
-        lca_string_append_format(codegen->output, " unnamed_addr constant");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " unnamed_addr constant");
     } else {
-        lca_string_append_format(codegen->output, " global");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " global");
     }
 
-    lca_string_append_format(codegen->output, " ");
+    lca_writer_append_char(codegen->output, ' ');
     llvm_print_type(codegen, layec_instruction_get_alloca_type(global));
 
     layec_value* value = layec_instruction_get_value(global);
     if (value == NULL) {
-        lca_string_append_format(codegen->output, " zeroinitializer");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " zeroinitializer");
     } else {
-        lca_string_append_format(codegen->output, " ");
+        lca_writer_append_char(codegen->output, ' ');
         llvm_print_value(codegen, value, false);
     }
 
-    lca_string_append_format(codegen->output, ", align %d\n", layec_type_align_in_bytes(layec_value_get_type(global)));
+    LCA_WRITER_APPEND_LITERAL(codegen->output, ", align ");
+    lca_writer_append_int(codegen->output, layec_type_align_in_bytes(layec_value_get_type(global)));
+    lca_writer_append_char(codegen->output, '\n');
 }
 
 static void llvm_print_function(llvm_codegen* codegen, layec_value* function) {
     int64_t block_count = layec_function_block_count(function);
 
-    lca_string_append_format(
-        codegen->output,
-        "%s ",
-        (block_count == 0 ? "declare" : "define")
-    );
+    lca_writer_append_cstring(codegen->output, (block_count == 0 ? "declare" : "define"));
+    lca_writer_append_char(codegen->output, ' ');
 
     llvm_print_type(codegen, layec_function_return_type(function));
 
-    lca_string_append_format(
-        codegen->output,
-        " @%.*s(",
-        STR_EXPAND(layec_function_name(function))
-    );
+    LCA_WRITER_APPEND_LITERAL(codegen->output, " @");
+    lca_writer_append_view(codegen->output, layec_function_name(function));
+    lca_writer_append_char(codegen->output, '(');
 
     layec_type* function_type = layec_value_get_type(function);
     assert(layec_type_is_function(function_type));
     for (int64_t i = 0, count = layec_function_type_parameter_count(function_type); i < count; i++) {
         if (i > 0) {
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
         }
 
         layec_type* parameter_type = layec_function_type_get_parameter_type_at_index(function_type, i);
         llvm_print_type(codegen, parameter_type);
-        lca_string_append_format(codegen->output, " %%%lld", i);
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " %");
+        lca_writer_append_int(codegen->output, i);
     }
 
     if (layec_function_type_is_variadic(function_type)) {
         if (layec_function_type_parameter_count(function_type) != 0) {
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
         }
 
-        lca_string_append_format(codegen->output, "...");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "...");
     }
 
-    lca_string_append_format(codegen->output, ")");
+    lca_writer_append_char(codegen->output, ')');
 
     if (block_count == 0) {
-        lca_string_append_format(codegen->output, "\n\n");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "\n\n");
         return;
     }
 
-    lca_string_append_format(codegen->output, " {\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, " {\n");
 
     for (int64_t i = 0; i < block_count; i++) {
         llvm_print_block(codegen, layec_function_get_block_at_index(function, i));
     }
 
-    lca_string_append_format(codegen->output, "}\n");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "}\n");
 }
 
 static void llvm_print_type_struct_literally(llvm_codegen* codegen, layec_type* type) {
-    lca_string_append_format(codegen->output, "type { ");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "type { ");
 
     for (int64_t i = 0; i < layec_type_struct_member_count(type); i++) {
         if (i > 0) {
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
         }
 
         layec_type* member_type = layec_type_struct_get_member_type_at_index(type, i);
         llvm_print_type(codegen, member_type);
     }
 
-    lca_string_append_format(codegen->output, "}");
+    lca_writer_append_char(codegen->output, '}');
 }
 
 static void llvm_print_type(llvm_codegen* codegen, layec_type* type) {
@@ -235,15 +251,16 @@ static void llvm_print_type(llvm_codegen* codegen, layec_type* type) {
         } break;
 
         case LAYEC_TYPE_POINTER: {
-            lca_string_append_format(codegen->output, "ptr");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "ptr");
         } break;
 
         case LAYEC_TYPE_VOID: {
-            lca_string_append_format(codegen->output, "void");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "void");
         } break;
 
         case LAYEC_TYPE_INTEGER: {
-            lca_string_append_format(codegen->output, "i%d", layec_type_size_in_bits(type));
+            lca_writer_append_char(codegen->output, 'i');
+            lca_writer_append_int(codegen->output, layec_type_size_in_bits(type));
         } break;
 
         case LAYEC_TYPE_FLOAT: {
@@ -254,25 +271,28 @@ static void llvm_print_type(llvm_codegen* codegen, layec_type* type) {
                 } break;
 
                 case 32: {
-                    lca_string_append_format(codegen->output, "float");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "float");
                 } break;
 
                 case 64: {
-                    lca_string_append_format(codegen->output, "double");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, "double");
                 } break;
             }
         } break;
 
         case LAYEC_TYPE_ARRAY: {
             layec_type* element_type = layec_type_element_type(type);
-            lca_string_append_format(codegen->output, "[%lld x ", layec_type_array_length(type));
+            lca_writer_append_char(codegen->output, '[');
+            lca_writer_append_int(codegen->output, layec_type_array_length(type));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " x ");
             llvm_print_type(codegen, element_type);
-            lca_string_append_format(codegen->output, "]");
+            lca_writer_append_char(codegen->output, ']');
         } break;
 
         case LAYEC_TYPE_STRUCT: {
             if (layec_type_struct_is_named(type)) {
-                lca_string_append_format(codegen->output, "%%%.*s", STR_EXPAND(layec_type_struct_name(type)));
+                lca_writer_append_char(codegen->output, '%');
+                lca_writer_append_view(codegen->output, layec_type_struct_name(type));
             } else {
                 llvm_print_type_struct_literally(codegen, type);
             }
@@ -284,9 +304,12 @@ static void llvm_print_block(llvm_codegen* codegen, layec_value* block) {
     int64_t instruction_count = layec_block_instruction_count(block);
 
     if (layec_block_has_name(block)) {
-        lca_string_append_format(codegen->output, "%.*s:\n", STR_EXPAND(layec_block_name(block)));
+        lca_writer_append_view(codegen->output, layec_block_name(block));
+        LCA_WRITER_APPEND_LITERAL(codegen->output, ":\n");
     } else {
-        lca_string_append_format(codegen->output, "_bb%lld:\n", layec_block_index(block));
+        LCA_WRITER_APPEND_LITERAL(codegen->output, "_bb");
+        lca_writer_append_int(codegen->output, layec_block_index(block));
+        LCA_WRITER_APPEND_LITERAL(codegen->output, ":\n");
     }
 
     for (int64_t i = 0; i < instruction_count; i++) {
@@ -301,11 +324,11 @@ static void llvm_print_instruction(llvm_codegen* codegen, layec_value* instructi
         return;
     }
 
-    lca_string_append_format(codegen->output, "  ");
+    LCA_WRITER_APPEND_LITERAL(codegen->output, "  ");
 
     if (!layec_type_is_void(layec_value_get_type(instruction))) {
         llvm_print_value(codegen, instruction, false);
-        lca_string_append_format(codegen->output, " = ");
+        LCA_WRITER_APPEND_LITERAL(codegen->output, " = ");
     }
 
     switch (kind) {
@@ -315,62 +338,63 @@ static void llvm_print_instruction(llvm_codegen* codegen, layec_value* instructi
         } break;
 
         case LAYEC_IR_UNREACHABLE: {
-            lca_string_append_format(codegen->output, "unreachable");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "unreachable");
         } break;
 
         case LAYEC_IR_RETURN: {
-            lca_string_append_format(codegen->output, "ret ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "ret ");
             if (layec_instruction_return_has_value(instruction)) {
                 llvm_print_value(codegen, layec_instruction_return_value(instruction), true);
             } else {
-                lca_string_append_format(codegen->output, "void");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "void");
             }
         } break;
 
         case LAYEC_IR_ALLOCA: {
-            lca_string_append_format(codegen->output, "alloca ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "alloca ");
             llvm_print_type(codegen, layec_instruction_get_alloca_type(instruction));
-            lca_string_append_format(codegen->output, ", i64 1");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", i64 1");
         } break;
 
         case LAYEC_IR_STORE: {
-            lca_string_append_format(codegen->output, "store ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "store ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_get_address(instruction), true);
-            lca_string_append_format(codegen->output, ", align %d", layec_type_align_in_bytes(layec_value_get_type(layec_instruction_get_operand(instruction))));
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", align ");
+            lca_writer_append_int(codegen->output, layec_type_align_in_bytes(layec_value_get_type(layec_instruction_get_operand(instruction))));
         } break;
 
         case LAYEC_IR_LOAD: {
-            lca_string_append_format(codegen->output, "load ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "load ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_get_address(instruction), true);
         } break;
 
         case LAYEC_IR_CALL: {
-            lca_string_append_format(codegen->output, "call ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "call ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
-            lca_string_append_format(codegen->output, " ");
+            lca_writer_append_char(codegen->output, ' ');
             llvm_print_value(codegen, layec_instruction_callee(instruction), false);
-            lca_string_append_format(codegen->output, "(");
+            lca_writer_append_char(codegen->output, '(');
 
             for (int64_t i = 0, count = layec_instruction_call_argument_count(instruction); i < count; i++) {
                 if (i > 0) {
-                    lca_string_append_format(codegen->output, ", ");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
                 }
 
                 layec_value* argument = layec_instruction_call_get_argument_at_index(instruction, i);
                 llvm_print_value(codegen, argument, true);
             }
 
-            lca_string_append_format(codegen->output, ")");
+            lca_writer_append_char(codegen->output, ')');
         } break;
 
         case LAYEC_IR_PTRADD: {
-            lca_string_append_format(codegen->output, "getelementptr inbounds i8, ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "getelementptr inbounds i8, ");
             llvm_print_value(codegen, layec_instruction_get_address(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
         } break;
 
@@ -387,11 +411,13 @@ static void llvm_print_instruction(llvm_codegen* codegen, layec_value* instructi
                 case LAYEC_BUILTIN_MEMSET: intrinsic_name = LLVM_MEMSET_INTRINSIC; break;
             }
 
-            lca_string_append_format(codegen->output, "call void @%s(", intrinsic_name);
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "call void @");
+            lca_writer_append_cstring(codegen->output, intrinsic_name);
+            lca_writer_append_char(codegen->output, '(');
 
             for (int64_t i = 0, count = layec_instruction_builtin_argument_count(instruction); i < count; i++) {
                 if (i > 0) {
-                    lca_string_append_format(codegen->output, ", ");
+                    LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
                 }
 
                 layec_value* argument = layec_instruction_builtin_get_argument_at_index(instruction, i);
@@ -404,440 +430,440 @@ static void llvm_print_instruction(llvm_codegen* codegen, layec_value* instructi
                 }
 
                 case LAYEC_BUILTIN_MEMCOPY:
-                case LAYEC_BUILTIN_MEMSET: lca_string_append_format(codegen->output, ", i1 false"); break;
+                case LAYEC_BUILTIN_MEMSET: LCA_WRITER_APPEND_LITERAL(codegen->output, ", i1 false"); break;
             }
 
-            lca_string_append_format(codegen->output, ")");
+            lca_writer_append_char(codegen->output, ')');
         } break;
 
         case LAYEC_IR_BRANCH: {
-            lca_string_append_format(codegen->output, "br label ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "br label ");
             llvm_print_value(codegen, layec_instruction_branch_get_pass(instruction), false);
         } break;
 
         case LAYEC_IR_COND_BRANCH: {
-            lca_string_append_format(codegen->output, "br i1 ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "br i1 ");
             llvm_print_value(codegen, layec_instruction_get_value(instruction), false);
-            lca_string_append_format(codegen->output, ", label ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", label ");
             llvm_print_value(codegen, layec_instruction_branch_get_pass(instruction), false);
-            lca_string_append_format(codegen->output, ", label ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", label ");
             llvm_print_value(codegen, layec_instruction_branch_get_fail(instruction), false);
         } break;
 
         case LAYEC_IR_PHI: {
-            lca_string_append_format(codegen->output, "phi ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "phi ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
 
             for (int64_t i = 0, count = layec_instruction_phi_incoming_value_count(instruction); i < count; i++) {
-                if (i > 0) lca_string_append_format(codegen->output, ",");
-                lca_string_append_format(codegen->output, " [ ");
+                if (i > 0) lca_writer_append_char(codegen->output, ',');
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " [ ");
                 llvm_print_value(codegen, layec_instruction_phi_incoming_value_at_index(instruction, i), false);
-                lca_string_append_format(codegen->output, ", ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
                 llvm_print_value(codegen, layec_instruction_phi_incoming_block_at_index(instruction, i), false);
-                lca_string_append_format(codegen->output, " ]");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " ]");
             }
         } break;
 
         case LAYEC_IR_SEXT: {
-            lca_string_append_format(codegen->output, "sext ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "sext ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_ZEXT: {
-            lca_string_append_format(codegen->output, "zext ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "zext ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_TRUNC: {
-            lca_string_append_format(codegen->output, "trunc ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "trunc ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_BITCAST: {
-            lca_string_append_format(codegen->output, "bitcast ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "bitcast ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_NEG: {
             layec_value* operand = layec_instruction_get_operand(instruction);
             if (layec_type_is_float(layec_value_get_type(operand))) {
-                lca_string_append_format(codegen->output, "fsub ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "fsub ");
                 llvm_print_type(codegen, layec_value_get_type(operand));
-                lca_string_append_format(codegen->output, " 0.0, ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " 0.0, ");
             } else {
-                lca_string_append_format(codegen->output, "sub ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "sub ");
                 llvm_print_type(codegen, layec_value_get_type(operand));
-                lca_string_append_format(codegen->output, " 0, ");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, " 0, ");
             }
             llvm_print_value(codegen, operand, false);
         } break;
 
         case LAYEC_IR_COMPL: {
-            lca_string_append_format(codegen->output, "xor ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "xor ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, ", -1");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", -1");
         } break;
 
         case LAYEC_IR_FPTOUI: {
-            lca_string_append_format(codegen->output, "fptoui ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fptoui ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_FPTOSI: {
-            lca_string_append_format(codegen->output, "fptosi ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fptosi ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_UITOFP: {
-            lca_string_append_format(codegen->output, "uitofp ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "uitofp ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_SITOFP: {
-            lca_string_append_format(codegen->output, "sitofp ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "sitofp ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_FPEXT: {
-            lca_string_append_format(codegen->output, "fpext ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fpext ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_FPTRUNC: {
-            lca_string_append_format(codegen->output, "fptrunc ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fptrunc ");
             llvm_print_value(codegen, layec_instruction_get_operand(instruction), true);
-            lca_string_append_format(codegen->output, " to ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, " to ");
             llvm_print_type(codegen, layec_value_get_type(instruction));
         } break;
 
         case LAYEC_IR_ADD: {
-            lca_string_append_format(codegen->output, "add ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "add ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FADD: {
-            lca_string_append_format(codegen->output, "fadd ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fadd ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SUB: {
-            lca_string_append_format(codegen->output, "sub ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "sub ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FSUB: {
-            lca_string_append_format(codegen->output, "fsub ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fsub ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_MUL: {
-            lca_string_append_format(codegen->output, "mul ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "mul ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FMUL: {
-            lca_string_append_format(codegen->output, "fmul ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fmul ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SDIV: {
-            lca_string_append_format(codegen->output, "sdiv ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "sdiv ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_UDIV: {
-            lca_string_append_format(codegen->output, "udiv ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "udiv ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FDIV: {
-            lca_string_append_format(codegen->output, "fdiv ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fdiv ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SMOD: {
-            lca_string_append_format(codegen->output, "srem ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "srem ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_UMOD: {
-            lca_string_append_format(codegen->output, "urem ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "urem ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FMOD: {
-            lca_string_append_format(codegen->output, "frem ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "frem ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_AND: {
-            lca_string_append_format(codegen->output, "and ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "and ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_OR: {
-            lca_string_append_format(codegen->output, "or ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "or ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_XOR: {
-            lca_string_append_format(codegen->output, "xor ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "xor ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SHL: {
-            lca_string_append_format(codegen->output, "shl ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "shl ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SAR: {
-            lca_string_append_format(codegen->output, "ashr ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "ashr ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_SHR: {
-            lca_string_append_format(codegen->output, "lshr ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "lshr ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_EQ: {
-            lca_string_append_format(codegen->output, "icmp eq ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp eq ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_NE: {
-            lca_string_append_format(codegen->output, "icmp ne ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp ne ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_SLT: {
-            lca_string_append_format(codegen->output, "icmp slt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp slt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_ULT: {
-            lca_string_append_format(codegen->output, "icmp ult ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp ult ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_SLE: {
-            lca_string_append_format(codegen->output, "icmp sle ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp sle ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_ULE: {
-            lca_string_append_format(codegen->output, "icmp ule ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp ule ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_SGT: {
-            lca_string_append_format(codegen->output, "icmp sgt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp sgt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_UGT: {
-            lca_string_append_format(codegen->output, "icmp ugt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp ugt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_SGE: {
-            lca_string_append_format(codegen->output, "icmp sge ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp sge ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_ICMP_UGE: {
-            lca_string_append_format(codegen->output, "icmp uge ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "icmp uge ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_FALSE: {
-            lca_string_append_format(codegen->output, "fcmp false ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp false ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_OEQ: {
-            lca_string_append_format(codegen->output, "fcmp oeq ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp oeq ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_OGT: {
-            lca_string_append_format(codegen->output, "fcmp ogt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ogt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_OGE: {
-            lca_string_append_format(codegen->output, "fcmp oge ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp oge ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_OLT: {
-            lca_string_append_format(codegen->output, "fcmp olt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp olt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_OLE: {
-            lca_string_append_format(codegen->output, "fcmp ole ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ole ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_ONE: {
-            lca_string_append_format(codegen->output, "fcmp one ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp one ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_ORD: {
-            lca_string_append_format(codegen->output, "fcmp ord ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ord ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_UEQ: {
-            lca_string_append_format(codegen->output, "fcmp ueq ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ueq ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_UGT: {
-            lca_string_append_format(codegen->output, "fcmp ugt ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ugt ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_UGE: {
-            lca_string_append_format(codegen->output, "fcmp uge ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp uge ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_ULT: {
-            lca_string_append_format(codegen->output, "fcmp ult ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ult ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_ULE: {
-            lca_string_append_format(codegen->output, "fcmp ule ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp ule ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_UNE: {
-            lca_string_append_format(codegen->output, "fcmp une ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp une ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_UNO: {
-            lca_string_append_format(codegen->output, "fcmp uno ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp uno ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
 
         case LAYEC_IR_FCMP_TRUE: {
-            lca_string_append_format(codegen->output, "fcmp true ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "fcmp true ");
             llvm_print_value(codegen, layec_instruction_binary_get_lhs(instruction), true);
-            lca_string_append_format(codegen->output, ", ");
+            LCA_WRITER_APPEND_LITERAL(codegen->output, ", ");
             llvm_print_value(codegen, layec_instruction_binary_get_rhs(instruction), false);
         } break;
     }
 
-    lca_string_append_format(codegen->output, "\n");
+    lca_writer_append_char(codegen->output, '\n');
 }
 
 static void llvm_print_value(llvm_codegen* codegen, layec_value* value, bool include_type) {
@@ -845,7 +871,7 @@ static void llvm_print_value(llvm_codegen* codegen, layec_value* value, bool inc
 
     if (include_type) {
         llvm_print_type(codegen, layec_value_get_type(value));
-        lca_string_append_format(codegen->output, " ");
+        lca_writer_append_char(codegen->output, ' ');
     }
 
     switch (kind) {
@@ -853,66 +879,78 @@ static void llvm_print_value(llvm_codegen* codegen, layec_value* value, bool inc
             string_view name = layec_value_name(value);
             if (name.count == 0) {
                 int64_t index = layec_value_index(value);
-                lca_string_append_format(codegen->output, "%%%lld", index);
+                lca_writer_append_char(codegen->output, '%');
+                lca_writer_append_int(codegen->output, index);
             } else {
-                lca_string_append_format(codegen->output, "%%%.*s", STR_EXPAND(name));
+                lca_writer_append_char(codegen->output, '%');
+                lca_writer_append_view(codegen->output, name);
             }
         } break;
 
         case LAYEC_IR_FUNCTION: {
-            lca_string_append_format(codegen->output, "@%.*s", STR_EXPAND(layec_function_name(value)));
+            lca_writer_append_char(codegen->output, '@');
+            lca_writer_append_view(codegen->output, layec_function_name(value));
         } break;
 
         case LAYEC_IR_INTEGER_CONSTANT: {
             int64_t ival = layec_value_integer_constant(value);
             if (layec_type_is_ptr(layec_value_get_type(value)) && ival == 0)
-                lca_string_append_format(codegen->output, "null");
-            else lca_string_append_format(codegen->output, "%lld", ival);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "null");
+            else lca_writer_append_int(codegen->output, ival);
         } break;
 
         case LAYEC_IR_FLOAT_CONSTANT: {
             double float_value = layec_value_float_constant(value);
             if (float_value == 0.0) {
-                lca_string_append_format(codegen->output, "0.0");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "0.0");
             } else {
-                lca_string_append_format(codegen->output, "%f", float_value);
+                lca_writer_append_float(codegen->output, float_value);
             }
         } break;
 
+        case LAYEC_IR_POISON: {
+            LCA_WRITER_APPEND_LITERAL(codegen->output, "poison");
+        } break;
+
         case LAYEC_IR_GLOBAL_VARIABLE: {
             string_view name = layec_value_name(value);
             if (name.count == 0) {
                 int64_t index = layec_value_index(value);
-                lca_string_append_format(codegen->output, "@.global.%lld", index);
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "@.global.");
+                lca_writer_append_int(codegen->output, index);
             } else {
-                lca_string_append_format(codegen->output, "@%.*s", STR_EXPAND(name));
+                lca_writer_append_char(codegen->output, '@');
+                lca_writer_append_view(codegen->output, name);
             }
         } break;
 
         case LAYEC_IR_BLOCK: {
             if (layec_block_has_name(value)) {
-                lca_string_append_format(codegen->output, "%%%.*s", STR_EXPAND(layec_block_name(value)));
+                lca_writer_append_char(codegen->output, '%');
+                lca_writer_append_view(codegen->output, layec_block_name(value));
             } else {
-                lca_string_append_format(codegen->output, "%%_bb%lld", layec_block_index(value));
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "%_bb");
+                lca_writer_append_int(codegen->output, layec_block_index(value));
             }
         } break;
 
         case LAYEC_IR_ARRAY_CONSTANT: {
             bool is_string = layec_array_constant_is_string(value);
             if (is_string) {
-                lca_string_append_format(codegen->output, "c\"");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "c\"");
                 const uint8_t* data = (const uint8_t*)layec_array_constant_data(value);
                 for (int64_t i = 0, count = layec_array_constant_length(value); i < count; i++) {
                     uint8_t c = data[i];
                     if (c < 32 || c > 127) {
-                        lca_string_append_format(codegen->output, "\\%02X", (int)c);
+                        lca_writer_append_char(codegen->output, '\\');
+                        lca_writer_append_hex(codegen->output, c, 2);
                     } else {
-                        lca_string_append_format(codegen->output, "%c", c);
+                        lca_writer_append_char(codegen->output, c);
                     }
                 }
-                lca_string_append_format(codegen->output, "\"");
+                lca_writer_append_char(codegen->output, '"');
             } else {
-                lca_string_append_format(codegen->output, "{}");
+                LCA_WRITER_APPEND_LITERAL(codegen->output, "{}");
                 assert(false && "todo llvm_print_value non-string arrays");
             }
         } break;
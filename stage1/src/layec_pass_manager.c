@@ -0,0 +1,458 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "layec.h"
+
+typedef enum layec_pass_kind {
+    LAYEC_PASS_MODULE,
+    LAYEC_PASS_FUNCTION,
+} layec_pass_kind;
+
+typedef struct layec_pass {
+    const char* name;
+    layec_pass_kind kind;
+
+    union {
+        layec_ir_pass_function module_pass;
+        layec_ir_function_pass_function function_pass;
+    };
+
+    // accumulated over every module the pass manager has run on, for -ftime-passes.
+    int64_t run_count;
+    double total_seconds;
+    int64_t instruction_delta;
+    int64_t block_delta;
+} layec_pass;
+
+typedef struct layec_cached_analysis {
+    const layec_analysis_info* analysis;
+    void* result;
+    // the function's version (or CFG version) the result was computed from.
+    int64_t version;
+} layec_cached_analysis;
+
+typedef struct layec_ir_size {
+    int64_t instruction_count;
+    int64_t block_count;
+} layec_ir_size;
+
+struct layec_pass_manager {
+    layec_context* context;
+    dynarr(layec_pass) passes;
+    bool time_passes;
+    bool print_pass_stats;
+    bool print_remarks;
+
+    // what's running, for remarks.
+    layec_module* current_module;
+    layec_pass* current_pass;
+
+    // function -> dynarr(layec_cached_analysis)
+    ptrmap analyses;
+    // every function with cached analyses, so they can be released without walking the map.
+    dynarr(layec_value*) analysed_functions;
+};
+
+layec_pass_manager* layec_pass_manager_create(layec_context* context) {
+    assert(context != NULL);
+
+    layec_pass_manager* pass_manager = lca_allocate(context->allocator, sizeof *pass_manager);
+    assert(pass_manager != NULL);
+    *pass_manager = (layec_pass_manager){
+        .context = context,
+    };
+
+    return pass_manager;
+}
+
+void layec_pass_manager_destroy(layec_pass_manager* pass_manager) {
+    if (pass_manager == NULL) return;
+    assert(pass_manager->context != NULL);
+
+    layec_pass_manager_invalidate_analyses(pass_manager, NULL);
+    ptrmap_free(&pass_manager->analyses);
+    arr_free(pass_manager->analysed_functions);
+    arr_free(pass_manager->passes);
+
+    lca_allocator allocator = pass_manager->context->allocator;
+    *pass_manager = (layec_pass_manager){0};
+    lca_deallocate(allocator, pass_manager);
+}
+
+void layec_pass_manager_add_module_pass(layec_pass_manager* pass_manager, const char* name, layec_ir_pass_function pass) {
+    assert(pass_manager != NULL);
+    assert(name != NULL);
+    assert(pass != NULL);
+
+    layec_pass module_pass = {
+        .name = name,
+        .kind = LAYEC_PASS_MODULE,
+        .module_pass = pass,
+    };
+
+    arr_push(pass_manager->passes, module_pass);
+}
+
+void layec_pass_manager_add_function_pass(layec_pass_manager* pass_manager, const char* name, layec_ir_function_pass_function pass) {
+    assert(pass_manager != NULL);
+    assert(name != NULL);
+    assert(pass != NULL);
+
+    layec_pass function_pass = {
+        .name = name,
+        .kind = LAYEC_PASS_FUNCTION,
+        .function_pass = pass,
+    };
+
+    arr_push(pass_manager->passes, function_pass);
+}
+
+void layec_pass_manager_add_default_passes(layec_pass_manager* pass_manager, int optimization_level) {
+    assert(pass_manager != NULL);
+    assert(optimization_level >= 0);
+
+    layec_pass_manager_add_module_pass(pass_manager, "validate", layec_irpass_validate);
+    layec_pass_manager_add_module_pass(pass_manager, "fix-abi", layec_irpass_fix_abi);
+
+    if (optimization_level >= 1) {
+        layec_pass_manager_add_function_pass(pass_manager, "mem2reg", layec_irpass_mem2reg_function);
+        layec_pass_manager_add_function_pass(pass_manager, "simplify", layec_irpass_simplify_function);
+        layec_pass_manager_add_function_pass(pass_manager, "simplifycfg", layec_irpass_simplifycfg_function);
+
+        // inlined bodies are cleaned up again now that they know their arguments.
+        layec_pass_manager_add_module_pass(pass_manager, "inline", layec_irpass_inline);
+        layec_pass_manager_add_function_pass(pass_manager, "mem2reg", layec_irpass_mem2reg_function);
+        layec_pass_manager_add_function_pass(pass_manager, "simplify", layec_irpass_simplify_function);
+        layec_pass_manager_add_function_pass(pass_manager, "simplifycfg", layec_irpass_simplifycfg_function);
+        // merging blocks turns phis of constants into constants which can be folded further.
+        layec_pass_manager_add_function_pass(pass_manager, "simplify", layec_irpass_simplify_function);
+
+        // -O2 adds the passes which need the dominator tree and loop analyses on top of the
+        // cleanups, besides inlining larger functions.
+        if (optimization_level >= 2) {
+            layec_pass_manager_add_function_pass(pass_manager, "gvn", layec_irpass_gvn_function);
+            layec_pass_manager_add_function_pass(pass_manager, "simplify", layec_irpass_simplify_function);
+
+            // invariant bases leave the loop before their addresses are strength reduced.
+            layec_pass_manager_add_function_pass(pass_manager, "licm", layec_irpass_licm_function);
+            layec_pass_manager_add_function_pass(pass_manager, "lsr", layec_irpass_lsr_function);
+        }
+
+        layec_pass_manager_add_function_pass(pass_manager, "dce", layec_irpass_dce_function);
+        layec_pass_manager_add_module_pass(pass_manager, "validate", layec_irpass_validate);
+    }
+}
+
+void layec_pass_manager_set_time_passes(layec_pass_manager* pass_manager, bool time_passes) {
+    assert(pass_manager != NULL);
+    pass_manager->time_passes = time_passes;
+}
+
+void layec_pass_manager_set_print_pass_stats(layec_pass_manager* pass_manager, bool print_pass_stats) {
+    assert(pass_manager != NULL);
+    pass_manager->print_pass_stats = print_pass_stats;
+}
+
+void layec_pass_manager_set_print_remarks(layec_pass_manager* pass_manager, bool print_remarks) {
+    assert(pass_manager != NULL);
+    pass_manager->print_remarks = print_remarks;
+}
+
+bool layec_pass_manager_wants_remarks(layec_pass_manager* pass_manager) {
+    assert(pass_manager != NULL);
+    return pass_manager->print_remarks && pass_manager->current_pass != NULL;
+}
+
+void layec_pass_manager_remark(layec_pass_manager* pass_manager, layec_value* function, layec_value* block, const char* format, ...) {
+    assert(pass_manager != NULL);
+    assert(function != NULL);
+    assert(format != NULL);
+
+    if (!layec_pass_manager_wants_remarks(pass_manager)) {
+        return;
+    }
+
+    assert(pass_manager->current_module != NULL);
+    string_view module_name = layec_module_name(pass_manager->current_module);
+    string_view function_name = layec_function_name(function);
+    fprintf(stderr, "%.*s: %s: %.*s", STR_EXPAND(module_name), pass_manager->current_pass->name, STR_EXPAND(function_name));
+
+    if (block != NULL) {
+        // the same names the LYIR printer gives blocks.
+        if (layec_block_has_name(block)) {
+            string_view block_name = layec_block_name(block);
+            fprintf(stderr, ": %.*s", STR_EXPAND(block_name));
+        } else {
+            fprintf(stderr, ": _bb%lld", (long long)layec_block_index(block));
+        }
+    }
+
+    fprintf(stderr, ": ");
+
+    va_list v;
+    va_start(v, format);
+    vfprintf(stderr, format, v);
+    va_end(v);
+
+    fprintf(stderr, "\n");
+}
+
+static layec_ir_size layec_module_ir_size(layec_module* module) {
+    layec_ir_size size = {0};
+
+    for (int64_t f = 0, fcount = layec_module_function_count(module); f < fcount; f++) {
+        layec_value* function = layec_module_get_function_at_index(module, f);
+        for (int64_t b = 0, bcount = layec_function_block_count(function); b < bcount; b++) {
+            size.block_count++;
+            size.instruction_count += layec_block_instruction_count(layec_function_get_block_at_index(function, b));
+        }
+    }
+
+    return size;
+}
+
+void layec_pass_manager_run(layec_pass_manager* pass_manager, layec_module* module) {
+    assert(pass_manager != NULL);
+    assert(module != NULL);
+    assert(layec_module_context(module) == pass_manager->context);
+
+    bool measure_size = pass_manager->time_passes || pass_manager->print_pass_stats;
+    string_view module_name = layec_module_name(module);
+
+    pass_manager->current_module = module;
+    for (int64_t p = 0; p < arr_count(pass_manager->passes); p++) {
+        layec_pass* pass = &pass_manager->passes[p];
+        pass_manager->current_pass = pass;
+
+        layec_ir_size size_before = {0};
+        if (measure_size) {
+            size_before = layec_module_ir_size(module);
+        }
+
+        double start_seconds = 0;
+        if (pass_manager->time_passes) {
+            start_seconds = lca_plat_time_seconds();
+        }
+
+        layec_trace_begin(pass_manager->context, "pass", string_view_from_cstring(pass->name), module_name);
+        switch (pass->kind) {
+            case LAYEC_PASS_MODULE: {
+                pass->module_pass(module);
+                // nothing says what a module pass touched, so assume everything.
+                layec_pass_manager_invalidate_analyses(pass_manager, NULL);
+            } break;
+
+            case LAYEC_PASS_FUNCTION: {
+                for (int64_t f = 0, fcount = layec_module_function_count(module); f < fcount; f++) {
+                    layec_value* function = layec_module_get_function_at_index(module, f);
+                    if (layec_function_block_count(function) == 0) {
+                        continue;
+                    }
+
+                    // whatever the pass changed bumped the function's version, which is
+                    // enough for the cached analyses to be recomputed on their next request.
+                    pass->function_pass(pass_manager, function);
+                }
+            } break;
+        }
+        layec_trace_end(pass_manager->context);
+
+        if (pass_manager->time_passes) {
+            pass->total_seconds += lca_plat_time_seconds() - start_seconds;
+        }
+
+        if (measure_size) {
+            layec_ir_size size_after = layec_module_ir_size(module);
+            int64_t instruction_delta = size_after.instruction_count - size_before.instruction_count;
+            int64_t block_delta = size_after.block_count - size_before.block_count;
+
+            pass->instruction_delta += instruction_delta;
+            pass->block_delta += block_delta;
+
+            if (pass_manager->print_pass_stats && (instruction_delta != 0 || block_delta != 0)) {
+                fprintf(
+                    stderr,
+                    "%.*s: %s: %+lld instructions, %+lld blocks\n",
+                    STR_EXPAND(module_name),
+                    pass->name,
+                    (long long)instruction_delta,
+                    (long long)block_delta
+                );
+            }
+        }
+
+        pass->run_count++;
+    }
+
+    pass_manager->current_module = NULL;
+    pass_manager->current_pass = NULL;
+
+    // the module may be destroyed once we're done with it, so nothing can stay cached.
+    layec_pass_manager_invalidate_analyses(pass_manager, NULL);
+}
+
+static int64_t layec_pass_manager_analysis_version(const layec_analysis_info* analysis, layec_value* function) {
+    if (analysis->depends_only_on_cfg) {
+        return layec_function_cfg_version(function);
+    }
+
+    return layec_function_version(function);
+}
+
+void* layec_pass_manager_get_analysis(layec_pass_manager* pass_manager, const layec_analysis_info* analysis, layec_value* function) {
+    assert(pass_manager != NULL);
+    assert(analysis != NULL);
+    assert(analysis->compute != NULL);
+    assert(function != NULL);
+    assert(layec_value_is_function(function));
+
+    dynarr(layec_cached_analysis) cached_analyses = ptrmap_get(&pass_manager->analyses, function);
+    for (int64_t i = 0; i < arr_count(cached_analyses); i++) {
+        if (cached_analyses[i].analysis != analysis) {
+            continue;
+        }
+
+        if (cached_analyses[i].version == layec_pass_manager_analysis_version(analysis, function)) {
+            return cached_analyses[i].result;
+        }
+
+        // stale; drop it and compute it again below.
+        if (analysis->destroy != NULL) {
+            analysis->destroy(cached_analyses[i].result);
+        }
+
+        cached_analyses[i] = *arr_back(cached_analyses);
+        arr_pop(cached_analyses);
+        ptrmap_set(&pass_manager->analyses, function, cached_analyses);
+        break;
+    }
+
+    void* result = analysis->compute(pass_manager, function);
+
+    // the computation may itself have requested (and cached) other analyses of this function.
+    cached_analyses = ptrmap_get(&pass_manager->analyses, function);
+    if (cached_analyses == NULL) {
+        arr_push(pass_manager->analysed_functions, function);
+    }
+
+    layec_cached_analysis cached_analysis = {
+        .analysis = analysis,
+        .result = result,
+        .version = layec_pass_manager_analysis_version(analysis, function),
+    };
+
+    arr_push(cached_analyses, cached_analysis);
+    ptrmap_set(&pass_manager->analyses, function, cached_analyses);
+
+    return result;
+}
+
+static void layec_pass_manager_release_analyses(layec_pass_manager* pass_manager, layec_value* function) {
+    dynarr(layec_cached_analysis) cached_analyses = ptrmap_get(&pass_manager->analyses, function);
+    for (int64_t i = 0; i < arr_count(cached_analyses); i++) {
+        if (cached_analyses[i].analysis->destroy != NULL) {
+            cached_analyses[i].analysis->destroy(cached_analyses[i].result);
+        }
+    }
+
+    arr_free(cached_analyses);
+    ptrmap_remove(&pass_manager->analyses, function);
+}
+
+void layec_pass_manager_invalidate_analyses(layec_pass_manager* pass_manager, layec_value* function) {
+    assert(pass_manager != NULL);
+
+    if (function != NULL) {
+        if (!ptrmap_contains(&pass_manager->analyses, function)) {
+            return;
+        }
+
+        layec_pass_manager_release_analyses(pass_manager, function);
+        for (int64_t i = 0; i < arr_count(pass_manager->analysed_functions); i++) {
+            if (pass_manager->analysed_functions[i] == function) {
+                pass_manager->analysed_functions[i] = *arr_back(pass_manager->analysed_functions);
+                arr_pop(pass_manager->analysed_functions);
+                break;
+            }
+        }
+
+        return;
+    }
+
+    for (int64_t i = 0; i < arr_count(pass_manager->analysed_functions); i++) {
+        layec_pass_manager_release_analyses(pass_manager, pass_manager->analysed_functions[i]);
+    }
+
+    arr_set_count(pass_manager->analysed_functions, 0);
+    assert(pass_manager->analyses.count == 0);
+}
+
+void layec_pass_manager_print_time_passes(layec_pass_manager* pass_manager) {
+    assert(pass_manager != NULL);
+
+    double total_seconds = 0;
+    for (int64_t p = 0; p < arr_count(pass_manager->passes); p++) {
+        total_seconds += pass_manager->passes[p].total_seconds;
+    }
+
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "                          LYIR pass execution timing\n");
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "  Total: %.3f ms\n\n", total_seconds * 1000.0);
+    fprintf(stderr, "  %12s  %7s  %14s  %10s  %s\n", "wall (ms)", "%", "instructions", "blocks", "pass");
+
+    for (int64_t p = 0; p < arr_count(pass_manager->passes); p++) {
+        layec_pass* pass = &pass_manager->passes[p];
+        double percent = total_seconds > 0 ? 100.0 * pass->total_seconds / total_seconds : 0;
+        fprintf(
+            stderr,
+            "  %12.3f  %6.1f%%  %+14lld  %+10lld  %s\n",
+            pass->total_seconds * 1000.0,
+            percent,
+            (long long)pass->instruction_delta,
+            (long long)pass->block_delta,
+            pass->name
+        );
+    }
+}
@@ -0,0 +1,152 @@
+/*
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Local Atticus
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "layec.h"
+
+// writes Chrome's JSON array trace format as it goes. events are left to stdio's buffering so
+// tracing costs no syscall per span; closing the trace, which every exit from the driver does,
+// ends any open spans and flushes. all events are on the one thread.
+typedef struct layec_trace {
+    FILE* stream;
+    double start_time;
+    int64_t depth;
+    bool has_events;
+} layec_trace;
+
+static void layec_trace_write_string(FILE* stream, string_view s) {
+    fputc('"', stream);
+    for (int64_t i = 0; i < s.count; i++) {
+        unsigned char c = (unsigned char)s.data[i];
+        if (c == '"' || c == '\\') {
+            fputc('\\', stream);
+            fputc(c, stream);
+        } else if (c < 0x20) {
+            fprintf(stream, "\\u%04x", c);
+        } else fputc(c, stream);
+    }
+    fputc('"', stream);
+}
+
+static void layec_trace_event_start(layec_trace* trace, const char* phase) {
+    double ts = (lca_plat_time_seconds() - trace->start_time) * 1000000.0;
+    fprintf(trace->stream, "%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":1,\"ts\":%.3f", trace->has_events ? "," : "", phase, ts);
+    trace->has_events = true;
+}
+
+static void layec_trace_event_finish(layec_trace* trace) {
+    fputc('}', trace->stream);
+}
+
+bool layec_trace_open(layec_context* context, const char* file_path) {
+    assert(context != NULL);
+    assert(file_path != NULL);
+    assert(context->trace == NULL && "a trace is already open");
+
+    FILE* stream = fopen(file_path, "wb");
+    if (stream == NULL) {
+        return false;
+    }
+
+    layec_trace* trace = lca_allocate(context->allocator, sizeof *trace);
+    assert(trace != NULL);
+    *trace = (layec_trace){
+        .stream = stream,
+        .start_time = lca_plat_time_seconds(),
+    };
+
+    context->trace = trace;
+
+    setvbuf(stream, NULL, _IOFBF, 64 * 1024);
+    fputc('[', stream);
+    layec_trace_event_start(trace, "M");
+    fprintf(stream, ",\"name\":\"process_name\",\"args\":{\"name\":\"laye1\"}");
+    layec_trace_event_finish(trace);
+    return true;
+}
+
+void layec_trace_close(layec_context* context) {
+    assert(context != NULL);
+    layec_trace* trace = context->trace;
+    if (trace == NULL) return;
+
+    // an early exit can leave spans open; end them here so viewers don't drop them.
+    while (trace->depth > 0) {
+        layec_trace_end(context);
+    }
+
+    fprintf(trace->stream, "\n]\n");
+    fclose(trace->stream);
+
+    lca_deallocate(context->allocator, trace);
+    context->trace = NULL;
+}
+
+void layec_trace_begin(layec_context* context, const char* category, string_view name, string_view detail) {
+    assert(context != NULL);
+    layec_trace* trace = context->trace;
+    if (trace == NULL) return;
+
+    assert(category != NULL);
+    layec_trace_event_start(trace, "B");
+    fprintf(trace->stream, ",\"cat\":\"%s\",\"name\":", category);
+    layec_trace_write_string(trace->stream, name);
+    if (detail.count > 0) {
+        fprintf(trace->stream, ",\"args\":{\"detail\":");
+        layec_trace_write_string(trace->stream, detail);
+        fputc('}', trace->stream);
+    }
+
+    layec_trace_event_finish(trace);
+    trace->depth++;
+}
+
+void layec_trace_end(layec_context* context) {
+    assert(context != NULL);
+    layec_trace* trace = context->trace;
+    if (trace == NULL) return;
+
+    assert(trace->depth > 0 && "trace span ended without one being open");
+    layec_trace_event_start(trace, "E");
+    layec_trace_event_finish(trace);
+    trace->depth--;
+}